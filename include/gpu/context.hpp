@@ -1,7 +1,174 @@
 #pragma once
 
+#include "gpu/pass_timing.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string_view>
+
 namespace vulkron::gpu {
 
-    class Context {};
+    /**
+     * @brief Owns the device and records each frame on every core
+     *
+     * Commands are recorded between begin_frame() and end_frame(). record()
+     * fans `tasks` callbacks out over the context's job system, each task
+     * fills its own secondary command buffer and all of them are stitched
+     * into the frame's primary in task order, then submitted once.
+     *
+     * Every recording lane has its own command pools per frame in flight,
+     * reset in bulk when the frame comes around again instead of freeing
+     * buffers one by one.
+     *
+     * With a headless extent the context also owns one offscreen color
+     * target per frame in flight and needs no window, surface or swapchain.
+     * render() records the tasks inside the current frame's target, which
+     * is left as a transfer source for copying the result out. read_back()
+     * copies it into a ring of host-cached staging buffers and hands the
+     * pixels to a callback once the frame has retired, frames_in_flight
+     * frames later, without ever waiting on the queue.
+     *
+     * With timed_passes set, begin_pass() and end_pass() bracket commands in
+     * the primary with GPU timestamps. pass_timings() reports them per name
+     * once their frame retired, again without waiting on the queue.
+     *
+     * @code
+     * Context context({.frames_in_flight = 2, .threads = 7});
+     *
+     * auto cmd = context.begin_frame();
+     * context.record(256, [&](Context::native_command_buffer secondary, uint32_t task) {
+     *     record_objects(secondary, task * 64, 64);
+     * });
+     * context.end_frame();
+     *
+     * Context headless({.frames_in_flight = 3, .headless = {.width = 1920, .height = 1080}});
+     *
+     * auto cmd = headless.begin_frame();
+     * headless.render(64, [&](Context::native_command_buffer secondary, uint32_t task) {
+     *     record_objects(secondary, task * 64, 64);
+     * });
+     * headless.read_back([&](std::span<const std::byte> pixels, uint64_t frame) {
+     *     encode(frame, pixels);
+     * });
+     * headless.end_frame();
+     *
+     * Context timed({.timed_passes = 16, .headless = {.width = 1920, .height = 1080}});
+     *
+     * auto cmd  = timed.begin_frame();
+     * auto pass = timed.begin_pass("scene");
+     * timed.render(64, record_chunk);
+     * timed.end_pass(pass);
+     * timed.end_frame();
+     * @endcode
+     */
+    class Context {
+        struct Impl;
+
+        using impl_pointer       = Impl*;
+        using const_impl_pointer = const Impl*;
+
+        alignas(std::max_align_t) std::byte _storage[1536];
+
+      public:
+        using native_command_buffer = void*; // VkCommandBuffer
+        using native_image          = void*; // VkImage
+        using record_function       = std::function<void(native_command_buffer cmd, uint32_t task)>;
+        using readback_function     = std::function<void(std::span<const std::byte> pixels, uint64_t frame)>;
+
+        static constexpr uint32_t AUTO_THREADS = UINT32_MAX; // a worker per hardware thread besides the caller's
+
+      public:
+        // Offscreen render targets, a zero extent leaves the context without them
+        struct Headless {
+            uint32_t width        = 0;
+            uint32_t height       = 0;
+            uint32_t color_format = 37; // VK_FORMAT_R8G8B8A8_UNORM
+            uint32_t depth_format = 0;  // VK_FORMAT_UNDEFINED, no depth attachment
+        };
+
+        struct Config {
+            uint32_t frames_in_flight = 2;
+            uint32_t threads          = AUTO_THREADS; // job system workers besides the caller, 0 records on the caller only
+            uint32_t timed_passes     = 0;            // begin_pass() calls timed per frame, 0 disables pass timing
+            Headless headless;
+        };
+
+        // Attachments of the vkCmdBeginRendering that record() runs inside, as VkFormat values
+        struct RenderingFormats {
+            std::span<const uint32_t> color_formats;
+            uint32_t                  depth_format   = 0;
+            uint32_t                  stencil_format = 0;
+            uint32_t                  samples        = 1;
+        };
+
+        struct Stats {
+            uint64_t frames                    = 0;
+            uint64_t secondaries               = 0;
+            uint64_t frame_waits               = 0; // begin_frame() calls that waited for the GPU
+            uint32_t threads                   = 0; // recording threads, including the caller
+            double   last_record_ms            = 0.0;
+            double   mean_record_ms            = 0.0;
+            double   frames_per_second         = 0.0;
+            uint64_t readbacks                 = 0; // read_back() callbacks delivered
+            uint64_t readback_stalls           = 0; // read_back() calls that waited for a staging buffer
+            double   readback_latency_ms       = 0.0; // mean time from read_back() to its callback
+            double   readback_bytes_per_second = 0.0;
+        };
+
+      public:
+        Context();
+        explicit Context(const Config& config);
+        ~Context();
+
+        Context(const Context&)                    = delete;
+        auto operator=(const Context&) -> Context& = delete;
+
+        Context(Context&&)                    = delete;
+        auto operator=(Context&&) -> Context& = delete;
+
+        // Primary command buffer of the frame, valid until end_frame()
+        [[nodiscard]] auto begin_frame() -> native_command_buffer;
+
+        // Records the tasks in parallel, they execute in the primary in task order
+        auto record(uint32_t tasks, const record_function& record) -> void;
+        auto record(uint32_t tasks, const record_function& record, const RenderingFormats& rendering) -> void;
+
+        // Clears the frame's offscreen target and records the tasks inside it, once per frame
+        auto render(uint32_t tasks, const record_function& record) -> void;
+
+        // Copies the frame's offscreen target to the CPU after render(), `done` runs on a later frame's thread
+        auto read_back(readback_function done) -> void;
+
+        // Brackets the commands recorded in between with GPU timestamps, passes nest
+        [[nodiscard]] auto begin_pass(std::string_view name) -> uint32_t;
+        auto end_pass(uint32_t pass) -> void;
+
+        // Submits the frame and delivers the read backs of frames that have retired
+        auto end_frame() -> void;
+        // Waits for the GPU and delivers every pending read back
+        auto wait_idle() -> void;
+
+        // Recreates the offscreen targets without waiting for the frames still using the old ones
+        auto resize(uint32_t width, uint32_t height) -> void;
+
+        [[nodiscard]] auto headless() const noexcept -> bool;
+
+        // Offscreen color target of the frame being recorded, in TRANSFER_SRC_OPTIMAL after render()
+        [[nodiscard]] auto frame_image() const -> native_image;
+
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+        // Empty unless the context was created with timed_passes
+        [[nodiscard]] auto pass_timings() const noexcept -> std::span<const PassTiming>;
+        // CSV with one line per pass, false when the file can't be written or timing is off
+        auto write_pass_timings(const std::filesystem::path& path) const -> bool;
+
+      private:
+        [[nodiscard]] auto impl() noexcept -> impl_pointer;
+        [[nodiscard]] auto impl() const noexcept -> const_impl_pointer;
+    };
 
-} // namespace vulkron::gpu
\ No newline at end of file
+} // namespace vulkron::gpu
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace vulkron::gpu {
+
+    // Counters of one pass, in the order Vulkan writes them; zero unless statistics queries are on
+    struct PipelineStatistics {
+        uint64_t input_vertices       = 0;
+        uint64_t input_primitives     = 0;
+        uint64_t vertex_invocations   = 0;
+        uint64_t clipping_invocations = 0;
+        uint64_t clipping_primitives  = 0;
+        uint64_t fragment_invocations = 0;
+        uint64_t compute_invocations  = 0;
+    };
+
+    /**
+     * @brief One row of the per-pass GPU timing table
+     *
+     * Rows are keyed by pass name and appear in the order the passes were
+     * first seen. The figures lag the frame being recorded by the number of
+     * frames in flight, results are only read once their frame retired.
+     */
+    struct PassTiming {
+        std::string        name;
+        double             last_ms = 0.0;
+        double             mean_ms = 0.0;
+        double             min_ms  = 0.0;
+        double             max_ms  = 0.0;
+        uint64_t           samples = 0;
+        uint64_t           frame   = 0; // frame the last sample was recorded in
+        PipelineStatistics statistics;  // of the last sample
+    };
+
+} // namespace vulkron::gpu
@@ -274,10 +274,12 @@
  * @def VULKRON_ENABLE_PROFILER
  * @brief Enable profiling instrumentation throughout the library
  *
- * When defined, adds profiling scopes and markers to track performance.
- * Significantly increases overhead - only enable during development.
+ * When defined, VULKRON_PROFILE_ZONE and VULKRON_PROFILE_FRAME record into
+ * per-thread ring buffers that export to Chrome trace / Perfetto JSON.
+ * Each zone costs two timestamps and a store; without the flag they
+ * compile to nothing. Set through the VULKRON_ENABLE_PROFILER CMake option.
  *
- * @note Currently disabled - implement in vulkron_profiler.hpp
+ * @see support/profiler/profiler.hpp
  */
 // #define VULKRON_ENABLE_PROFILER
 
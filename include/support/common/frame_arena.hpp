@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+
+namespace vulkron::support {
+
+    /**
+     * @brief Linear allocator for memory that lives for one frame
+     *
+     * Allocations bump a pointer through large blocks and are never freed
+     * one by one, reset() rewinds the whole arena at once. When a frame
+     * needed more than one block, reset() replaces them with a single block
+     * of their combined size, so after the first few frames every frame is
+     * served from one block without touching the heap.
+     *
+     * The arena is a std::pmr::memory_resource, so std::pmr containers can
+     * allocate from it directly. Destructors of what lives in the arena are
+     * not run. Not thread-safe, give each thread or frame its own arena.
+     *
+     * @code
+     * FrameArena arena;
+     *
+     * // Every frame
+     * arena.reset();
+     * std::pmr::vector<VkImageMemoryBarrier2> barriers(&arena);
+     * std::span<uint32_t> indices = arena.allocate_array<uint32_t>(draw_count);
+     * @endcode
+     */
+    class FrameArena final : public std::pmr::memory_resource {
+        struct Block {
+            Block* next;
+            size_t size; // including this header
+        };
+
+        static constexpr size_t HEADER = (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        std::pmr::memory_resource* _upstream;
+        size_t                     _block_size;
+
+        Block*     _blocks = nullptr; // newest first
+        std::byte* _cursor = nullptr;
+        std::byte* _end    = nullptr;
+        size_t     _used   = 0;
+        size_t     _peak   = 0;
+
+      public:
+        explicit FrameArena(size_t block_size = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : _upstream(upstream),
+            _block_size(std::max(block_size, HEADER * 2))
+        {
+        }
+
+        ~FrameArena() override {
+            release();
+        }
+
+        FrameArena(const FrameArena&) = delete;
+        auto operator=(const FrameArena&) -> FrameArena& = delete;
+
+        FrameArena(FrameArena&&) = delete;
+        auto operator=(FrameArena&&) -> FrameArena& = delete;
+
+        // Uninitialized storage for `count` objects, only meant for implicit-lifetime types
+        template <class T>
+        [[nodiscard]] auto allocate_array(size_t count) -> std::span<T> {
+            static_assert(std::is_trivially_destructible_v<T>, "The arena never runs destructors");
+            if (count == 0) {
+                return {};
+            }
+            return {static_cast<T*>(allocate(sizeof(T) * count, alignof(T))), count};
+        }
+
+        // Forgets every allocation, keeping the memory for the next frame
+        auto reset() -> void {
+            if (_blocks != nullptr && _blocks->next != nullptr) {
+                // Outgrew one block: coalesce so the same load fits in one next time
+                size_t total = 0;
+                for (const Block* block = _blocks; block != nullptr; block = block->next) {
+                    total += block->size;
+                }
+                release();
+                push_block(total);
+            }
+
+            if (_blocks != nullptr) {
+                _cursor = reinterpret_cast<std::byte*>(_blocks) + HEADER;
+                _end    = reinterpret_cast<std::byte*>(_blocks) + _blocks->size;
+            }
+            _used = 0;
+        }
+
+        // Frees every block
+        auto release() noexcept -> void {
+            while (_blocks != nullptr) {
+                Block* next = _blocks->next;
+                _upstream->deallocate(_blocks, _blocks->size, alignof(std::max_align_t));
+                _blocks = next;
+            }
+            _cursor = _end = nullptr;
+            _used   = 0;
+        }
+
+        // Bytes handed out since the last reset
+        [[nodiscard]] auto used() const noexcept -> size_t {
+            return _used;
+        }
+
+        [[nodiscard]] auto peak() const noexcept -> size_t {
+            return _peak;
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> size_t {
+            size_t total = 0;
+            for (const Block* block = _blocks; block != nullptr; block = block->next) {
+                total += block->size - HEADER;
+            }
+            return total;
+        }
+
+      private:
+        auto push_block(size_t size) -> void {
+            auto* block = static_cast<Block*>(_upstream->allocate(size, alignof(std::max_align_t)));
+            block->next = _blocks;
+            block->size = size;
+            _blocks     = block;
+
+            _cursor = reinterpret_cast<std::byte*>(block) + HEADER;
+            _end    = reinterpret_cast<std::byte*>(block) + size;
+        }
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override {
+            const auto padding = [&] {
+                return (alignment - reinterpret_cast<uintptr_t>(_cursor) % alignment) % alignment;
+            };
+
+            if (_cursor == nullptr || static_cast<size_t>(_end - _cursor) < padding() + bytes) {
+                push_block(std::max(_block_size, HEADER + bytes + alignment));
+            }
+
+            std::byte* start = _cursor + padding();
+            _cursor = start + bytes;
+            _used  += bytes;
+            _peak   = std::max(_peak, _used);
+            return start;
+        }
+
+        auto do_deallocate(void*, size_t, size_t) -> void override {
+            // Released in bulk by reset()
+        }
+
+        [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override {
+            return this == &other;
+        }
+    };
+
+} // namespace vulkron::support
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace vulkron::support {
+
+    /**
+     * @brief Fixed-size block allocator with an intrusive free list
+     *
+     * Blocks are carved out of chunks of `blocks_per_chunk` and go back on
+     * the free list when released, so a steady number of live objects costs
+     * no heap traffic. Chunks are only returned when the pool is destroyed.
+     *
+     * As a std::pmr::memory_resource, requests that don't fit a block are
+     * forwarded upstream. Not thread-safe.
+     *
+     * @code
+     * PoolAllocator nodes(sizeof(Node), alignof(Node));
+     * Node* node = new (nodes.allocate_block()) Node{};
+     * node->~Node();
+     * nodes.free_block(node);
+     * @endcode
+     */
+    class PoolAllocator final : public std::pmr::memory_resource {
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        struct Chunk {
+            Chunk* next;
+            size_t size;
+        };
+
+        std::pmr::memory_resource* _upstream;
+        size_t                     _block_size;
+        size_t                     _alignment;
+        size_t                     _blocks_per_chunk;
+        size_t                     _header; // chunk header rounded up to the block alignment
+
+        Chunk*     _chunks = nullptr;
+        FreeBlock* _free   = nullptr;
+        size_t     _live   = 0;
+
+      public:
+        PoolAllocator(size_t block_size, size_t alignment = alignof(std::max_align_t), size_t blocks_per_chunk = 256,
+                      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : _upstream(upstream),
+            _alignment(std::max(alignment, alignof(FreeBlock))),
+            _blocks_per_chunk(std::max<size_t>(blocks_per_chunk, 1))
+        {
+            // Every block has to hold a free list link and keep the next block aligned
+            _block_size = (std::max(block_size, sizeof(FreeBlock)) + _alignment - 1) / _alignment * _alignment;
+            _header     = (sizeof(Chunk) + _alignment - 1) / _alignment * _alignment;
+        }
+
+        ~PoolAllocator() override {
+            while (_chunks != nullptr) {
+                Chunk* next = _chunks->next;
+                _upstream->deallocate(_chunks, _chunks->size, std::max(_alignment, alignof(Chunk)));
+                _chunks = next;
+            }
+        }
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        auto operator=(const PoolAllocator&) -> PoolAllocator& = delete;
+
+        PoolAllocator(PoolAllocator&&) = delete;
+        auto operator=(PoolAllocator&&) -> PoolAllocator& = delete;
+
+        [[nodiscard]] auto allocate_block() -> void* {
+            if (_free == nullptr) {
+                grow();
+            }
+
+            FreeBlock* block = _free;
+            _free = block->next;
+            ++_live;
+            return block;
+        }
+
+        auto free_block(void* pointer) noexcept -> void {
+            if (pointer == nullptr) {
+                return;
+            }
+
+            auto* block = static_cast<FreeBlock*>(pointer);
+            block->next = _free;
+            _free       = block;
+            --_live;
+        }
+
+        template <class T, class... Args>
+        [[nodiscard]] auto create(Args&&... args) -> T* {
+            if (!fits(sizeof(T), alignof(T))) {
+                throw std::bad_alloc();
+            }
+
+            void* block = allocate_block();
+            try {
+                return new (block) T(std::forward<Args>(args)...);
+            } catch (...) {
+                free_block(block);
+                throw;
+            }
+        }
+
+        template <class T>
+        auto destroy(T* object) noexcept -> void {
+            if (object != nullptr) {
+                object->~T();
+                free_block(object);
+            }
+        }
+
+        [[nodiscard]] auto block_size() const noexcept -> size_t {
+            return _block_size;
+        }
+
+        // Blocks handed out and not yet freed
+        [[nodiscard]] auto live() const noexcept -> size_t {
+            return _live;
+        }
+
+      private:
+        auto grow() -> void {
+            const size_t size  = _header + _block_size * _blocks_per_chunk;
+            auto*        chunk = static_cast<Chunk*>(_upstream->allocate(size, std::max(_alignment, alignof(Chunk))));
+            chunk->next = _chunks;
+            chunk->size = size;
+            _chunks     = chunk;
+
+            // Thread the new blocks onto the free list back to front, so they're handed out in address order
+            std::byte* first = reinterpret_cast<std::byte*>(chunk) + _header;
+            for (size_t i = _blocks_per_chunk; i-- > 0;) {
+                auto* block = reinterpret_cast<FreeBlock*>(first + i * _block_size);
+                block->next = _free;
+                _free       = block;
+            }
+        }
+
+        auto fits(size_t bytes, size_t alignment) const noexcept -> bool {
+            return bytes <= _block_size && alignment <= _alignment;
+        }
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override {
+            return fits(bytes, alignment) ? allocate_block() : _upstream->allocate(bytes, alignment);
+        }
+
+        auto do_deallocate(void* pointer, size_t bytes, size_t alignment) -> void override {
+            if (fits(bytes, alignment)) {
+                free_block(pointer);
+            } else {
+                _upstream->deallocate(pointer, bytes, alignment);
+            }
+        }
+
+        [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override {
+            return this == &other;
+        }
+    };
+
+} // namespace vulkron::support
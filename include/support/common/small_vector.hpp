@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace vulkron::support {
+
+    /**
+     * @brief Vector that keeps its first N elements inline
+     *
+     * Lists that are almost always short, like physical devices, queue
+     * families or the barriers of one pass, stay on the stack and only
+     * spill to the heap past N elements. Contiguous, so it converts to
+     * std::span and passes straight into Vulkan calls.
+     *
+     * @code
+     * SmallVector<VkPhysicalDevice, 8> gpus(gpu_count);
+     * vkEnumeratePhysicalDevices(instance, &gpu_count, gpus.data());
+     * @endcode
+     */
+    template <class T, size_t N>
+    class SmallVector {
+        static_assert(N > 0, "Use std::vector without inline storage");
+
+        T*     _data;
+        size_t _size     = 0;
+        size_t _capacity = N;
+
+        alignas(T) std::byte _inline[N * sizeof(T)];
+
+      public:
+        using value_type      = T;
+        using size_type       = size_t;
+        using reference       = T&;
+        using const_reference = const T&;
+        using iterator        = T*;
+        using const_iterator  = const T*;
+
+        SmallVector() noexcept
+            : _data(inline_data())
+        {
+        }
+
+        explicit SmallVector(size_t count)
+            : SmallVector()
+        {
+            resize(count);
+        }
+
+        SmallVector(size_t count, const T& value)
+            : SmallVector()
+        {
+            resize(count, value);
+        }
+
+        SmallVector(std::initializer_list<T> values)
+            : SmallVector()
+        {
+            reserve(values.size());
+            std::uninitialized_copy(values.begin(), values.end(), _data);
+            _size = values.size();
+        }
+
+        SmallVector(const SmallVector& other)
+            : SmallVector()
+        {
+            reserve(other._size);
+            std::uninitialized_copy(other.begin(), other.end(), _data);
+            _size = other._size;
+        }
+
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : SmallVector()
+        {
+            take(std::move(other));
+        }
+
+        ~SmallVector() {
+            clear();
+            release_heap();
+        }
+
+        auto operator=(const SmallVector& other) -> SmallVector& {
+            if (this != &other) {
+                clear();
+                reserve(other._size);
+                std::uninitialized_copy(other.begin(), other.end(), _data);
+                _size = other._size;
+            }
+            return *this;
+        }
+
+        auto operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> SmallVector& {
+            if (this != &other) {
+                clear();
+                release_heap();
+                take(std::move(other));
+            }
+            return *this;
+        }
+
+        template <class... Args>
+        auto emplace_back(Args&&... args) -> T& {
+            if (_size == _capacity) {
+                // Constructed first: args may point into the storage that's about to move
+                T value(std::forward<Args>(args)...);
+                grow(_capacity * 2);
+                return *std::construct_at(_data + _size++, std::move(value));
+            }
+            return *std::construct_at(_data + _size++, std::forward<Args>(args)...);
+        }
+
+        auto push_back(const T& value) -> void {
+            emplace_back(value);
+        }
+
+        auto push_back(T&& value) -> void {
+            emplace_back(std::move(value));
+        }
+
+        auto pop_back() noexcept -> void {
+            std::destroy_at(_data + --_size);
+        }
+
+        auto resize(size_t count) -> void {
+            reserve(count);
+            if (count > _size) {
+                std::uninitialized_value_construct(_data + _size, _data + count);
+            } else {
+                std::destroy(_data + count, _data + _size);
+            }
+            _size = count;
+        }
+
+        auto resize(size_t count, const T& value) -> void {
+            reserve(count);
+            if (count > _size) {
+                std::uninitialized_fill(_data + _size, _data + count, value);
+            } else {
+                std::destroy(_data + count, _data + _size);
+            }
+            _size = count;
+        }
+
+        auto reserve(size_t capacity) -> void {
+            if (capacity > _capacity) {
+                grow(std::max(capacity, _capacity * 2));
+            }
+        }
+
+        // Keeps the capacity
+        auto clear() noexcept -> void {
+            std::destroy(_data, _data + _size);
+            _size = 0;
+        }
+
+        [[nodiscard]] auto operator[](size_t index) noexcept -> T& {
+            return _data[index];
+        }
+
+        [[nodiscard]] auto operator[](size_t index) const noexcept -> const T& {
+            return _data[index];
+        }
+
+        [[nodiscard]] auto at(size_t index) -> T& {
+            if (index >= _size) {
+                throw std::out_of_range("SmallVector index out of range");
+            }
+            return _data[index];
+        }
+
+        [[nodiscard]] auto at(size_t index) const -> const T& {
+            if (index >= _size) {
+                throw std::out_of_range("SmallVector index out of range");
+            }
+            return _data[index];
+        }
+
+        [[nodiscard]] auto front() noexcept -> T& {
+            return _data[0];
+        }
+
+        [[nodiscard]] auto front() const noexcept -> const T& {
+            return _data[0];
+        }
+
+        [[nodiscard]] auto back() noexcept -> T& {
+            return _data[_size - 1];
+        }
+
+        [[nodiscard]] auto back() const noexcept -> const T& {
+            return _data[_size - 1];
+        }
+
+        [[nodiscard]] auto data() noexcept -> T* {
+            return _data;
+        }
+
+        [[nodiscard]] auto data() const noexcept -> const T* {
+            return _data;
+        }
+
+        [[nodiscard]] auto begin() noexcept -> iterator {
+            return _data;
+        }
+
+        [[nodiscard]] auto begin() const noexcept -> const_iterator {
+            return _data;
+        }
+
+        [[nodiscard]] auto end() noexcept -> iterator {
+            return _data + _size;
+        }
+
+        [[nodiscard]] auto end() const noexcept -> const_iterator {
+            return _data + _size;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> size_t {
+            return _size;
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> size_t {
+            return _capacity;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool {
+            return _size == 0;
+        }
+
+        // Whether the elements still live in the inline storage
+        [[nodiscard]] auto is_inline() const noexcept -> bool {
+            return _data == inline_data();
+        }
+
+      private:
+        auto inline_data() noexcept -> T* {
+            return reinterpret_cast<T*>(_inline);
+        }
+
+        auto inline_data() const noexcept -> const T* {
+            return reinterpret_cast<const T*>(_inline);
+        }
+
+        auto grow(size_t capacity) -> void {
+            T* data = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+            try {
+                std::uninitialized_move(_data, _data + _size, data);
+            } catch (...) {
+                ::operator delete(data, std::align_val_t{alignof(T)});
+                throw;
+            }
+            std::destroy(_data, _data + _size);
+            release_heap();
+
+            _data     = data;
+            _capacity = capacity;
+        }
+
+        auto release_heap() noexcept -> void {
+            if (!is_inline()) {
+                ::operator delete(_data, std::align_val_t{alignof(T)});
+                _data     = inline_data();
+                _capacity = N;
+            }
+        }
+
+        // Expects this to be empty and inline
+        auto take(SmallVector&& other) -> void {
+            if (other.is_inline()) {
+                std::uninitialized_move(other.begin(), other.end(), _data);
+                _size = other._size;
+                other.clear();
+                return;
+            }
+
+            _data     = std::exchange(other._data, other.inline_data());
+            _size     = std::exchange(other._size, 0);
+            _capacity = std::exchange(other._capacity, N);
+        }
+    };
+
+} // namespace vulkron::support
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace vulkron::support {
+
+    class JobSystem;
+
+    namespace detail {
+        struct Job;
+    } // namespace detail
+
+    /**
+     * @brief Number of jobs still to finish
+     *
+     * Jobs started with a counter add one to it and take it back once they
+     * returned. Jobs queued with JobSystem::run_after() start when the
+     * counter they depend on drops to zero.
+     *
+     * Use JobSystem::wait() before destroying a counter that jobs still
+     * signal, done() alone doesn't guarantee the last job let go of it.
+     */
+    class JobCounter {
+        friend class JobSystem;
+
+        std::atomic<uint32_t>     _pending = 0;
+        std::mutex                _mutex; // held while the count reaches zero
+        std::vector<detail::Job*> _continuations;
+
+      public:
+        JobCounter() = default;
+        ~JobCounter();
+
+        JobCounter(const JobCounter&) = delete;
+        auto operator=(const JobCounter&) -> JobCounter& = delete;
+
+        JobCounter(JobCounter&&) = delete;
+        auto operator=(JobCounter&&) -> JobCounter& = delete;
+
+        [[nodiscard]] auto done() const noexcept -> bool {
+            return _pending.load(std::memory_order_acquire) == 0;
+        }
+    };
+
+    /**
+     * @brief Work-stealing scheduler shared by everything that runs in parallel
+     *
+     * Each worker owns a Chase-Lev deque: jobs started from a worker go to
+     * its own deque and run newest first, idle workers steal the oldest job
+     * from a random victim. Jobs from other threads enter through a shared
+     * injection queue. Workers sleep once nothing is left to steal and can
+     * be pinned to one core each.
+     *
+     * wait() never just blocks, the waiting thread runs queued jobs until
+     * its counter reaches zero, so jobs may start and wait on other jobs.
+     *
+     * @code
+     * JobSystem jobs;
+     *
+     * JobCounter loaded;
+     * for (const auto& path : paths) {
+     *     jobs.run([&, path] { load(path); }, &loaded);
+     * }
+     * jobs.run_after(loaded, [&] { build_atlas(); });
+     *
+     * jobs.parallel_for(0, objects.size(), 256, [&](size_t first, size_t last) {
+     *     update(objects, first, last);
+     * });
+     * @endcode
+     */
+    class JobSystem {
+      public:
+        using Function = std::function<void()>;
+
+        static constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+        static constexpr uint32_t AUTO_THREADS = UINT32_MAX; // hardware threads - 1
+
+        struct Config {
+            uint32_t threads        = AUTO_THREADS; // workers, 0 runs every job on the thread that waits for it
+            bool     pin_threads    = false;        // worker i runs on core i + 1, only worth it on a machine the process has to itself
+            uint32_t deque_capacity = 4096;         // per worker, rounded up to a power of two
+        };
+
+        struct Stats {
+            uint64_t executed = 0;
+            uint64_t stolen   = 0;
+            uint64_t injected = 0; // started from threads outside the pool
+            uint64_t inlined  = 0; // ran immediately because the worker's deque was full
+        };
+
+      private:
+        struct Worker;
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+        uint32_t                             _worker_count = 0;
+
+        // Jobs are recycled through size-class pools, steady-state scheduling doesn't touch the heap
+        std::pmr::synchronized_pool_resource _job_memory;
+
+        std::mutex                _injection_mutex;
+        std::vector<detail::Job*> _injection; // FIFO through _injection_head
+        size_t                    _injection_head = 0;
+        std::atomic<size_t>       _injected       = 0; // jobs waiting in _injection
+
+        // Sleepers wait for _epoch to move, every new job moves it
+        std::mutex                  _sleep_mutex;
+        std::condition_variable_any _wake;
+        std::atomic<uint64_t>       _epoch    = 0;
+        std::atomic<uint32_t>       _sleepers = 0;
+
+        std::atomic<uint64_t> _executed       = 0;
+        std::atomic<uint64_t> _stolen         = 0;
+        std::atomic<uint64_t> _injected_total = 0;
+        std::atomic<uint64_t> _inlined        = 0;
+
+        std::vector<std::jthread> _threads;
+
+      public:
+        JobSystem();
+        explicit JobSystem(const Config& config);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        auto operator=(const JobSystem&) -> JobSystem& = delete;
+
+        JobSystem(JobSystem&&) = delete;
+        auto operator=(JobSystem&&) -> JobSystem& = delete;
+
+        auto run(Function function, JobCounter* counter = nullptr) -> void;
+        // Starts `function` once `dependency` reaches zero, right away if it already has
+        auto run_after(JobCounter& dependency, Function function, JobCounter* counter = nullptr) -> void;
+
+        // Runs other jobs until `counter` reaches zero
+        auto wait(JobCounter& counter) -> void;
+
+        // Calls body(first, last) over [begin, end) in chunks of `grain`, returns when all are done
+        template <class Body>
+        auto parallel_for(size_t begin, size_t end, size_t grain, Body&& body) -> void {
+            if (begin >= end) {
+                return;
+            }
+            grain = std::max<size_t>(grain, 1);
+
+            // Jobs capture two words so std::function keeps them inline
+            struct Range {
+                Body&  body;
+                size_t end;
+                size_t grain;
+            } range{body, end, grain};
+
+            JobCounter counter;
+            for (size_t first = begin; first < end; first += grain) {
+                run([&range, first] { range.body(first, std::min(range.end, first + range.grain)); }, &counter);
+            }
+            wait(counter);
+        }
+
+        [[nodiscard]] auto thread_count() const noexcept -> uint32_t;
+        // Index of the calling worker of this system, NOT_A_WORKER for any other thread
+        [[nodiscard]] auto worker_index() const noexcept -> uint32_t;
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+      private:
+        auto work(std::stop_token stop, uint32_t index) -> void;
+        auto make_job(Function function, JobCounter* counter) -> detail::Job*;
+        auto schedule(detail::Job* job) -> void;
+        auto find_job(uint32_t self) -> detail::Job*;
+        auto execute(detail::Job* job) -> void;
+        auto finish(JobCounter& counter) -> void;
+        auto wake() -> void;
+    };
+
+} // namespace vulkron::support
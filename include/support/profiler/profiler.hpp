@@ -0,0 +1,170 @@
+#pragma once
+
+#include "support/common/config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define VULKRON_PROFILER_TSC 1
+#endif
+
+namespace vulkron::support::profiler {
+
+    /**
+     * @brief One recorded zone, or a frame marker when `end` is 0
+     *
+     * `name` must outlive the capture, the macros only pass string literals.
+     */
+    struct Event {
+        const char* name;
+        uint64_t    begin; // ticks of now()
+        uint64_t    end;
+    };
+
+    namespace detail {
+
+        inline constexpr size_t RING_CAPACITY = size_t{1} << 15;
+        inline constexpr size_t RING_MASK     = RING_CAPACITY - 1;
+
+        /**
+         * @brief Event in a ring, published through its sequence
+         *
+         * `sequence` is odd while record() writes event `h` into the slot and
+         * 2 * h + 2 once it's complete. The fields are atomics so the exporter
+         * may copy them while the owning thread overwrites them; it keeps a
+         * copy only if the sequence read before and after is the published
+         * value of the event it wanted.
+         */
+        struct Slot {
+            std::atomic<uint64_t>    sequence = 0;
+            std::atomic<const char*> name     = nullptr;
+            std::atomic<uint64_t>    begin    = 0;
+            std::atomic<uint64_t>    end      = 0;
+        };
+
+        /**
+         * @brief Events of one thread, written only by that thread
+         *
+         * The oldest events are overwritten once the ring is full. `head`
+         * counts every event ever written, the exporter copies the last
+         * RING_CAPACITY of them and drops those whose slot was overwritten
+         * meanwhile, see Slot.
+         */
+        struct alignas(64) ThreadRing {
+            std::atomic<uint64_t> head = 0;
+            uint32_t              thread_index;
+            char                  thread_name[32] = {};
+            Slot                  slots[RING_CAPACITY];
+        };
+
+        // Cold path of the first event on a thread. The ring goes back to the registry when the
+        // thread exits, its events stay exportable until another thread takes it over.
+        [[nodiscard]] VULKRON_NOINLINE auto register_thread() -> ThreadRing*;
+
+        inline thread_local ThreadRing* t_ring = nullptr;
+
+        VULKRON_ALWAYS_INLINE auto ring() -> ThreadRing* {
+            if (VULKRON_UNLIKELY(t_ring == nullptr)) {
+                t_ring = register_thread();
+            }
+            return t_ring;
+        }
+
+    } // namespace detail
+
+    // Invariant TSC where available, which costs a handful of cycles; steady_clock ticks elsewhere
+    VULKRON_ALWAYS_INLINE auto now() noexcept -> uint64_t {
+#if defined(VULKRON_PROFILER_TSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    VULKRON_ALWAYS_INLINE auto record(const char* name, uint64_t begin, uint64_t end) -> void {
+        detail::ThreadRing* ring = detail::ring();
+        const uint64_t      head = ring->head.load(std::memory_order_relaxed);
+        detail::Slot&       slot = ring->slots[head & detail::RING_MASK];
+
+        // The fence keeps the field stores after the odd sequence, pairs with the one in the exporter
+        slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.sequence.store(2 * head + 2, std::memory_order_release);
+
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    VULKRON_ALWAYS_INLINE auto frame_mark(const char* name) -> void {
+        record(name, now(), 0);
+    }
+
+    // Shown as the thread's name in the trace, truncated to 31 characters
+    auto set_thread_name(const char* name) -> void;
+
+    // Writes every recorded event as Chrome trace event JSON, which Perfetto opens as well
+    auto export_chrome_trace(const std::filesystem::path& path) -> bool;
+
+    // Drops the events recorded so far, threads must not be recording meanwhile
+    auto clear() -> void;
+
+    /**
+     * @brief Records the time between its construction and destruction
+     *
+     * Zones are written once, when they close, so a zone costs two
+     * timestamps and one slot write into the thread's ring.
+     *
+     * @code
+     * auto Device::select_gpu(GpuUsage usage, GpuSelection selection) -> void {
+     *     VULKRON_PROFILE_ZONE("Device::select_gpu");
+     *     // ...
+     * }
+     * @endcode
+     */
+    class Zone {
+        const char* _name;
+        uint64_t    _begin;
+
+      public:
+        VULKRON_ALWAYS_INLINE explicit Zone(const char* name) noexcept
+            : _name(name),
+            _begin(now())
+        {
+        }
+
+        VULKRON_ALWAYS_INLINE ~Zone() {
+            record(_name, _begin, now());
+        }
+
+        Zone(const Zone&) = delete;
+        auto operator=(const Zone&) -> Zone& = delete;
+
+        Zone(Zone&&) = delete;
+        auto operator=(Zone&&) -> Zone& = delete;
+    };
+
+} // namespace vulkron::support::profiler
+
+#define VULKRON_PROFILE_CONCAT_INNER(a, b) a##b
+#define VULKRON_PROFILE_CONCAT(a, b)       VULKRON_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(VULKRON_ENABLE_PROFILER)
+    #define VULKRON_PROFILE_ZONE(name)        ::vulkron::support::profiler::Zone VULKRON_PROFILE_CONCAT(vulkron_zone_, __LINE__)(name)
+    #define VULKRON_PROFILE_FRAME(name)       ::vulkron::support::profiler::frame_mark(name)
+    #define VULKRON_PROFILE_THREAD_NAME(name) ::vulkron::support::profiler::set_thread_name(name)
+#else
+    #define VULKRON_PROFILE_ZONE(name)        static_cast<void>(0)
+    #define VULKRON_PROFILE_FRAME(name)       static_cast<void>(0)
+    #define VULKRON_PROFILE_THREAD_NAME(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,409 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <locale>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+namespace vulkron::bench {
+
+    namespace {
+
+        constexpr uint32_t REPORT_VERSION = 1;
+
+        auto summarize(Result& result, std::vector<double>& samples) -> void {
+            std::ranges::sort(samples);
+
+            const size_t count = samples.size();
+            result.samples = static_cast<uint32_t>(count);
+            result.min     = samples.front();
+            result.max     = samples.back();
+            result.median  = count % 2 == 1 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+            result.mean    = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(count);
+
+            double variance = 0.0;
+            for (double sample : samples) {
+                variance += (sample - result.mean) * (sample - result.mean);
+            }
+            result.stddev = count > 1 ? std::sqrt(variance / static_cast<double>(count - 1)) : 0.0;
+        }
+
+        auto write_string(std::ostream& out, std::string_view text) -> void {
+            out << '"';
+            for (char c : text) {
+                switch (c) {
+                    case '"':
+                        out << "\\\"";
+                        break;
+                    case '\\':
+                        out << "\\\\";
+                        break;
+                    case '\n':
+                        out << "\\n";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                            out << escaped;
+                        } else {
+                            out << c;
+                        }
+                }
+            }
+            out << '"';
+        }
+
+        // Just enough JSON to read reports back: objects, arrays, strings, numbers and literals
+        struct Value {
+            enum class Kind : uint8_t { Null, Bool, Number, String, Array, Object };
+
+            Kind                         kind   = Kind::Null;
+            double                       number = 0.0;
+            std::string                  text;
+            std::vector<Value>           items;
+            std::map<std::string, Value> fields;
+
+            [[nodiscard]] auto field(const std::string& key) const -> const Value* {
+                auto found = fields.find(key);
+                return found != fields.end() ? &found->second : nullptr;
+            }
+        };
+
+        class Parser {
+            std::string_view _text;
+            size_t           _at = 0;
+
+          public:
+            explicit Parser(std::string_view text)
+                : _text(text)
+            {
+            }
+
+            auto parse(Value& value) -> bool {
+                if (!parse_value(value, 0)) {
+                    return false;
+                }
+                skip_space();
+                return _at == _text.size();
+            }
+
+          private:
+            static constexpr uint32_t MAX_DEPTH = 32;
+
+            auto skip_space() -> void {
+                while (_at < _text.size() && (_text[_at] == ' ' || _text[_at] == '\n' || _text[_at] == '\r' || _text[_at] == '\t')) {
+                    ++_at;
+                }
+            }
+
+            auto consume(char c) -> bool {
+                skip_space();
+                if (_at < _text.size() && _text[_at] == c) {
+                    ++_at;
+                    return true;
+                }
+                return false;
+            }
+
+            auto literal(std::string_view word) -> bool {
+                if (_text.substr(_at, word.size()) != word) {
+                    return false;
+                }
+                _at += word.size();
+                return true;
+            }
+
+            auto parse_value(Value& value, uint32_t depth) -> bool {
+                if (depth > MAX_DEPTH) {
+                    return false;
+                }
+
+                skip_space();
+                if (_at == _text.size()) {
+                    return false;
+                }
+
+                switch (_text[_at]) {
+                    case '{':
+                        value.kind = Value::Kind::Object;
+                        return parse_object(value, depth);
+                    case '[':
+                        value.kind = Value::Kind::Array;
+                        return parse_array(value, depth);
+                    case '"':
+                        value.kind = Value::Kind::String;
+                        return parse_string(value.text);
+                    case 't':
+                        value.kind   = Value::Kind::Bool;
+                        value.number = 1.0;
+                        return literal("true");
+                    case 'f':
+                        value.kind = Value::Kind::Bool;
+                        return literal("false");
+                    case 'n':
+                        return literal("null");
+                    default:
+                        value.kind = Value::Kind::Number;
+                        return parse_number(value.number);
+                }
+            }
+
+            auto parse_object(Value& value, uint32_t depth) -> bool {
+                ++_at;
+                if (consume('}')) {
+                    return true;
+                }
+
+                do {
+                    std::string key;
+                    skip_space();
+                    if (!parse_string(key) || !consume(':') || !parse_value(value.fields[key], depth + 1)) {
+                        return false;
+                    }
+                } while (consume(','));
+
+                return consume('}');
+            }
+
+            auto parse_array(Value& value, uint32_t depth) -> bool {
+                ++_at;
+                if (consume(']')) {
+                    return true;
+                }
+
+                do {
+                    if (!parse_value(value.items.emplace_back(), depth + 1)) {
+                        return false;
+                    }
+                } while (consume(','));
+
+                return consume(']');
+            }
+
+            auto parse_string(std::string& text) -> bool {
+                if (_at == _text.size() || _text[_at] != '"') {
+                    return false;
+                }
+                ++_at;
+
+                while (_at < _text.size() && _text[_at] != '"') {
+                    char c = _text[_at++];
+                    if (c == '\\') {
+                        if (_at == _text.size()) {
+                            return false;
+                        }
+                        c = _text[_at++];
+                        switch (c) {
+                            case 'n':
+                                c = '\n';
+                                break;
+                            case 't':
+                                c = '\t';
+                                break;
+                            case 'u': {
+                                // Only ever written for control characters, which names don't contain
+                                unsigned code = 0;
+                                if (_at + 4 > _text.size() || std::from_chars(_text.data() + _at, _text.data() + _at + 4, code, 16).ec != std::errc()) {
+                                    return false;
+                                }
+                                c = static_cast<char>(code);
+                                _at += 4;
+                                break;
+                            }
+                            default:
+                                break; // \" \\ \/
+                        }
+                    }
+                    text.push_back(c);
+                }
+                return _at++ < _text.size();
+            }
+
+            auto parse_number(double& number) -> bool {
+                const size_t start = _at;
+                while (_at < _text.size() && std::string_view("+-.0123456789eE").find(_text[_at]) != std::string_view::npos) {
+                    ++_at;
+                }
+                if (start == _at) {
+                    return false;
+                }
+
+                std::istringstream in{std::string(_text.substr(start, _at - start))};
+                in.imbue(std::locale::classic());
+                in >> number;
+                return !in.fail();
+            }
+        };
+
+        auto string_field(const Value& object, const std::string& key) -> std::string {
+            const Value* value = object.field(key);
+            return value != nullptr && value->kind == Value::Kind::String ? value->text : std::string();
+        }
+
+        auto number_field(const Value& object, const std::string& key) -> double {
+            const Value* value = object.field(key);
+            return value != nullptr && value->kind == Value::Kind::Number ? value->number : 0.0;
+        }
+
+    } // namespace
+
+    auto Suite::add(std::string name, std::string unit, Better better, std::function<double()> run) -> void {
+        _benchmarks.push_back(Benchmark{std::move(name), std::move(unit), better, std::move(run)});
+    }
+
+    auto Suite::benchmarks() const noexcept -> const std::vector<Benchmark>& {
+        return _benchmarks;
+    }
+
+    auto Suite::run(uint32_t repetitions, std::string_view filter) const -> std::vector<Result> {
+        std::vector<Result> results;
+        std::vector<double> samples;
+
+        for (const Benchmark& benchmark : _benchmarks) {
+            if (benchmark.name.find(filter) == std::string::npos) {
+                continue;
+            }
+
+            Result& result = results.emplace_back(Result{.name = benchmark.name, .unit = benchmark.unit, .better = benchmark.better, .skipped = {}});
+            std::fprintf(stderr, "%-44s ", benchmark.name.c_str());
+
+            samples.clear();
+            try {
+                // The warm-up run pays for first-use costs: shader caches, page faults, lazy loader work
+                keep(benchmark.run());
+                for (uint32_t i = 0; i < repetitions; ++i) {
+                    samples.push_back(benchmark.run());
+                }
+            } catch (const std::exception& error) {
+                result.skipped = error.what();
+                std::fprintf(stderr, "skipped: %s\n", error.what());
+                continue;
+            }
+
+            summarize(result, samples);
+            std::fprintf(stderr, "%14.3f %-10s (min %.3f, max %.3f)\n", result.median, result.unit.c_str(), result.min, result.max);
+        }
+        return results;
+    }
+
+    auto write_report(const Report& report, const std::filesystem::path& path) -> bool {
+        std::ostringstream out;
+        out.imbue(std::locale::classic());
+        out.precision(17);
+
+        out << "{\n  \"version\": " << REPORT_VERSION << ",\n  \"gpu\": ";
+        write_string(out, report.gpu);
+        out << ",\n  \"driver\": ";
+        write_string(out, report.driver);
+        out << ",\n  \"repetitions\": " << report.repetitions << ",\n  \"benchmarks\": [";
+
+        for (size_t i = 0; i < report.results.size(); ++i) {
+            const Result& result = report.results[i];
+
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+            write_string(out, result.name);
+            out << ", \"unit\": ";
+            write_string(out, result.unit);
+            out << ", \"better\": \"" << (result.better == Better::Lower ? "lower" : "higher") << '"';
+
+            if (!result.skipped.empty()) {
+                out << ", \"skipped\": ";
+                write_string(out, result.skipped);
+            } else {
+                out << ", \"median\": " << result.median << ", \"mean\": " << result.mean << ", \"min\": " << result.min
+                    << ", \"max\": " << result.max << ", \"stddev\": " << result.stddev << ", \"samples\": " << result.samples;
+            }
+            out << '}';
+        }
+        out << "\n  ]\n}\n";
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << out.str();
+        return static_cast<bool>(file);
+    }
+
+    auto read_report(const std::filesystem::path& path) -> std::optional<Report> {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return std::nullopt;
+        }
+        const std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+        Value root;
+        if (!Parser(text).parse(root) || root.kind != Value::Kind::Object) {
+            return std::nullopt;
+        }
+        if (number_field(root, "version") != REPORT_VERSION) {
+            return std::nullopt;
+        }
+
+        const Value* benchmarks = root.field("benchmarks");
+        if (benchmarks == nullptr || benchmarks->kind != Value::Kind::Array) {
+            return std::nullopt;
+        }
+
+        Report report = {
+            .gpu         = string_field(root, "gpu"),
+            .driver      = string_field(root, "driver"),
+            .repetitions = static_cast<uint32_t>(number_field(root, "repetitions")),
+            .results     = {}
+        };
+
+        for (const Value& entry : benchmarks->items) {
+            if (entry.kind != Value::Kind::Object) {
+                return std::nullopt;
+            }
+
+            report.results.push_back(Result{
+                .name    = string_field(entry, "name"),
+                .unit    = string_field(entry, "unit"),
+                .better  = string_field(entry, "better") == "higher" ? Better::Higher : Better::Lower,
+                .median  = number_field(entry, "median"),
+                .mean    = number_field(entry, "mean"),
+                .min     = number_field(entry, "min"),
+                .max     = number_field(entry, "max"),
+                .stddev  = number_field(entry, "stddev"),
+                .samples = static_cast<uint32_t>(number_field(entry, "samples")),
+                .skipped = string_field(entry, "skipped")
+            });
+        }
+        return report;
+    }
+
+    auto compare(const Report& baseline, const Report& current, double threshold) -> std::vector<Comparison> {
+        std::vector<Comparison> comparisons;
+
+        for (const Result& now : current.results) {
+            auto before = std::ranges::find(baseline.results, now.name, &Result::name);
+            if (before == baseline.results.end() || !before->skipped.empty() || !now.skipped.empty()) {
+                continue;
+            }
+            // Units changing means the benchmark changed, its numbers aren't comparable anymore
+            if (before->unit != now.unit || before->better != now.better || before->median == 0.0) {
+                continue;
+            }
+
+            const double ratio  = now.median / before->median;
+            const double change = now.better == Better::Higher ? ratio - 1.0 : 1.0 - ratio;
+
+            comparisons.push_back(Comparison{
+                .name       = now.name,
+                .unit       = now.unit,
+                .baseline   = before->median,
+                .current    = now.median,
+                .change     = change,
+                .regression = change < -threshold
+            });
+        }
+        return comparisons;
+    }
+
+} // namespace vulkron::bench
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vulkron::bench {
+
+    enum class Better : uint8_t {
+        Lower, // times, latencies
+        Higher // throughputs
+    };
+
+    /**
+     * @brief One benchmark, measured as a single number per repetition
+     *
+     * `run` performs the whole measured workload once and returns its value
+     * in `unit`, so it chooses its own batch size and does its own setup
+     * outside the timed region. Throwing skips the benchmark, which is how
+     * ones the GPU can't run report it.
+     */
+    struct Benchmark {
+        std::string             name; // group.case, e.g. "startup.create_device"
+        std::string             unit;
+        Better                  better;
+        std::function<double()> run;
+    };
+
+    struct Result {
+        std::string name;
+        std::string unit;
+        Better      better  = Better::Lower;
+        double      median  = 0.0;
+        double      mean    = 0.0;
+        double      min     = 0.0;
+        double      max     = 0.0;
+        double      stddev  = 0.0;
+        uint32_t    samples = 0;
+        std::string skipped; // reason, empty when the benchmark ran
+    };
+
+    struct Report {
+        std::string         gpu;
+        std::string         driver;
+        uint32_t            repetitions = 0;
+        std::vector<Result> results;
+    };
+
+    struct Comparison {
+        std::string name;
+        std::string unit;
+        double      baseline   = 0.0;
+        double      current    = 0.0;
+        double      change     = 0.0; // fraction, positive is better
+        bool        regression = false;
+    };
+
+    class Suite {
+        std::vector<Benchmark> _benchmarks;
+
+      public:
+        auto add(std::string name, std::string unit, Better better, std::function<double()> run) -> void;
+
+        [[nodiscard]] auto benchmarks() const noexcept -> const std::vector<Benchmark>&;
+
+        // One warm-up run, then `repetitions` measured ones of every benchmark whose name contains `filter`
+        [[nodiscard]] auto run(uint32_t repetitions, std::string_view filter) const -> std::vector<Result>;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    [[nodiscard]] inline auto milliseconds(Clock::duration duration) -> double {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    [[nodiscard]] inline auto per_second(uint64_t count, Clock::duration duration) -> double {
+        const double seconds = std::chrono::duration<double>(duration).count();
+        return seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+    }
+
+    // Keeps the compiler from discarding a value computed only to be measured
+    template <class T>
+    inline auto keep(const T& value) -> void {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    auto write_report(const Report& report, const std::filesystem::path& path) -> bool;
+
+    // Nothing on a missing or malformed file
+    [[nodiscard]] auto read_report(const std::filesystem::path& path) -> std::optional<Report>;
+
+    // Benchmarks present in both, a regression is a median worse than the baseline by more than `threshold`
+    [[nodiscard]] auto compare(const Report& baseline, const Report& current, double threshold) -> std::vector<Comparison>;
+
+} // namespace vulkron::bench
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "bench.hpp"
+
+namespace vulkron::bench {
+
+    // Job system scheduling, needs no GPU
+    auto add_support_benchmarks(Suite& suite) -> void;
+
+    // Startup, submission, recording, memory, dispatch, headless rendering and compute kernels on the selected GPU
+    auto add_gpu_benchmarks(Suite& suite) -> void;
+
+    // Name and driver of the GPU the gpu benchmarks run on, "unavailable" without one
+    auto describe_gpu(Report& report) -> void;
+
+} // namespace vulkron::bench
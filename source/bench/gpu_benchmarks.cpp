@@ -0,0 +1,1204 @@
+#include "benchmarks.hpp"
+#include "bindless_heap.hpp"
+#include "command_recorder.hpp"
+#include "compute.hpp"
+#include "device.hpp"
+#include "gpu/context.hpp"
+#include "instance.hpp"
+#include "pipeline_cache.hpp"
+#include "pipeline_state_cache.hpp"
+#include "render_graph.hpp"
+#include "shader_compiler.hpp"
+#include "support/jobs/job_system.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vulkron::bench {
+
+    namespace {
+
+        using gpu::vulkan::Device;
+
+        // Caches would make every run after the first measure a different path
+        auto fresh_device() -> Device {
+            Device device;
+            device.set_cache_directory({});
+            return device;
+        }
+
+        auto make_device() -> Device {
+            Device device = fresh_device();
+            device.select_gpu(Device::GpuUsage::Graphics);
+            device.create_device();
+            return device;
+        }
+
+        // Device for the benchmarks that don't measure creation, created by the first of them
+        auto shared_device() -> Device& {
+            static std::unique_ptr<Device> device = std::make_unique<Device>(make_device());
+            return *device;
+        }
+
+        auto recorder_config(const Device& device, uint32_t frames_in_flight) -> gpu::vulkan::CommandRecorder::Config {
+            const gpu::vulkan::Queue& graphics = device.queues().graphics;
+            return {.queue = graphics.handle, .queue_family = graphics.family, .frames_in_flight = frames_in_flight};
+        }
+
+        auto buffer_info(VkDeviceSize size, VkBufferUsageFlags usage) -> VkBufferCreateInfo {
+            return VkBufferCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size                  = size,
+                .usage                 = usage,
+                .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices   = nullptr
+            };
+        }
+
+        auto add_startup(Suite& suite) -> void {
+            // Opens the loader once per process, the warm-up run pays for that
+            suite.add("startup.create_instance", "ms", Better::Lower, [] {
+                const Clock::time_point start = Clock::now();
+                gpu::vulkan::Instance instance;
+                return milliseconds(Clock::now() - start);
+            });
+
+            suite.add("startup.select_gpu", "ms", Better::Lower, [] {
+                Device device = fresh_device();
+
+                const Clock::time_point start = Clock::now();
+                device.select_gpu(Device::GpuUsage::Graphics);
+                return milliseconds(Clock::now() - start);
+            });
+
+            suite.add("startup.create_device", "ms", Better::Lower, [] {
+                Device device = fresh_device();
+                device.select_gpu(Device::GpuUsage::Graphics);
+
+                const Clock::time_point start = Clock::now();
+                device.create_device();
+                return milliseconds(Clock::now() - start);
+            });
+
+            suite.add("startup.total", "ms", Better::Lower, [] {
+                const Clock::time_point start = Clock::now();
+                Device device = make_device();
+                return milliseconds(Clock::now() - start);
+            });
+
+            // Another Device on an Instance that already exists, e.g. one more tenant on a render server
+            suite.add("startup.nth_device", "ms", Better::Lower, [] {
+                auto   instance = std::make_shared<const gpu::vulkan::Instance>();
+                Device first(instance);
+                first.set_cache_directory({});
+                first.select_gpu(Device::GpuUsage::Graphics);
+                first.create_device();
+
+                const Clock::time_point start = Clock::now();
+                Device device(instance);
+                device.set_cache_directory({});
+                device.select_gpu(Device::GpuUsage::Graphics);
+                device.create_device();
+                return milliseconds(Clock::now() - start);
+            });
+
+            // Instance plus N Devices created concurrently, against N times startup.nth_device when serial
+            for (uint32_t count : {4u, 16u}) {
+                suite.add("startup.parallel_devices/" + std::to_string(count), "ms", Better::Lower, [count] {
+                    const Clock::time_point start = Clock::now();
+                    auto instance = std::make_shared<const gpu::vulkan::Instance>();
+                    std::vector<Device> devices = gpu::vulkan::create_devices(instance, count, Device::GpuUsage::Graphics, [](Device& device, uint32_t) {
+                        device.set_cache_directory({});
+                    });
+                    return milliseconds(Clock::now() - start);
+                });
+            }
+        }
+
+        // Empty frames: begin, end and the timeline bookkeeping of every submission
+        auto add_submission(Suite& suite) -> void {
+            suite.add("submit.empty_frames", "submits/s", Better::Higher, [] {
+                constexpr uint32_t FRAMES = 2000;
+
+                Device&                       device = shared_device();
+                support::JobSystem            jobs(support::JobSystem::Config{.threads = 1});
+                gpu::vulkan::CommandRecorder  recorder(device, jobs, recorder_config(device, 3));
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < FRAMES; ++i) {
+                    static_cast<void>(recorder.begin_frame());
+                    recorder.end_frame();
+                }
+                recorder.wait_idle();
+                return per_second(FRAMES, Clock::now() - start);
+            });
+        }
+
+        // Secondaries of dynamic state commands, cheap enough to the driver that the recorder's own cost shows
+        auto add_recording(Suite& suite) -> void {
+            const uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+            // The caller records too, threads:1 is the caller alone with no workers
+            for (uint32_t threads = 1; threads <= cores; threads *= 2) {
+                suite.add("record.commands/threads:" + std::to_string(threads), "commands/s", Better::Higher, [threads] {
+                    constexpr uint32_t FRAMES   = 20;
+                    constexpr uint32_t TASKS    = 256;
+                    constexpr uint32_t COMMANDS = 512; // per task
+
+                    Device&                      device = shared_device();
+                    const auto&                  api    = device.dispatch();
+                    support::JobSystem           jobs(support::JobSystem::Config{.threads = threads - 1});
+                    gpu::vulkan::CommandRecorder recorder(device, jobs, recorder_config(device, 2));
+
+                    const auto record = [&api](VkCommandBuffer cmd, uint32_t task) {
+                        for (uint32_t i = 0; i < COMMANDS; ++i) {
+                            const VkViewport viewport = {0.0f, 0.0f, static_cast<float>(64 + task), static_cast<float>(64 + i), 0.0f, 1.0f};
+                            api.vkCmdSetViewport(cmd, 0, 1, &viewport);
+                        }
+                    };
+
+                    const Clock::time_point start = Clock::now();
+                    for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+                        static_cast<void>(recorder.begin_frame());
+                        recorder.record_parallel(TASKS, record);
+                        recorder.end_frame();
+                    }
+                    recorder.wait_idle();
+                    return per_second(uint64_t{FRAMES} * TASKS * COMMANDS, Clock::now() - start);
+                });
+            }
+        }
+
+        auto add_memory(Suite& suite) -> void {
+            constexpr uint32_t COUNT = 1024;
+
+            suite.add("memory.create_buffer", "buffers/s", Better::Higher, [] {
+                gpu::vulkan::MemoryAllocator& allocator = shared_device().allocator();
+
+                const VkBufferCreateInfo                  info = buffer_info(64 << 10, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+                std::vector<gpu::vulkan::AllocatedBuffer> buffers(COUNT);
+
+                const Clock::time_point start = Clock::now();
+                for (gpu::vulkan::AllocatedBuffer& buffer : buffers) {
+                    buffer = allocator.create_buffer(info, gpu::vulkan::MemoryUsage::GpuOnly);
+                }
+                for (gpu::vulkan::AllocatedBuffer& buffer : buffers) {
+                    allocator.destroy_buffer(buffer);
+                }
+                return per_second(COUNT, Clock::now() - start);
+            });
+
+            // Sub-allocation alone, mixed sizes so the free lists see some fragmentation
+            suite.add("memory.allocate", "allocations/s", Better::Higher, [] {
+                Device&                       device    = shared_device();
+                gpu::vulkan::MemoryAllocator& allocator = device.allocator();
+
+                gpu::vulkan::AllocatedBuffer probe = allocator.create_buffer(buffer_info(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), gpu::vulkan::MemoryUsage::GpuOnly);
+                VkMemoryRequirements         requirements;
+                device.dispatch().vkGetBufferMemoryRequirements(device.device_handle(), probe.buffer, &requirements);
+                allocator.destroy_buffer(probe);
+
+                std::vector<gpu::vulkan::Allocation> allocations(COUNT);
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < COUNT; ++i) {
+                    requirements.size = VkDeviceSize{256} << (i % 8);
+                    allocations[i]    = allocator.allocate(requirements, gpu::vulkan::MemoryUsage::GpuOnly, gpu::vulkan::ResourceTiling::Linear);
+                }
+                // Every other one first, then the rest, so freed ranges have to coalesce
+                for (uint32_t i = 0; i < COUNT; i += 2) {
+                    allocator.free(allocations[i]);
+                }
+                for (uint32_t i = 1; i < COUNT; i += 2) {
+                    allocator.free(allocations[i]);
+                }
+                return per_second(COUNT, Clock::now() - start);
+            });
+
+            // What memory.allocate replaces: one vkAllocateMemory per resource, same sizes and memory type
+            suite.add("memory.allocate_baseline", "allocations/s", Better::Higher, [] {
+                Device&                       device    = shared_device();
+                gpu::vulkan::MemoryAllocator& allocator = device.allocator();
+
+                gpu::vulkan::AllocatedBuffer probe       = allocator.create_buffer(buffer_info(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), gpu::vulkan::MemoryUsage::GpuOnly);
+                const uint32_t               memory_type = probe.allocation.memory_type;
+                allocator.destroy_buffer(probe);
+
+                std::vector<VkDeviceMemory> memories(COUNT, VK_NULL_HANDLE);
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < COUNT; ++i) {
+                    const VkMemoryAllocateInfo info = {
+                        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                        .pNext           = nullptr,
+                        .allocationSize  = VkDeviceSize{256} << (i % 8),
+                        .memoryTypeIndex = memory_type
+                    };
+                    if (device.dispatch().vkAllocateMemory(device.device_handle(), &info, nullptr, &memories[i]) != VK_SUCCESS) {
+                        for (VkDeviceMemory memory : memories) {
+                            device.dispatch().vkFreeMemory(device.device_handle(), memory, nullptr);
+                        }
+                        throw std::runtime_error("vkAllocateMemory failed, the driver's allocation limit may be below the count");
+                    }
+                }
+                for (uint32_t i = 0; i < COUNT; i += 2) {
+                    device.dispatch().vkFreeMemory(device.device_handle(), memories[i], nullptr);
+                }
+                for (uint32_t i = 1; i < COUNT; i += 2) {
+                    device.dispatch().vkFreeMemory(device.device_handle(), memories[i], nullptr);
+                }
+                return per_second(COUNT, Clock::now() - start);
+            });
+        }
+
+        // The same query through the DispatchTable and through the loader's trampoline
+        auto add_dispatch(Suite& suite) -> void {
+            constexpr uint32_t CALLS = 1'000'000;
+
+            const auto measure = [](bool trampoline) {
+                Device&                       device    = shared_device();
+                gpu::vulkan::MemoryAllocator& allocator = device.allocator();
+
+                PFN_vkGetBufferMemoryRequirements function = device.dispatch().vkGetBufferMemoryRequirements;
+                if (trampoline) {
+                    function = reinterpret_cast<PFN_vkGetBufferMemoryRequirements>(
+                        gpu::vulkan::loader_proc_addr()(device.instance_handle(), "vkGetBufferMemoryRequirements"));
+                }
+                if (function == nullptr) {
+                    throw std::runtime_error("vkGetBufferMemoryRequirements not found");
+                }
+
+                gpu::vulkan::AllocatedBuffer buffer = allocator.create_buffer(buffer_info(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), gpu::vulkan::MemoryUsage::GpuOnly);
+                VkMemoryRequirements         requirements;
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < CALLS; ++i) {
+                    function(device.device_handle(), buffer.buffer, &requirements);
+                }
+                const Clock::duration elapsed = Clock::now() - start;
+
+                allocator.destroy_buffer(buffer);
+                return std::chrono::duration<double, std::nano>(elapsed).count() / CALLS;
+            };
+
+            suite.add("dispatch.device_table", "ns/call", Better::Lower, [measure] {
+                return measure(false);
+            });
+            suite.add("dispatch.loader_trampoline", "ns/call", Better::Lower, [measure] {
+                return measure(true);
+            });
+        }
+
+        // Its own device, the descriptor indexing features have to be asked for before selection
+        auto bindless_device() -> Device& {
+            static std::unique_ptr<Device> device = [] {
+                auto created = std::make_unique<Device>(fresh_device());
+                gpu::vulkan::BindlessHeap::require_features(*created);
+                created->select_gpu(Device::GpuUsage::Graphics);
+                created->create_device();
+                return created;
+            }();
+            return *device;
+        }
+
+        // What a renderer without the heap does: one set per draw pointing at its storage buffer
+        class PerDrawSets {
+            const gpu::vulkan::DispatchTable& _api;
+            VkDevice                          _device;
+            VkDescriptorSetLayout             _layout = VK_NULL_HANDLE;
+            VkDescriptorPool                  _pool   = VK_NULL_HANDLE;
+
+          public:
+            PerDrawSets(const Device& device, uint32_t max_sets)
+                : _api(device.dispatch()),
+                _device(device.device_handle())
+            {
+                const VkDescriptorSetLayoutBinding binding = {
+                    .binding            = 0,
+                    .descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount    = 1,
+                    .stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .pImmutableSamplers = nullptr
+                };
+                const VkDescriptorSetLayoutCreateInfo layout_info = {
+                    .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                    .pNext        = nullptr,
+                    .flags        = 0,
+                    .bindingCount = 1,
+                    .pBindings    = &binding
+                };
+                if (_api.vkCreateDescriptorSetLayout(_device, &layout_info, nullptr, &_layout) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create per-draw descriptor set layout");
+                }
+
+                const VkDescriptorPoolSize       pool_size = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_sets};
+                const VkDescriptorPoolCreateInfo pool_info = {
+                    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                    .pNext         = nullptr,
+                    .flags         = 0,
+                    .maxSets       = max_sets,
+                    .poolSizeCount = 1,
+                    .pPoolSizes    = &pool_size
+                };
+                if (_api.vkCreateDescriptorPool(_device, &pool_info, nullptr, &_pool) != VK_SUCCESS) {
+                    _api.vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+                    throw std::runtime_error("Failed to create per-draw descriptor pool");
+                }
+            }
+
+            ~PerDrawSets() {
+                _api.vkDestroyDescriptorPool(_device, _pool, nullptr);
+                _api.vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+            }
+
+            PerDrawSets(const PerDrawSets&) = delete;
+            auto operator=(const PerDrawSets&) -> PerDrawSets& = delete;
+
+            [[nodiscard]] auto layout() const noexcept -> VkDescriptorSetLayout {
+                return _layout;
+            }
+
+            // Once per frame, frees every set at once
+            auto reset() -> void {
+                _api.vkResetDescriptorPool(_device, _pool, 0);
+            }
+
+            [[nodiscard]] auto allocate(VkBuffer buffer) -> VkDescriptorSet {
+                const VkDescriptorSetAllocateInfo allocate_info = {
+                    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                    .pNext              = nullptr,
+                    .descriptorPool     = _pool,
+                    .descriptorSetCount = 1,
+                    .pSetLayouts        = &_layout
+                };
+
+                VkDescriptorSet set;
+                if (_api.vkAllocateDescriptorSets(_device, &allocate_info, &set) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to allocate per-draw descriptor set");
+                }
+
+                const VkDescriptorBufferInfo buffer_info = {buffer, 0, VK_WHOLE_SIZE};
+                const VkWriteDescriptorSet   write       = {
+                    .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext            = nullptr,
+                    .dstSet           = set,
+                    .dstBinding       = 0,
+                    .dstArrayElement  = 0,
+                    .descriptorCount  = 1,
+                    .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pImageInfo       = nullptr,
+                    .pBufferInfo      = &buffer_info,
+                    .pTexelBufferView = nullptr
+                };
+                _api.vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+                return set;
+            }
+        };
+
+        struct DrawShaders {
+            gpu::vulkan::ShaderBinary bindless;
+            gpu::vulkan::ShaderBinary per_draw;
+        };
+
+        struct BindlessDrawPush {
+            uint32_t buffer;
+            uint32_t slot;
+        };
+
+        // Compiled with slangc through the shader cache, benchmarks are skipped when it isn't installed
+        auto draw_shaders() -> const DrawShaders& {
+            static const DrawShaders shaders = [] {
+                gpu::vulkan::ShaderCompiler compiler(gpu::vulkan::ShaderCompiler::Config{});
+
+                const auto compile = [&](const char* name) {
+                    return compiler.compile(gpu::vulkan::ShaderRequest{
+                        .source = std::filesystem::path(VULKRON_BENCH_SHADER_DIRECTORY) / name
+                    });
+                };
+                return DrawShaders{
+                    .bindless = compile("bindless_draw.slang"),
+                    .per_draw = compile("per_draw.slang")
+                };
+            }();
+            return shaders;
+        }
+
+        auto add_bindless(Suite& suite) -> void {
+            suite.add("bindless.add_release", "descriptors/s", Better::Higher, [] {
+                constexpr uint32_t COUNT = 4096;
+
+                Device&                      device = bindless_device();
+                gpu::vulkan::BindlessHeap    heap(device);
+                gpu::vulkan::AllocatedBuffer buffer = device.allocator().create_buffer(buffer_info(4096, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), gpu::vulkan::MemoryUsage::GpuOnly);
+                std::vector<uint32_t>        indices(COUNT);
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < COUNT; ++i) {
+                    indices[i] = heap.add_storage_buffer(buffer.buffer, 0, 256);
+                }
+                for (uint32_t index : indices) {
+                    heap.release(gpu::vulkan::BindlessType::StorageBuffer, index, 1);
+                }
+                heap.recycle(1);
+                const Clock::duration elapsed = Clock::now() - start;
+
+                device.allocator().destroy_buffer(buffer);
+                return per_second(COUNT, elapsed);
+            });
+
+            // Each draw writes one value into one of 64 storage buffers. It is a single-group
+            // dispatch because the bench has no graphics pipeline; the descriptor work per draw,
+            // a set allocated, written and bound against a push constant, is the same either way.
+            enum class Descriptors : uint8_t { Bindless, PerDrawSets };
+
+            const auto draws = [](Descriptors descriptors) {
+                return [descriptors] {
+                    constexpr uint32_t DRAWS   = 10'000;
+                    constexpr uint32_t BUFFERS = 64;
+                    constexpr uint32_t SLOTS   = 1024; // uints per buffer
+
+                    Device&                   device  = bindless_device();
+                    const DrawShaders&        shaders = draw_shaders();
+                    gpu::vulkan::BindlessHeap heap(device);
+                    PerDrawSets               sets(device, DRAWS);
+
+                    std::vector<gpu::vulkan::AllocatedBuffer> buffers(BUFFERS);
+                    std::vector<uint32_t>                     indices(BUFFERS);
+                    for (uint32_t i = 0; i < BUFFERS; ++i) {
+                        buffers[i] = device.allocator().create_buffer(buffer_info(SLOTS * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), gpu::vulkan::MemoryUsage::GpuOnly);
+                        indices[i] = heap.add_storage_buffer(buffers[i].buffer);
+                    }
+
+                    const bool                       bindless = descriptors == Descriptors::Bindless;
+                    const gpu::vulkan::ShaderBinary& shader   = bindless ? shaders.bindless : shaders.per_draw;
+                    gpu::vulkan::ComputeKernel       kernel(device, gpu::vulkan::ComputeKernelDesc{
+                        .shader             = {VK_SHADER_STAGE_COMPUTE_BIT, shader.spirv, "main", shader.key},
+                        .push_constant_size = static_cast<uint32_t>(bindless ? sizeof(BindlessDrawPush) : sizeof(uint32_t)),
+                        .set_layouts        = {bindless ? heap.layout() : sets.layout()}
+                    });
+                    gpu::vulkan::ComputeQueue queue(device);
+
+                    const Clock::time_point start = Clock::now();
+                    if (bindless) {
+                        heap.bind(queue.command_buffer(), VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout(), 0);
+                        for (uint32_t i = 0; i < DRAWS; ++i) {
+                            queue.dispatch(kernel, 1, 1, 1, BindlessDrawPush{indices[i % BUFFERS], i % SLOTS});
+                        }
+                    }
+                    else {
+                        sets.reset();
+                        for (uint32_t i = 0; i < DRAWS; ++i) {
+                            const VkDescriptorSet set = sets.allocate(buffers[i % BUFFERS].buffer);
+                            device.dispatch().vkCmdBindDescriptorSets(queue.command_buffer(), VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout(), 0, 1, &set, 0, nullptr);
+                            queue.dispatch(kernel, 1, 1, 1, i % SLOTS);
+                        }
+                    }
+                    queue.wait(queue.submit());
+                    const Clock::duration elapsed = Clock::now() - start;
+
+                    for (gpu::vulkan::AllocatedBuffer& buffer : buffers) {
+                        device.allocator().destroy_buffer(buffer);
+                    }
+                    return per_second(DRAWS, elapsed);
+                };
+            };
+
+            suite.add("bindless.draws/bindless", "draws/s", Better::Higher, draws(Descriptors::Bindless));
+            suite.add("bindless.draws/per_draw_sets", "draws/s", Better::Higher, draws(Descriptors::PerDrawSets));
+        }
+
+        // Whole frames through the public Context: clear, submit and optionally copy back
+        // Peak transient memory of a post-processing chain, each pass reading the previous pass's
+        // 1080p image and writing its own; with aliasing two images are alive at any point
+        auto add_render_graph(Suite& suite) -> void {
+            const auto transient_memory = [](bool aliasing) {
+                return [aliasing] {
+                    constexpr uint32_t PASSES = 8;
+
+                    const gpu::graphs::ImageDesc image = {.format = VK_FORMAT_R16G16B16A16_SFLOAT, .extent = {1920, 1080, 1}};
+
+                    gpu::graphs::RenderGraph graph;
+                    graph.set_aliasing(aliasing);
+
+                    gpu::graphs::ResourceHandle previous = graph.create_image("pass_0", image);
+                    graph.add_pass("pass_0", {}).write(previous, gpu::graphs::ResourceUsage::ComputeStorageWrite);
+                    for (uint32_t i = 1; i < PASSES; ++i) {
+                        const gpu::graphs::ResourceHandle target = graph.create_image("pass_" + std::to_string(i), image);
+
+                        gpu::graphs::RenderGraph::PassBuilder pass = graph.add_pass("pass_" + std::to_string(i), {});
+                        pass.read(previous, gpu::graphs::ResourceUsage::ComputeShaderSampled);
+                        pass.write(target, gpu::graphs::ResourceUsage::ComputeStorageWrite);
+                        if (i == PASSES - 1) {
+                            pass.keep();
+                        }
+                        previous = target;
+                    }
+                    graph.compile(shared_device());
+
+                    return static_cast<double>(graph.stats().transient_bytes) / 1e6;
+                };
+            };
+
+            suite.add("render_graph.transient_memory/aliased", "MB", Better::Lower, transient_memory(true));
+            suite.add("render_graph.transient_memory/unaliased", "MB", Better::Lower, transient_memory(false));
+        }
+
+        auto add_headless(Suite& suite) -> void {
+            suite.add("headless.frames_1080p", "frames/s", Better::Higher, [] {
+                constexpr uint32_t FRAMES = 300;
+
+                gpu::Context context({.frames_in_flight = 3, .headless = {.width = 1920, .height = 1080}});
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t i = 0; i < FRAMES; ++i) {
+                    static_cast<void>(context.begin_frame());
+                    context.render(0, {});
+                    context.end_frame();
+                }
+                context.wait_idle();
+                return per_second(FRAMES, Clock::now() - start);
+            });
+
+            // Throughput and the mean time from read_back() to its callback, from the same frames
+            const auto readback = [](uint32_t width, uint32_t height, double (*measure)(const gpu::Context::Stats&)) {
+                return [width, height, measure] {
+                    constexpr uint32_t FRAMES = 60;
+
+                    gpu::Context context({.frames_in_flight = 3, .headless = {.width = width, .height = height}});
+
+                    uint64_t checksum = 0;
+                    for (uint32_t i = 0; i < FRAMES; ++i) {
+                        static_cast<void>(context.begin_frame());
+                        context.render(0, {});
+                        context.read_back([&checksum](std::span<const std::byte> pixels, uint64_t) {
+                            checksum += static_cast<uint64_t>(pixels.back());
+                        });
+                        context.end_frame();
+                    }
+                    context.wait_idle();
+                    keep(checksum);
+
+                    if (context.stats().readbacks != FRAMES) {
+                        throw std::runtime_error("read backs went missing");
+                    }
+                    return measure(context.stats());
+                };
+            };
+            const auto megabytes_per_second = [](const gpu::Context::Stats& stats) { return stats.readback_bytes_per_second / 1e6; };
+            const auto latency_ms           = [](const gpu::Context::Stats& stats) { return stats.readback_latency_ms; };
+
+            suite.add("readback.1080p", "MB/s", Better::Higher, readback(1920, 1080, megabytes_per_second));
+            suite.add("readback.4k", "MB/s", Better::Higher, readback(3840, 2160, megabytes_per_second));
+            suite.add("readback.1080p_latency", "ms", Better::Lower, readback(1920, 1080, latency_ms));
+            suite.add("readback.4k_latency", "ms", Better::Lower, readback(3840, 2160, latency_ms));
+        }
+
+        // Kernels take their buffers by address, the compiled ones are shared by every compute benchmark
+        struct ComputeKernels {
+            std::unique_ptr<gpu::vulkan::ComputeKernel> saxpy;
+            std::unique_ptr<gpu::vulkan::ComputeKernel> reduce;
+            std::vector<gpu::vulkan::ShaderStageDesc>   shaders; // saxpy's then reduce's, for the pipeline benchmarks
+        };
+
+        struct SaxpyPush {
+            VkDeviceAddress x;
+            VkDeviceAddress y;
+            float           a;
+            uint32_t        count;
+        };
+
+        struct ReducePush {
+            VkDeviceAddress input;
+            VkDeviceAddress output;
+            uint32_t        count;
+            uint32_t        padding;
+        };
+
+        constexpr uint32_t SAXPY_GROUP_SIZE  = 64;  // numthreads of saxpy.slang
+        constexpr uint32_t REDUCE_GROUP_SIZE = 256; // numthreads of reduce.slang
+
+        // Its own device, buffer device addresses have to be asked for before selection
+        auto compute_device() -> Device& {
+            static std::unique_ptr<Device> device = [] {
+                auto created = std::make_unique<Device>(fresh_device());
+                gpu::vulkan::ComputeQueue::require_features(*created);
+                created->select_gpu(Device::GpuUsage::Compute);
+                created->create_device();
+                return created;
+            }();
+            return *device;
+        }
+
+        // Compiled with slangc through the shader cache, benchmarks are skipped when it isn't installed
+        auto compute_kernels() -> ComputeKernels& {
+            static ComputeKernels kernels = [] {
+                Device&                     device = compute_device();
+                gpu::vulkan::ShaderCompiler compiler(gpu::vulkan::ShaderCompiler::Config{});
+                ComputeKernels              compiled;
+
+                const auto kernel = [&](const char* name, uint32_t push_constant_size) {
+                    gpu::vulkan::ShaderBinary binary = compiler.compile(gpu::vulkan::ShaderRequest{
+                        .source = std::filesystem::path(VULKRON_BENCH_SHADER_DIRECTORY) / name
+                    });
+                    compiled.shaders.push_back({VK_SHADER_STAGE_COMPUTE_BIT, std::move(binary.spirv), "main", binary.key});
+                    return std::make_unique<gpu::vulkan::ComputeKernel>(device, gpu::vulkan::ComputeKernelDesc{
+                        .shader             = compiled.shaders.back(),
+                        .push_constant_size = push_constant_size
+                    });
+                };
+
+                compiled.saxpy  = kernel("saxpy.slang", sizeof(SaxpyPush));
+                compiled.reduce = kernel("reduce.slang", sizeof(ReducePush));
+                return compiled;
+            }();
+            return kernels;
+        }
+
+        auto float_bits(float value) -> uint32_t {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        // Storage buffers of `count` floats addressed from kernels, filled with `value` in the queue's open batch
+        class ComputeBuffer {
+            Device&                      _device;
+            gpu::vulkan::AllocatedBuffer _buffer;
+
+          public:
+            ComputeBuffer(Device& device, gpu::vulkan::ComputeQueue& compute, uint64_t count, float value,
+                gpu::vulkan::MemoryUsage usage = gpu::vulkan::MemoryUsage::GpuOnly)
+                : _device(device),
+                _buffer(device.allocator().create_buffer(buffer_info(count * sizeof(float),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT), usage))
+            {
+                device.dispatch().vkCmdFillBuffer(compute.command_buffer(), _buffer.buffer, 0, VK_WHOLE_SIZE, float_bits(value));
+            }
+
+            ~ComputeBuffer() {
+                _device.allocator().destroy_buffer(_buffer);
+            }
+
+            ComputeBuffer(const ComputeBuffer&) = delete;
+            auto operator=(const ComputeBuffer&) -> ComputeBuffer& = delete;
+
+            [[nodiscard]] auto buffer() const noexcept -> VkBuffer {
+                return _buffer.buffer;
+            }
+
+            [[nodiscard]] auto address(uint64_t element = 0) const -> VkDeviceAddress {
+                return gpu::vulkan::buffer_address(_device, _buffer.buffer) + element * sizeof(float);
+            }
+
+            [[nodiscard]] auto read(uint64_t element) const -> float {
+                _device.allocator().invalidate(_buffer.allocation);
+
+                float value;
+                std::memcpy(&value, static_cast<const std::byte*>(_buffer.allocation.mapped) + element * sizeof(float), sizeof(value));
+                return value;
+            }
+        };
+
+        auto add_compute(Suite& suite) -> void {
+            // Bandwidth bound: each pass reads x and y and writes y, and depends on the pass before
+            suite.add("compute.saxpy", "GB/s", Better::Higher, [] {
+                constexpr uint32_t COUNT  = 1 << 22;
+                constexpr uint32_t PASSES = 20;
+
+                Device&                   device  = compute_device();
+                ComputeKernels&           kernels = compute_kernels();
+                gpu::vulkan::ComputeQueue compute(device);
+
+                ComputeBuffer x(device, compute, COUNT, 1.0f);
+                ComputeBuffer y(device, compute, COUNT, 0.0f);
+                ComputeBuffer result(device, compute, 1, 0.0f, gpu::vulkan::MemoryUsage::Readback);
+                compute.wait(compute.submit());
+
+                const SaxpyPush push = {.x = x.address(), .y = y.address(), .a = 0.5f, .count = COUNT};
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t pass = 0; pass < PASSES; ++pass) {
+                    compute.barrier();
+                    compute.dispatch(*kernels.saxpy, gpu::vulkan::group_count(COUNT, SAXPY_GROUP_SIZE), 1, 1, push);
+                }
+                compute.wait(compute.submit());
+                const Clock::duration elapsed = Clock::now() - start;
+
+                const VkBufferCopy last = {.srcOffset = (COUNT - 1) * sizeof(float), .dstOffset = 0, .size = sizeof(float)};
+                compute.barrier();
+                device.dispatch().vkCmdCopyBuffer(compute.command_buffer(), y.buffer(), result.buffer(), 1, &last);
+                compute.wait(compute.submit());
+
+                if (result.read(0) != 0.5f * PASSES) {
+                    throw std::runtime_error("saxpy computed a wrong result");
+                }
+                const double bytes = double{PASSES} * COUNT * 3 * sizeof(float);
+                return bytes / std::chrono::duration<double>(elapsed).count() / 1e9;
+            });
+
+            // Many kernels too small to fill the GPU: what one dispatch costs when batched, ordered or submitted on its own
+            constexpr uint32_t SMALL_DISPATCHES = 1024;
+            constexpr uint32_t SMALL_COUNT      = 4096;
+
+            enum class Batching {
+                Independent, // one submission, no barriers
+                Serialized,  // one submission, a barrier between every two dispatches
+                SubmitEach   // a submission per dispatch
+            };
+
+            const auto small_dispatches = [](Batching batching) {
+                return [batching] {
+                    Device&                   device  = compute_device();
+                    ComputeKernels&           kernels = compute_kernels();
+                    gpu::vulkan::ComputeQueue compute(device, {.queue = device.queues().compute.handle, .queue_family = device.queues().compute.family, .batches_in_flight = 4});
+
+                    ComputeBuffer x(device, compute, uint64_t{SMALL_DISPATCHES} * SMALL_COUNT, 1.0f);
+                    ComputeBuffer y(device, compute, uint64_t{SMALL_DISPATCHES} * SMALL_COUNT, 0.0f);
+                    compute.wait(compute.submit());
+                    compute.barrier();
+
+                    const VkDeviceAddress x_base = x.address();
+                    const VkDeviceAddress y_base = y.address();
+
+                    const Clock::time_point start = Clock::now();
+                    for (uint32_t i = 0; i < SMALL_DISPATCHES; ++i) {
+                        const VkDeviceAddress offset = VkDeviceAddress{i} * SMALL_COUNT * sizeof(float);
+                        const SaxpyPush       push   = {.x = x_base + offset, .y = y_base + offset, .a = 2.0f, .count = SMALL_COUNT};
+
+                        compute.dispatch(*kernels.saxpy, gpu::vulkan::group_count(SMALL_COUNT, SAXPY_GROUP_SIZE), 1, 1, push);
+                        if (batching == Batching::Serialized) {
+                            compute.barrier();
+                        } else if (batching == Batching::SubmitEach) {
+                            static_cast<void>(compute.submit());
+                        }
+                    }
+                    compute.wait(compute.submit());
+                    return per_second(SMALL_DISPATCHES, Clock::now() - start);
+                };
+            };
+
+            suite.add("compute.small_dispatches/independent", "dispatches/s", Better::Higher, small_dispatches(Batching::Independent));
+            suite.add("compute.small_dispatches/serialized", "dispatches/s", Better::Higher, small_dispatches(Batching::Serialized));
+            suite.add("compute.small_dispatches/submit_each", "dispatches/s", Better::Higher, small_dispatches(Batching::SubmitEach));
+
+            // Tree reduction, every pass shrinks the input by the group size and waits on the one before
+            suite.add("compute.reduction", "Melem/s", Better::Higher, [] {
+                constexpr uint32_t COUNT      = 1 << 22;
+                constexpr uint32_t REDUCTIONS = 10;
+
+                Device&                   device  = compute_device();
+                ComputeKernels&           kernels = compute_kernels();
+                gpu::vulkan::ComputeQueue compute(device);
+
+                ComputeBuffer input(device, compute, COUNT, 1.0f);
+                ComputeBuffer partials(device, compute, gpu::vulkan::group_count(COUNT, REDUCE_GROUP_SIZE), 0.0f);
+                ComputeBuffer sums(device, compute, gpu::vulkan::group_count(COUNT, REDUCE_GROUP_SIZE), 0.0f, gpu::vulkan::MemoryUsage::Readback);
+                compute.wait(compute.submit());
+
+                const VkDeviceAddress input_address    = input.address();
+                const VkDeviceAddress partials_address = partials.address();
+                const VkDeviceAddress sums_address     = sums.address();
+
+                const Clock::time_point start = Clock::now();
+                for (uint32_t reduction = 0; reduction < REDUCTIONS; ++reduction) {
+                    // Passes alternate between the two buffers of partial sums, the total lands in element 0 of the last one written
+                    uint32_t        count  = COUNT;
+                    VkDeviceAddress source = input_address;
+                    bool            flip   = false;
+                    while (count > 1) {
+                        const VkDeviceAddress target = flip ? partials_address : sums_address;
+                        const uint32_t        groups = gpu::vulkan::group_count(count, REDUCE_GROUP_SIZE);
+
+                        compute.barrier();
+                        compute.dispatch(*kernels.reduce, groups, 1, 1, ReducePush{.input = source, .output = target, .count = count, .padding = 0});
+
+                        count  = groups;
+                        source = target;
+                        flip   = !flip;
+                    }
+                }
+                compute.wait(compute.submit());
+                const Clock::duration elapsed = Clock::now() - start;
+
+                // 2^22 ones: 2^14 partials, then 2^6, then 1, an odd number of passes ends in `sums`
+                if (sums.read(0) != static_cast<float>(COUNT)) {
+                    throw std::runtime_error("reduction computed a wrong result");
+                }
+                return per_second(uint64_t{REDUCTIONS} * COUNT, elapsed) / 1e6;
+            });
+        }
+
+        // Creates the compute kernels' pipelines again through `cache`, returns the mean time per pipeline
+        auto create_kernel_pipelines(Device& device, const ComputeKernels& kernels, VkPipelineCache cache) -> double {
+            const auto&                 api       = device.dispatch();
+            const VkPipelineLayout      layouts[] = {kernels.saxpy->layout(), kernels.reduce->layout()};
+            std::vector<VkShaderModule> modules;
+            std::vector<VkPipeline>     pipelines;
+            Clock::duration             elapsed{};
+
+            for (size_t i = 0; i < kernels.shaders.size(); ++i) {
+                const gpu::vulkan::ShaderStageDesc& shader = kernels.shaders[i];
+
+                const VkShaderModuleCreateInfo module_info = {
+                    .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+                    .pNext    = nullptr,
+                    .flags    = 0,
+                    .codeSize = shader.spirv.size() * sizeof(uint32_t),
+                    .pCode    = shader.spirv.data()
+                };
+                VkShaderModule module = VK_NULL_HANDLE;
+                if (api.vkCreateShaderModule(device.device_handle(), &module_info, nullptr, &module) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create shader module");
+                }
+                modules.push_back(module);
+
+                const VkComputePipelineCreateInfo create_info = {
+                    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .stage = {
+                        .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                        .pNext  = nullptr,
+                        .flags  = 0,
+                        .stage  = shader.stage,
+                        .module = module,
+                        .pName  = shader.entry_point.c_str(),
+                        .pSpecializationInfo = nullptr
+                    },
+                    .layout             = layouts[i],
+                    .basePipelineHandle = VK_NULL_HANDLE,
+                    .basePipelineIndex  = -1
+                };
+
+                VkPipeline              pipeline = VK_NULL_HANDLE;
+                const Clock::time_point start    = Clock::now();
+                const VkResult          result   = api.vkCreateComputePipelines(device.device_handle(), cache, 1, &create_info, nullptr, &pipeline);
+                elapsed += Clock::now() - start;
+
+                if (result != VK_SUCCESS) {
+                    break;
+                }
+                pipelines.push_back(pipeline);
+            }
+
+            for (VkPipeline pipeline : pipelines) {
+                api.vkDestroyPipeline(device.device_handle(), pipeline, nullptr);
+            }
+            for (VkShaderModule module : modules) {
+                api.vkDestroyShaderModule(device.device_handle(), module, nullptr);
+            }
+            if (pipelines.size() != kernels.shaders.size()) {
+                throw std::runtime_error("Failed to create compute pipeline");
+            }
+            return milliseconds(elapsed) / static_cast<double>(pipelines.size());
+        }
+
+        // Its own device, the state cache's pipelines target dynamic rendering
+        auto pipeline_device() -> Device& {
+            static std::unique_ptr<Device> device = [] {
+                auto created = std::make_unique<Device>(fresh_device());
+                created->require_feature(gpu::vulkan::DeviceFeature::DynamicRendering);
+                created->select_gpu(Device::GpuUsage::Graphics);
+                created->create_device();
+                return created;
+            }();
+            return *device;
+        }
+
+        // No sets and no push constants, the triangle shaders take nothing
+        class EmptyPipelineLayout {
+            const Device&    _device;
+            VkPipelineLayout _layout = VK_NULL_HANDLE;
+
+          public:
+            explicit EmptyPipelineLayout(const Device& device)
+                : _device(device)
+            {
+                const VkPipelineLayoutCreateInfo layout_info = {
+                    .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                    .pNext                  = nullptr,
+                    .flags                  = 0,
+                    .setLayoutCount         = 0,
+                    .pSetLayouts            = nullptr,
+                    .pushConstantRangeCount = 0,
+                    .pPushConstantRanges    = nullptr
+                };
+                if (device.dispatch().vkCreatePipelineLayout(device.device_handle(), &layout_info, nullptr, &_layout) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create pipeline layout");
+                }
+            }
+
+            ~EmptyPipelineLayout() {
+                _device.dispatch().vkDestroyPipelineLayout(_device.device_handle(), _layout, nullptr);
+            }
+
+            EmptyPipelineLayout(const EmptyPipelineLayout&) = delete;
+            auto operator=(const EmptyPipelineLayout&) -> EmptyPipelineLayout& = delete;
+
+            [[nodiscard]] auto handle() const noexcept -> VkPipelineLayout {
+                return _layout;
+            }
+        };
+
+        /**
+         * 64 valid graphics states over triangle.slang: four color formats, two cull modes, blending on or
+         * off, with or without a depth attachment and two front faces, like the variants a material
+         * system asks for
+         */
+        auto graphics_states() -> const std::vector<gpu::vulkan::GraphicsPipelineDesc>& {
+            static const EmptyPipelineLayout layout(pipeline_device());
+
+            static const std::vector<gpu::vulkan::GraphicsPipelineDesc> states = [] {
+                gpu::vulkan::ShaderCompiler compiler(gpu::vulkan::ShaderCompiler::Config{});
+
+                const std::filesystem::path                  source   = std::filesystem::path(VULKRON_BENCH_SHADER_DIRECTORY) / "triangle.slang";
+                const std::vector<gpu::vulkan::ShaderBinary> binaries = compiler.compile(std::vector<gpu::vulkan::ShaderRequest>{
+                    {.source = source, .entry_point = "vertex_main", .stage = VK_SHADER_STAGE_VERTEX_BIT},
+                    {.source = source, .entry_point = "fragment_main", .stage = VK_SHADER_STAGE_FRAGMENT_BIT}
+                });
+
+                constexpr VkFormat COLOR_FORMATS[] = {
+                    VK_FORMAT_R8G8B8A8_UNORM,
+                    VK_FORMAT_B8G8R8A8_UNORM,
+                    VK_FORMAT_R8G8B8A8_SRGB,
+                    VK_FORMAT_R16G16B16A16_SFLOAT
+                };
+
+                std::vector<gpu::vulkan::GraphicsPipelineDesc> created(64);
+                for (uint32_t i = 0; i < created.size(); ++i) {
+                    gpu::vulkan::GraphicsPipelineDesc& state = created[i];
+
+                    // slangc names the SPIR-V entry point main whatever -entry was
+                    state.stages = {
+                        {VK_SHADER_STAGE_VERTEX_BIT, binaries[0].spirv, "main", binaries[0].key},
+                        {VK_SHADER_STAGE_FRAGMENT_BIT, binaries[1].spirv, "main", binaries[1].key}
+                    };
+                    state.layout        = layout.handle();
+                    state.color_formats = {COLOR_FORMATS[i % 4]};
+                    state.cull_mode     = i / 4 % 2 == 0 ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE;
+
+                    const bool blended = i / 8 % 2 != 0;
+                    state.blend = {VkPipelineColorBlendAttachmentState{
+                        .blendEnable         = blended ? VK_TRUE : VK_FALSE,
+                        .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+                        .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+                        .colorBlendOp        = VK_BLEND_OP_ADD,
+                        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+                        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+                        .alphaBlendOp        = VK_BLEND_OP_ADD,
+                        .colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+                    }};
+
+                    if (i / 16 % 2 != 0) {
+                        state.depth_test   = true;
+                        state.depth_write  = true;
+                        state.depth_format = VK_FORMAT_D32_SFLOAT;
+                    }
+                    state.front_face = i / 32 == 0 ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+                }
+                return created;
+            }();
+            return states;
+        }
+
+        struct StateCacheContention {
+            double lookups_per_second = 0.0;
+            double p50_ns             = 0.0;
+            double p99_ns             = 0.0;
+            double hit_rate           = 0.0;
+            double memory_kb          = 0.0;
+        };
+
+        /**
+         * 16 recording threads asking a new PipelineStateCache for the 64 graphics states at once, each
+         * starting at a different state. The first request of every state misses and compiles in the
+         * background, the rest take the lock-free hit path. Every eighth lookup is timed on its own for
+         * the latency percentiles, which include one steady_clock read.
+         */
+        auto state_cache_contention() -> StateCacheContention {
+            constexpr uint32_t THREADS = 16;
+            constexpr uint32_t LOOKUPS = 100'000; // per thread
+            constexpr uint32_t SAMPLED = 8;       // every n-th lookup is timed
+
+            Device&                                               device = pipeline_device();
+            const std::vector<gpu::vulkan::GraphicsPipelineDesc>& states = graphics_states();
+
+            gpu::vulkan::PipelineCompiler   compiler(device);
+            gpu::vulkan::PipelineStateCache cache(compiler);
+
+            std::vector<std::vector<double>> latencies(THREADS);
+            std::latch                       ready(THREADS + 1);
+            std::vector<std::jthread>        threads;
+            threads.reserve(THREADS);
+            for (uint32_t t = 0; t < THREADS; ++t) {
+                latencies[t].reserve(LOOKUPS / SAMPLED);
+                threads.emplace_back([&, t] {
+                    uint64_t found = 0;
+                    ready.arrive_and_wait();
+                    for (uint32_t i = 0; i < LOOKUPS; ++i) {
+                        const gpu::vulkan::GraphicsPipelineDesc& state = states[(i + t * 4) % states.size()];
+                        if (i % SAMPLED != 0) {
+                            found += cache.get(state).valid() ? 1 : 0;
+                            continue;
+                        }
+
+                        const Clock::time_point start = Clock::now();
+                        found += cache.get(state).valid() ? 1 : 0;
+                        latencies[t].push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+                    }
+                    keep(found);
+                });
+            }
+
+            const Clock::time_point start = Clock::now();
+            ready.arrive_and_wait();
+            threads.clear();
+            const Clock::duration elapsed = Clock::now() - start;
+
+            const gpu::vulkan::PipelineStateCache::Stats stats = cache.stats();
+            if (stats.misses != states.size()) {
+                throw std::runtime_error("pipeline states were built more than once");
+            }
+
+            compiler.wait_idle();
+            if (compiler.stats().failed != 0) {
+                throw std::runtime_error("graphics state failed to compile");
+            }
+
+            std::vector<double> samples;
+            for (const std::vector<double>& thread : latencies) {
+                samples.insert(samples.end(), thread.begin(), thread.end());
+            }
+            const auto percentile = [&samples](double fraction) {
+                const auto nth = samples.begin() + static_cast<ptrdiff_t>(fraction * static_cast<double>(samples.size() - 1));
+                std::nth_element(samples.begin(), nth, samples.end());
+                return *nth;
+            };
+
+            return StateCacheContention{
+                .lookups_per_second = per_second(uint64_t{THREADS} * LOOKUPS, elapsed),
+                .p50_ns             = percentile(0.50),
+                .p99_ns             = percentile(0.99),
+                .hit_rate           = stats.hit_rate(),
+                .memory_kb          = static_cast<double>(stats.memory_bytes) / 1024.0
+            };
+        }
+
+        auto add_pipelines(Suite& suite) -> void {
+            // Loading a PipelineCache and creating both pipelines through it, per round. Cold starts without
+            // a file, warm loads the one an earlier run saved. The driver may keep a cache of its own,
+            // which narrows the gap between the two.
+            const auto pipeline_cache = [](bool warm) {
+                return [warm] {
+                    constexpr uint32_t ROUNDS = 8;
+
+                    Device&         device  = compute_device();
+                    ComputeKernels& kernels = compute_kernels();
+
+                    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vulkron-bench-pipeline-cache";
+                    const std::filesystem::path file      = directory / "pipelines.bin";
+                    std::filesystem::remove_all(directory);
+                    std::filesystem::create_directories(directory);
+
+                    const gpu::vulkan::Adapter* adapter = device.instance()->adapter(device.physical_device_handle());
+                    if (adapter == nullptr) {
+                        throw std::runtime_error("No GPU selected");
+                    }
+                    const auto load = [&](const std::filesystem::path& path) {
+                        return std::make_unique<gpu::vulkan::PipelineCache>(device.dispatch(), *adapter, device.device_handle(), path);
+                    };
+
+                    if (warm) {
+                        std::unique_ptr<gpu::vulkan::PipelineCache> seed = load(file);
+                        static_cast<void>(create_kernel_pipelines(device, kernels, seed->handle()));
+                        if (!seed->save()) {
+                            throw std::runtime_error("Failed to save the pipeline cache");
+                        }
+                    }
+
+                    double total_ms = 0.0;
+                    for (uint32_t round = 0; round < ROUNDS; ++round) {
+                        const Clock::time_point                     start = Clock::now();
+                        std::unique_ptr<gpu::vulkan::PipelineCache> cache = load(warm ? file : std::filesystem::path{});
+                        const double loaded_ms = milliseconds(Clock::now() - start);
+
+                        if (warm && cache->stats().load_result != gpu::vulkan::PipelineCache::LoadResult::Loaded) {
+                            throw std::runtime_error("Saved pipeline cache was not loaded");
+                        }
+                        total_ms += loaded_ms + create_kernel_pipelines(device, kernels, cache->handle()) * static_cast<double>(kernels.shaders.size());
+                    }
+
+                    std::filesystem::remove_all(directory);
+                    return total_ms / ROUNDS;
+                };
+            };
+
+            suite.add("pipeline_cache.cold", "ms", Better::Lower, pipeline_cache(false));
+            suite.add("pipeline_cache.warm", "ms", Better::Lower, pipeline_cache(true));
+
+            // Every row runs its own state_cache_contention(), a new cache and compiler each time
+            const auto contention = [](double (*measure)(const StateCacheContention&)) {
+                return [measure] { return measure(state_cache_contention()); };
+            };
+
+            suite.add("pipeline_state_cache.lookup", "lookups/s", Better::Higher,
+                contention([](const StateCacheContention& run) { return run.lookups_per_second; }));
+            suite.add("pipeline_state_cache.lookup_p50", "ns", Better::Lower,
+                contention([](const StateCacheContention& run) { return run.p50_ns; }));
+            suite.add("pipeline_state_cache.lookup_p99", "ns", Better::Lower,
+                contention([](const StateCacheContention& run) { return run.p99_ns; }));
+            suite.add("pipeline_state_cache.hit_rate", "%", Better::Higher,
+                contention([](const StateCacheContention& run) { return run.hit_rate * 100.0; }));
+            suite.add("pipeline_state_cache.memory", "KB", Better::Lower,
+                contention([](const StateCacheContention& run) { return run.memory_kb; }));
+        }
+
+    } // namespace
+
+    auto add_gpu_benchmarks(Suite& suite) -> void {
+        add_startup(suite);
+        add_submission(suite);
+        add_recording(suite);
+        add_memory(suite);
+        add_dispatch(suite);
+        add_bindless(suite);
+        add_render_graph(suite);
+        add_headless(suite);
+        add_compute(suite);
+        add_pipelines(suite);
+    }
+
+    auto describe_gpu(Report& report) -> void {
+        try {
+            Device device = fresh_device();
+            device.select_gpu(Device::GpuUsage::Graphics);
+
+            const gpu::vulkan::Adapter* adapter = device.instance()->adapter(device.physical_device_handle());
+            if (adapter == nullptr) {
+                throw std::runtime_error("No GPU selected");
+            }
+            const VkPhysicalDeviceProperties& properties = adapter->properties.head()->properties;
+
+            char driver[32];
+            std::snprintf(driver, sizeof(driver), "driver 0x%08x", properties.driverVersion);
+
+            report.gpu    = properties.deviceName;
+            report.driver = driver;
+        } catch (const std::exception&) {
+            report.gpu    = "unavailable";
+            report.driver = "unavailable";
+        }
+    }
+
+} // namespace vulkron::bench
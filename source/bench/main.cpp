@@ -0,0 +1,133 @@
+#include "benchmarks.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <string_view>
+
+namespace {
+
+    constexpr int EXIT_REGRESSION = 1;
+    constexpr int EXIT_USAGE      = 2;
+
+    struct Options {
+        std::string out         = "vulkron-bench.json";
+        std::string baseline;
+        std::string filter;
+        double      threshold   = 0.10;
+        uint32_t    repetitions = 5;
+        bool        list        = false;
+    };
+
+    auto usage() -> void {
+        std::fputs(
+            "usage: vulkron-bench [options]\n"
+            "\n"
+            "  --out <path>          report to write (default vulkron-bench.json)\n"
+            "  --baseline <path>     compare against a stored report, exit 1 on regressions\n"
+            "  --threshold <pct>     slowdown of the median tolerated before it counts (default 10)\n"
+            "  --repetitions <n>     measured runs per benchmark after one warm-up (default 5)\n"
+            "  --filter <text>       only benchmarks whose name contains <text>\n"
+            "  --list                print the benchmark names and exit\n"
+            "\n"
+            "Runs headless. To pin it to lavapipe, point the loader at its ICD only:\n"
+            "  VK_DRIVER_FILES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json vulkron-bench\n",
+            stderr);
+    }
+
+    auto parse(int argc, char const* argv[], Options& options) -> bool {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool             has_value = i + 1 < argc;
+
+            if (arg == "--list") {
+                options.list = true;
+            } else if (arg == "--out" && has_value) {
+                options.out = argv[++i];
+            } else if (arg == "--baseline" && has_value) {
+                options.baseline = argv[++i];
+            } else if (arg == "--filter" && has_value) {
+                options.filter = argv[++i];
+            } else if (arg == "--threshold" && has_value) {
+                options.threshold = std::strtod(argv[++i], nullptr) / 100.0;
+            } else if (arg == "--repetitions" && has_value) {
+                options.repetitions = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else {
+                return false;
+            }
+        }
+        return options.repetitions > 0 && options.threshold >= 0.0;
+    }
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int {
+    using namespace vulkron::bench;
+
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return EXIT_USAGE;
+    }
+
+    Suite suite;
+    add_support_benchmarks(suite);
+    add_gpu_benchmarks(suite);
+
+    if (options.list) {
+        for (const Benchmark& benchmark : suite.benchmarks()) {
+            std::printf("%s (%s)\n", benchmark.name.c_str(), benchmark.unit.c_str());
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Read first, a baseline that can't be used should fail before minutes of measuring
+    std::optional<Report> baseline;
+    if (!options.baseline.empty()) {
+        baseline = read_report(options.baseline);
+        if (!baseline) {
+            std::fprintf(stderr, "vulkron-bench: can't read baseline %s\n", options.baseline.c_str());
+            return EXIT_USAGE;
+        }
+    }
+
+    Report report;
+    report.repetitions = options.repetitions;
+    describe_gpu(report);
+    std::fprintf(stderr, "gpu: %s (%s)\n\n", report.gpu.c_str(), report.driver.c_str());
+
+    try {
+        report.results = suite.run(options.repetitions, options.filter);
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "vulkron-bench: %s\n", error.what());
+        return EXIT_FAILURE;
+    }
+
+    if (!write_report(report, options.out)) {
+        std::fprintf(stderr, "vulkron-bench: can't write %s\n", options.out.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (!baseline) {
+        return EXIT_SUCCESS;
+    }
+
+    if (baseline->gpu != report.gpu || baseline->driver != report.driver) {
+        std::fprintf(stderr, "\nwarning: baseline was taken on %s (%s)\n", baseline->gpu.c_str(), baseline->driver.c_str());
+    }
+
+    int regressions = 0;
+    std::fprintf(stderr, "\n%-44s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+    for (const Comparison& comparison : compare(*baseline, report, options.threshold)) {
+        std::fprintf(stderr, "%-44s %14.3f %14.3f %+8.1f%%%s\n", comparison.name.c_str(), comparison.baseline, comparison.current,
+            comparison.change * 100.0, comparison.regression ? "  REGRESSION" : "");
+        regressions += comparison.regression ? 1 : 0;
+    }
+
+    if (regressions > 0) {
+        std::fprintf(stderr, "\n%d regression(s) beyond %.1f%%\n", regressions, options.threshold * 100.0);
+        return EXIT_REGRESSION;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#include "benchmarks.hpp"
+#include "support/jobs/job_system.hpp"
+#include "support/profiler/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vulkron::bench {
+
+    namespace {
+
+        constexpr uint32_t JOBS = 100'000;
+
+        // One pool for every job benchmark, threads are started outside the measurements
+        auto jobs() -> support::JobSystem& {
+            static std::unique_ptr<support::JobSystem> instance = std::make_unique<support::JobSystem>();
+            return *instance;
+        }
+
+        // Baseline: the textbook pool, one deque behind one mutex that every worker and producer contends on
+        class MutexQueuePool {
+            std::mutex                        _mutex;
+            std::condition_variable_any       _ready;
+            std::deque<std::function<void()>> _queue;
+            std::vector<std::jthread>         _threads;
+
+          public:
+            explicit MutexQueuePool(uint32_t threads) {
+                _threads.reserve(threads);
+                for (uint32_t i = 0; i < threads; ++i) {
+                    _threads.emplace_back([this](std::stop_token stop) { work(stop); });
+                }
+            }
+
+            ~MutexQueuePool() {
+                for (std::jthread& thread : _threads) {
+                    thread.request_stop();
+                }
+                _threads.clear();
+            }
+
+            MutexQueuePool(const MutexQueuePool&) = delete;
+            auto operator=(const MutexQueuePool&) -> MutexQueuePool& = delete;
+
+            auto run(std::function<void()> function) -> void {
+                {
+                    std::lock_guard lock(_mutex);
+                    _queue.push_back(std::move(function));
+                }
+                _ready.notify_one();
+            }
+
+          private:
+            auto work(std::stop_token stop) -> void {
+                while (true) {
+                    std::function<void()> function;
+                    {
+                        std::unique_lock lock(_mutex);
+                        if (!_ready.wait(lock, stop, [this] { return !_queue.empty(); })) {
+                            return;
+                        }
+                        function = std::move(_queue.front());
+                        _queue.pop_front();
+                    }
+                    function();
+                }
+            }
+        };
+
+    } // namespace
+
+    auto add_support_benchmarks(Suite& suite) -> void {
+        // Scheduling overhead alone: injection, stealing and the counter, nothing to execute
+        suite.add("jobs.run_empty", "jobs/s", Better::Higher, [] {
+            support::JobSystem& pool = jobs();
+            support::JobCounter counter;
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < JOBS; ++i) {
+                pool.run([] {}, &counter);
+            }
+            pool.wait(counter);
+            return per_second(JOBS, Clock::now() - start);
+        });
+
+        // Same empty jobs through the baselines the job system replaces, with as many workers as it has
+        suite.add("jobs.run_empty/mutex_queue", "jobs/s", Better::Higher, [] {
+            MutexQueuePool        pool(std::max(jobs().thread_count(), 1u));
+            std::atomic<uint32_t> remaining = JOBS;
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < JOBS; ++i) {
+                pool.run([&remaining] {
+                    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        remaining.notify_one();
+                    }
+                });
+            }
+            for (uint32_t left = remaining.load(std::memory_order_acquire); left != 0; left = remaining.load(std::memory_order_acquire)) {
+                remaining.wait(left, std::memory_order_acquire);
+            }
+            return per_second(JOBS, Clock::now() - start);
+        });
+
+        // A thread per job, so fewer of them
+        suite.add("jobs.run_empty/std_async", "jobs/s", Better::Higher, [] {
+            constexpr uint32_t ASYNC_JOBS = JOBS / 10;
+
+            std::vector<std::future<void>> futures;
+            futures.reserve(ASYNC_JOBS);
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < ASYNC_JOBS; ++i) {
+                futures.push_back(std::async(std::launch::async, [] {}));
+            }
+            for (std::future<void>& future : futures) {
+                future.get();
+            }
+            return per_second(ASYNC_JOBS, Clock::now() - start);
+        });
+
+        // Jobs started from a worker go to its own deque, the path recording and fan-out take
+        suite.add("jobs.run_nested", "jobs/s", Better::Higher, [] {
+            support::JobSystem& pool = jobs();
+            support::JobCounter outer;
+
+            constexpr uint32_t PARENTS = 100;
+            constexpr uint32_t CHILDREN = JOBS / PARENTS;
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < PARENTS; ++i) {
+                pool.run([&pool] {
+                    support::JobCounter inner;
+                    for (uint32_t j = 0; j < CHILDREN; ++j) {
+                        pool.run([] {}, &inner);
+                    }
+                    pool.wait(inner);
+                }, &outer);
+            }
+            pool.wait(outer);
+            return per_second(PARENTS * CHILDREN, Clock::now() - start);
+        });
+
+        suite.add("jobs.parallel_for", "items/s", Better::Higher, [] {
+            constexpr size_t ITEMS = size_t{1} << 22;
+
+            std::atomic<uint64_t> sum = 0;
+
+            const Clock::time_point start = Clock::now();
+            jobs().parallel_for(0, ITEMS, 4096, [&sum](size_t first, size_t last) {
+                uint64_t local = 0;
+                for (size_t i = first; i < last; ++i) {
+                    local += i;
+                }
+                sum.fetch_add(local, std::memory_order_relaxed);
+            });
+            const Clock::duration elapsed = Clock::now() - start;
+
+            keep(sum.load());
+            return per_second(ITEMS, elapsed);
+        });
+
+#if defined(VULKRON_ENABLE_PROFILER)
+        // Opening and closing one zone, two timestamps and the slot write; should stay under 20 ns.
+        // Wraps the ring many times, which is what a long capture does.
+        suite.add("profiler.zone", "ns", Better::Lower, [] {
+            constexpr uint32_t ZONES = 1'000'000;
+
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < ZONES; ++i) {
+                VULKRON_PROFILE_ZONE("profiler.zone");
+            }
+            const Clock::duration elapsed = Clock::now() - start;
+
+            return std::chrono::duration<double, std::nano>(elapsed).count() / ZONES;
+        });
+#endif
+    }
+
+} // namespace vulkron::bench
@@ -1 +1,354 @@
-#include "gpu/context.hpp"
\ No newline at end of file
+#include "gpu/context.hpp"
+
+#include "command_recorder.hpp"
+#include "deletion_queue.hpp"
+#include "device.hpp"
+#include "offscreen.hpp"
+#include "query_manager.hpp"
+#include "readback.hpp"
+#include "support/common/small_vector.hpp"
+#include "support/jobs/job_system.hpp"
+#include "support/profiler/profiler.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu {
+
+    namespace {
+
+        auto make_device() -> vulkan::Device {
+            vulkan::Device device;
+            // record() runs inside dynamic rendering with inherited attachment formats
+            device.require_feature(vulkan::DeviceFeature::DynamicRendering);
+            device.select_gpu(vulkan::Device::GpuUsage::Graphics);
+            device.create_device();
+            return device;
+        }
+
+        auto recorder_config(const vulkan::Device& device, const Context::Config& config) -> vulkan::CommandRecorder::Config {
+            const vulkan::Queue& graphics = device.queues().graphics;
+            return vulkan::CommandRecorder::Config{
+                .queue            = graphics.handle,
+                .queue_family     = graphics.family,
+                .frames_in_flight = config.frames_in_flight
+            };
+        }
+
+        auto make_offscreen(vulkan::Device& device, const Context::Config& config) -> std::unique_ptr<vulkan::OffscreenTargets> {
+            if (config.headless.width == 0 || config.headless.height == 0) {
+                return nullptr;
+            }
+
+            // One target per frame in flight, so a target is free again whenever its frame comes around
+            return std::make_unique<vulkan::OffscreenTargets>(device, vulkan::OffscreenTargets::Config{
+                .width        = config.headless.width,
+                .height       = config.headless.height,
+                .color_format = static_cast<VkFormat>(config.headless.color_format),
+                .depth_format = static_cast<VkFormat>(config.headless.depth_format),
+                .count        = std::max(config.frames_in_flight, 1u)
+            });
+        }
+
+        auto make_readback(vulkan::Device& device, const vulkan::CommandRecorder& recorder, const vulkan::OffscreenTargets* offscreen) -> std::unique_ptr<vulkan::ReadbackRing> {
+            if (offscreen == nullptr) {
+                return nullptr;
+            }
+
+            const vulkan::OffscreenTargets::Config& targets = offscreen->config();
+            const uint32_t                          texel   = vulkan::texel_size(targets.color_format);
+            if (texel == 0) {
+                return nullptr; // read_back() reports the unsupported format
+            }
+
+            // As many staging buffers as frames in flight, a slot is reused once its frame retired
+            return std::make_unique<vulkan::ReadbackRing>(device, vulkan::ReadbackRing::Config{
+                .timeline  = recorder.semaphore(),
+                .slots     = targets.count,
+                .slot_size = VkDeviceSize{targets.width} * targets.height * texel
+            });
+        }
+
+        auto make_queries(vulkan::Device& device, const vulkan::CommandRecorder& recorder, const Context::Config& config) -> std::unique_ptr<vulkan::QueryManager> {
+            if (config.timed_passes == 0) {
+                return nullptr;
+            }
+
+            // Timestamps only, statistics queries would have to be inherited by every secondary
+            return std::make_unique<vulkan::QueryManager>(device, vulkan::QueryManager::Config{
+                .timeline         = recorder.semaphore(),
+                .queue_family     = device.queues().graphics.family,
+                .frames_in_flight = std::max(config.frames_in_flight, 1u),
+                .max_passes       = config.timed_passes
+            });
+        }
+
+    } // namespace
+
+    struct Context::Impl {
+        support::JobSystem      jobs;
+        vulkan::Device          device;
+        vulkan::CommandRecorder recorder;
+        vulkan::DeletionQueue   retired;
+
+        std::unique_ptr<vulkan::OffscreenTargets> offscreen;
+        std::unique_ptr<vulkan::ReadbackRing>     readback;
+        std::unique_ptr<vulkan::QueryManager>     queries;
+
+        support::SmallVector<VkFormat, 8> color_formats;
+        VkCommandBuffer                   frame = VK_NULL_HANDLE;
+
+        explicit Impl(const Config& config)
+            : jobs(support::JobSystem::Config{.threads = config.threads == AUTO_THREADS ? support::JobSystem::AUTO_THREADS : config.threads}),
+            device(make_device()),
+            recorder(device, jobs, recorder_config(device, config)),
+            retired(device, vulkan::DeletionQueue::Config{.timeline = recorder.semaphore()}),
+            offscreen(make_offscreen(device, config)),
+            readback(make_readback(device, recorder, offscreen.get())),
+            queries(make_queries(device, recorder, config))
+        {
+        }
+
+        ~Impl()
+        {
+            // Targets may still be rendered to by frames in flight
+            recorder.wait_idle();
+        }
+    };
+
+    Context::Context()
+        : Context(Config{})
+    {
+    }
+
+    Context::Context(const Config& config)
+    {
+        static_assert(sizeof(_storage) >= sizeof(Impl), "Context storage too small for Impl");
+        static_assert(alignof(std::max_align_t) >= alignof(Impl), "Context storage underaligned for Impl");
+        new (&_storage) Impl(config);
+    }
+
+    Context::~Context()
+    {
+        impl()->~Impl();
+    }
+
+    auto Context::impl() noexcept -> impl_pointer
+    {
+        return std::launder(reinterpret_cast<impl_pointer>(&_storage));
+    }
+
+    auto Context::impl() const noexcept -> const_impl_pointer
+    {
+        return std::launder(reinterpret_cast<const_impl_pointer>(&_storage));
+    }
+
+    auto Context::begin_frame() -> native_command_buffer
+    {
+        Impl& state = *impl();
+        state.frame = state.recorder.begin_frame();
+
+        // begin_frame() retired the frame whose staging buffer this one reuses
+        if (state.readback) {
+            state.readback->poll();
+        }
+        if (state.queries) {
+            state.queries->begin_frame(state.frame);
+        }
+        state.retired.collect();
+        return state.frame;
+    }
+
+    auto Context::record(uint32_t tasks, const record_function& record) -> void
+    {
+        impl()->recorder.record_parallel(tasks, [&record](VkCommandBuffer cmd, uint32_t task) {
+            record(cmd, task);
+        });
+    }
+
+    auto Context::record(uint32_t tasks, const record_function& record, const RenderingFormats& rendering) -> void
+    {
+        support::SmallVector<VkFormat, 8>& color_formats = impl()->color_formats;
+        color_formats.clear();
+        for (uint32_t format : rendering.color_formats) {
+            color_formats.push_back(static_cast<VkFormat>(format));
+        }
+
+        const vulkan::RenderingInheritance inheritance = {
+            .color_formats  = color_formats,
+            .depth_format   = static_cast<VkFormat>(rendering.depth_format),
+            .stencil_format = static_cast<VkFormat>(rendering.stencil_format),
+            .samples        = static_cast<VkSampleCountFlagBits>(rendering.samples)
+        };
+
+        impl()->recorder.record_parallel(tasks, [&record](VkCommandBuffer cmd, uint32_t task) {
+            record(cmd, task);
+        }, &inheritance);
+    }
+
+    auto Context::render(uint32_t tasks, const record_function& record) -> void
+    {
+        Impl& state = *impl();
+        if (!state.offscreen) {
+            throw std::runtime_error("render() needs a Context created with a headless extent");
+        }
+        if (state.frame == VK_NULL_HANDLE) {
+            throw std::runtime_error("render() outside of begin_frame() and end_frame()");
+        }
+
+        const vulkan::OffscreenTargets::Config& targets = state.offscreen->config();
+        const VkFormat                          color   = targets.color_format;
+        const uint32_t                          frame   = state.recorder.frame_index();
+
+        const vulkan::RenderingInheritance inheritance = {
+            .color_formats = std::span(&color, 1),
+            .depth_format  = targets.depth_format
+        };
+
+        state.offscreen->begin(state.frame, frame, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+        state.recorder.record_parallel(tasks, [&record](VkCommandBuffer cmd, uint32_t task) {
+            record(cmd, task);
+        }, &inheritance);
+        state.offscreen->end(state.frame, frame);
+    }
+
+    auto Context::read_back(readback_function done) -> void
+    {
+        Impl& state = *impl();
+        if (!state.offscreen) {
+            throw std::runtime_error("read_back() needs a Context created with a headless extent");
+        }
+        if (!state.readback) {
+            throw std::runtime_error("read_back() doesn't support the headless color format");
+        }
+        if (state.frame == VK_NULL_HANDLE) {
+            throw std::runtime_error("read_back() outside of begin_frame() and end_frame()");
+        }
+
+        const vulkan::OffscreenTargets::Config& targets = state.offscreen->config();
+        const uint64_t                          frame   = state.recorder.stats().frames;
+        const VkImage                           image   = state.offscreen->target(state.recorder.frame_index()).color.image;
+
+        state.readback->copy_image(state.frame, image, state.offscreen->extent(), targets.color_format,
+            [done = std::move(done), frame](const vulkan::ReadbackFrame& finished) {
+                done(finished.pixels, frame);
+            });
+    }
+
+    auto Context::begin_pass(std::string_view name) -> uint32_t
+    {
+        Impl& state = *impl();
+        if (!state.queries) {
+            return vulkan::QueryManager::NO_PASS;
+        }
+        if (state.frame == VK_NULL_HANDLE) {
+            throw std::runtime_error("begin_pass() outside of begin_frame() and end_frame()");
+        }
+        return state.queries->begin_pass(state.frame, name);
+    }
+
+    auto Context::end_pass(uint32_t pass) -> void
+    {
+        Impl& state = *impl();
+        if (state.queries && state.frame != VK_NULL_HANDLE) {
+            state.queries->end_pass(state.frame, pass);
+        }
+    }
+
+    auto Context::end_frame() -> void
+    {
+        VULKRON_PROFILE_FRAME("Context::end_frame");
+
+        Impl& state = *impl();
+        const uint64_t value = state.recorder.end_frame();
+        state.frame = VK_NULL_HANDLE;
+
+        if (state.queries) {
+            state.queries->end_frame(value);
+        }
+
+        if (state.readback) {
+            state.readback->submit(value);
+            state.readback->poll();
+        }
+    }
+
+    auto Context::wait_idle() -> void
+    {
+        impl()->recorder.wait_idle();
+        if (impl()->readback) {
+            impl()->readback->poll();
+        }
+        if (impl()->queries) {
+            impl()->queries->resolve();
+        }
+    }
+
+    auto Context::resize(uint32_t width, uint32_t height) -> void
+    {
+        Impl& state = *impl();
+        if (!state.offscreen) {
+            throw std::runtime_error("resize() needs a Context created with a headless extent");
+        }
+        if (state.frame != VK_NULL_HANDLE) {
+            throw std::runtime_error("resize() between begin_frame() and end_frame()");
+        }
+
+        // Frames in flight keep rendering into the old targets, they go once the last of them retires
+        state.offscreen->resize(width, height, state.retired, state.recorder.submitted_value());
+    }
+
+    auto Context::headless() const noexcept -> bool
+    {
+        return impl()->offscreen != nullptr;
+    }
+
+    auto Context::frame_image() const -> native_image
+    {
+        const Impl& state = *impl();
+        if (!state.offscreen) {
+            throw std::runtime_error("frame_image() needs a Context created with a headless extent");
+        }
+        return state.offscreen->target(state.recorder.frame_index()).color.image;
+    }
+
+    auto Context::stats() const noexcept -> Stats
+    {
+        const vulkan::CommandRecorder::Stats stats = impl()->recorder.stats();
+        Stats result = {
+            .frames            = stats.frames,
+            .secondaries       = stats.secondaries,
+            .frame_waits       = stats.frame_waits,
+            .threads           = stats.lanes,
+            .last_record_ms    = stats.last_record_ms,
+            .mean_record_ms    = stats.mean_record_ms,
+            .frames_per_second = stats.frames_per_second
+        };
+
+        if (impl()->readback) {
+            const vulkan::ReadbackRing::Stats readback = impl()->readback->stats();
+            result.readbacks                 = readback.frames;
+            result.readback_stalls           = readback.stalls;
+            result.readback_latency_ms       = readback.mean_latency_ms;
+            result.readback_bytes_per_second = readback.bytes_per_second;
+        }
+        return result;
+    }
+
+    auto Context::pass_timings() const noexcept -> std::span<const PassTiming>
+    {
+        if (!impl()->queries) {
+            return {};
+        }
+        return impl()->queries->table();
+    }
+
+    auto Context::write_pass_timings(const std::filesystem::path& path) const -> bool
+    {
+        return impl()->queries && impl()->queries->write_table(path);
+    }
+
+} // namespace vulkron::gpu
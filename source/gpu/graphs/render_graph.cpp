@@ -0,0 +1,1151 @@
+#include "render_graph.hpp"
+#include "deletion_queue.hpp"
+#include "device.hpp"
+#include "query_manager.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+
+namespace vulkron::gpu::graphs {
+
+    namespace {
+
+        constexpr VkAccessFlags2 WRITE_ACCESS_MASK =
+            VK_ACCESS_2_SHADER_WRITE_BIT |
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_TRANSFER_WRITE_BIT |
+            VK_ACCESS_2_HOST_WRITE_BIT |
+            VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+        constexpr VkAccessFlags2 READ_ACCESS_MASK =
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT |
+            VK_ACCESS_2_INDEX_READ_BIT |
+            VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT |
+            VK_ACCESS_2_UNIFORM_READ_BIT |
+            VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT |
+            VK_ACCESS_2_SHADER_READ_BIT |
+            VK_ACCESS_2_SHADER_SAMPLED_READ_BIT |
+            VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+            VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+            VK_ACCESS_2_TRANSFER_READ_BIT |
+            VK_ACCESS_2_HOST_READ_BIT |
+            VK_ACCESS_2_MEMORY_READ_BIT;
+
+        constexpr VkPipelineStageFlags2 DEPTH_TEST_STAGES =
+            VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+        // Scopes already made visible since the last write. Kept as a handful of
+        // (stage, access) pairs rather than two unions so a pair that was never
+        // synchronized together is not mistaken for a visible one. Overflow just
+        // costs a redundant barrier.
+        struct VisibleScopes {
+            std::array<SyncScope, 4> scopes{};
+            uint32_t                 count = 0;
+
+            [[nodiscard]] auto covers(const SyncScope& scope) const noexcept -> bool {
+                for (uint32_t i = 0; i < count; ++i) {
+                    if ((scope.stages & ~scopes[i].stages) == 0 && (scope.access & ~scopes[i].access) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            auto add(const SyncScope& scope) noexcept -> void {
+                if (count < scopes.size()) {
+                    scopes[count++] = scope;
+                }
+            }
+        };
+
+        struct ResourceState {
+            VkPipelineStageFlags2 write_stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2        write_access = VK_ACCESS_2_NONE;
+            VkPipelineStageFlags2 read_stages  = VK_PIPELINE_STAGE_2_NONE; // readers since the last write
+            VkImageLayout         layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+            VisibleScopes         visible;
+        };
+
+        struct Barrier {
+            VkPipelineStageFlags2 src_stages;
+            VkAccessFlags2        src_access;
+            VkPipelineStageFlags2 dst_stages;
+            VkAccessFlags2        dst_access;
+            VkImageLayout         old_layout;
+            VkImageLayout         new_layout;
+        };
+
+        // Advances the resource state past `scope` and returns the barrier that
+        // has to precede it, if any.
+        auto transition(ResourceState& state, const SyncScope& scope, bool is_image) -> std::optional<Barrier> {
+            const bool layout_change = is_image && scope.layout != state.layout;
+            std::optional<Barrier> barrier;
+
+            if (scope.write || layout_change) {
+                // Write-after-write / write-after-read, or a layout transition which
+                // behaves like a write. Reads only need an execution dependency.
+                const VkPipelineStageFlags2 src_stages = state.write_stages | state.read_stages;
+
+                if (layout_change || src_stages != VK_PIPELINE_STAGE_2_NONE) {
+                    barrier = Barrier{
+                        .src_stages = src_stages,
+                        .src_access = state.write_access,
+                        .dst_stages = scope.stages,
+                        .dst_access = scope.access,
+                        .old_layout = state.layout,
+                        .new_layout = scope.layout
+                    };
+                }
+
+                state.write_stages = scope.stages;
+                state.visible      = {};
+
+                if (scope.write) {
+                    state.write_access = scope.access & WRITE_ACCESS_MASK;
+                    state.read_stages  = VK_PIPELINE_STAGE_2_NONE;
+                }
+                else {
+                    // Transition only: the barrier already made it visible to this scope
+                    state.write_access = VK_ACCESS_2_NONE;
+                    state.read_stages  = scope.stages;
+                    state.visible.add(scope);
+                }
+
+                state.layout = scope.layout;
+                return barrier;
+            }
+
+            // Read-after-write in the same layout
+            if (state.write_stages != VK_PIPELINE_STAGE_2_NONE && !state.visible.covers(scope)) {
+                barrier = Barrier{
+                    .src_stages = state.write_stages,
+                    .src_access = state.write_access,
+                    .dst_stages = scope.stages,
+                    .dst_access = scope.access,
+                    .old_layout = state.layout,
+                    .new_layout = state.layout
+                };
+                state.visible.add(scope);
+            }
+
+            state.read_stages |= scope.stages;
+            return barrier;
+        }
+
+        auto image_usage_flags(ResourceUsage usage) noexcept -> VkImageUsageFlags {
+            switch (usage) {
+                case ResourceUsage::ColorAttachmentWrite:
+                case ResourceUsage::ColorAttachmentReadWrite:
+                    return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                case ResourceUsage::DepthStencilWrite:
+                case ResourceUsage::DepthStencilRead:
+                    return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                case ResourceUsage::VertexShaderSampled:
+                case ResourceUsage::FragmentShaderSampled:
+                case ResourceUsage::ComputeShaderSampled:
+                    return VK_IMAGE_USAGE_SAMPLED_BIT;
+                case ResourceUsage::FragmentStorageRead:
+                case ResourceUsage::ComputeStorageRead:
+                case ResourceUsage::ComputeStorageWrite:
+                case ResourceUsage::ComputeStorageReadWrite:
+                    return VK_IMAGE_USAGE_STORAGE_BIT;
+                case ResourceUsage::TransferSrc:
+                    return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+                case ResourceUsage::TransferDst:
+                    return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+                default:
+                    return 0;
+            }
+        }
+
+        auto buffer_usage_flags(ResourceUsage usage) noexcept -> VkBufferUsageFlags {
+            switch (usage) {
+                case ResourceUsage::GraphicsUniformBuffer:
+                case ResourceUsage::ComputeUniformBuffer:
+                    return VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+                case ResourceUsage::FragmentStorageRead:
+                case ResourceUsage::ComputeStorageRead:
+                case ResourceUsage::ComputeStorageWrite:
+                case ResourceUsage::ComputeStorageReadWrite:
+                    return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+                case ResourceUsage::VertexBuffer:
+                    return VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+                case ResourceUsage::IndexBuffer:
+                    return VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+                case ResourceUsage::IndirectBuffer:
+                    return VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+                case ResourceUsage::TransferSrc:
+                    return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+                case ResourceUsage::TransferDst:
+                    return VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+                default:
+                    return 0;
+            }
+        }
+
+        constexpr auto align_up(VkDeviceSize value, VkDeviceSize alignment) noexcept -> VkDeviceSize {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+    } // namespace
+
+    auto sync_scope(ResourceUsage usage) noexcept -> SyncScope {
+        switch (usage) {
+            case ResourceUsage::ColorAttachmentWrite:
+                return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+            case ResourceUsage::ColorAttachmentReadWrite:
+                return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+            case ResourceUsage::DepthStencilWrite:
+                return {DEPTH_TEST_STAGES,
+                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true};
+            case ResourceUsage::DepthStencilRead:
+                return {DEPTH_TEST_STAGES,
+                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false};
+
+            case ResourceUsage::VertexShaderSampled:
+                return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+            case ResourceUsage::FragmentShaderSampled:
+                return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+            case ResourceUsage::ComputeShaderSampled:
+                return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+
+            case ResourceUsage::FragmentStorageRead:
+                return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                        VK_IMAGE_LAYOUT_GENERAL, false};
+            case ResourceUsage::ComputeStorageRead:
+                return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                        VK_IMAGE_LAYOUT_GENERAL, false};
+            case ResourceUsage::ComputeStorageWrite:
+                return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_GENERAL, true};
+            case ResourceUsage::ComputeStorageReadWrite:
+                return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_GENERAL, true};
+
+            case ResourceUsage::GraphicsUniformBuffer:
+                return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                        VK_ACCESS_2_UNIFORM_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, false};
+            case ResourceUsage::ComputeUniformBuffer:
+                return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_2_UNIFORM_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, false};
+            case ResourceUsage::VertexBuffer:
+                return {VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+                        VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, false};
+            case ResourceUsage::IndexBuffer:
+                return {VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
+                        VK_ACCESS_2_INDEX_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, false};
+            case ResourceUsage::IndirectBuffer:
+                return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                        VK_IMAGE_LAYOUT_UNDEFINED, false};
+
+            case ResourceUsage::TransferSrc:
+                return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                        VK_ACCESS_2_TRANSFER_READ_BIT,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false};
+            case ResourceUsage::TransferDst:
+                return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                        VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+
+            case ResourceUsage::Present:
+                // Presentation engine synchronizes through the semaphore, not the barrier
+                return {VK_PIPELINE_STAGE_2_NONE,
+                        VK_ACCESS_2_NONE,
+                        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false};
+        }
+
+        return {};
+    }
+
+    RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, uint32_t pass) noexcept
+        : _graph(graph),
+        _pass(pass)
+    {}
+
+    auto RenderGraph::PassBuilder::read(ResourceHandle resource, ResourceUsage usage) -> PassBuilder& {
+        _graph.add_access(_pass, resource, usage, false);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::write(ResourceHandle resource, ResourceUsage usage) -> PassBuilder& {
+        _graph.add_access(_pass, resource, usage, true);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::keep() -> PassBuilder& {
+        _graph._passes[_pass].keep = true;
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::pipeline(const vulkan::PipelineHandle& pipeline) -> PassBuilder& {
+        _graph._passes[_pass].pipelines.push_back(pipeline);
+        return *this;
+    }
+
+    RenderGraph::~RenderGraph() {
+        release_transients();
+    }
+
+    auto RenderGraph::import_image(std::string_view name, const ImageImport& image) -> ResourceHandle {
+        if (image.image == VK_NULL_HANDLE) {
+            throw std::runtime_error("Cannot import a null image into the render graph");
+        }
+
+        _resources.push_back(Resource{
+            .name   = std::string(name),
+            .kind   = ResourceKind::Image,
+            .image  = image,
+            .buffer = {}
+        });
+
+        _compiled = false;
+        return ResourceHandle{static_cast<uint32_t>(_resources.size() - 1)};
+    }
+
+    auto RenderGraph::import_buffer(std::string_view name, const BufferImport& buffer) -> ResourceHandle {
+        if (buffer.buffer == VK_NULL_HANDLE) {
+            throw std::runtime_error("Cannot import a null buffer into the render graph");
+        }
+
+        _resources.push_back(Resource{
+            .name   = std::string(name),
+            .kind   = ResourceKind::Buffer,
+            .image  = {},
+            .buffer = buffer
+        });
+
+        _compiled = false;
+        return ResourceHandle{static_cast<uint32_t>(_resources.size() - 1)};
+    }
+
+    auto RenderGraph::create_image(std::string_view name, const ImageDesc& desc) -> ResourceHandle {
+        if (desc.extent.width == 0 || desc.extent.height == 0 || desc.extent.depth == 0) {
+            throw std::runtime_error("Render graph transient image needs a non-zero extent");
+        }
+
+        _resources.push_back(Resource{
+            .name        = std::string(name),
+            .kind        = ResourceKind::Image,
+            .image       = ImageImport{
+                .image = VK_NULL_HANDLE,
+                .range = {desc.aspect, 0, desc.mip_levels, 0, desc.array_layers}
+            },
+            .buffer      = {},
+            .transient   = true,
+            .image_desc  = desc,
+            .buffer_desc = {},
+            .usage_flags = desc.extra_usage,
+            .lifetime    = {},
+            .placement   = {}
+        });
+
+        _compiled = false;
+        return ResourceHandle{static_cast<uint32_t>(_resources.size() - 1)};
+    }
+
+    auto RenderGraph::create_buffer(std::string_view name, const BufferDesc& desc) -> ResourceHandle {
+        if (desc.size == 0) {
+            throw std::runtime_error("Render graph transient buffer needs a non-zero size");
+        }
+
+        _resources.push_back(Resource{
+            .name        = std::string(name),
+            .kind        = ResourceKind::Buffer,
+            .image       = {},
+            .buffer      = BufferImport{
+                .buffer = VK_NULL_HANDLE,
+                .offset = 0,
+                .size   = desc.size
+            },
+            .transient   = true,
+            .image_desc  = {},
+            .buffer_desc = desc,
+            .usage_flags = desc.extra_usage,
+            .lifetime    = {},
+            .placement   = {}
+        });
+
+        _compiled = false;
+        return ResourceHandle{static_cast<uint32_t>(_resources.size() - 1)};
+    }
+
+    auto RenderGraph::add_pass(std::string_view name, RecordCallback record) -> PassBuilder {
+        _passes.push_back(Pass{
+            .name     = std::string(name),
+            .record   = std::move(record),
+            .accesses = {}
+        });
+
+        _compiled = false;
+        return PassBuilder(*this, static_cast<uint32_t>(_passes.size() - 1));
+    }
+
+    auto RenderGraph::add_access(uint32_t pass, ResourceHandle resource, ResourceUsage usage, bool write) -> void {
+        if (!resource.valid() || resource.index >= _resources.size()) {
+            throw std::runtime_error("Render graph pass references an unknown resource");
+        }
+
+        const SyncScope scope = sync_scope(usage);
+        if (scope.write != write) {
+            throw std::runtime_error(write ? "Resource usage is read-only and cannot be declared as a write"
+                                           : "Resource usage writes and must be declared with write()");
+        }
+
+        Resource&  target   = _resources[resource.index];
+        const bool is_image = target.kind == ResourceKind::Image;
+        std::vector<Access>& accesses = _passes[pass].accesses;
+
+        target.usage_flags |= is_image ? image_usage_flags(usage) : buffer_usage_flags(usage);
+
+        // Several usages of one resource inside a pass collapse into a single access
+        for (Access& access : accesses) {
+            if (access.resource != resource.index) {
+                continue;
+            }
+
+            if (is_image && access.scope.layout != scope.layout) {
+                throw std::runtime_error("Render graph pass uses one image in two different layouts");
+            }
+
+            access.scope.stages |= scope.stages;
+            access.scope.access |= scope.access;
+            access.scope.write  |= scope.write;
+            _compiled = false;
+            return;
+        }
+
+        accesses.push_back(Access{resource.index, scope});
+        _compiled = false;
+    }
+
+    auto RenderGraph::set_aliasing(bool enabled) noexcept -> void {
+        _aliasing = enabled;
+        _compiled = false;
+    }
+
+    auto RenderGraph::compile() -> void {
+        compile_impl(nullptr, nullptr, 0);
+    }
+
+    auto RenderGraph::compile(const vulkan::Device& device) -> void {
+        compile_impl(&device, nullptr, 0);
+    }
+
+    auto RenderGraph::compile(const vulkan::Device& device, vulkan::DeletionQueue& retired, uint64_t value) -> void {
+        compile_impl(&device, &retired, value);
+    }
+
+    auto RenderGraph::cull_passes() -> uint32_t {
+        const uint32_t pass_count = static_cast<uint32_t>(_passes.size());
+
+        // Walk backwards tracking whether the current contents of each resource
+        // are observed later. Imported contents outlive the graph, transient ones
+        // only matter if a live pass reads them.
+        std::pmr::vector<bool> needed(_resources.size(), false, &_scratch);
+        for (size_t i = 0; i < _resources.size(); ++i) {
+            needed[i] = !_resources[i].transient;
+        }
+
+        _alive.assign(pass_count, false);
+        uint32_t culled = 0;
+
+        for (uint32_t pass = pass_count; pass-- > 0;) {
+            const Pass& current = _passes[pass];
+
+            bool alive = current.keep;
+            for (const Access& access : current.accesses) {
+                alive = alive || (access.scope.write && needed[access.resource]);
+            }
+
+            if (!alive) {
+                ++culled;
+                continue;
+            }
+
+            _alive[pass] = true;
+            for (const Access& access : current.accesses) {
+                // A pure write replaces the contents, anything that reads keeps the producer alive
+                needed[access.resource] = (access.scope.access & READ_ACCESS_MASK) != 0 ||
+                    (!access.scope.write && needed[access.resource]);
+            }
+        }
+
+        return culled;
+    }
+
+    auto RenderGraph::compute_lifetimes() -> void {
+        for (Resource& resource : _resources) {
+            resource.lifetime = {};
+        }
+
+        for (uint32_t step = 0; step < _steps.size(); ++step) {
+            const Step& current = _steps[step];
+
+            for (uint32_t i = current.first_pass; i < current.first_pass + current.pass_count; ++i) {
+                for (const Access& access : _passes[_order[i]].accesses) {
+                    Lifetime& lifetime = _resources[access.resource].lifetime;
+
+                    if (lifetime.first_step == UINT32_MAX) {
+                        lifetime.first_step = step;
+                    }
+
+                    if (lifetime.last_step != step) {
+                        lifetime.last_step   = step;
+                        lifetime.last_stages = VK_PIPELINE_STAGE_2_NONE;
+                        lifetime.last_access = VK_ACCESS_2_NONE;
+                    }
+
+                    lifetime.last_stages |= access.scope.stages;
+                    lifetime.last_access |= access.scope.access;
+                }
+            }
+        }
+    }
+
+    auto RenderGraph::place_transients(const vulkan::Device& device) -> void {
+        const vulkan::DispatchTable& api       = device.dispatch();
+        const VkDevice               vk_device = device.device_handle();
+        const vulkan::Adapter*       adapter   = device.instance()->adapter(device.physical_device_handle());
+        if (adapter == nullptr) {
+            throw std::runtime_error("Render graph transients need a device with a selected GPU");
+        }
+        const VkPhysicalDeviceLimits& limits = adapter->properties.head()->properties.limits;
+
+        // Padding every range to the granularity lets images and buffers share memory
+        const VkDeviceSize granularity = std::max<VkDeviceSize>(limits.bufferImageGranularity, 1);
+
+        _api       = &api;
+        _device    = vk_device;
+        _allocator = &device.allocator();
+
+        struct Item {
+            uint32_t     resource;
+            uint32_t     memory_type;
+            VkDeviceSize size;
+            VkDeviceSize alignment;
+        };
+
+        std::pmr::vector<Item> items(&_scratch);
+
+        for (uint32_t i = 0; i < _resources.size(); ++i) {
+            Resource& resource = _resources[i];
+            if (!resource.transient || resource.lifetime.first_step == UINT32_MAX) {
+                continue;
+            }
+
+            VkMemoryRequirements requirements;
+
+            if (resource.kind == ResourceKind::Image) {
+                const ImageDesc& desc = resource.image_desc;
+
+                VkImageCreateInfo create_info = {
+                    .sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                    .pNext                 = nullptr,
+                    .flags                 = 0,
+                    .imageType             = desc.type,
+                    .format                = desc.format,
+                    .extent                = desc.extent,
+                    .mipLevels             = desc.mip_levels,
+                    .arrayLayers           = desc.array_layers,
+                    .samples               = VK_SAMPLE_COUNT_1_BIT,
+                    .tiling                = VK_IMAGE_TILING_OPTIMAL,
+                    .usage                 = resource.usage_flags,
+                    .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+                    .queueFamilyIndexCount = 0,
+                    .pQueueFamilyIndices   = nullptr,
+                    .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+                };
+
+                if (api.vkCreateImage(vk_device, &create_info, nullptr, &resource.image.image) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create render graph transient image");
+                }
+
+                api.vkGetImageMemoryRequirements(vk_device, resource.image.image, &requirements);
+            }
+            else {
+                VkBufferCreateInfo create_info = {
+                    .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                    .pNext                 = nullptr,
+                    .flags                 = 0,
+                    .size                  = resource.buffer_desc.size,
+                    .usage                 = resource.usage_flags,
+                    .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+                    .queueFamilyIndexCount = 0,
+                    .pQueueFamilyIndices   = nullptr
+                };
+
+                if (api.vkCreateBuffer(vk_device, &create_info, nullptr, &resource.buffer.buffer) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create render graph transient buffer");
+                }
+
+                api.vkGetBufferMemoryRequirements(vk_device, resource.buffer.buffer, &requirements);
+            }
+
+            items.push_back(Item{
+                .resource    = i,
+                .memory_type = _allocator->find_memory_type(requirements.memoryTypeBits, vulkan::MemoryUsage::GpuOnly),
+                .size        = align_up(requirements.size, granularity),
+                .alignment   = std::max(requirements.alignment, granularity)
+            });
+        }
+
+        // Largest first keeps the greedy placement close to the peak live size,
+        // ties go in order of first use so chains of equal targets reuse ranges
+        std::stable_sort(items.begin(), items.end(), [&](const Item& a, const Item& b) {
+            if (a.size != b.size) {
+                return a.size > b.size;
+            }
+            return _resources[a.resource].lifetime.first_step < _resources[b.resource].lifetime.first_step;
+        });
+
+        std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> type_size{};
+        std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> type_alignment{};
+        std::pmr::vector<const Item*> placed(&_scratch);
+        std::pmr::vector<const Item*> overlapping(&_scratch);
+        VkDeviceSize                  unaliased = 0;
+
+        for (const Item& item : items) {
+            Resource&       resource = _resources[item.resource];
+            const Lifetime& lifetime = resource.lifetime;
+            VkDeviceSize    offset   = 0;
+
+            if (_aliasing) {
+                overlapping.clear();
+                for (const Item* other : placed) {
+                    const Lifetime& other_lifetime = _resources[other->resource].lifetime;
+                    if (other->memory_type == item.memory_type &&
+                        other_lifetime.first_step <= lifetime.last_step &&
+                        lifetime.first_step <= other_lifetime.last_step) {
+                        overlapping.push_back(other);
+                    }
+                }
+
+                std::sort(overlapping.begin(), overlapping.end(), [&](const Item* a, const Item* b) {
+                    return _resources[a->resource].placement.offset < _resources[b->resource].placement.offset;
+                });
+
+                // First gap between live ranges that is large enough
+                for (const Item* other : overlapping) {
+                    const Placement& other_placement = _resources[other->resource].placement;
+                    if (offset + item.size <= other_placement.offset) {
+                        break;
+                    }
+                    offset = std::max(offset, align_up(other_placement.offset + other_placement.size, item.alignment));
+                }
+            }
+            else {
+                offset = align_up(type_size[item.memory_type], item.alignment);
+            }
+
+            resource.placement = Placement{
+                .memory = item.memory_type, // remapped to a _transient_memory index below
+                .offset = offset,
+                .size   = item.size
+            };
+
+            type_size[item.memory_type]      = std::max(type_size[item.memory_type], offset + item.size);
+            type_alignment[item.memory_type] = std::max(type_alignment[item.memory_type], item.alignment);
+            unaliased += item.size;
+            placed.push_back(&item);
+        }
+
+        std::array<uint32_t, VK_MAX_MEMORY_TYPES> type_memory;
+        type_memory.fill(UINT32_MAX);
+
+        VkDeviceSize transient_bytes = 0;
+        for (uint32_t type = 0; type < VK_MAX_MEMORY_TYPES; ++type) {
+            if (type_size[type] == 0) {
+                continue;
+            }
+
+            // One range per memory type, aligned for the strictest resource placed in it
+            const VkMemoryRequirements requirements = {
+                .size           = type_size[type],
+                .alignment      = type_alignment[type],
+                .memoryTypeBits = 1u << type
+            };
+
+            type_memory[type] = static_cast<uint32_t>(_transient_memory.size());
+            _transient_memory.push_back(
+                _allocator->allocate(requirements, vulkan::MemoryUsage::GpuOnly, vulkan::ResourceTiling::Optimal));
+            transient_bytes += type_size[type];
+        }
+
+        for (const Item& item : items) {
+            Resource& resource = _resources[item.resource];
+            resource.placement.memory = type_memory[item.memory_type];
+
+            const vulkan::Allocation& memory = _transient_memory[resource.placement.memory];
+            const VkDeviceSize        offset = memory.offset + resource.placement.offset;
+
+            const VkResult result = resource.kind == ResourceKind::Image
+                ? api.vkBindImageMemory(vk_device, resource.image.image, memory.memory, offset)
+                : api.vkBindBufferMemory(vk_device, resource.buffer.buffer, memory.memory, offset);
+
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error("Failed to bind render graph transient memory");
+            }
+        }
+
+        _stats.transient_resources = static_cast<uint32_t>(items.size());
+        _stats.transient_bytes     = transient_bytes;
+        _stats.unaliased_bytes     = unaliased;
+    }
+
+    auto RenderGraph::release_transients(vulkan::DeletionQueue* retired, uint64_t value) -> void {
+        if (_device == VK_NULL_HANDLE) {
+            return;
+        }
+
+        for (Resource& resource : _resources) {
+            if (!resource.transient) {
+                continue;
+            }
+
+            if (resource.image.image != VK_NULL_HANDLE) {
+                if (retired != nullptr) {
+                    retired->retire(resource.image.image, value);
+                }
+                else {
+                    _api->vkDestroyImage(_device, resource.image.image, nullptr);
+                }
+                resource.image.image = VK_NULL_HANDLE;
+            }
+
+            if (resource.buffer.buffer != VK_NULL_HANDLE) {
+                if (retired != nullptr) {
+                    retired->retire(resource.buffer.buffer, value);
+                }
+                else {
+                    _api->vkDestroyBuffer(_device, resource.buffer.buffer, nullptr);
+                }
+                resource.buffer.buffer = VK_NULL_HANDLE;
+            }
+
+            resource.placement = {};
+        }
+
+        // Retired after the images and buffers bound to it, a batch destroys in retire order
+        for (vulkan::Allocation& memory : _transient_memory) {
+            if (retired != nullptr) {
+                retired->retire(memory, value);
+            }
+            else {
+                _allocator->free(memory);
+            }
+        }
+
+        _transient_memory.clear();
+        _api       = nullptr;
+        _device    = VK_NULL_HANDLE;
+        _allocator = nullptr;
+    }
+
+    auto RenderGraph::compile_impl(const vulkan::Device* device, vulkan::DeletionQueue* retired, uint64_t value) -> void {
+        const uint32_t pass_count     = static_cast<uint32_t>(_passes.size());
+        const uint32_t resource_count = static_cast<uint32_t>(_resources.size());
+
+        release_transients(retired, value);
+
+        _order.clear();
+        _steps.clear();
+        _batches.clear();
+        _image_barriers.clear();
+        _buffer_barriers.clear();
+        _final_batch = UINT32_MAX;
+        _stats       = {};
+        _scratch.reset();
+
+        // 1. Drop passes nobody observes
+        const uint32_t culled = cull_passes();
+
+        // 2. Dependency levels. Declaration order is a valid topological order, so a
+        //    single forward sweep assigns each pass one level past its latest producer.
+        struct Hazards {
+            using allocator_type = std::pmr::polymorphic_allocator<>;
+
+            uint32_t                   last_writer = UINT32_MAX;
+            std::pmr::vector<uint32_t> readers; // since last_writer
+            VkImageLayout              reader_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            explicit Hazards(const allocator_type& allocator)
+                : readers(allocator)
+            {
+            }
+        };
+
+        std::pmr::vector<Hazards>  hazards(resource_count, &_scratch);
+        std::pmr::vector<uint32_t> levels(pass_count, 0, &_scratch);
+        uint32_t                   level_count = 0;
+
+        for (uint32_t pass = 0; pass < pass_count; ++pass) {
+            if (!_alive[pass]) {
+                continue;
+            }
+
+            uint32_t level = 0;
+            auto depend_on = [&](uint32_t producer) {
+                if (producer != UINT32_MAX && producer != pass) {
+                    level = std::max(level, levels[producer] + 1);
+                }
+            };
+
+            for (const Access& access : _passes[pass].accesses) {
+                Hazards&   hazard   = hazards[access.resource];
+                const bool is_image = _resources[access.resource].kind == ResourceKind::Image;
+
+                depend_on(hazard.last_writer);
+
+                // Readers in another layout must finish before the transition
+                const bool layout_change = is_image && !hazard.readers.empty() && hazard.reader_layout != access.scope.layout;
+                if (access.scope.write || layout_change) {
+                    for (uint32_t reader : hazard.readers) {
+                        depend_on(reader);
+                    }
+                    hazard.readers.clear();
+                }
+            }
+
+            for (const Access& access : _passes[pass].accesses) {
+                Hazards& hazard = hazards[access.resource];
+                if (access.scope.write) {
+                    hazard.last_writer = pass;
+                }
+                else {
+                    hazard.readers.push_back(pass);
+                }
+                hazard.reader_layout = access.scope.layout;
+            }
+
+            levels[pass] = level;
+            level_count  = std::max(level_count, level + 1);
+            _order.push_back(pass);
+        }
+
+        // Ties broken on the pass index keep declaration order without stable_sort's temporary buffer
+        std::sort(_order.begin(), _order.end(), [&](uint32_t a, uint32_t b) {
+            return levels[a] != levels[b] ? levels[a] < levels[b] : a < b;
+        });
+
+        const uint32_t alive_count = static_cast<uint32_t>(_order.size());
+        for (uint32_t first = 0; first < alive_count;) {
+            const uint32_t level = levels[_order[first]];
+            uint32_t       last  = first;
+            while (last < alive_count && levels[_order[last]] == level) {
+                ++last;
+            }
+
+            _steps.push_back(Step{
+                .batch      = UINT32_MAX,
+                .first_pass = first,
+                .pass_count = last - first
+            });
+
+            first = last;
+        }
+
+        // 3. Lifetimes and memory for the transients that survived culling
+        compute_lifetimes();
+
+        bool has_transients = false;
+        for (const Resource& resource : _resources) {
+            has_transients = has_transients || (resource.transient && resource.lifetime.first_step != UINT32_MAX);
+        }
+
+        if (has_transients) {
+            if (device == nullptr) {
+                throw std::runtime_error("Render graph with transient resources must be compiled against a device");
+            }
+            place_transients(*device);
+        }
+
+        // 4. Replay the schedule level by level against tracked resource state and
+        //    merge every barrier a level needs into one batch.
+        std::pmr::vector<ResourceState> states(resource_count, &_scratch);
+        for (uint32_t i = 0; i < resource_count; ++i) {
+            const Resource& resource = _resources[i];
+            ResourceState&  state    = states[i];
+
+            if (resource.transient) {
+                // Whoever used the range before must be done with it first: an alias earlier in
+                // this execution, or any user of it, the resource itself included, late in the
+                // previous one. Lifetimes sharing a range never overlap, so every final use counts.
+                for (const Resource& other : _resources) {
+                    if (!other.transient ||
+                        other.placement.memory == UINT32_MAX ||
+                        other.placement.memory != resource.placement.memory ||
+                        other.placement.offset >= resource.placement.offset + resource.placement.size ||
+                        resource.placement.offset >= other.placement.offset + other.placement.size) {
+                        continue;
+                    }
+
+                    state.write_stages |= other.lifetime.last_stages;
+                    state.write_access |= other.lifetime.last_access & WRITE_ACCESS_MASK;
+                }
+            }
+            else if (resource.kind == ResourceKind::Image) {
+                state.write_stages = resource.image.initial_stages;
+                state.write_access = resource.image.initial_access;
+                state.layout       = resource.image.initial_layout;
+            }
+            else {
+                state.write_stages = resource.buffer.initial_stages;
+                state.write_access = resource.buffer.initial_access;
+            }
+        }
+
+        std::pmr::vector<uint32_t> merged_slot(resource_count, UINT32_MAX, &_scratch);
+        std::pmr::vector<Access>   merged(&_scratch);
+
+        auto flush_batch = [&](std::span<const Access> level_accesses) -> uint32_t {
+            const BarrierBatch batch{
+                .first_image  = static_cast<uint32_t>(_image_barriers.size()),
+                .image_count  = 0,
+                .first_buffer = static_cast<uint32_t>(_buffer_barriers.size()),
+                .buffer_count = 0
+            };
+
+            for (const Access& access : level_accesses) {
+                const Resource& resource = _resources[access.resource];
+                const bool      is_image = resource.kind == ResourceKind::Image;
+
+                const std::optional<Barrier> barrier = transition(states[access.resource], access.scope, is_image);
+                if (!barrier) {
+                    continue;
+                }
+
+                if (is_image) {
+                    _image_barriers.push_back(VkImageMemoryBarrier2{
+                        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                        .pNext               = nullptr,
+                        .srcStageMask        = barrier->src_stages,
+                        .srcAccessMask       = barrier->src_access,
+                        .dstStageMask        = barrier->dst_stages,
+                        .dstAccessMask       = barrier->dst_access,
+                        .oldLayout           = barrier->old_layout,
+                        .newLayout           = barrier->new_layout,
+                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .image               = resource.image.image,
+                        .subresourceRange    = resource.image.range
+                    });
+                }
+                else {
+                    _buffer_barriers.push_back(VkBufferMemoryBarrier2{
+                        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                        .pNext               = nullptr,
+                        .srcStageMask        = barrier->src_stages,
+                        .srcAccessMask       = barrier->src_access,
+                        .dstStageMask        = barrier->dst_stages,
+                        .dstAccessMask       = barrier->dst_access,
+                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .buffer              = resource.buffer.buffer,
+                        .offset              = resource.buffer.offset,
+                        .size                = resource.buffer.size
+                    });
+                }
+            }
+
+            const uint32_t image_count  = static_cast<uint32_t>(_image_barriers.size()) - batch.first_image;
+            const uint32_t buffer_count = static_cast<uint32_t>(_buffer_barriers.size()) - batch.first_buffer;
+            if (image_count == 0 && buffer_count == 0) {
+                return UINT32_MAX;
+            }
+
+            _batches.push_back(BarrierBatch{
+                .first_image  = batch.first_image,
+                .image_count  = image_count,
+                .first_buffer = batch.first_buffer,
+                .buffer_count = buffer_count
+            });
+            return static_cast<uint32_t>(_batches.size() - 1);
+        };
+
+        for (Step& step : _steps) {
+            // Passes within a level never conflict, so their accesses simply union
+            merged.clear();
+            for (uint32_t i = step.first_pass; i < step.first_pass + step.pass_count; ++i) {
+                for (const Access& access : _passes[_order[i]].accesses) {
+                    uint32_t& slot = merged_slot[access.resource];
+                    if (slot == UINT32_MAX) {
+                        slot = static_cast<uint32_t>(merged.size());
+                        merged.push_back(access);
+                        continue;
+                    }
+
+                    merged[slot].scope.stages |= access.scope.stages;
+                    merged[slot].scope.access |= access.scope.access;
+                    merged[slot].scope.write  |= access.scope.write;
+                }
+            }
+            for (const Access& access : merged) {
+                merged_slot[access.resource] = UINT32_MAX;
+            }
+
+            step.batch = flush_batch(merged);
+        }
+
+        // 5. Hand imported resources back in the state the caller asked for
+        merged.clear();
+        for (uint32_t i = 0; i < resource_count; ++i) {
+            const Resource& resource = _resources[i];
+            if (resource.transient) {
+                continue;
+            }
+
+            const std::optional<ResourceUsage>& final_usage =
+                resource.kind == ResourceKind::Image ? resource.image.final_usage : resource.buffer.final_usage;
+
+            if (final_usage) {
+                merged.push_back(Access{i, sync_scope(*final_usage)});
+            }
+        }
+        _final_batch = flush_batch(merged);
+
+        _stats.pass_count      = pass_count;
+        _stats.level_count     = level_count;
+        _stats.barrier_batches = static_cast<uint32_t>(_batches.size());
+        _stats.image_barriers  = static_cast<uint32_t>(_image_barriers.size());
+        _stats.buffer_barriers = static_cast<uint32_t>(_buffer_barriers.size());
+        _stats.culled_passes   = culled;
+        _compiled = true;
+    }
+
+    auto RenderGraph::execute(const vulkan::Device& device, VkCommandBuffer cmd, vulkan::QueryManager* queries) const -> void {
+        if (!_compiled) {
+            throw std::runtime_error("Render graph must be compiled before execution");
+        }
+
+        const vulkan::DispatchTable& api = device.dispatch();
+
+        for (const Step& step : _steps) {
+            if (step.batch != UINT32_MAX) {
+                emit_batch(api, cmd, step.batch);
+            }
+
+            for (uint32_t i = step.first_pass; i < step.first_pass + step.pass_count; ++i) {
+                const Pass& pass = _passes[_order[i]];
+                const bool  ready = std::ranges::all_of(pass.pipelines, [](const vulkan::PipelineHandle& pipeline) {
+                    return pipeline.usable();
+                });
+                if (!pass.record || !ready) {
+                    continue;
+                }
+
+                if (queries == nullptr) {
+                    pass.record(cmd);
+                    continue;
+                }
+
+                const uint32_t timed = queries->begin_pass(cmd, pass.name);
+                pass.record(cmd);
+                queries->end_pass(cmd, timed);
+            }
+        }
+
+        if (_final_batch != UINT32_MAX) {
+            emit_batch(api, cmd, _final_batch);
+        }
+    }
+
+    auto RenderGraph::emit_batch(const vulkan::DispatchTable& api, VkCommandBuffer cmd, uint32_t batch) const -> void {
+        const BarrierBatch& barriers = _batches[batch];
+
+        VkDependencyInfo dependency_info = {
+            .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext                    = nullptr,
+            .dependencyFlags          = 0,
+            .memoryBarrierCount       = 0,
+            .pMemoryBarriers          = nullptr,
+            .bufferMemoryBarrierCount = barriers.buffer_count,
+            .pBufferMemoryBarriers    = _buffer_barriers.data() + barriers.first_buffer,
+            .imageMemoryBarrierCount  = barriers.image_count,
+            .pImageMemoryBarriers     = _image_barriers.data() + barriers.first_image
+        };
+
+        api.vkCmdPipelineBarrier2(cmd, &dependency_info);
+    }
+
+    auto RenderGraph::clear() -> void {
+        release_transients();
+
+        _resources.clear();
+        _passes.clear();
+        _alive.clear();
+        _order.clear();
+        _steps.clear();
+        _batches.clear();
+        _image_barriers.clear();
+        _buffer_barriers.clear();
+        _final_batch = UINT32_MAX;
+        _stats       = {};
+        _compiled    = false;
+    }
+
+    auto RenderGraph::stats() const noexcept -> const CompileStats& {
+        return _stats;
+    }
+
+    auto RenderGraph::execution_order() const noexcept -> const std::vector<uint32_t>& {
+        return _order;
+    }
+
+    auto RenderGraph::pass_name(uint32_t pass) const -> std::string_view {
+        return _passes.at(pass).name;
+    }
+
+    auto RenderGraph::is_culled(uint32_t pass) const -> bool {
+        return !_alive.at(pass);
+    }
+
+    auto RenderGraph::image(ResourceHandle resource) const -> VkImage {
+        return _resources.at(resource.index).image.image;
+    }
+
+    auto RenderGraph::buffer(ResourceHandle resource) const -> VkBuffer {
+        return _resources.at(resource.index).buffer.buffer;
+    }
+
+    auto RenderGraph::memory_binding(ResourceHandle resource) const -> MemoryBinding {
+        const Placement& placement = _resources.at(resource.index).placement;
+        if (placement.memory >= _transient_memory.size()) {
+            throw std::runtime_error("Render graph resource has no transient memory");
+        }
+
+        const vulkan::Allocation& memory = _transient_memory[placement.memory];
+        return MemoryBinding{
+            .memory = memory.memory,
+            .offset = memory.offset + placement.offset,
+            .size   = placement.size
+        };
+    }
+
+} // namespace vulkron::gpu::graphs
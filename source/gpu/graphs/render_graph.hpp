@@ -0,0 +1,339 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "pipeline_compiler.hpp"
+#include "support/common/frame_arena.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+    class DeletionQueue;
+    class Device;
+    class QueryManager;
+} // namespace vulkron::gpu::vulkan
+
+namespace vulkron::gpu::graphs {
+
+    /**
+     * @brief How a pass touches a resource
+     *
+     * Every usage maps to the narrowest stage / access / layout triple that
+     * covers it, so barriers derived from it are never stronger than needed.
+     */
+    enum class ResourceUsage : uint8_t {
+        ColorAttachmentWrite,
+        ColorAttachmentReadWrite,
+        DepthStencilWrite,
+        DepthStencilRead,
+
+        VertexShaderSampled,
+        FragmentShaderSampled,
+        ComputeShaderSampled,
+
+        FragmentStorageRead,
+        ComputeStorageRead,
+        ComputeStorageWrite,
+        ComputeStorageReadWrite,
+
+        GraphicsUniformBuffer,
+        ComputeUniformBuffer,
+        VertexBuffer,
+        IndexBuffer,
+        IndirectBuffer,
+
+        TransferSrc,
+        TransferDst,
+
+        Present
+    };
+
+    /**
+     * @brief Synchronization scope of a single resource access
+     */
+    struct SyncScope {
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        access = VK_ACCESS_2_NONE;
+        VkImageLayout         layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool                  write  = false;
+    };
+
+    [[nodiscard]] auto sync_scope(ResourceUsage usage) noexcept -> SyncScope;
+
+    /**
+     * @brief Opaque reference to a resource declared on a RenderGraph
+     */
+    struct ResourceHandle {
+        uint32_t index = UINT32_MAX;
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool {
+            return index != UINT32_MAX;
+        }
+    };
+
+    /**
+     * @brief Externally owned image handed to the graph
+     *
+     * The initial scope describes the last access made before the graph runs,
+     * the optional final usage is the state the graph leaves the image in.
+     */
+    struct ImageImport {
+        VkImage                      image;
+        VkImageSubresourceRange      range;
+        VkImageLayout                initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2        initial_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2               initial_access = VK_ACCESS_2_NONE;
+        std::optional<ResourceUsage> final_usage;
+    };
+
+    /**
+     * @brief Externally owned buffer range handed to the graph
+     */
+    struct BufferImport {
+        VkBuffer                     buffer;
+        VkDeviceSize                 offset         = 0;
+        VkDeviceSize                 size           = VK_WHOLE_SIZE;
+        VkPipelineStageFlags2        initial_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2               initial_access = VK_ACCESS_2_NONE;
+        std::optional<ResourceUsage> final_usage;
+    };
+
+    /**
+     * @brief Graph-owned image that only lives for the passes that use it
+     *
+     * Usage flags are derived from the pass declarations, extra_usage is
+     * or'ed on top for anything recorded outside the graph.
+     */
+    struct ImageDesc {
+        VkFormat           format;
+        VkExtent3D         extent;
+        VkImageAspectFlags aspect       = VK_IMAGE_ASPECT_COLOR_BIT;
+        uint32_t           mip_levels   = 1;
+        uint32_t           array_layers = 1;
+        VkImageType        type         = VK_IMAGE_TYPE_2D;
+        VkImageUsageFlags  extra_usage  = 0;
+    };
+
+    /**
+     * @brief Graph-owned buffer that only lives for the passes that use it
+     */
+    struct BufferDesc {
+        VkDeviceSize       size;
+        VkBufferUsageFlags extra_usage = 0;
+    };
+
+    /**
+     * @brief Declarative frame graph with automatic barrier placement
+     *
+     * Passes declare what they read and write. compile() derives the
+     * dependencies, groups independent passes into levels and emits exactly
+     * one merged vkCmdPipelineBarrier2 per level that needs synchronization.
+     *
+     * Passes whose writes are never observed (read by a live pass, or left in
+     * an imported resource) are culled. Transient resources are placed by
+     * lifetime so ones that are never alive at the same time share the same
+     * VkDeviceMemory range. Transients are created by compile(Device&), so
+     * build the graph once and re-execute it every frame; recompile when its
+     * shape changes. Recompiling replaces the transients: given a
+     * DeletionQueue, the old ones are retired at the value of the last
+     * submission that executed the graph, otherwise they are destroyed
+     * right away and the GPU must be done with them, as it must before
+     * clear() or destruction. Passes naming a pipeline that is still compiling, with
+     * no fallback, are skipped by execute() until it becomes usable. Given a
+     * QueryManager, execute() times every recorded pass under its name.
+     *
+     * @code
+     * RenderGraph graph;
+     * auto albedo = graph.import_image("albedo", {...});
+     *
+     * graph.add_pass("gbuffer", [&](VkCommandBuffer cmd) { ... })
+     *      .write(albedo, ResourceUsage::ColorAttachmentWrite);
+     *
+     * graph.add_pass("lighting", [&](VkCommandBuffer cmd) { ... })
+     *      .read(albedo, ResourceUsage::FragmentShaderSampled);
+     *
+     * graph.compile();
+     * graph.execute(device, cmd);
+     * @endcode
+     */
+    class RenderGraph {
+      public:
+        using RecordCallback = std::function<void(VkCommandBuffer)>;
+
+        struct CompileStats {
+            uint32_t pass_count      = 0;
+            uint32_t level_count     = 0;
+            uint32_t barrier_batches = 0; // vkCmdPipelineBarrier2 calls per execute()
+            uint32_t image_barriers  = 0;
+            uint32_t buffer_barriers = 0;
+
+            uint32_t     culled_passes       = 0;
+            uint32_t     transient_resources = 0;
+            VkDeviceSize transient_bytes     = 0; // peak transient memory as placed
+            VkDeviceSize unaliased_bytes     = 0; // what the same resources need without aliasing
+        };
+
+        // Where a transient's memory is bound, aliased transients share a range of one VkDeviceMemory
+        struct MemoryBinding {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize   offset = 0;
+            VkDeviceSize   size   = 0;
+        };
+
+        class PassBuilder {
+            friend class RenderGraph;
+
+            RenderGraph& _graph;
+            uint32_t     _pass;
+
+            PassBuilder(RenderGraph& graph, uint32_t pass) noexcept;
+
+          public:
+            auto read(ResourceHandle resource, ResourceUsage usage) -> PassBuilder&;
+            auto write(ResourceHandle resource, ResourceUsage usage) -> PassBuilder&;
+
+            // Never cull this pass, e.g. it has effects outside the graph
+            auto keep() -> PassBuilder&;
+
+            // Skip recording while the pipeline has nothing to bind, barriers are still emitted
+            auto pipeline(const vulkan::PipelineHandle& pipeline) -> PassBuilder&;
+        };
+
+      private:
+        enum class ResourceKind : uint8_t { Image, Buffer };
+
+        struct Lifetime {
+            uint32_t              first_step  = UINT32_MAX;
+            uint32_t              last_step   = UINT32_MAX;
+            VkPipelineStageFlags2 last_stages = VK_PIPELINE_STAGE_2_NONE; // scope of the final use
+            VkAccessFlags2        last_access = VK_ACCESS_2_NONE;
+        };
+
+        struct Placement {
+            uint32_t     memory = UINT32_MAX; // index into _transient_memory
+            VkDeviceSize offset = 0;
+            VkDeviceSize size   = 0;
+        };
+
+        struct Resource {
+            std::string  name;
+            ResourceKind kind;
+            ImageImport  image;
+            BufferImport buffer;
+
+            bool       transient   = false;
+            ImageDesc  image_desc  = {};
+            BufferDesc buffer_desc = {};
+            VkFlags    usage_flags = 0; // VkImageUsageFlags or VkBufferUsageFlags
+
+            Lifetime  lifetime;
+            Placement placement;
+        };
+
+        struct Access {
+            uint32_t  resource;
+            SyncScope scope;
+        };
+
+        struct Pass {
+            std::string         name;
+            RecordCallback      record;
+            std::vector<Access> accesses;
+            bool                keep = false;
+
+            std::vector<vulkan::PipelineHandle> pipelines;
+        };
+
+        struct BarrierBatch {
+            uint32_t first_image;
+            uint32_t image_count;
+            uint32_t first_buffer;
+            uint32_t buffer_count;
+        };
+
+        // One level of independent passes, preceded by an optional barrier batch
+        struct Step {
+            uint32_t batch = UINT32_MAX;
+            uint32_t first_pass;
+            uint32_t pass_count;
+        };
+
+        std::vector<Resource> _resources;
+        std::vector<Pass>     _passes;
+        std::vector<bool>     _alive;
+
+        std::vector<uint32_t>              _order;
+        std::vector<Step>                  _steps;
+        std::vector<BarrierBatch>          _batches;
+        std::vector<VkImageMemoryBarrier2>  _image_barriers;
+        std::vector<VkBufferMemoryBarrier2> _buffer_barriers;
+        uint32_t                           _final_batch = UINT32_MAX;
+
+        const vulkan::DispatchTable* _api       = nullptr;
+        VkDevice                     _device    = VK_NULL_HANDLE; // owner of the transient objects below
+        vulkan::MemoryAllocator*     _allocator = nullptr;
+        std::vector<vulkan::Allocation> _transient_memory;
+
+        // Backs the working sets of compile(), rewound at the start of every compile
+        support::FrameArena _scratch;
+
+        CompileStats _stats;
+        bool         _aliasing = true;
+        bool         _compiled = false;
+
+      public:
+        RenderGraph() = default;
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph&) = delete;
+        auto operator=(const RenderGraph&) -> RenderGraph& = delete;
+
+        RenderGraph(RenderGraph&&) = delete;
+        auto operator=(RenderGraph&&) -> RenderGraph& = delete;
+
+        [[nodiscard]] auto import_image(std::string_view name, const ImageImport& image) -> ResourceHandle;
+        [[nodiscard]] auto import_buffer(std::string_view name, const BufferImport& buffer) -> ResourceHandle;
+
+        [[nodiscard]] auto create_image(std::string_view name, const ImageDesc& desc) -> ResourceHandle;
+        [[nodiscard]] auto create_buffer(std::string_view name, const BufferDesc& desc) -> ResourceHandle;
+
+        auto add_pass(std::string_view name, RecordCallback record) -> PassBuilder;
+
+        // Aliasing is on by default; turning it off gives every transient its own range
+        auto set_aliasing(bool enabled) noexcept -> void;
+
+        // Graphs with transient resources must be compiled against a device
+        auto compile() -> void;
+        auto compile(const vulkan::Device& device) -> void;
+        // Old transients stay alive until the timeline reaches `value`, no idle wait needed
+        auto compile(const vulkan::Device& device, vulkan::DeletionQueue& retired, uint64_t value) -> void;
+        auto execute(const vulkan::Device& device, VkCommandBuffer cmd, vulkan::QueryManager* queries = nullptr) const -> void;
+        auto clear() -> void;
+
+        [[nodiscard]] auto stats() const noexcept -> const CompileStats&;
+        [[nodiscard]] auto execution_order() const noexcept -> const std::vector<uint32_t>&;
+        [[nodiscard]] auto pass_name(uint32_t pass) const -> std::string_view;
+        [[nodiscard]] auto is_culled(uint32_t pass) const -> bool;
+
+        // Physical handles of transient resources, valid after compile(Device&)
+        [[nodiscard]] auto image(ResourceHandle resource) const -> VkImage;
+        [[nodiscard]] auto buffer(ResourceHandle resource) const -> VkBuffer;
+        [[nodiscard]] auto memory_binding(ResourceHandle resource) const -> MemoryBinding;
+
+      private:
+        auto add_access(uint32_t pass, ResourceHandle resource, ResourceUsage usage, bool write) -> void;
+        auto compile_impl(const vulkan::Device* device, vulkan::DeletionQueue* retired, uint64_t value) -> void;
+        auto cull_passes() -> uint32_t;
+        auto compute_lifetimes() -> void;
+        auto place_transients(const vulkan::Device& device) -> void;
+        // Destroys the transients now, or retires them at `value` when given a queue
+        auto release_transients(vulkan::DeletionQueue* retired = nullptr, uint64_t value = 0) -> void;
+        auto emit_batch(const vulkan::DispatchTable& api, VkCommandBuffer cmd, uint32_t batch) const -> void;
+    };
+
+} // namespace vulkron::gpu::graphs
@@ -0,0 +1,693 @@
+#include "allocator.hpp"
+#include "instance.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr uint32_t NONE = UINT32_MAX;
+
+        constexpr auto align_up(VkDeviceSize value, VkDeviceSize alignment) noexcept -> VkDeviceSize {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        constexpr auto align_down(VkDeviceSize value, VkDeviceSize alignment) noexcept -> VkDeviceSize {
+            return value / alignment * alignment;
+        }
+
+        constexpr auto pool_index(uint32_t memory_type, ResourceTiling tiling) noexcept -> uint32_t {
+            return memory_type * 2 + static_cast<uint32_t>(tiling);
+        }
+
+    } // namespace
+
+    // ========================================================================
+    // TLSF pool
+    // ========================================================================
+
+    struct MemoryAllocator::Pool {
+        // Sizes below 2^MIN_FL_BITS share the first level in linear steps of 8 bytes,
+        // above that every power of two is split into SL_COUNT classes.
+        static constexpr uint32_t SL_BITS     = 5;
+        static constexpr uint32_t SL_COUNT    = 1u << SL_BITS;
+        static constexpr uint32_t MIN_FL_BITS = 8;
+        static constexpr uint32_t FL_COUNT    = 64 - MIN_FL_BITS + 1;
+
+        struct Node {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            uint32_t     block;
+            uint32_t     prev_physical;
+            uint32_t     next_physical;
+            uint32_t     prev_free;
+            uint32_t     next_free;
+            bool         free;
+        };
+
+        struct Block {
+            VkDeviceMemory memory;
+            VkDeviceSize   size;
+            void*          mapped;
+        };
+
+        uint32_t       memory_type;
+        ResourceTiling tiling;
+
+        std::vector<Node>     nodes;
+        std::vector<uint32_t> spare_nodes;
+        std::vector<Block>    blocks;
+        std::vector<uint32_t> spare_blocks;
+
+        uint64_t                                               fl_bitmap = 0;
+        std::array<uint32_t, FL_COUNT>                         sl_bitmap{};
+        std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT>   heads;
+
+        uint32_t     block_count      = 0;
+        uint32_t     allocation_count = 0;
+        VkDeviceSize block_bytes      = 0;
+        VkDeviceSize used_bytes       = 0;
+
+        Pool(uint32_t type, ResourceTiling pool_tiling)
+            : memory_type(type),
+            tiling(pool_tiling)
+        {
+            for (auto& level : heads) {
+                level.fill(NONE);
+            }
+        }
+
+        static auto mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl) noexcept -> void {
+            if (size < (VkDeviceSize{1} << MIN_FL_BITS)) {
+                fl = 0;
+                sl = static_cast<uint32_t>(size >> (MIN_FL_BITS - SL_BITS));
+                return;
+            }
+
+            const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+            fl = log2 - MIN_FL_BITS + 1;
+            sl = static_cast<uint32_t>(size >> (log2 - SL_BITS)) - SL_COUNT;
+        }
+
+        // Rounds up to the next class boundary so every range in the class found fits
+        static auto search_size(VkDeviceSize size) noexcept -> VkDeviceSize {
+            if (size < (VkDeviceSize{1} << MIN_FL_BITS)) {
+                return size + (VkDeviceSize{1} << (MIN_FL_BITS - SL_BITS)) - 1;
+            }
+
+            const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+            return size + (VkDeviceSize{1} << (log2 - SL_BITS)) - 1;
+        }
+
+        static auto mapping_search(VkDeviceSize size, uint32_t& fl, uint32_t& sl) noexcept -> void {
+            mapping(search_size(size), fl, sl);
+        }
+
+        auto new_node() -> uint32_t {
+            if (!spare_nodes.empty()) {
+                const uint32_t index = spare_nodes.back();
+                spare_nodes.pop_back();
+                return index;
+            }
+            nodes.push_back({});
+            return static_cast<uint32_t>(nodes.size() - 1);
+        }
+
+        auto insert_free(uint32_t index) noexcept -> void {
+            uint32_t fl, sl;
+            mapping(nodes[index].size, fl, sl);
+
+            Node& node     = nodes[index];
+            node.free      = true;
+            node.prev_free = NONE;
+            node.next_free = heads[fl][sl];
+
+            if (node.next_free != NONE) {
+                nodes[node.next_free].prev_free = index;
+            }
+
+            heads[fl][sl] = index;
+            fl_bitmap    |= uint64_t{1} << fl;
+            sl_bitmap[fl] |= 1u << sl;
+        }
+
+        auto remove_free(uint32_t index) noexcept -> void {
+            Node& node = nodes[index];
+
+            if (node.prev_free != NONE) {
+                nodes[node.prev_free].next_free = node.next_free;
+            }
+            if (node.next_free != NONE) {
+                nodes[node.next_free].prev_free = node.prev_free;
+            }
+
+            uint32_t fl, sl;
+            mapping(node.size, fl, sl);
+
+            if (heads[fl][sl] == index) {
+                heads[fl][sl] = node.next_free;
+                if (heads[fl][sl] == NONE) {
+                    sl_bitmap[fl] &= ~(1u << sl);
+                    if (sl_bitmap[fl] == 0) {
+                        fl_bitmap &= ~(uint64_t{1} << fl);
+                    }
+                }
+            }
+
+            node.free      = false;
+            node.prev_free = NONE;
+            node.next_free = NONE;
+        }
+
+        [[nodiscard]] auto find_free(VkDeviceSize size) const noexcept -> uint32_t {
+            uint32_t fl, sl;
+            mapping_search(size, fl, sl);
+            if (fl >= FL_COUNT) {
+                return NONE;
+            }
+
+            uint32_t sl_map = sl < SL_COUNT ? sl_bitmap[fl] & (~0u << sl) : 0;
+            if (sl_map == 0) {
+                const uint64_t fl_map = fl + 1 < 64 ? fl_bitmap & (~uint64_t{0} << (fl + 1)) : 0;
+                if (fl_map == 0) {
+                    return NONE;
+                }
+
+                fl     = static_cast<uint32_t>(std::countr_zero(fl_map));
+                sl_map = sl_bitmap[fl];
+            }
+
+            return heads[fl][static_cast<uint32_t>(std::countr_zero(sl_map))];
+        }
+
+        auto add_block(VkDeviceMemory memory, VkDeviceSize size, void* mapped) -> void {
+            uint32_t block;
+            if (!spare_blocks.empty()) {
+                block = spare_blocks.back();
+                spare_blocks.pop_back();
+                blocks[block] = Block{memory, size, mapped};
+            }
+            else {
+                blocks.push_back(Block{memory, size, mapped});
+                block = static_cast<uint32_t>(blocks.size() - 1);
+            }
+
+            const uint32_t index = new_node();
+            nodes[index] = Node{
+                .offset        = 0,
+                .size          = size,
+                .block         = block,
+                .prev_physical = NONE,
+                .next_physical = NONE,
+                .prev_free     = NONE,
+                .next_free     = NONE,
+                .free          = false
+            };
+            insert_free(index);
+
+            ++block_count;
+            block_bytes += size;
+        }
+
+        // Splits the front of a free range off as its own free range
+        auto split_front(uint32_t index, VkDeviceSize front) -> void {
+            const uint32_t head = new_node();
+            Node&          node = nodes[index];
+
+            nodes[head] = Node{
+                .offset        = node.offset,
+                .size          = front,
+                .block         = node.block,
+                .prev_physical = node.prev_physical,
+                .next_physical = index,
+                .prev_free     = NONE,
+                .next_free     = NONE,
+                .free          = false
+            };
+
+            if (node.prev_physical != NONE) {
+                nodes[node.prev_physical].next_physical = head;
+            }
+
+            node.prev_physical = head;
+            node.offset       += front;
+            node.size         -= front;
+
+            insert_free(head);
+        }
+
+        auto split_back(uint32_t index, VkDeviceSize keep) -> void {
+            const uint32_t tail = new_node();
+            Node&          node = nodes[index];
+
+            nodes[tail] = Node{
+                .offset        = node.offset + keep,
+                .size          = node.size - keep,
+                .block         = node.block,
+                .prev_physical = index,
+                .next_physical = node.next_physical,
+                .prev_free     = NONE,
+                .next_free     = NONE,
+                .free          = false
+            };
+
+            if (node.next_physical != NONE) {
+                nodes[node.next_physical].prev_physical = tail;
+            }
+
+            node.next_physical = tail;
+            node.size          = keep;
+
+            insert_free(tail);
+        }
+
+        [[nodiscard]] auto allocate(VkDeviceSize size, VkDeviceSize alignment) -> uint32_t {
+            // Searching for size + alignment - 1 guarantees the first hit fits after alignment
+            const uint32_t index = find_free(size + alignment - 1);
+            if (index == NONE) {
+                return NONE;
+            }
+
+            remove_free(index);
+
+            const VkDeviceSize padding = align_up(nodes[index].offset, alignment) - nodes[index].offset;
+            if (padding > 0) {
+                split_front(index, padding);
+            }
+            if (nodes[index].size > size) {
+                split_back(index, size);
+            }
+
+            ++allocation_count;
+            used_bytes += nodes[index].size;
+            return index;
+        }
+
+        // Returns the merged free range when its whole block became free, NONE otherwise
+        auto free(uint32_t index) -> uint32_t {
+            --allocation_count;
+            used_bytes -= nodes[index].size;
+
+            const uint32_t prev = nodes[index].prev_physical;
+            if (prev != NONE && nodes[prev].free) {
+                remove_free(prev);
+                nodes[prev].size         += nodes[index].size;
+                nodes[prev].next_physical = nodes[index].next_physical;
+                if (nodes[index].next_physical != NONE) {
+                    nodes[nodes[index].next_physical].prev_physical = prev;
+                }
+                spare_nodes.push_back(index);
+                index = prev;
+            }
+
+            const uint32_t next = nodes[index].next_physical;
+            if (next != NONE && nodes[next].free) {
+                remove_free(next);
+                nodes[index].size         += nodes[next].size;
+                nodes[index].next_physical = nodes[next].next_physical;
+                if (nodes[next].next_physical != NONE) {
+                    nodes[nodes[next].next_physical].prev_physical = index;
+                }
+                spare_nodes.push_back(next);
+            }
+
+            insert_free(index);
+
+            const Node& node = nodes[index];
+            return node.prev_physical == NONE && node.next_physical == NONE ? index : NONE;
+        }
+
+        // Detaches an entirely free block and returns its memory
+        auto remove_block(uint32_t index) -> VkDeviceMemory {
+            const uint32_t block  = nodes[index].block;
+            VkDeviceMemory memory = blocks[block].memory;
+
+            remove_free(index);
+            spare_nodes.push_back(index);
+
+            --block_count;
+            block_bytes -= blocks[block].size;
+            blocks[block] = Block{VK_NULL_HANDLE, 0, nullptr};
+            spare_blocks.push_back(block);
+
+            return memory;
+        }
+
+        [[nodiscard]] auto largest_free() const noexcept -> VkDeviceSize {
+            if (fl_bitmap == 0) {
+                return 0;
+            }
+
+            // Only the highest non-empty class can hold the largest range
+            const uint32_t fl = 63 - static_cast<uint32_t>(std::countl_zero(fl_bitmap));
+            const uint32_t sl = 31 - static_cast<uint32_t>(std::countl_zero(sl_bitmap[fl]));
+
+            VkDeviceSize largest = 0;
+            for (uint32_t index = heads[fl][sl]; index != NONE; index = nodes[index].next_free) {
+                largest = std::max(largest, nodes[index].size);
+            }
+            return largest;
+        }
+    };
+
+    // ========================================================================
+    // MemoryAllocator
+    // ========================================================================
+
+    MemoryAllocator::MemoryAllocator(const DispatchTable& api, const Adapter& adapter, VkDevice device)
+        : MemoryAllocator(api, adapter, device, Config{})
+    {}
+
+    MemoryAllocator::MemoryAllocator(const DispatchTable& api, const Adapter& adapter, VkDevice device, const Config& config)
+        : _api(api),
+        _device(device),
+        _config(config)
+    {
+        VkPhysicalDeviceMemoryProperties2 memory_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2};
+        _api.vkGetPhysicalDeviceMemoryProperties2(adapter.gpu, &memory_properties);
+        _memory_properties = memory_properties.memoryProperties;
+
+        const VkPhysicalDeviceLimits& limits = adapter.properties.head()->properties.limits;
+        _non_coherent_atom_size = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+
+        if (_config.block_size == 0) {
+            throw std::runtime_error("Memory allocator block size must be non-zero");
+        }
+    }
+
+    MemoryAllocator::~MemoryAllocator() {
+        for (std::unique_ptr<Pool>& pool : _pools) {
+            if (!pool) {
+                continue;
+            }
+
+            for (const Pool::Block& block : pool->blocks) {
+                if (block.memory != VK_NULL_HANDLE) {
+                    _api.vkFreeMemory(_device, block.memory, nullptr);
+                }
+            }
+        }
+    }
+
+    auto MemoryAllocator::find_memory_type(uint32_t type_bits, MemoryUsage usage) const -> uint32_t {
+        VkMemoryPropertyFlags required  = 0;
+        VkMemoryPropertyFlags preferred = 0;
+        VkMemoryPropertyFlags avoided   = 0;
+
+        switch (usage) {
+            case MemoryUsage::GpuOnly:
+                preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+                avoided   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+                break;
+            case MemoryUsage::Upload:
+                required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+                preferred = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                avoided   = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
+            case MemoryUsage::Readback:
+                required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+                preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
+        }
+
+        uint32_t best_type  = NONE;
+        int      best_score = -1;
+
+        for (uint32_t i = 0; i < _memory_properties.memoryTypeCount; ++i) {
+            const VkMemoryPropertyFlags flags = _memory_properties.memoryTypes[i].propertyFlags;
+            if (!(type_bits & (1u << i)) || (flags & required) != required) {
+                continue;
+            }
+
+            const int score = std::popcount(flags & preferred) * 2 + (std::popcount(flags & avoided) == 0 ? 1 : 0);
+            if (score > best_score) {
+                best_score = score;
+                best_type  = i;
+            }
+        }
+
+        if (best_type == NONE) {
+            throw std::runtime_error("No suitable memory type found");
+        }
+
+        return best_type;
+    }
+
+    auto MemoryAllocator::allocate_device_memory(VkDeviceSize size, uint32_t memory_type, VkDeviceMemory& memory, void*& mapped) -> VkResult {
+        // Any block may end up backing a buffer whose address is taken
+        VkMemoryAllocateFlagsInfo flags_info = {
+            .sType      = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+            .pNext      = nullptr,
+            .flags      = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+            .deviceMask = 0
+        };
+
+        VkMemoryAllocateInfo allocate_info = {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext           = _config.device_address ? &flags_info : nullptr,
+            .allocationSize  = size,
+            .memoryTypeIndex = memory_type
+        };
+
+        const VkResult result = _api.vkAllocateMemory(_device, &allocate_info, nullptr, &memory);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        ++_device_allocations;
+        mapped = nullptr;
+
+        if (_memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            if (_api.vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+                _api.vkFreeMemory(_device, memory, nullptr);
+                throw std::runtime_error("Failed to map host visible memory block");
+            }
+        }
+
+        return VK_SUCCESS;
+    }
+
+    auto MemoryAllocator::free_device_memory(VkDeviceMemory memory) -> void {
+        // Freeing implicitly unmaps
+        _api.vkFreeMemory(_device, memory, nullptr);
+    }
+
+    auto MemoryAllocator::allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, ResourceTiling tiling) -> Allocation {
+        const uint32_t     memory_type = find_memory_type(requirements.memoryTypeBits, usage);
+        const VkDeviceSize alignment   = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+        std::lock_guard lock(_mutex);
+
+        // Large resources would waste most of a block, give them their own memory
+        if (requirements.size > _config.block_size / 2) {
+            Allocation allocation{.size = requirements.size, .memory_type = memory_type};
+
+            if (allocate_device_memory(requirements.size, memory_type, allocation.memory, allocation.mapped) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate dedicated device memory");
+            }
+
+            ++_dedicated_count;
+            _dedicated_bytes += requirements.size;
+            return allocation;
+        }
+
+        const uint32_t         index = pool_index(memory_type, tiling);
+        std::unique_ptr<Pool>& pool  = _pools[index];
+        if (!pool) {
+            pool = std::make_unique<Pool>(memory_type, tiling);
+        }
+
+        uint32_t node = pool->allocate(requirements.size, alignment);
+
+        if (node == NONE) {
+            // Pool is full, grow it by one block. Halve on failure in case the heap is tight,
+            // but never below what the class search needs to find the new range.
+            const VkDeviceSize minimum    = Pool::search_size(requirements.size + alignment - 1);
+            VkDeviceSize       block_size = _config.block_size;
+            VkDeviceMemory     memory     = VK_NULL_HANDLE;
+            void*              mapped     = nullptr;
+
+            while (allocate_device_memory(block_size, memory_type, memory, mapped) != VK_SUCCESS) {
+                block_size /= 2;
+                if (block_size < minimum) {
+                    throw std::runtime_error("Out of device memory");
+                }
+            }
+
+            pool->add_block(memory, block_size, mapped);
+            node = pool->allocate(requirements.size, alignment);
+
+            if (node == NONE) {
+                throw std::runtime_error("Out of device memory");
+            }
+        }
+
+        const Pool::Node&  range = pool->nodes[node];
+        const Pool::Block& block = pool->blocks[range.block];
+
+        return Allocation{
+            .memory      = block.memory,
+            .offset      = range.offset,
+            .size        = range.size,
+            .mapped      = block.mapped ? static_cast<std::byte*>(block.mapped) + range.offset : nullptr,
+            .memory_type = memory_type,
+            .pool        = index,
+            .node        = node
+        };
+    }
+
+    auto MemoryAllocator::free(Allocation& allocation) -> void {
+        if (!allocation.valid()) {
+            return;
+        }
+
+        std::lock_guard lock(_mutex);
+
+        if (allocation.pool == NONE) {
+            free_device_memory(allocation.memory);
+            --_dedicated_count;
+            _dedicated_bytes -= allocation.size;
+        }
+        else {
+            Pool&          pool  = *_pools[allocation.pool];
+            const uint32_t empty = pool.free(allocation.node);
+
+            // Keep one empty block around so alloc/free churn doesn't hit the driver
+            if (empty != NONE && pool.block_count > 1) {
+                free_device_memory(pool.remove_block(empty));
+            }
+        }
+
+        allocation = {};
+    }
+
+    auto MemoryAllocator::create_buffer(const VkBufferCreateInfo& create_info, MemoryUsage usage) -> AllocatedBuffer {
+        AllocatedBuffer buffer;
+        if (_api.vkCreateBuffer(_device, &create_info, nullptr, &buffer.buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer");
+        }
+
+        VkMemoryRequirements requirements;
+        _api.vkGetBufferMemoryRequirements(_device, buffer.buffer, &requirements);
+
+        buffer.allocation = allocate(requirements, usage, ResourceTiling::Linear);
+
+        if (_api.vkBindBufferMemory(_device, buffer.buffer, buffer.allocation.memory, buffer.allocation.offset) != VK_SUCCESS) {
+            destroy_buffer(buffer);
+            throw std::runtime_error("Failed to bind buffer memory");
+        }
+
+        return buffer;
+    }
+
+    auto MemoryAllocator::create_image(const VkImageCreateInfo& create_info, MemoryUsage usage) -> AllocatedImage {
+        AllocatedImage image;
+        if (_api.vkCreateImage(_device, &create_info, nullptr, &image.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image");
+        }
+
+        VkMemoryRequirements requirements;
+        _api.vkGetImageMemoryRequirements(_device, image.image, &requirements);
+
+        const ResourceTiling tiling = create_info.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceTiling::Optimal
+                                                                                    : ResourceTiling::Linear;
+        image.allocation = allocate(requirements, usage, tiling);
+
+        if (_api.vkBindImageMemory(_device, image.image, image.allocation.memory, image.allocation.offset) != VK_SUCCESS) {
+            destroy_image(image);
+            throw std::runtime_error("Failed to bind image memory");
+        }
+
+        return image;
+    }
+
+    auto MemoryAllocator::destroy_buffer(AllocatedBuffer& buffer) -> void {
+        if (buffer.buffer != VK_NULL_HANDLE) {
+            _api.vkDestroyBuffer(_device, buffer.buffer, nullptr);
+            buffer.buffer = VK_NULL_HANDLE;
+        }
+        free(buffer.allocation);
+    }
+
+    auto MemoryAllocator::destroy_image(AllocatedImage& image) -> void {
+        if (image.image != VK_NULL_HANDLE) {
+            _api.vkDestroyImage(_device, image.image, nullptr);
+            image.image = VK_NULL_HANDLE;
+        }
+        free(image.allocation);
+    }
+
+    auto MemoryAllocator::mapped_range(const Allocation& allocation) const -> VkMappedMemoryRange {
+        // Ranges must be multiples of nonCoherentAtomSize relative to the memory object
+        const VkDeviceSize begin = align_down(allocation.offset, _non_coherent_atom_size);
+        const VkDeviceSize end   = align_up(allocation.offset + allocation.size, _non_coherent_atom_size);
+
+        return VkMappedMemoryRange{
+            .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext  = nullptr,
+            .memory = allocation.memory,
+            .offset = begin,
+            .size   = allocation.pool == NONE ? VK_WHOLE_SIZE : end - begin
+        };
+    }
+
+    auto MemoryAllocator::flush(const Allocation& allocation) const -> void {
+        if (_memory_properties.memoryTypes[allocation.memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+            return;
+        }
+
+        const VkMappedMemoryRange range = mapped_range(allocation);
+        _api.vkFlushMappedMemoryRanges(_device, 1, &range);
+    }
+
+    auto MemoryAllocator::invalidate(const Allocation& allocation) const -> void {
+        if (_memory_properties.memoryTypes[allocation.memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+            return;
+        }
+
+        const VkMappedMemoryRange range = mapped_range(allocation);
+        _api.vkInvalidateMappedMemoryRanges(_device, 1, &range);
+    }
+
+    auto MemoryAllocator::memory_properties() const noexcept -> const VkPhysicalDeviceMemoryProperties& {
+        return _memory_properties;
+    }
+
+    auto MemoryAllocator::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+
+        Stats stats{
+            .pools              = {},
+            .dedicated_count    = _dedicated_count,
+            .dedicated_bytes    = _dedicated_bytes,
+            .device_allocations = _device_allocations
+        };
+
+        for (const std::unique_ptr<Pool>& pool : _pools) {
+            if (!pool || pool->block_count == 0) {
+                continue;
+            }
+
+            const VkDeviceSize free_bytes = pool->block_bytes - pool->used_bytes;
+            const VkDeviceSize largest    = pool->largest_free();
+
+            stats.pools.push_back(PoolStats{
+                .memory_type      = pool->memory_type,
+                .tiling           = pool->tiling,
+                .block_count      = pool->block_count,
+                .allocation_count = pool->allocation_count,
+                .block_bytes      = pool->block_bytes,
+                .used_bytes       = pool->used_bytes,
+                .free_bytes       = free_bytes,
+                .largest_free     = largest,
+                .fragmentation    = free_bytes > 0 ? 1.0 - static_cast<double>(largest) / static_cast<double>(free_bytes) : 0.0
+            });
+        }
+
+        return stats;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "dispatch.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    struct Adapter;
+
+    enum class MemoryUsage : uint8_t {
+        GpuOnly, // Device local, never mapped
+        Upload,  // Host visible, written by the CPU and read by the GPU
+        Readback // Host visible and preferably cached, written by the GPU and read by the CPU
+    };
+
+    // Linear and optimal-tiling resources come from separate pools, so neighbours
+    // within a block never need bufferImageGranularity padding
+    enum class ResourceTiling : uint8_t {
+        Linear, // Buffers and linear images
+        Optimal // Optimal-tiling images
+    };
+
+    /**
+     * @brief A range of device memory handed out by MemoryAllocator
+     *
+     * Host-visible memory stays mapped for the lifetime of its block, so
+     * `mapped` can be written at any time without vkMapMemory.
+     */
+    struct Allocation {
+        VkDeviceMemory memory      = VK_NULL_HANDLE;
+        VkDeviceSize   offset      = 0;
+        VkDeviceSize   size        = 0;
+        void*          mapped      = nullptr;
+        uint32_t       memory_type = UINT32_MAX;
+
+        uint32_t pool = UINT32_MAX; // UINT32_MAX for dedicated allocations
+        uint32_t node = UINT32_MAX;
+
+        [[nodiscard]] auto valid() const noexcept -> bool {
+            return memory != VK_NULL_HANDLE;
+        }
+    };
+
+    struct AllocatedBuffer {
+        VkBuffer   buffer = VK_NULL_HANDLE;
+        Allocation allocation;
+    };
+
+    struct AllocatedImage {
+        VkImage    image = VK_NULL_HANDLE;
+        Allocation allocation;
+    };
+
+    /**
+     * @brief Sub-allocates buffers and images out of large VkDeviceMemory blocks
+     *
+     * There is one pool per (memory type, tiling) pair. A pool spans all of its
+     * blocks with a single two-level segregated fit (TLSF) index, so both
+     * allocate() and free() are O(1) regardless of how many blocks or ranges
+     * exist. Requests larger than half a block get a dedicated allocation.
+     */
+    class MemoryAllocator {
+      public:
+        struct Config {
+            VkDeviceSize block_size     = VkDeviceSize{64} << 20;
+            bool         device_address = false; // allocate with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+        };
+
+        struct PoolStats {
+            uint32_t       memory_type;
+            ResourceTiling tiling;
+            uint32_t       block_count;
+            uint32_t       allocation_count;
+            VkDeviceSize   block_bytes;
+            VkDeviceSize   used_bytes;
+            VkDeviceSize   free_bytes;
+            VkDeviceSize   largest_free;
+            double         fragmentation; // 1 - largest_free / free_bytes
+        };
+
+        struct Stats {
+            std::vector<PoolStats> pools;
+            uint32_t               dedicated_count;
+            VkDeviceSize           dedicated_bytes;
+            uint64_t               device_allocations; // vkAllocateMemory calls made so far
+        };
+
+      private:
+        struct Pool;
+
+        static constexpr uint32_t POOL_COUNT = VK_MAX_MEMORY_TYPES * 2;
+
+        const DispatchTable&             _api;
+        VkDevice                         _device;
+        VkPhysicalDeviceMemoryProperties _memory_properties;
+        VkDeviceSize                     _non_coherent_atom_size;
+        Config                           _config;
+
+        std::array<std::unique_ptr<Pool>, POOL_COUNT> _pools;
+
+        uint32_t     _dedicated_count    = 0;
+        VkDeviceSize _dedicated_bytes    = 0;
+        uint64_t     _device_allocations = 0;
+
+        mutable std::mutex _mutex;
+
+      public:
+        MemoryAllocator(const DispatchTable& api, const Adapter& adapter, VkDevice device, const Config& config);
+        MemoryAllocator(const DispatchTable& api, const Adapter& adapter, VkDevice device);
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        auto operator=(const MemoryAllocator&) -> MemoryAllocator& = delete;
+
+        MemoryAllocator(MemoryAllocator&&) = delete;
+        auto operator=(MemoryAllocator&&) -> MemoryAllocator& = delete;
+
+        [[nodiscard]] auto allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, ResourceTiling tiling) -> Allocation;
+        auto free(Allocation& allocation) -> void;
+
+        [[nodiscard]] auto create_buffer(const VkBufferCreateInfo& create_info, MemoryUsage usage) -> AllocatedBuffer;
+        [[nodiscard]] auto create_image(const VkImageCreateInfo& create_info, MemoryUsage usage) -> AllocatedImage;
+        auto destroy_buffer(AllocatedBuffer& buffer) -> void;
+        auto destroy_image(AllocatedImage& image) -> void;
+
+        // No-ops on host-coherent memory
+        auto flush(const Allocation& allocation) const -> void;
+        auto invalidate(const Allocation& allocation) const -> void;
+
+        [[nodiscard]] auto find_memory_type(uint32_t type_bits, MemoryUsage usage) const -> uint32_t;
+        [[nodiscard]] auto memory_properties() const noexcept -> const VkPhysicalDeviceMemoryProperties&;
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        auto allocate_device_memory(VkDeviceSize size, uint32_t memory_type, VkDeviceMemory& memory, void*& mapped) -> VkResult;
+        auto free_device_memory(VkDeviceMemory memory) -> void;
+        auto mapped_range(const Allocation& allocation) const -> VkMappedMemoryRange;
+    };
+
+} // namespace vulkron::gpu::vulkan
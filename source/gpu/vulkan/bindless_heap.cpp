@@ -0,0 +1,333 @@
+#include "bindless_heap.hpp"
+#include "device.hpp"
+#include "instance.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr DeviceFeature REQUIRED_FEATURES[] = {
+            DeviceFeature::DescriptorIndexing,
+            DeviceFeature::RuntimeDescriptorArray,
+            DeviceFeature::DescriptorBindingPartiallyBound,
+            DeviceFeature::DescriptorBindingSampledImageUpdateAfterBind,
+            DeviceFeature::DescriptorBindingStorageImageUpdateAfterBind,
+            DeviceFeature::DescriptorBindingStorageBufferUpdateAfterBind,
+            DeviceFeature::ShaderSampledImageArrayNonUniformIndexing,
+            DeviceFeature::ShaderStorageBufferArrayNonUniformIndexing,
+            DeviceFeature::ShaderStorageImageArrayNonUniformIndexing
+        };
+
+        constexpr VkDescriptorType DESCRIPTOR_TYPES[BINDLESS_TYPE_COUNT] = {
+            VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_SAMPLER
+        };
+
+        constexpr const char* TYPE_NAMES[BINDLESS_TYPE_COUNT] = {
+            "sampled image",
+            "storage image",
+            "storage buffer",
+            "sampler"
+        };
+
+        constexpr auto slot(BindlessType type) noexcept -> size_t {
+            return static_cast<size_t>(type);
+        }
+
+        // Arrays can't exceed what the device allows in one update-after-bind set or stage
+        auto device_limits(const Adapter& adapter) -> std::array<uint32_t, BINDLESS_TYPE_COUNT> {
+            const VkPhysicalDeviceVulkan12Properties& vk12 = adapter.properties.get<VkPhysicalDeviceVulkan12Properties>();
+
+            return {
+                std::min(vk12.maxDescriptorSetUpdateAfterBindSampledImages, vk12.maxPerStageDescriptorUpdateAfterBindSampledImages),
+                std::min(vk12.maxDescriptorSetUpdateAfterBindStorageImages, vk12.maxPerStageDescriptorUpdateAfterBindStorageImages),
+                std::min(vk12.maxDescriptorSetUpdateAfterBindStorageBuffers, vk12.maxPerStageDescriptorUpdateAfterBindStorageBuffers),
+                std::min(vk12.maxDescriptorSetUpdateAfterBindSamplers, vk12.maxPerStageDescriptorUpdateAfterBindSamplers)
+            };
+        }
+
+    } // namespace
+
+    auto BindlessHeap::require_features(Device& device) -> void {
+        for (DeviceFeature feature : REQUIRED_FEATURES) {
+            device.require_feature(feature);
+        }
+    }
+
+    BindlessHeap::BindlessHeap(Device& device)
+        : BindlessHeap(device, Config{})
+    {
+    }
+
+    BindlessHeap::BindlessHeap(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _layout(VK_NULL_HANDLE),
+        _pool(VK_NULL_HANDLE),
+        _set(VK_NULL_HANDLE)
+    {
+        if (_device == VK_NULL_HANDLE) {
+            throw std::runtime_error("BindlessHeap needs a Device after create_device()");
+        }
+
+        std::string missing;
+        for (DeviceFeature feature : REQUIRED_FEATURES) {
+            if (!device.capabilities().has(feature)) {
+                missing += " ";
+                missing += to_string(feature);
+            }
+        }
+        if (!missing.empty()) {
+            throw std::runtime_error("BindlessHeap needs features the device was created without:" + missing);
+        }
+
+        const Adapter* adapter = device.instance()->adapter(device.physical_device_handle());
+        if (adapter == nullptr) {
+            throw std::runtime_error("BindlessHeap needs a device with a selected GPU");
+        }
+        const auto limits = device_limits(*adapter);
+
+        std::array<VkDescriptorSetLayoutBinding, BINDLESS_TYPE_COUNT> bindings;
+        std::array<VkDescriptorBindingFlags, BINDLESS_TYPE_COUNT>     binding_flags;
+        std::array<VkDescriptorPoolSize, BINDLESS_TYPE_COUNT>         pool_sizes;
+
+        for (size_t i = 0; i < BINDLESS_TYPE_COUNT; ++i) {
+            _slots[i].capacity = std::max(1u, std::min(config.capacity[i], limits[i]));
+
+            bindings[i] = VkDescriptorSetLayoutBinding{
+                .binding         = static_cast<uint32_t>(i),
+                .descriptorType  = DESCRIPTOR_TYPES[i],
+                .descriptorCount = _slots[i].capacity,
+                .stageFlags      = config.stages,
+                .pImmutableSamplers = nullptr
+            };
+            // Unwritten slots are fine as long as shaders don't reach them
+            binding_flags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+            pool_sizes[i]    = VkDescriptorPoolSize{DESCRIPTOR_TYPES[i], _slots[i].capacity};
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .pNext = nullptr,
+            .bindingCount  = static_cast<uint32_t>(binding_flags.size()),
+            .pBindingFlags = binding_flags.data()
+        };
+
+        VkDescriptorSetLayoutCreateInfo layout_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = &flags_info,
+            .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings    = bindings.data()
+        };
+
+        if (_api.vkCreateDescriptorSetLayout(_device, &layout_info, nullptr, &_layout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor set layout");
+        }
+
+        VkDescriptorPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+            .pPoolSizes    = pool_sizes.data()
+        };
+
+        if (_api.vkCreateDescriptorPool(_device, &pool_info, nullptr, &_pool) != VK_SUCCESS) {
+            _api.vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+            throw std::runtime_error("Failed to create bindless descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo allocate_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool     = _pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &_layout
+        };
+
+        if (_api.vkAllocateDescriptorSets(_device, &allocate_info, &_set) != VK_SUCCESS) {
+            _api.vkDestroyDescriptorPool(_device, _pool, nullptr);
+            _api.vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+            throw std::runtime_error("Failed to allocate bindless descriptor set");
+        }
+    }
+
+    BindlessHeap::~BindlessHeap() {
+        // Frees the set along with the pool
+        _api.vkDestroyDescriptorPool(_device, _pool, nullptr);
+        _api.vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+    }
+
+    auto BindlessHeap::add_sampled_image(VkImageView view, VkImageLayout layout) -> uint32_t {
+        std::lock_guard lock(_mutex);
+        const uint32_t index = allocate(BindlessType::SampledImage);
+        write_image(BindlessType::SampledImage, index, view, layout, VK_NULL_HANDLE);
+        return index;
+    }
+
+    auto BindlessHeap::add_storage_image(VkImageView view, VkImageLayout layout) -> uint32_t {
+        std::lock_guard lock(_mutex);
+        const uint32_t index = allocate(BindlessType::StorageImage);
+        write_image(BindlessType::StorageImage, index, view, layout, VK_NULL_HANDLE);
+        return index;
+    }
+
+    auto BindlessHeap::add_storage_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> uint32_t {
+        std::lock_guard lock(_mutex);
+        const uint32_t index = allocate(BindlessType::StorageBuffer);
+        write_buffer(index, buffer, offset, range);
+        return index;
+    }
+
+    auto BindlessHeap::add_sampler(VkSampler sampler) -> uint32_t {
+        std::lock_guard lock(_mutex);
+        const uint32_t index = allocate(BindlessType::Sampler);
+        write_image(BindlessType::Sampler, index, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED, sampler);
+        return index;
+    }
+
+    auto BindlessHeap::update_sampled_image(uint32_t index, VkImageView view, VkImageLayout layout) -> void {
+        std::lock_guard lock(_mutex);
+        write_image(BindlessType::SampledImage, index, view, layout, VK_NULL_HANDLE);
+    }
+
+    auto BindlessHeap::update_storage_image(uint32_t index, VkImageView view, VkImageLayout layout) -> void {
+        std::lock_guard lock(_mutex);
+        write_image(BindlessType::StorageImage, index, view, layout, VK_NULL_HANDLE);
+    }
+
+    auto BindlessHeap::update_storage_buffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> void {
+        std::lock_guard lock(_mutex);
+        write_buffer(index, buffer, offset, range);
+    }
+
+    auto BindlessHeap::update_sampler(uint32_t index, VkSampler sampler) -> void {
+        std::lock_guard lock(_mutex);
+        write_image(BindlessType::Sampler, index, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED, sampler);
+    }
+
+    auto BindlessHeap::release(BindlessType type, uint32_t index, uint64_t retire_value) -> void {
+        std::lock_guard lock(_mutex);
+        Slots& slots = _slots[slot(type)];
+        if (!slots.is_live(index)) {
+            throw std::runtime_error(std::string("Releasing a bindless ") + TYPE_NAMES[slot(type)] + " index that is not allocated");
+        }
+        slots.live[index] = false;
+        _retired.push_back(Retired{type, index, retire_value});
+    }
+
+    auto BindlessHeap::recycle(uint64_t completed_value) -> void {
+        std::lock_guard lock(_mutex);
+
+        // Values retire in submission order, an out of order value only delays what follows it
+        while (!_retired.empty() && _retired.front().value <= completed_value) {
+            const Retired& retired = _retired.front();
+            _slots[slot(retired.type)].free.push_back(retired.index);
+            _retired.pop_front();
+        }
+    }
+
+    auto BindlessHeap::bind(VkCommandBuffer cmd, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout, uint32_t set_index) const -> void {
+        _api.vkCmdBindDescriptorSets(cmd, bind_point, pipeline_layout, set_index, 1, &_set, 0, nullptr);
+    }
+
+    auto BindlessHeap::layout() const noexcept -> VkDescriptorSetLayout {
+        return _layout;
+    }
+
+    auto BindlessHeap::set() const noexcept -> VkDescriptorSet {
+        return _set;
+    }
+
+    auto BindlessHeap::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+
+        Stats stats;
+        for (size_t i = 0; i < BINDLESS_TYPE_COUNT; ++i) {
+            stats.capacity[i]  = _slots[i].capacity;
+            stats.allocated[i] = _slots[i].next - static_cast<uint32_t>(_slots[i].free.size());
+        }
+        stats.retired = static_cast<uint32_t>(_retired.size());
+        return stats;
+    }
+
+    auto BindlessHeap::allocate(BindlessType type) -> uint32_t {
+        Slots& slots = _slots[slot(type)];
+
+        // Reuse recycled slots before growing the range the GPU touches
+        if (!slots.free.empty()) {
+            const uint32_t index = slots.free.back();
+            slots.free.pop_back();
+            slots.live[index] = true;
+            return index;
+        }
+        if (slots.next == slots.capacity) {
+            throw std::runtime_error(std::string("Bindless heap is out of ") + TYPE_NAMES[slot(type)] + " slots");
+        }
+        slots.live.push_back(true);
+        return slots.next++;
+    }
+
+    auto BindlessHeap::write_image(BindlessType type, uint32_t index, VkImageView view, VkImageLayout layout, VkSampler sampler) -> void {
+        if (!_slots[slot(type)].is_live(index)) {
+            throw std::runtime_error(std::string("Bindless ") + TYPE_NAMES[slot(type)] + " index is not allocated");
+        }
+
+        VkDescriptorImageInfo image_info = {
+            .sampler     = sampler,
+            .imageView   = view,
+            .imageLayout = layout
+        };
+
+        VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet          = _set,
+            .dstBinding      = static_cast<uint32_t>(type),
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = DESCRIPTOR_TYPES[slot(type)],
+            .pImageInfo       = &image_info,
+            .pBufferInfo      = nullptr,
+            .pTexelBufferView = nullptr
+        };
+
+        _api.vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+    }
+
+    auto BindlessHeap::write_buffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> void {
+        if (!_slots[slot(BindlessType::StorageBuffer)].is_live(index)) {
+            throw std::runtime_error("Bindless storage buffer index is not allocated");
+        }
+
+        VkDescriptorBufferInfo buffer_info = {
+            .buffer = buffer,
+            .offset = offset,
+            .range  = range
+        };
+
+        VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet          = _set,
+            .dstBinding      = static_cast<uint32_t>(BindlessType::StorageBuffer),
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo       = nullptr,
+            .pBufferInfo      = &buffer_info,
+            .pTexelBufferView = nullptr
+        };
+
+        _api.vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "dispatch.hpp"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    enum class BindlessType : uint8_t {
+        SampledImage,
+        StorageImage,
+        StorageBuffer,
+        Sampler,
+        Count
+    };
+
+    inline constexpr size_t BINDLESS_TYPE_COUNT = static_cast<size_t>(BindlessType::Count);
+
+    /**
+     * @brief One global descriptor set holding every shader-visible resource
+     *
+     * Each BindlessType is an update-after-bind, partially bound array at
+     * binding `static_cast<uint32_t>(type)` of a single set. Resources get a
+     * stable index into their array that shaders use directly, so draws bind
+     * the set once per command buffer instead of allocating sets per draw.
+     *
+     * Released indices stay reserved until the caller reports that the GPU
+     * has passed the value they were retired at, descriptors the GPU may
+     * still read are never overwritten.
+     *
+     * @code
+     * BindlessHeap::require_features(device);
+     * device.create_device();
+     *
+     * BindlessHeap heap(device);
+     * uint32_t albedo = heap.add_sampled_image(albedo_view);
+     * heap.bind(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0);
+     * // ... push `albedo` as a constant, index the array in the shader
+     * heap.release(BindlessType::SampledImage, albedo, frame_value);
+     * heap.recycle(completed_frame_value);
+     * @endcode
+     */
+    class BindlessHeap {
+      public:
+        struct Config {
+            std::array<uint32_t, BINDLESS_TYPE_COUNT> capacity = {
+                65536, // SampledImage
+                8192,  // StorageImage
+                65536, // StorageBuffer
+                2048   // Sampler
+            };
+            VkShaderStageFlags stages = VK_SHADER_STAGE_ALL;
+        };
+
+        struct Stats {
+            std::array<uint32_t, BINDLESS_TYPE_COUNT> capacity  = {};
+            std::array<uint32_t, BINDLESS_TYPE_COUNT> allocated = {}; // including retired, not yet recycled
+            uint32_t                                  retired   = 0;
+        };
+
+      private:
+        struct Retired {
+            BindlessType type;
+            uint32_t     index;
+            uint64_t     value;
+        };
+
+        struct Slots {
+            uint32_t              capacity = 0;
+            uint32_t              next     = 0; // never handed out above this
+            std::vector<uint32_t> free;
+            std::vector<bool>     live; // [index] handed out and not released since, `next` long
+
+            [[nodiscard]] auto is_live(uint32_t index) const noexcept -> bool {
+                return index < live.size() && live[index];
+            }
+        };
+
+        const DispatchTable&  _api;
+        VkDevice              _device;
+        VkDescriptorSetLayout _layout;
+        VkDescriptorPool      _pool;
+        VkDescriptorSet       _set;
+
+        mutable std::mutex                     _mutex;
+        std::array<Slots, BINDLESS_TYPE_COUNT> _slots;
+        std::deque<Retired>                    _retired;
+
+      public:
+        // Declares the descriptor indexing features the heap needs, call before create_device()
+        static auto require_features(Device& device) -> void;
+
+        explicit BindlessHeap(Device& device);
+        BindlessHeap(Device& device, const Config& config);
+        ~BindlessHeap();
+
+        BindlessHeap(const BindlessHeap&) = delete;
+        auto operator=(const BindlessHeap&) -> BindlessHeap& = delete;
+
+        BindlessHeap(BindlessHeap&&) = delete;
+        auto operator=(BindlessHeap&&) -> BindlessHeap& = delete;
+
+        [[nodiscard]] auto add_sampled_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) -> uint32_t;
+        [[nodiscard]] auto add_storage_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL) -> uint32_t;
+        [[nodiscard]] auto add_storage_buffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) -> uint32_t;
+        [[nodiscard]] auto add_sampler(VkSampler sampler) -> uint32_t;
+
+        // Points an index at another resource, e.g. after a resize; the GPU must no longer read the old one
+        auto update_sampled_image(uint32_t index, VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) -> void;
+        auto update_storage_image(uint32_t index, VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL) -> void;
+        auto update_storage_buffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) -> void;
+        auto update_sampler(uint32_t index, VkSampler sampler) -> void;
+
+        // The index becomes reusable once recycle() sees `retire_value`, e.g. the frame's timeline value.
+        // Throws when it isn't allocated, a second release would hand the slot out twice.
+        auto release(BindlessType type, uint32_t index, uint64_t retire_value) -> void;
+        auto recycle(uint64_t completed_value) -> void;
+
+        auto bind(VkCommandBuffer cmd, VkPipelineBindPoint bind_point, VkPipelineLayout pipeline_layout, uint32_t set_index) const -> void;
+
+        [[nodiscard]] auto layout() const noexcept -> VkDescriptorSetLayout;
+        [[nodiscard]] auto set() const noexcept -> VkDescriptorSet;
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        auto allocate(BindlessType type) -> uint32_t;
+        auto write_image(BindlessType type, uint32_t index, VkImageView view, VkImageLayout layout, VkSampler sampler) -> void;
+        auto write_buffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> void;
+    };
+
+} // namespace vulkron::gpu::vulkan
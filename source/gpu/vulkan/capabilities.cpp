@@ -0,0 +1,138 @@
+#include "capabilities.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    auto to_string(DeviceFeature feature) noexcept -> std::string_view {
+        switch (feature) {
+            case DeviceFeature::SamplerAnisotropy:                             return "samplerAnisotropy";
+            case DeviceFeature::MultiDrawIndirect:                             return "multiDrawIndirect";
+            case DeviceFeature::PipelineStatisticsQuery:                       return "pipelineStatisticsQuery";
+            case DeviceFeature::ShaderInt64:                                   return "shaderInt64";
+            case DeviceFeature::ShaderDrawParameters:                          return "shaderDrawParameters";
+            case DeviceFeature::DrawIndirectCount:                             return "drawIndirectCount";
+            case DeviceFeature::DescriptorIndexing:                            return "descriptorIndexing";
+            case DeviceFeature::RuntimeDescriptorArray:                        return "runtimeDescriptorArray";
+            case DeviceFeature::DescriptorBindingPartiallyBound:               return "descriptorBindingPartiallyBound";
+            case DeviceFeature::DescriptorBindingVariableDescriptorCount:      return "descriptorBindingVariableDescriptorCount";
+            case DeviceFeature::DescriptorBindingSampledImageUpdateAfterBind:  return "descriptorBindingSampledImageUpdateAfterBind";
+            case DeviceFeature::DescriptorBindingStorageImageUpdateAfterBind:  return "descriptorBindingStorageImageUpdateAfterBind";
+            case DeviceFeature::DescriptorBindingStorageBufferUpdateAfterBind: return "descriptorBindingStorageBufferUpdateAfterBind";
+            case DeviceFeature::ShaderSampledImageArrayNonUniformIndexing:     return "shaderSampledImageArrayNonUniformIndexing";
+            case DeviceFeature::ShaderStorageBufferArrayNonUniformIndexing:    return "shaderStorageBufferArrayNonUniformIndexing";
+            case DeviceFeature::ShaderStorageImageArrayNonUniformIndexing:     return "shaderStorageImageArrayNonUniformIndexing";
+            case DeviceFeature::ScalarBlockLayout:                             return "scalarBlockLayout";
+            case DeviceFeature::HostQueryReset:                                return "hostQueryReset";
+            case DeviceFeature::TimelineSemaphore:                             return "timelineSemaphore";
+            case DeviceFeature::BufferDeviceAddress:                           return "bufferDeviceAddress";
+            case DeviceFeature::PipelineCreationCacheControl:                  return "pipelineCreationCacheControl";
+            case DeviceFeature::Synchronization2:                              return "synchronization2";
+            case DeviceFeature::DynamicRendering:                              return "dynamicRendering";
+            case DeviceFeature::Maintenance4:                                  return "maintenance4";
+            case DeviceFeature::Maintenance5:                                  return "maintenance5";
+            case DeviceFeature::Count:                                         break;
+        }
+        return "unknown";
+    }
+
+    auto DeviceCapabilities::has(DeviceFeature feature) const noexcept -> bool {
+        return features.test(static_cast<size_t>(feature));
+    }
+
+    auto DeviceCapabilities::has(std::string_view extension) const noexcept -> bool {
+        return std::ranges::find(extensions, extension) != extensions.end();
+    }
+
+    FeatureChain::FeatureChain(uint32_t api_version) noexcept
+        : _api_version(api_version)
+    {
+        if (_api_version < VK_API_VERSION_1_1) _chain.unlink<VkPhysicalDeviceVulkan11Features>();
+        if (_api_version < VK_API_VERSION_1_2) _chain.unlink<VkPhysicalDeviceVulkan12Features>();
+        if (_api_version < VK_API_VERSION_1_3) _chain.unlink<VkPhysicalDeviceVulkan13Features>();
+        if (_api_version < VK_API_VERSION_1_4) _chain.unlink<VkPhysicalDeviceVulkan14Features>();
+    }
+
+    auto FeatureChain::query(const DispatchTable& api, VkPhysicalDevice gpu) -> void {
+        api.vkGetPhysicalDeviceFeatures2(gpu, _chain.head());
+    }
+
+    auto FeatureChain::get() noexcept -> VkPhysicalDeviceFeatures2* {
+        return _chain.head();
+    }
+
+    auto FeatureChain::flag(DeviceFeature feature) noexcept -> VkBool32* {
+        VkPhysicalDeviceFeatures&         vk10 = _chain.head()->features;
+        VkPhysicalDeviceVulkan11Features& vk11 = _chain.get<VkPhysicalDeviceVulkan11Features>();
+        VkPhysicalDeviceVulkan12Features& vk12 = _chain.get<VkPhysicalDeviceVulkan12Features>();
+        VkPhysicalDeviceVulkan13Features& vk13 = _chain.get<VkPhysicalDeviceVulkan13Features>();
+        VkPhysicalDeviceVulkan14Features& vk14 = _chain.get<VkPhysicalDeviceVulkan14Features>();
+
+        const bool has_vk11 = _api_version >= VK_API_VERSION_1_1;
+        const bool has_vk12 = _api_version >= VK_API_VERSION_1_2;
+        const bool has_vk13 = _api_version >= VK_API_VERSION_1_3;
+        const bool has_vk14 = _api_version >= VK_API_VERSION_1_4;
+
+        switch (feature) {
+            case DeviceFeature::SamplerAnisotropy:                             return &vk10.samplerAnisotropy;
+            case DeviceFeature::MultiDrawIndirect:                             return &vk10.multiDrawIndirect;
+            case DeviceFeature::PipelineStatisticsQuery:                       return &vk10.pipelineStatisticsQuery;
+            case DeviceFeature::ShaderInt64:                                   return &vk10.shaderInt64;
+            case DeviceFeature::ShaderDrawParameters:                          return has_vk11 ? &vk11.shaderDrawParameters : nullptr;
+            case DeviceFeature::DrawIndirectCount:                             return has_vk12 ? &vk12.drawIndirectCount : nullptr;
+            case DeviceFeature::DescriptorIndexing:                            return has_vk12 ? &vk12.descriptorIndexing : nullptr;
+            case DeviceFeature::RuntimeDescriptorArray:                        return has_vk12 ? &vk12.runtimeDescriptorArray : nullptr;
+            case DeviceFeature::DescriptorBindingPartiallyBound:               return has_vk12 ? &vk12.descriptorBindingPartiallyBound : nullptr;
+            case DeviceFeature::DescriptorBindingVariableDescriptorCount:      return has_vk12 ? &vk12.descriptorBindingVariableDescriptorCount : nullptr;
+            case DeviceFeature::DescriptorBindingSampledImageUpdateAfterBind:  return has_vk12 ? &vk12.descriptorBindingSampledImageUpdateAfterBind : nullptr;
+            case DeviceFeature::DescriptorBindingStorageImageUpdateAfterBind:  return has_vk12 ? &vk12.descriptorBindingStorageImageUpdateAfterBind : nullptr;
+            case DeviceFeature::DescriptorBindingStorageBufferUpdateAfterBind: return has_vk12 ? &vk12.descriptorBindingStorageBufferUpdateAfterBind : nullptr;
+            case DeviceFeature::ShaderSampledImageArrayNonUniformIndexing:     return has_vk12 ? &vk12.shaderSampledImageArrayNonUniformIndexing : nullptr;
+            case DeviceFeature::ShaderStorageBufferArrayNonUniformIndexing:    return has_vk12 ? &vk12.shaderStorageBufferArrayNonUniformIndexing : nullptr;
+            case DeviceFeature::ShaderStorageImageArrayNonUniformIndexing:     return has_vk12 ? &vk12.shaderStorageImageArrayNonUniformIndexing : nullptr;
+            case DeviceFeature::ScalarBlockLayout:                             return has_vk12 ? &vk12.scalarBlockLayout : nullptr;
+            case DeviceFeature::HostQueryReset:                                return has_vk12 ? &vk12.hostQueryReset : nullptr;
+            case DeviceFeature::TimelineSemaphore:                             return has_vk12 ? &vk12.timelineSemaphore : nullptr;
+            case DeviceFeature::BufferDeviceAddress:                           return has_vk12 ? &vk12.bufferDeviceAddress : nullptr;
+            case DeviceFeature::PipelineCreationCacheControl:                  return has_vk13 ? &vk13.pipelineCreationCacheControl : nullptr;
+            case DeviceFeature::Synchronization2:                              return has_vk13 ? &vk13.synchronization2 : nullptr;
+            case DeviceFeature::DynamicRendering:                              return has_vk13 ? &vk13.dynamicRendering : nullptr;
+            case DeviceFeature::Maintenance4:                                  return has_vk13 ? &vk13.maintenance4 : nullptr;
+            case DeviceFeature::Maintenance5:                                  return has_vk14 ? &vk14.maintenance5 : nullptr;
+            case DeviceFeature::Count:                                         break;
+        }
+        return nullptr;
+    }
+
+    auto FeatureChain::supports(DeviceFeature feature) noexcept -> bool {
+        const VkBool32* value = flag(feature);
+        return value != nullptr && *value == VK_TRUE;
+    }
+
+    auto device_api_version(const DispatchTable& api, VkPhysicalDevice gpu) -> uint32_t {
+        VkPhysicalDeviceProperties properties;
+        api.vkGetPhysicalDeviceProperties(gpu, &properties);
+        return properties.apiVersion;
+    }
+
+    auto device_extensions(const DispatchTable& api, VkPhysicalDevice gpu) -> std::vector<std::string> {
+        uint32_t extension_count = 0;
+        if (api.vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extension_count, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to enumerate device extensions");
+        }
+
+        std::vector<VkExtensionProperties> properties(extension_count);
+        api.vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extension_count, properties.data());
+
+        std::vector<std::string> extensions;
+        extensions.reserve(extension_count);
+        for (uint32_t i = 0; i < extension_count; ++i) {
+            extensions.emplace_back(properties[i].extensionName);
+        }
+
+        std::ranges::sort(extensions);
+        return extensions;
+    }
+
+} // namespace vulkron::gpu::vulkan
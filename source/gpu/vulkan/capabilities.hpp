@@ -0,0 +1,111 @@
+#pragma once
+
+#include "dispatch.hpp"
+#include "structchain.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Device features the engine knows how to negotiate
+     *
+     * Each entry maps onto one VkBool32 of VkPhysicalDeviceFeatures or of the
+     * core VkPhysicalDeviceVulkan1XFeatures structs.
+     */
+    enum class DeviceFeature : uint8_t {
+        // Vulkan 1.0
+        SamplerAnisotropy,
+        MultiDrawIndirect,
+        PipelineStatisticsQuery,
+        ShaderInt64,
+
+        // Vulkan 1.1
+        ShaderDrawParameters,
+
+        // Vulkan 1.2
+        DrawIndirectCount,
+        DescriptorIndexing,
+        RuntimeDescriptorArray,
+        DescriptorBindingPartiallyBound,
+        DescriptorBindingVariableDescriptorCount,
+        DescriptorBindingSampledImageUpdateAfterBind,
+        DescriptorBindingStorageImageUpdateAfterBind,
+        DescriptorBindingStorageBufferUpdateAfterBind,
+        ShaderSampledImageArrayNonUniformIndexing,
+        ShaderStorageBufferArrayNonUniformIndexing,
+        ShaderStorageImageArrayNonUniformIndexing,
+        ScalarBlockLayout,
+        HostQueryReset,
+        TimelineSemaphore,
+        BufferDeviceAddress,
+
+        // Vulkan 1.3
+        PipelineCreationCacheControl,
+        Synchronization2,
+        DynamicRendering,
+        Maintenance4,
+
+        // Vulkan 1.4
+        Maintenance5,
+
+        Count
+    };
+
+    inline constexpr size_t DEVICE_FEATURE_COUNT = static_cast<size_t>(DeviceFeature::Count);
+
+    [[nodiscard]] auto to_string(DeviceFeature feature) noexcept -> std::string_view;
+
+    enum class Requirement : uint8_t {
+        Required, // create_device() throws when it is missing
+        Optional  // Enabled when supported, check DeviceCapabilities afterwards
+    };
+
+    /**
+     * @brief What a device ended up with after negotiation
+     */
+    struct DeviceCapabilities {
+        uint32_t                          api_version = 0;
+        std::bitset<DEVICE_FEATURE_COUNT> features;
+        std::vector<std::string>          extensions;
+
+        [[nodiscard]] auto has(DeviceFeature feature) const noexcept -> bool;
+        [[nodiscard]] auto has(std::string_view extension) const noexcept -> bool;
+    };
+
+    /**
+     * @brief Owns the full core feature chain, either queried or to be enabled
+     *
+     * Structs for core versions above `api_version` are left out of the chain,
+     * their features are reported as unavailable.
+     */
+    class FeatureChain {
+        StructChain<VkPhysicalDeviceFeatures2,
+                    VkPhysicalDeviceVulkan11Features,
+                    VkPhysicalDeviceVulkan12Features,
+                    VkPhysicalDeviceVulkan13Features,
+                    VkPhysicalDeviceVulkan14Features> _chain;
+
+        uint32_t _api_version;
+
+      public:
+        explicit FeatureChain(uint32_t api_version) noexcept;
+
+        auto query(const DispatchTable& api, VkPhysicalDevice gpu) -> void;
+
+        [[nodiscard]] auto get() noexcept -> VkPhysicalDeviceFeatures2*;
+
+        // nullptr when the feature belongs to a core version the device doesn't expose
+        [[nodiscard]] auto flag(DeviceFeature feature) noexcept -> VkBool32*;
+        [[nodiscard]] auto supports(DeviceFeature feature) noexcept -> bool;
+    };
+
+    [[nodiscard]] auto device_api_version(const DispatchTable& api, VkPhysicalDevice gpu) -> uint32_t;
+    [[nodiscard]] auto device_extensions(const DispatchTable& api, VkPhysicalDevice gpu) -> std::vector<std::string>;
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,387 @@
+#include "command_recorder.hpp"
+#include "device.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        auto create_pool(const DispatchTable& api, VkDevice device, uint32_t queue_family) -> VkCommandPool {
+            // Transient: buffers are re-recorded every frame and only ever reset with the whole pool
+            VkCommandPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = queue_family
+            };
+
+            VkCommandPool pool = VK_NULL_HANDLE;
+            if (api.vkCreateCommandPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create command pool");
+            }
+            return pool;
+        }
+
+        auto allocate_buffer(const DispatchTable& api, VkDevice device, VkCommandPool pool, VkCommandBufferLevel level) -> VkCommandBuffer {
+            VkCommandBufferAllocateInfo allocate_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool        = pool,
+                .level              = level,
+                .commandBufferCount = 1
+            };
+
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            if (api.vkAllocateCommandBuffers(device, &allocate_info, &cmd) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate command buffer");
+            }
+            return cmd;
+        }
+
+        auto milliseconds(std::chrono::steady_clock::duration duration) -> double {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+    } // namespace
+
+    CommandRecorder::CommandRecorder(Device& device, support::JobSystem& jobs, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _jobs(jobs),
+        _config(config),
+        _lanes(jobs.thread_count() + 1)
+    {
+        if (_config.queue == VK_NULL_HANDLE) {
+            throw std::runtime_error("CommandRecorder needs a queue");
+        }
+        _config.frames_in_flight = std::max(_config.frames_in_flight, 1u);
+
+        VkSemaphoreTypeCreateInfo type_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue  = 0
+        };
+
+        VkSemaphoreCreateInfo semaphore_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+            .flags = 0
+        };
+
+        if (_api.vkCreateSemaphore(_device, &semaphore_info, nullptr, &_timeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create command recorder timeline semaphore");
+        }
+
+        _frames.resize(_config.frames_in_flight);
+        _pools.resize(static_cast<size_t>(_config.frames_in_flight) * _lanes);
+
+        try {
+            for (Frame& frame : _frames) {
+                frame.pool    = create_pool(_api, _device, _config.queue_family);
+                frame.primary = allocate_buffer(_api, _device, frame.pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+            }
+            for (Pool& pool : _pools) {
+                pool.pool = create_pool(_api, _device, _config.queue_family);
+            }
+        } catch (...) {
+            for (Pool& pool : _pools) {
+                _api.vkDestroyCommandPool(_device, pool.pool, nullptr);
+            }
+            for (Frame& frame : _frames) {
+                _api.vkDestroyCommandPool(_device, frame.pool, nullptr);
+            }
+            _api.vkDestroySemaphore(_device, _timeline, nullptr);
+            throw;
+        }
+
+        _stats.lanes = _lanes;
+    }
+
+    CommandRecorder::~CommandRecorder() {
+        try {
+            wait_idle();
+        } catch (const std::runtime_error&) {
+            // The wait only fails once the device is lost, nothing executes on it any more
+        }
+
+        for (Pool& pool : _pools) {
+            _api.vkDestroyCommandPool(_device, pool.pool, nullptr);
+        }
+        for (Frame& frame : _frames) {
+            _api.vkDestroyCommandPool(_device, frame.pool, nullptr);
+        }
+        _api.vkDestroySemaphore(_device, _timeline, nullptr);
+    }
+
+    auto CommandRecorder::begin_frame() -> VkCommandBuffer {
+        if (_recording) {
+            throw std::runtime_error("begin_frame() called twice without end_frame()");
+        }
+
+        Frame& frame = _frames[_frame];
+        if (frame.value > completed_value()) {
+            ++_stats.frame_waits;
+            wait_value(frame.value);
+        }
+        _frame_start = Clock::now();
+        if (_stats.frames == 0) {
+            _first_frame_start = _frame_start;
+        }
+
+        // One reset per pool recycles every buffer recorded from it
+        _api.vkResetCommandPool(_device, frame.pool, 0);
+        for (uint32_t lane = 0; lane < _lanes; ++lane) {
+            Pool& pool = _pools[static_cast<size_t>(_frame) * _lanes + lane];
+            if (pool.used != 0) {
+                _api.vkResetCommandPool(_device, pool.pool, 0);
+                pool.used = 0;
+            }
+        }
+
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr
+        };
+
+        if (_api.vkBeginCommandBuffer(frame.primary, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin frame command buffer");
+        }
+
+        _recording = true;
+        return frame.primary;
+    }
+
+    auto CommandRecorder::record_parallel(uint32_t tasks, const RecordFunction& record, const RenderingInheritance* rendering) -> void {
+        if (!_recording) {
+            throw std::runtime_error("record_parallel() outside of begin_frame() and end_frame()");
+        }
+        if (tasks == 0) {
+            return;
+        }
+
+        VkCommandBufferInheritanceRenderingInfo rendering_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .viewMask = 0,
+            .colorAttachmentCount    = 0,
+            .pColorAttachmentFormats = nullptr,
+            .depthAttachmentFormat   = VK_FORMAT_UNDEFINED,
+            .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+            .rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT
+        };
+
+        if (rendering != nullptr) {
+            rendering_info.colorAttachmentCount    = static_cast<uint32_t>(rendering->color_formats.size());
+            rendering_info.pColorAttachmentFormats = rendering->color_formats.data();
+            rendering_info.depthAttachmentFormat   = rendering->depth_format;
+            rendering_info.stencilAttachmentFormat = rendering->stencil_format;
+            rendering_info.rasterizationSamples    = rendering->samples;
+        }
+
+        VkCommandBufferInheritanceInfo inheritance = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = rendering != nullptr ? &rendering_info : nullptr,
+            .renderPass           = VK_NULL_HANDLE, // dynamic rendering
+            .subpass              = 0,
+            .framebuffer          = VK_NULL_HANDLE,
+            .occlusionQueryEnable = VK_FALSE,
+            .queryFlags           = 0,
+            .pipelineStatistics   = 0
+        };
+
+        VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (rendering != nullptr) {
+            usage |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
+
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = usage,
+            .pInheritanceInfo = &inheritance
+        };
+
+        _recorded.assign(tasks, VK_NULL_HANDLE);
+
+        // Any lane may end up with every task, grow the buffer lists here rather than on the workers
+        for (uint32_t lane = 0; lane < _lanes; ++lane) {
+            Pool& pool = _pools[static_cast<size_t>(_frame) * _lanes + lane];
+            pool.buffers.reserve(pool.used + tasks);
+        }
+
+        std::atomic<uint32_t> next = 0;
+        std::mutex            error_mutex;
+        std::exception_ptr    error;
+
+        // A lane records whichever tasks it gets to first into its own pool
+        const auto record_lane = [&](uint32_t lane) {
+            for (uint32_t task = next.fetch_add(1, std::memory_order_relaxed); task < tasks; task = next.fetch_add(1, std::memory_order_relaxed)) {
+                try {
+                    VkCommandBuffer cmd = secondary(lane);
+                    if (_api.vkBeginCommandBuffer(cmd, &begin_info) != VK_SUCCESS) {
+                        throw std::runtime_error("Failed to begin secondary command buffer");
+                    }
+                    record(cmd, task);
+                    if (_api.vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+                        throw std::runtime_error("Failed to end secondary command buffer");
+                    }
+                    _recorded[task] = cmd;
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        const uint32_t lanes = std::min(tasks, _lanes);
+        if (lanes == 1) {
+            record_lane(0);
+        } else {
+            support::JobCounter counter;
+            for (uint32_t i = 0; i < lanes; ++i) {
+                _jobs.run([&record_lane, i] { record_lane(i); }, &counter);
+            }
+            _jobs.wait(counter);
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        _api.vkCmdExecuteCommands(_frames[_frame].primary, tasks, _recorded.data());
+        _stats.secondaries += tasks;
+    }
+
+    auto CommandRecorder::end_frame(std::span<const VkSemaphoreSubmitInfo> waits, std::span<const VkSemaphoreSubmitInfo> signals) -> uint64_t {
+        if (!_recording) {
+            throw std::runtime_error("end_frame() without begin_frame()");
+        }
+        _recording = false;
+
+        Frame& frame = _frames[_frame];
+        if (_api.vkEndCommandBuffer(frame.primary) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to end frame command buffer");
+        }
+
+        const uint64_t value = _submitted + 1;
+
+        _signals.assign(signals.begin(), signals.end());
+        _signals.push_back(VkSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .semaphore   = _timeline,
+            .value       = value,
+            .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        });
+
+        VkCommandBufferSubmitInfo command_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = frame.primary,
+            .deviceMask    = 0
+        };
+
+        VkSubmitInfo2 submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = 0,
+            .waitSemaphoreInfoCount   = static_cast<uint32_t>(waits.size()),
+            .pWaitSemaphoreInfos      = waits.data(),
+            .commandBufferInfoCount   = 1,
+            .pCommandBufferInfos      = &command_info,
+            .signalSemaphoreInfoCount = static_cast<uint32_t>(_signals.size()),
+            .pSignalSemaphoreInfos    = _signals.data()
+        };
+
+        if (_api.vkQueueSubmit2(_config.queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit frame");
+        }
+
+        _submitted  = value;
+        frame.value = value;
+        _frame      = (_frame + 1) % _config.frames_in_flight;
+
+        const Clock::time_point now       = Clock::now();
+        const double            record_ms = milliseconds(now - _frame_start);
+        ++_stats.frames;
+        _stats.last_record_ms = record_ms;
+        _total_record_ms += record_ms;
+        _stats.mean_record_ms = _total_record_ms / static_cast<double>(_stats.frames);
+
+        const double elapsed_ms = milliseconds(now - _first_frame_start);
+        if (elapsed_ms > 0.0) {
+            _stats.frames_per_second = static_cast<double>(_stats.frames) * 1000.0 / elapsed_ms;
+        }
+
+        return value;
+    }
+
+    auto CommandRecorder::wait_idle() -> void {
+        wait_value(_submitted);
+    }
+
+    auto CommandRecorder::frame_index() const noexcept -> uint32_t {
+        return _frame;
+    }
+
+    auto CommandRecorder::semaphore() const noexcept -> VkSemaphore {
+        return _timeline;
+    }
+
+    auto CommandRecorder::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query command recorder timeline semaphore");
+        }
+        return value;
+    }
+
+    auto CommandRecorder::submitted_value() const noexcept -> uint64_t {
+        return _submitted;
+    }
+
+    auto CommandRecorder::stats() const noexcept -> Stats {
+        return _stats;
+    }
+
+    auto CommandRecorder::secondary(uint32_t lane) -> VkCommandBuffer {
+        Pool& pool = _pools[static_cast<size_t>(_frame) * _lanes + lane];
+
+        if (pool.used == pool.buffers.size()) {
+            pool.buffers.push_back(allocate_buffer(_api, _device, pool.pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+        }
+        return pool.buffers[pool.used++];
+    }
+
+    auto CommandRecorder::wait_value(uint64_t value) const -> void {
+        if (value == 0) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores    = &_timeline,
+            .pValues        = &value
+        };
+
+        if (_api.vkWaitSemaphores(_device, &wait_info, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to wait on command recorder timeline semaphore");
+        }
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "dispatch.hpp"
+#include "support/jobs/job_system.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    // Attachment formats secondaries inherit when they are executed inside vkCmdBeginRendering
+    struct RenderingInheritance {
+        std::span<const VkFormat> color_formats;
+        VkFormat                  depth_format   = VK_FORMAT_UNDEFINED;
+        VkFormat                  stencil_format = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits     samples        = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    /**
+     * @brief Records a frame's commands on several threads and submits them as one
+     *
+     * record_parallel() runs one job per recording lane on the JobSystem,
+     * one lane per worker plus one for the waiting caller. Each lane owns a
+     * command pool per frame in flight, so recording never locks, whichever
+     * thread ends up running the lane. A frame's pools are recycled with a
+     * single vkResetCommandPool each once the timeline semaphore shows the
+     * GPU is done with them; command buffers are never freed, only reused.
+     *
+     * Lanes pull tasks from a shared counter and record each into its own
+     * secondary, which are then executed in task order in the frame's
+     * primary, so results don't depend on which lane picked up which task.
+     *
+     * @code
+     * CommandRecorder recorder(device, jobs, {.queue = queues.graphics.handle, .queue_family = queues.graphics.family});
+     *
+     * const DispatchTable& api = device.dispatch();
+     *
+     * VkCommandBuffer cmd = recorder.begin_frame();
+     * api.vkCmdBeginRendering(cmd, &rendering); // with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT
+     * recorder.record_parallel(64, [&](VkCommandBuffer secondary, uint32_t task) {
+     *     draw_chunk(secondary, task);
+     * }, &inheritance);
+     * api.vkCmdEndRendering(cmd);
+     * recorder.end_frame();
+     * @endcode
+     */
+    class CommandRecorder {
+      public:
+        using RecordFunction = std::function<void(VkCommandBuffer cmd, uint32_t task)>;
+
+        struct Config {
+            VkQueue  queue;
+            uint32_t queue_family;
+            uint32_t frames_in_flight = 2;
+        };
+
+        struct Stats {
+            uint64_t frames            = 0;
+            uint64_t secondaries       = 0;
+            uint64_t frame_waits       = 0; // begin_frame() calls that blocked on the GPU
+            uint32_t lanes             = 0; // secondaries recorded concurrently at most
+            double   last_record_ms    = 0.0; // begin_frame() to end_frame() of the last frame
+            double   mean_record_ms    = 0.0;
+            double   frames_per_second = 0.0; // submitted frames over the time since the first begin_frame()
+        };
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        // One per recording lane and frame in flight
+        struct Pool {
+            VkCommandPool                pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> buffers;
+            size_t                       used = 0;
+        };
+
+        struct Frame {
+            VkCommandPool   pool    = VK_NULL_HANDLE;
+            VkCommandBuffer primary = VK_NULL_HANDLE;
+            uint64_t        value   = 0; // timeline value of its last submission
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        support::JobSystem&  _jobs;
+        Config               _config;
+        uint32_t             _lanes;
+
+        VkSemaphore _timeline  = VK_NULL_HANDLE;
+        uint64_t    _submitted = 0;
+
+        std::vector<Frame> _frames;
+        std::vector<Pool>  _pools; // [frame * _lanes + lane]
+        uint32_t           _frame     = 0;
+        bool               _recording = false;
+        Clock::time_point  _frame_start;
+        Clock::time_point  _first_frame_start;
+
+        std::vector<VkCommandBuffer>       _recorded; // secondaries of the current call, in task order
+        std::vector<VkSemaphoreSubmitInfo> _signals;
+
+        Stats  _stats;
+        double _total_record_ms = 0.0;
+
+      public:
+        CommandRecorder(Device& device, support::JobSystem& jobs, const Config& config);
+        ~CommandRecorder();
+
+        CommandRecorder(const CommandRecorder&) = delete;
+        auto operator=(const CommandRecorder&) -> CommandRecorder& = delete;
+
+        CommandRecorder(CommandRecorder&&) = delete;
+        auto operator=(CommandRecorder&&) -> CommandRecorder& = delete;
+
+        // Waits for the oldest frame in flight, recycles its pools and begins its primary
+        [[nodiscard]] auto begin_frame() -> VkCommandBuffer;
+
+        // Records `tasks` secondaries in parallel and executes them in order in the primary
+        auto record_parallel(uint32_t tasks, const RecordFunction& record, const RenderingInheritance* rendering = nullptr) -> void;
+
+        // Submits the primary, returns the timeline value that signals its completion
+        auto end_frame(std::span<const VkSemaphoreSubmitInfo> waits = {}, std::span<const VkSemaphoreSubmitInfo> signals = {}) -> uint64_t;
+
+        auto wait_idle() -> void;
+
+        // Frame in flight being recorded, or the next one outside begin_frame() and end_frame()
+        [[nodiscard]] auto frame_index() const noexcept -> uint32_t;
+
+        [[nodiscard]] auto semaphore() const noexcept -> VkSemaphore;
+        [[nodiscard]] auto completed_value() const -> uint64_t;
+        [[nodiscard]] auto submitted_value() const noexcept -> uint64_t;
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+      private:
+        auto secondary(uint32_t lane) -> VkCommandBuffer;
+        auto wait_value(uint64_t value) const -> void;
+    };
+
+} // namespace vulkron::gpu::vulkan
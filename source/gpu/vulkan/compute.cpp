@@ -0,0 +1,467 @@
+#include "compute.hpp"
+#include "device.hpp"
+#include "disk_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+        // Every implementation supports at least this much, kernels stay portable
+        constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 128;
+
+        constexpr DeviceFeature REQUIRED_FEATURES[] = {
+            DeviceFeature::BufferDeviceAddress,
+            DeviceFeature::ShaderInt64 // pointer arithmetic on device addresses
+        };
+
+        // Writes of dispatches, fills and copies before the barrier, any read or write of them after it
+        constexpr VkMemoryBarrier2 BATCH_BARRIER = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+            .dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT |
+                             VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT
+        };
+
+        // Device writes only reach mapped memory through a barrier into the host domain
+        constexpr VkMemoryBarrier2 HOST_BARRIER = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask  = VK_PIPELINE_STAGE_2_HOST_BIT,
+            .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT
+        };
+
+        auto record_barrier(const DispatchTable& api, VkCommandBuffer cmd, const VkMemoryBarrier2& barrier) -> void {
+            VkDependencyInfo dependency = {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags = 0,
+                .memoryBarrierCount       = 1,
+                .pMemoryBarriers          = &barrier,
+                .bufferMemoryBarrierCount = 0,
+                .pBufferMemoryBarriers    = nullptr,
+                .imageMemoryBarrierCount  = 0,
+                .pImageMemoryBarriers     = nullptr
+            };
+            api.vkCmdPipelineBarrier2(cmd, &dependency);
+        }
+
+        auto compute_queue(const Device& device) -> ComputeQueue::Config {
+            const QueueSet& queues = device.queues();
+            const Queue&    queue  = queues.compute.valid() ? queues.compute : queues.graphics;
+            return {.queue = queue.handle, .queue_family = queue.family};
+        }
+
+    } // namespace
+
+    ComputeKernel::ComputeKernel(Device& device, const ComputeKernelDesc& desc)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _push_constant_size(desc.push_constant_size)
+    {
+        if (desc.shader.stage != VK_SHADER_STAGE_COMPUTE_BIT) {
+            throw std::runtime_error("Compute kernel needs a compute stage");
+        }
+        if (_push_constant_size > MAX_PUSH_CONSTANT_SIZE || _push_constant_size % 4 != 0) {
+            throw std::runtime_error("Compute kernel push constants must be a multiple of 4 bytes, " + std::to_string(MAX_PUSH_CONSTANT_SIZE) + " at most");
+        }
+        if (desc.shader.spirv.empty()) {
+            throw std::runtime_error("Compute kernel has no SPIR-V");
+        }
+
+        VkPushConstantRange push_range = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = _push_constant_size
+        };
+
+        VkPipelineLayoutCreateInfo layout_info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount         = static_cast<uint32_t>(desc.set_layouts.size()),
+            .pSetLayouts            = desc.set_layouts.data(),
+            .pushConstantRangeCount = _push_constant_size != 0 ? 1u : 0u,
+            .pPushConstantRanges    = &push_range
+        };
+
+        if (_api.vkCreatePipelineLayout(_device, &layout_info, nullptr, &_layout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute kernel pipeline layout");
+        }
+
+        VkShaderModuleCreateInfo module_info = {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .codeSize = desc.shader.spirv.size() * sizeof(uint32_t),
+            .pCode    = desc.shader.spirv.data()
+        };
+
+        VkShaderModule module = VK_NULL_HANDLE;
+        if (_api.vkCreateShaderModule(_device, &module_info, nullptr, &module) != VK_SUCCESS) {
+            _api.vkDestroyPipelineLayout(_device, _layout, nullptr);
+            throw std::runtime_error("Failed to create compute kernel shader module");
+        }
+
+        VkComputePipelineCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = module,
+                .pName  = desc.shader.entry_point.c_str(),
+                .pSpecializationInfo = nullptr
+            },
+            .layout = _layout,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex  = -1
+        };
+
+        const VkResult result = _api.vkCreateComputePipelines(_device, device.pipeline_cache().thread_handle(), 1, &create_info, nullptr, &_pipeline);
+        _api.vkDestroyShaderModule(_device, module, nullptr);
+
+        if (result != VK_SUCCESS) {
+            _api.vkDestroyPipelineLayout(_device, _layout, nullptr);
+            throw std::runtime_error("Failed to create compute kernel pipeline");
+        }
+    }
+
+    ComputeKernel::~ComputeKernel() {
+        _api.vkDestroyPipeline(_device, _pipeline, nullptr);
+        _api.vkDestroyPipelineLayout(_device, _layout, nullptr);
+    }
+
+    auto ComputeKernel::pipeline() const noexcept -> VkPipeline {
+        return _pipeline;
+    }
+
+    auto ComputeKernel::layout() const noexcept -> VkPipelineLayout {
+        return _layout;
+    }
+
+    auto ComputeKernel::push_constant_size() const noexcept -> uint32_t {
+        return _push_constant_size;
+    }
+
+    auto ComputeQueue::require_features(Device& device) -> void {
+        for (DeviceFeature feature : REQUIRED_FEATURES) {
+            device.require_feature(feature);
+        }
+    }
+
+    ComputeQueue::ComputeQueue(Device& device)
+        : ComputeQueue(device, compute_queue(device))
+    {
+    }
+
+    ComputeQueue::ComputeQueue(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _config(config)
+    {
+        if (_config.queue == VK_NULL_HANDLE) {
+            throw std::runtime_error("ComputeQueue needs a queue");
+        }
+        _config.batches_in_flight = std::max(_config.batches_in_flight, 1u);
+
+        VkSemaphoreTypeCreateInfo type_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue  = 0
+        };
+
+        VkSemaphoreCreateInfo semaphore_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+            .flags = 0
+        };
+
+        if (_api.vkCreateSemaphore(_device, &semaphore_info, nullptr, &_timeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute queue timeline semaphore");
+        }
+
+        // Transient: a batch is recorded once and only ever reset with its pool
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = _config.queue_family
+        };
+
+        _batches.resize(_config.batches_in_flight);
+        for (Batch& batch : _batches) {
+            bool created = _api.vkCreateCommandPool(_device, &pool_info, nullptr, &batch.pool) == VK_SUCCESS;
+
+            if (created) {
+                VkCommandBufferAllocateInfo allocate_info = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                    .pNext = nullptr,
+                    .commandPool        = batch.pool,
+                    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                    .commandBufferCount = 1
+                };
+                created = _api.vkAllocateCommandBuffers(_device, &allocate_info, &batch.cmd) == VK_SUCCESS;
+            }
+
+            if (!created) {
+                for (Batch& other : _batches) {
+                    _api.vkDestroyCommandPool(_device, other.pool, nullptr);
+                }
+                _api.vkDestroySemaphore(_device, _timeline, nullptr);
+                throw std::runtime_error("Failed to create compute queue command buffers");
+            }
+        }
+    }
+
+    ComputeQueue::~ComputeQueue() {
+        // A batch left open was never submitted, the GPU only has to finish the others.
+        // The wait only fails once the device is lost, nothing executes on it any more.
+        try {
+            wait_idle();
+        } catch (const std::runtime_error&) {
+        }
+
+        for (Batch& batch : _batches) {
+            _api.vkDestroyCommandPool(_device, batch.pool, nullptr);
+        }
+        _api.vkDestroySemaphore(_device, _timeline, nullptr);
+    }
+
+    auto ComputeQueue::dispatch(const ComputeKernel& kernel, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z, std::span<const std::byte> push) -> void {
+        if (groups_x == 0 || groups_y == 0 || groups_z == 0) {
+            return;
+        }
+
+        VkCommandBuffer cmd = prepare();
+        bind(cmd, kernel, push);
+        _api.vkCmdDispatch(cmd, groups_x, groups_y, groups_z);
+
+        _written = true;
+        ++_stats.dispatches;
+    }
+
+    auto ComputeQueue::dispatch_indirect(const ComputeKernel& kernel, VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> push) -> void {
+        VkCommandBuffer cmd = prepare();
+        bind(cmd, kernel, push);
+        _api.vkCmdDispatchIndirect(cmd, buffer, offset);
+
+        _written = true;
+        ++_stats.dispatches;
+    }
+
+    auto ComputeQueue::barrier() -> void {
+        _pending = _written;
+    }
+
+    auto ComputeQueue::command_buffer() -> VkCommandBuffer {
+        VkCommandBuffer cmd = prepare();
+
+        // Whatever the caller records is assumed to write, and may bind a pipeline of its own
+        _written = true;
+        _bound   = VK_NULL_HANDLE;
+        return cmd;
+    }
+
+    auto ComputeQueue::submit(std::span<const VkSemaphoreSubmitInfo> waits, std::span<const VkSemaphoreSubmitInfo> signals) -> uint64_t {
+        if (!_recording) {
+            if (waits.empty() && signals.empty()) {
+                return _submitted;
+            }
+            // Nothing recorded, but the semaphores still have to be waited on and signalled in order
+            static_cast<void>(prepare());
+        }
+
+        Batch& batch = _batches[_batch];
+        if (_written) {
+            record_barrier(_api, batch.cmd, HOST_BARRIER);
+        }
+        // A pending barrier and unordered writes carry over, barrier() orders against earlier batches too
+        _recording = false;
+        _bound     = VK_NULL_HANDLE;
+
+        if (_api.vkEndCommandBuffer(batch.cmd) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to end compute batch command buffer");
+        }
+
+        const uint64_t value = _submitted + 1;
+
+        _signals.assign(signals.begin(), signals.end());
+        _signals.push_back(VkSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .semaphore   = _timeline,
+            .value       = value,
+            .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        });
+
+        VkCommandBufferSubmitInfo command_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = batch.cmd,
+            .deviceMask    = 0
+        };
+
+        VkSubmitInfo2 submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = 0,
+            .waitSemaphoreInfoCount   = static_cast<uint32_t>(waits.size()),
+            .pWaitSemaphoreInfos      = waits.data(),
+            .commandBufferInfoCount   = 1,
+            .pCommandBufferInfos      = &command_info,
+            .signalSemaphoreInfoCount = static_cast<uint32_t>(_signals.size()),
+            .pSignalSemaphoreInfos    = _signals.data()
+        };
+
+        if (_api.vkQueueSubmit2(_config.queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit compute batch");
+        }
+
+        _submitted  = value;
+        batch.value = value;
+        _batch      = (_batch + 1) % _config.batches_in_flight;
+        ++_stats.batches;
+
+        return value;
+    }
+
+    auto ComputeQueue::wait(uint64_t value) const -> void {
+        if (value == 0) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores    = &_timeline,
+            .pValues        = &value
+        };
+
+        if (_api.vkWaitSemaphores(_device, &wait_info, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to wait on compute queue timeline semaphore");
+        }
+    }
+
+    auto ComputeQueue::wait_idle() const -> void {
+        wait(_submitted);
+    }
+
+    auto ComputeQueue::semaphore() const noexcept -> VkSemaphore {
+        return _timeline;
+    }
+
+    auto ComputeQueue::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query compute queue timeline semaphore");
+        }
+        return value;
+    }
+
+    auto ComputeQueue::submitted_value() const noexcept -> uint64_t {
+        return _submitted;
+    }
+
+    auto ComputeQueue::stats() const noexcept -> Stats {
+        return _stats;
+    }
+
+    auto ComputeQueue::prepare() -> VkCommandBuffer {
+        Batch& batch = _batches[_batch];
+
+        if (!_recording) {
+            if (batch.value > completed_value()) {
+                ++_stats.batch_waits;
+                wait(batch.value);
+            }
+
+            _api.vkResetCommandPool(_device, batch.pool, 0);
+
+            VkCommandBufferBeginInfo begin_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                .pInheritanceInfo = nullptr
+            };
+
+            if (_api.vkBeginCommandBuffer(batch.cmd, &begin_info) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin compute batch command buffer");
+            }
+            _recording = true;
+        }
+
+        if (_pending) {
+            record_barrier(_api, batch.cmd, BATCH_BARRIER);
+            _pending = false;
+            _written = false;
+            ++_stats.barriers;
+        }
+        return batch.cmd;
+    }
+
+    auto ComputeQueue::bind(VkCommandBuffer cmd, const ComputeKernel& kernel, std::span<const std::byte> push) -> void {
+        if (push.size() > kernel.push_constant_size() || push.size() % 4 != 0) {
+            throw std::runtime_error("Push constants don't fit the compute kernel's range");
+        }
+
+        if (_bound != kernel.pipeline()) {
+            _api.vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.pipeline());
+            _bound = kernel.pipeline();
+            ++_stats.pipeline_binds;
+        }
+
+        if (!push.empty()) {
+            _api.vkCmdPushConstants(cmd, kernel.layout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, static_cast<uint32_t>(push.size()), push.data());
+        }
+    }
+
+    auto read_spirv(const std::filesystem::path& path) -> std::vector<uint32_t> {
+        const MappedFile                 file(path);
+        const std::span<const std::byte> bytes = file.bytes();
+
+        uint32_t magic = 0;
+        if (bytes.size() >= sizeof(magic)) {
+            std::memcpy(&magic, bytes.data(), sizeof(magic));
+        }
+        if (bytes.size() % sizeof(uint32_t) != 0 || magic != SPIRV_MAGIC) {
+            throw std::runtime_error("Not a SPIR-V binary: " + path.string());
+        }
+
+        std::vector<uint32_t> spirv(bytes.size() / sizeof(uint32_t));
+        std::memcpy(spirv.data(), bytes.data(), bytes.size());
+        return spirv;
+    }
+
+    auto buffer_address(const Device& device, VkBuffer buffer) -> VkDeviceAddress {
+        if (!device.capabilities().has(DeviceFeature::BufferDeviceAddress)) {
+            throw std::runtime_error("Buffer device addresses need DeviceFeature::BufferDeviceAddress");
+        }
+
+        VkBufferDeviceAddressInfo address_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = buffer
+        };
+        return device.dispatch().vkGetBufferDeviceAddress(device.device_handle(), &address_info);
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "dispatch.hpp"
+#include "pipeline_compiler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    struct ComputeKernelDesc {
+        ShaderStageDesc                    shader{VK_SHADER_STAGE_COMPUTE_BIT, {}};
+        uint32_t                           push_constant_size = 0; // bytes, 128 at most
+        std::vector<VkDescriptorSetLayout> set_layouts;            // e.g. BindlessHeap::layout(), none when buffers are passed by address
+    };
+
+    /**
+     * @brief A compute shader with its pipeline layout, ready to dispatch
+     *
+     * The layout has a single push constant range visible to the compute
+     * stage. Kernels usually take their buffers as device addresses in
+     * there, see buffer_address(), so dispatching one needs no descriptor
+     * sets at all. The pipeline is created synchronously through the
+     * Device's pipeline cache; use PipelineCompiler for kernels that may
+     * compile in the background.
+     */
+    class ComputeKernel {
+        const DispatchTable& _api;
+        VkDevice             _device;
+        VkPipelineLayout     _layout   = VK_NULL_HANDLE;
+        VkPipeline           _pipeline = VK_NULL_HANDLE;
+        uint32_t             _push_constant_size;
+
+      public:
+        ComputeKernel(Device& device, const ComputeKernelDesc& desc);
+        ~ComputeKernel();
+
+        ComputeKernel(const ComputeKernel&) = delete;
+        auto operator=(const ComputeKernel&) -> ComputeKernel& = delete;
+
+        ComputeKernel(ComputeKernel&&) = delete;
+        auto operator=(ComputeKernel&&) -> ComputeKernel& = delete;
+
+        [[nodiscard]] auto pipeline() const noexcept -> VkPipeline;
+        [[nodiscard]] auto layout() const noexcept -> VkPipelineLayout;
+        [[nodiscard]] auto push_constant_size() const noexcept -> uint32_t;
+    };
+
+    /**
+     * @brief Records compute dispatches and submits them in batches
+     *
+     * Every dispatch until submit() goes into one command buffer, so a
+     * thousand small kernels cost one vkQueueSubmit2 rather than a thousand.
+     * Dispatches in a batch may run concurrently: nothing orders them until
+     * barrier() is called, which makes everything recorded before it visible
+     * to everything recorded after it. Consecutive barrier() calls, or one
+     * with nothing recorded since the last, collapse into a single global
+     * memory barrier, and a kernel dispatched again is not rebound. The
+     * same holds across batches: without a barrier() the next batch may
+     * overlap the previous one like dispatches within a batch do.
+     *
+     * Batches are recycled like CommandRecorder frames: each owns a command
+     * pool that is reset once the timeline semaphore passed its submission,
+     * starting a batch only waits when all of them are still in flight.
+     * Writes are made visible to the host at the end of every batch, so a
+     * readback buffer can be read right after wait().
+     *
+     * Like the queue it submits to, a ComputeQueue is used by one thread at
+     * a time.
+     *
+     * @code
+     * ComputeQueue::require_features(device);
+     * device.select_gpu(Device::GpuUsage::Compute);
+     * device.create_device();
+     *
+     * ComputeKernel saxpy(device, {.shader = {VK_SHADER_STAGE_COMPUTE_BIT, read_spirv("saxpy.spv")}, .push_constant_size = sizeof(SaxpyPush)});
+     * ComputeQueue  compute(device);
+     *
+     * for (const Job& job : jobs) {
+     *     compute.dispatch(saxpy, group_count(job.count, 64), 1, 1, SaxpyPush{buffer_address(device, job.x), buffer_address(device, job.y), job.a, job.count});
+     * }
+     * compute.barrier(); // the reduction reads what every saxpy wrote
+     * compute.dispatch(reduce, 1, 1, 1, reduce_push);
+     * compute.wait(compute.submit());
+     * @endcode
+     */
+    class ComputeQueue {
+      public:
+        struct Config {
+            VkQueue  queue;
+            uint32_t queue_family;
+            uint32_t batches_in_flight = 2;
+        };
+
+        struct Stats {
+            uint64_t batches        = 0; // submissions
+            uint64_t dispatches     = 0; // direct and indirect
+            uint64_t barriers       = 0; // recorded, after collapsing
+            uint64_t pipeline_binds = 0;
+            uint64_t batch_waits    = 0; // batches that had to wait for an older one to retire
+        };
+
+      private:
+        struct Batch {
+            VkCommandPool   pool  = VK_NULL_HANDLE;
+            VkCommandBuffer cmd   = VK_NULL_HANDLE;
+            uint64_t        value = 0; // timeline value of its last submission
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        Config               _config;
+
+        VkSemaphore _timeline  = VK_NULL_HANDLE;
+        uint64_t    _submitted = 0;
+
+        std::vector<Batch> _batches;
+        uint32_t           _batch     = 0;
+        bool               _recording = false;
+
+        VkPipeline _bound   = VK_NULL_HANDLE; // pipeline bound in the open batch
+        bool       _pending = false;          // barrier() requested, recorded before the next command
+        bool       _written = false;          // commands recorded since the last barrier
+
+        std::vector<VkSemaphoreSubmitInfo> _signals;
+
+        Stats _stats;
+
+      public:
+        // Declares what kernels taking buffers by address need, call before create_device()
+        static auto require_features(Device& device) -> void;
+
+        // Submits to the Device's compute queue
+        explicit ComputeQueue(Device& device);
+        ComputeQueue(Device& device, const Config& config);
+        ~ComputeQueue();
+
+        ComputeQueue(const ComputeQueue&) = delete;
+        auto operator=(const ComputeQueue&) -> ComputeQueue& = delete;
+
+        ComputeQueue(ComputeQueue&&) = delete;
+        auto operator=(ComputeQueue&&) -> ComputeQueue& = delete;
+
+        // `push` is copied into the kernel's push constants, it may be shorter than their range
+        auto dispatch(const ComputeKernel& kernel, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z, std::span<const std::byte> push = {}) -> void;
+
+        template <typename Push>
+            requires std::is_trivially_copyable_v<Push>
+        auto dispatch(const ComputeKernel& kernel, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z, const Push& push) -> void {
+            dispatch(kernel, groups_x, groups_y, groups_z, std::as_bytes(std::span(&push, 1)));
+        }
+
+        // Group counts are read from a VkDispatchIndirectCommand at `offset`, which may be written by an earlier dispatch before a barrier()
+        auto dispatch_indirect(const ComputeKernel& kernel, VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> push = {}) -> void;
+
+        template <typename Push>
+            requires std::is_trivially_copyable_v<Push>
+        auto dispatch_indirect(const ComputeKernel& kernel, VkBuffer buffer, VkDeviceSize offset, const Push& push) -> void {
+            dispatch_indirect(kernel, buffer, offset, std::as_bytes(std::span(&push, 1)));
+        }
+
+        // Orders everything recorded before it, shader writes and transfers alike, before everything after it
+        auto barrier() -> void;
+
+        // The open batch, for copies, fills or descriptor binds of the caller's own; they are ordered by barrier() like dispatches
+        [[nodiscard]] auto command_buffer() -> VkCommandBuffer;
+
+        // Submits the open batch, returns the timeline value that signals its completion
+        auto submit(std::span<const VkSemaphoreSubmitInfo> waits = {}, std::span<const VkSemaphoreSubmitInfo> signals = {}) -> uint64_t;
+
+        auto wait(uint64_t value) const -> void;
+        auto wait_idle() const -> void;
+
+        [[nodiscard]] auto semaphore() const noexcept -> VkSemaphore;
+        [[nodiscard]] auto completed_value() const -> uint64_t;
+        [[nodiscard]] auto submitted_value() const noexcept -> uint64_t;
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+      private:
+        // Begins a batch when none is open and records a requested barrier
+        auto prepare() -> VkCommandBuffer;
+        auto bind(VkCommandBuffer cmd, const ComputeKernel& kernel, std::span<const std::byte> push) -> void;
+    };
+
+    // SPIR-V words of a compiled shader file, throws when it is missing or not SPIR-V
+    [[nodiscard]] auto read_spirv(const std::filesystem::path& path) -> std::vector<uint32_t>;
+
+    // Needs DeviceFeature::BufferDeviceAddress and a buffer created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+    [[nodiscard]] auto buffer_address(const Device& device, VkBuffer buffer) -> VkDeviceAddress;
+
+    // Workgroups of `group_size` invocations needed to cover `items`
+    [[nodiscard]] constexpr auto group_count(uint64_t items, uint32_t group_size) noexcept -> uint32_t {
+        return static_cast<uint32_t>((items + group_size - 1) / group_size);
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,153 @@
+#include "deletion_queue.hpp"
+#include "device.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace vulkron::gpu::vulkan {
+
+    DeletionQueue::DeletionQueue(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _allocator(device.allocator()),
+        _config(config)
+    {
+        if (_config.timeline == VK_NULL_HANDLE) {
+            throw std::runtime_error("DeletionQueue needs a timeline semaphore");
+        }
+    }
+
+    DeletionQueue::~DeletionQueue() {
+        try {
+            flush();
+        } catch (const std::runtime_error&) {
+            // The wait only fails once the device is lost, nothing executes on it any more
+            collect(UINT64_MAX);
+        }
+    }
+
+    auto DeletionQueue::push(Handle handle, uint64_t value) -> void {
+        std::lock_guard lock(_mutex);
+
+        // Values only move forward, an older one rides along with the newest batch
+        if (_batches.empty() || value > _batches.back().value) {
+            std::vector<Handle> handles;
+            if (!_spare.empty()) {
+                handles = std::move(_spare.back());
+                _spare.pop_back();
+            }
+            _batches.push_back(Batch{.value = value, .handles = std::move(handles)});
+        }
+
+        _batches.back().handles.push_back(std::move(handle));
+        ++_stats.retired;
+        ++_stats.pending;
+    }
+
+    auto DeletionQueue::collect() -> uint64_t {
+        {
+            std::lock_guard lock(_mutex);
+            if (_batches.empty()) {
+                return 0;
+            }
+        }
+        return collect(completed_value());
+    }
+
+    auto DeletionQueue::collect(uint64_t completed) -> uint64_t {
+        std::vector<Batch> ready;
+        {
+            std::lock_guard lock(_mutex);
+            while (!_batches.empty() && _batches.front().value <= completed) {
+                ready.push_back(std::move(_batches.front()));
+                _batches.pop_front();
+            }
+        }
+        if (ready.empty()) {
+            return 0;
+        }
+
+        // Destroyed outside the lock so retiring never waits on the driver
+        uint64_t destroyed = 0;
+        for (Batch& batch : ready) {
+            for (Handle& handle : batch.handles) {
+                destroy(handle);
+            }
+            destroyed += batch.handles.size();
+            batch.handles.clear();
+        }
+
+        std::lock_guard lock(_mutex);
+        for (Batch& batch : ready) {
+            _spare.push_back(std::move(batch.handles));
+        }
+        _stats.destroyed += destroyed;
+        _stats.pending   -= destroyed;
+        _stats.batches   += ready.size();
+        return destroyed;
+    }
+
+    auto DeletionQueue::flush() -> void {
+        uint64_t last = 0;
+        {
+            std::lock_guard lock(_mutex);
+            if (_batches.empty()) {
+                return;
+            }
+            last = _batches.back().value;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores    = &_config.timeline,
+            .pValues        = &last
+        };
+
+        if (_api.vkWaitSemaphores(_device, &wait_info, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to wait on deletion queue timeline semaphore");
+        }
+        collect(UINT64_MAX);
+    }
+
+    auto DeletionQueue::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+        return _stats;
+    }
+
+    auto DeletionQueue::destroy(Handle& handle) -> void {
+        struct Destroy {
+            DeletionQueue& queue;
+
+            auto operator()(VkBuffer buffer) const -> void { queue._api.vkDestroyBuffer(queue._device, buffer, nullptr); }
+            auto operator()(VkImage image) const -> void { queue._api.vkDestroyImage(queue._device, image, nullptr); }
+            auto operator()(VkImageView view) const -> void { queue._api.vkDestroyImageView(queue._device, view, nullptr); }
+            auto operator()(VkSampler sampler) const -> void { queue._api.vkDestroySampler(queue._device, sampler, nullptr); }
+            auto operator()(VkPipeline pipeline) const -> void { queue._api.vkDestroyPipeline(queue._device, pipeline, nullptr); }
+            auto operator()(VkPipelineLayout layout) const -> void { queue._api.vkDestroyPipelineLayout(queue._device, layout, nullptr); }
+            auto operator()(VkDescriptorSetLayout layout) const -> void { queue._api.vkDestroyDescriptorSetLayout(queue._device, layout, nullptr); }
+            auto operator()(VkDescriptorPool pool) const -> void { queue._api.vkDestroyDescriptorPool(queue._device, pool, nullptr); }
+            auto operator()(VkShaderModule module) const -> void { queue._api.vkDestroyShaderModule(queue._device, module, nullptr); }
+            auto operator()(VkCommandPool pool) const -> void { queue._api.vkDestroyCommandPool(queue._device, pool, nullptr); }
+            auto operator()(VkQueryPool pool) const -> void { queue._api.vkDestroyQueryPool(queue._device, pool, nullptr); }
+            auto operator()(VkSemaphore semaphore) const -> void { queue._api.vkDestroySemaphore(queue._device, semaphore, nullptr); }
+            auto operator()(VkFence fence) const -> void { queue._api.vkDestroyFence(queue._device, fence, nullptr); }
+            auto operator()(AllocatedBuffer& buffer) const -> void { queue._allocator.destroy_buffer(buffer); }
+            auto operator()(AllocatedImage& image) const -> void { queue._allocator.destroy_image(image); }
+            auto operator()(Allocation& allocation) const -> void { queue._allocator.free(allocation); }
+        };
+
+        std::visit(Destroy{*this}, handle);
+    }
+
+    auto DeletionQueue::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _config.timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query deletion queue timeline semaphore");
+        }
+        return value;
+    }
+
+} // namespace vulkron::gpu::vulkan
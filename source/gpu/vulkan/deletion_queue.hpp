@@ -0,0 +1,135 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "dispatch.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    /**
+     * @brief Destroys handles once the GPU is done with them, without idling the device
+     *
+     * Each retired handle is tagged with the timeline value of the last
+     * submission that may use it. collect() reads the semaphore once and
+     * destroys every batch the GPU has passed; batches are kept in value
+     * order, so it stops at the first one still in flight.
+     *
+     * A handle retired with a value lower than the newest batch's joins that
+     * batch, which only delays it. Retiring is thread-safe, destruction
+     * happens outside the lock on the thread calling collect().
+     *
+     * @code
+     * DeletionQueue retired(device, {.timeline = recorder.semaphore()});
+     *
+     * retired.retire(old_view, recorder.submitted_value());
+     * retired.retire(old_image, recorder.submitted_value());
+     * // ... next frame
+     * retired.collect();
+     * @endcode
+     */
+    class DeletionQueue {
+      public:
+        using Handle = std::variant<VkBuffer,
+                                    VkImage,
+                                    VkImageView,
+                                    VkSampler,
+                                    VkPipeline,
+                                    VkPipelineLayout,
+                                    VkDescriptorSetLayout,
+                                    VkDescriptorPool,
+                                    VkShaderModule,
+                                    VkCommandPool,
+                                    VkQueryPool,
+                                    VkSemaphore,
+                                    VkFence,
+                                    AllocatedBuffer,
+                                    AllocatedImage,
+                                    Allocation>;
+
+        struct Config {
+            VkSemaphore timeline; // signalled with the values handles are retired at
+        };
+
+        struct Stats {
+            uint64_t retired   = 0;
+            uint64_t destroyed = 0;
+            uint64_t batches   = 0; // batches destroyed
+            uint64_t pending   = 0; // handles waiting on the GPU
+        };
+
+      private:
+        struct Batch {
+            uint64_t            value;
+            std::vector<Handle> handles;
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        MemoryAllocator&     _allocator;
+        Config               _config;
+
+        std::deque<Batch>                _batches;
+        std::vector<std::vector<Handle>> _spare; // emptied batch vectors, kept for their capacity
+        Stats                            _stats;
+
+        mutable std::mutex _mutex;
+
+      public:
+        DeletionQueue(Device& device, const Config& config);
+        ~DeletionQueue();
+
+        DeletionQueue(const DeletionQueue&) = delete;
+        auto operator=(const DeletionQueue&) -> DeletionQueue& = delete;
+
+        DeletionQueue(DeletionQueue&&) = delete;
+        auto operator=(DeletionQueue&&) -> DeletionQueue& = delete;
+
+        // Null handles are ignored
+        template <typename T>
+            requires std::constructible_from<Handle, T>
+        auto retire(T handle, uint64_t value) -> void {
+            if (is_null(handle)) {
+                return;
+            }
+            push(Handle(std::move(handle)), value);
+        }
+
+        // Destroys every batch the timeline has passed, returns how many handles
+        auto collect() -> uint64_t;
+        auto collect(uint64_t completed) -> uint64_t;
+
+        // Waits for the newest batch and destroys everything, for shutdown
+        auto flush() -> void;
+
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        template <typename T>
+        static auto is_null(const T& handle) noexcept -> bool {
+            if constexpr (std::same_as<T, AllocatedBuffer>) {
+                return handle.buffer == VK_NULL_HANDLE && !handle.allocation.valid();
+            } else if constexpr (std::same_as<T, AllocatedImage>) {
+                return handle.image == VK_NULL_HANDLE && !handle.allocation.valid();
+            } else if constexpr (std::same_as<T, Allocation>) {
+                return !handle.valid();
+            } else {
+                return handle == VK_NULL_HANDLE;
+            }
+        }
+
+        auto push(Handle handle, uint64_t value) -> void;
+        auto destroy(Handle& handle) -> void;
+        auto completed_value() const -> uint64_t;
+    };
+
+} // namespace vulkron::gpu::vulkan
@@ -1,97 +1,151 @@
 #include "device.hpp"
+#include "disk_cache.hpp"
 #include "structchain.hpp"
-
-#include <iostream>
-#include <queue>
+#include "support/common/small_vector.hpp"
+#include "support/profiler/profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 namespace vulkron::gpu::vulkan {
 
-    Device::Device() 
-        : _instance(nullptr),
-        _device(nullptr), 
-        _gpu(nullptr)
-    {
-        VkApplicationInfo application_info = {
-            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-            .pNext = nullptr,
-            .pApplicationName   = "Vulkron",
-            .applicationVersion = VK_MAKE_VERSION(0, 1, 0),
-            .pEngineName        = "Vulkron",
-            .engineVersion      = VK_MAKE_VERSION(0, 1, 0),
-            .apiVersion         = VK_API_VERSION_1_4
-        };
+    namespace {
 
-        VkInstanceCreateInfo create_info = {
-            .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .pApplicationInfo        = &application_info,
-            .enabledLayerCount       = 0,
-            .ppEnabledLayerNames     = nullptr,
-            .enabledExtensionCount   = 0,
-            .ppEnabledExtensionNames = nullptr
+        struct ProbeWeights {
+            double bandwidth;
+            double compute;
+            double transfer;
+            double memory;
+            double features;
         };
 
-        if (vkCreateInstance(&create_info, nullptr, &_instance) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create Vulkan instance");
+        constexpr auto probe_weights(Device::GpuUsage usage) noexcept -> ProbeWeights {
+            switch (usage) {
+                case Device::GpuUsage::Graphics: return {0.35, 0.35, 0.10, 0.15, 0.05};
+                case Device::GpuUsage::Compute:  return {0.25, 0.50, 0.10, 0.10, 0.05};
+                case Device::GpuUsage::Transfer: return {0.30, 0.05, 0.50, 0.10, 0.05};
+            }
+            return {};
         }
+
+        auto hex(const uint8_t (&uuid)[VK_UUID_SIZE]) -> std::string {
+            std::string text(VK_UUID_SIZE * 2, '0');
+            for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+                std::snprintf(text.data() + i * 2, 3, "%02x", uuid[i]);
+            }
+            return text;
+        }
+
+        // Fraction of the best value among the candidates, 0 when nobody scored
+        auto relative(double value, double best) noexcept -> double {
+            return best > 0.0 ? value / best : 0.0;
+        }
+
+    } // namespace
+
+    Device::Device()
+        : Device(std::make_shared<const Instance>())
+    {
+    }
+
+    Device::Device(std::shared_ptr<const Instance> instance)
+        : _instance(std::move(instance)),
+        _device(nullptr),
+        _gpu(nullptr),
+        _cache_directory(default_cache_directory())
+    {
+        VULKRON_PROFILE_ZONE("Device::Device");
+
+        if (!_instance) {
+            throw std::runtime_error("Device needs an Instance");
+        }
+
+        // Instance level entries are shared, the device level ones get loaded into this copy
+        _api = std::make_unique<DispatchTable>(_instance->dispatch());
+
+        // The render graph records vkCmdPipelineBarrier2, uploads complete on a timeline semaphore
+        require_feature(DeviceFeature::Synchronization2);
+        require_feature(DeviceFeature::TimelineSemaphore);
     }
 
     Device::~Device()  {
+        _pipeline_cache.reset();
+        _allocator.reset();
+
         if (_device != nullptr) {
-            vkDestroyDevice(_device, nullptr);
+            _api->vkDestroyDevice(_device, nullptr);
             _device = nullptr;
         }
-
-        if (_instance != nullptr) {
-            vkDestroyInstance(_instance, nullptr);
-            _instance = nullptr;
-        }
+        // The Instance goes with the last Device or owner holding it
     }
 
     Device::Device(Device&& other) noexcept 
-    : _instance(other._instance),
+    : _instance(std::move(other._instance)),
+        _api(std::move(other._api)),
         _device(other._device),
         _gpu(other._gpu),
-        _queue_create_infos(std::move(other._queue_create_infos))
+        _queue_topology(std::move(other._queue_topology)),
+        _queues(other._queues),
+        _required_features(other._required_features),
+        _optional_features(other._optional_features),
+        _required_extensions(std::move(other._required_extensions)),
+        _optional_extensions(std::move(other._optional_extensions)),
+        _capabilities(std::move(other._capabilities)),
+        _allocator(std::move(other._allocator)),
+        _pipeline_cache(std::move(other._pipeline_cache)),
+        _cache_directory(std::move(other._cache_directory)),
+        _gpu_report(std::move(other._gpu_report))
     {
-        other._instance = nullptr;
-        other._device   = nullptr;
-        other._gpu      = nullptr;
+        other._device = nullptr;
+        other._gpu    = nullptr;
     }
 
     auto Device::operator=(Device&& other) noexcept -> Device& {
         if (this != &other) {
+            _pipeline_cache.reset();
+            _allocator.reset();
+
             if (_device != nullptr) {
-                vkDestroyDevice(_device, nullptr);
+                _api->vkDestroyDevice(_device, nullptr);
                 _device = nullptr;
             }
 
-            if (_instance != nullptr) {
-                vkDestroyInstance(_instance, nullptr);
-                _instance = nullptr;
-            }
-
-            _queue_create_infos.clear();
-
-            _instance = other._instance;
+            _instance = std::move(other._instance);
+            _api = std::move(other._api);
             _device = other._device;
             _gpu = other._gpu;
-            _queue_create_infos = std::move(other._queue_create_infos);
-
-            other._instance = nullptr;
-            other._device   = nullptr;
-            other._gpu      = nullptr;
+            _queue_topology = std::move(other._queue_topology);
+            _queues = other._queues;
+            _required_features = other._required_features;
+            _optional_features = other._optional_features;
+            _required_extensions = std::move(other._required_extensions);
+            _optional_extensions = std::move(other._optional_extensions);
+            _capabilities = std::move(other._capabilities);
+            _cache_directory = std::move(other._cache_directory);
+            _gpu_report = std::move(other._gpu_report);
+            _allocator = std::move(other._allocator);
+            _pipeline_cache = std::move(other._pipeline_cache);
+
+            other._device = nullptr;
+            other._gpu    = nullptr;
         }
         return *this;
     }
 
-    auto Device::instance_handle() const -> VkInstance {
+    auto Device::instance() const noexcept -> const std::shared_ptr<const Instance>& {
         return _instance;
     }
 
+    auto Device::instance_handle() const -> VkInstance {
+        return _instance ? _instance->handle() : VK_NULL_HANDLE;
+    }
+
     auto Device::device_handle() const -> VkDevice {
         return _device;
     }
@@ -100,161 +154,424 @@ namespace vulkron::gpu::vulkan {
         return _gpu;
     }
 
-    auto Device::select_gpu(GpuUsage usage) -> void {
-        uint32_t gpu_count = 0;
+    auto Device::dispatch() const noexcept -> const DispatchTable& {
+        // The table moves with the Device so references to it stay valid, a moved-from Device sees every function null
+        static const DispatchTable unloaded;
+        return _api ? *_api : unloaded;
+    }
+
+    auto Device::require_feature(DeviceFeature feature, Requirement requirement) -> void {
+        const size_t bit = static_cast<size_t>(feature);
 
-        vkEnumeratePhysicalDevices(_instance, &gpu_count, nullptr);
-        if (gpu_count == 0) {
-            throw std::runtime_error("No Vulkan GPUs found");
+        // Required wins over optional, whichever order they were declared in
+        if (requirement == Requirement::Required) {
+            _required_features.set(bit);
+            _optional_features.reset(bit);
+        } else if (!_required_features.test(bit)) {
+            _optional_features.set(bit);
         }
+    }
 
-        std::vector<VkPhysicalDevice> gpu_list(gpu_count);
-        vkEnumeratePhysicalDevices(_instance, &gpu_count, gpu_list.data());
+    auto Device::require_extension(std::string_view extension, Requirement requirement) -> void {
+        auto required = std::ranges::find(_required_extensions, extension);
+        auto optional = std::ranges::find(_optional_extensions, extension);
 
-        VkPhysicalDeviceVulkan11Properties vk11{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES};
-        VkPhysicalDeviceVulkan12Properties vk12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES};
-        VkPhysicalDeviceVulkan13Properties vk13{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES};
-        VkPhysicalDeviceVulkan14Properties vk14{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_4_PROPERTIES};
+        if (requirement == Requirement::Required) {
+            if (optional != _optional_extensions.end()) {
+                _optional_extensions.erase(optional);
+            }
+            if (required == _required_extensions.end()) {
+                _required_extensions.emplace_back(extension);
+            }
+        } else if (required == _required_extensions.end() && optional == _optional_extensions.end()) {
+            _optional_extensions.emplace_back(extension);
+        }
+    }
 
-        PChainNext chained_properties;
-        switch (usage) {
-            case GpuUsage::Graphics:
-                chained_properties = vk14 | vk13 | vk12 | vk11;
-                break;
-            case GpuUsage::Compute:
-                chained_properties = vk12 | vk11;
-                break;
-            case GpuUsage::Transfer:
-                chained_properties = vk11;
-                break;
+    auto Device::select_gpu(GpuUsage usage, GpuSelection selection) -> void {
+        VULKRON_PROFILE_ZONE("Device::select_gpu");
+
+        const std::span<const Adapter> adapters = _instance->adapters();
+        if (adapters.empty()) {
+            throw std::runtime_error("No Vulkan GPUs found");
         }
 
-        // chained_properties.print();
+        _gpu_report.clear();
+        support::SmallVector<std::string, 8> keys;
 
-        std::priority_queue<std::pair<size_t, VkPhysicalDevice>> max_heap;
+        for (const Adapter& adapter : adapters) {
+            FeatureChain enabled(adapter.api_version);
+            std::string  missing;
 
-        for (const VkPhysicalDevice& gpu : gpu_list) {
-            VkPhysicalDeviceProperties2 device_properties = {
-                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
-                .pNext = chained_properties.get()};
+            const DeviceCapabilities capabilities = resolve_capabilities(adapter, enabled, missing);
+            if (!missing.empty()) {
+                continue;
+            }
 
-            vkGetPhysicalDeviceProperties2(gpu, &device_properties);
-            std::cout << "Found GPU: " << device_properties.properties.deviceName << "\n";
+            const VkPhysicalDeviceProperties&         device_properties = adapter.properties.head()->properties;
+            const VkPhysicalDeviceVulkan11Properties& vk11              = adapter.properties.get<VkPhysicalDeviceVulkan11Properties>();
 
             size_t gpu_score = 0;
-            gpu_score += device_properties.properties.apiVersion;
+            gpu_score += device_properties.apiVersion;
 
             // Prefer discrete GPUs
-            if (device_properties.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
+            if (device_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
                 gpu_score += 1000;
             }
 
-            // Prefer more memory heaps
-            // VkPhysicalDeviceMemoryProperties2 mem_props;
-            // vkGetPhysicalDeviceMemoryProperties2(gpu, &mem_props);
-            // gpu_score += mem_props.memoryHeapCount;
+            GpuReport& report       = _gpu_report.emplace_back();
+            report.name             = device_properties.deviceName;
+            report.gpu              = adapter.gpu;
+            report.score            = static_cast<double>(gpu_score);
+            report.local_memory     = adapter.local_memory;
+            report.feature_count    = capabilities.features.count();
+            report.timestamp_period = device_properties.limits.timestampPeriod;
 
-            // VkPhysicalDeviceFeatures2 features;
-            // vkGetPhysicalDeviceFeatures2(gpy, &features);
-
-            max_heap.push({gpu_score, gpu});
+            // A driver update invalidates cached benchmark results
+            keys.push_back(hex(vk11.deviceUUID) + ":" + hex(vk11.driverUUID));
         }
 
-        if (max_heap.empty()) {
+        if (_gpu_report.empty()) {
             throw std::runtime_error("No suitable gpu found");
         }
 
-        auto [score, best_gpu] = max_heap.top();
-        std::cout << "Best GPU score: " << score << "\n";
-        _gpu = best_gpu;
+        if (selection == GpuSelection::Benchmark) {
+            benchmark_gpus(usage, keys);
+        }
+
+        // First adapter wins ties, matching enumeration order
+        auto best = std::ranges::max_element(_gpu_report, [](const GpuReport& a, const GpuReport& b) {
+            return a.score < b.score;
+        });
+        _gpu = best->gpu;
+
+        // Family layouts differ between GPUs, a plan for the previous one is stale
+        _queue_topology = QueueTopology{};
     }
 
-    auto Device::request_queue_family(const std::vector<float>& priorities, uint32_t queue_count, VkQueueFlags required_flags, VkQueueFlags excluded_flags) -> uint32_t {
-        if (priorities.size() != queue_count) {
-            throw std::runtime_error("Priorities vector size must match queue_count");
+    auto Device::gpu_report() const noexcept -> const std::vector<GpuReport>& {
+        return _gpu_report;
+    }
+
+    auto Device::timestamp_period() const noexcept -> float {
+        auto selected = std::ranges::find(_gpu_report, _gpu, &GpuReport::gpu);
+        return selected != _gpu_report.end() ? selected->timestamp_period : 0.0f;
+    }
+
+    auto Device::set_cache_directory(std::filesystem::path directory) -> void {
+        _cache_directory = std::move(directory);
+    }
+
+    auto Device::cache_directory() const noexcept -> const std::filesystem::path& {
+        return _cache_directory;
+    }
+
+    auto Device::benchmark_gpus(GpuUsage usage, std::span<const std::string> keys) -> void {
+        VULKRON_PROFILE_ZONE("Device::benchmark_gpus");
+
+        std::vector<std::string> sorted_keys(keys.begin(), keys.end());
+        std::ranges::sort(sorted_keys);
+
+        std::string selection_key = "usage=" + std::to_string(static_cast<int>(usage)) + " adapters=";
+        for (const std::string& key : sorted_keys) {
+            selection_key += key + ",";
         }
 
-        for (float priority : priorities) {
-            if (priority < 0.0f || priority > 1.0f) {
-                throw std::runtime_error("Queue priorities must be in range [0.0, 1.0]");
+        // One "<selection key>\t<winning adapter key>" line per adapter set and usage
+        const std::filesystem::path cache_path = _cache_directory.empty() ? std::filesystem::path() : _cache_directory / "gpu_selection.txt";
+
+        std::vector<std::string> cache_lines;
+        if (!cache_path.empty()) {
+            if (auto contents = read_cache_file(cache_path)) {
+                std::istringstream stream(*contents);
+                for (std::string line; std::getline(stream, line);) {
+                    const size_t tab = line.find('\t');
+                    if (tab == std::string::npos) {
+                        continue;
+                    }
+
+                    if (line.compare(0, tab, selection_key) != 0) {
+                        cache_lines.push_back(std::move(line));
+                        continue;
+                    }
+
+                    auto winner = std::ranges::find(keys, std::string_view(line).substr(tab + 1));
+                    if (winner != keys.end()) {
+                        for (size_t i = 0; i < _gpu_report.size(); ++i) {
+                            _gpu_report[i].score  = keys[i] == *winner ? 1.0 : 0.0;
+                            _gpu_report[i].cached = true;
+                        }
+                        return;
+                    }
+                }
             }
         }
 
-        uint32_t queue_family_count = 0;
-        vkGetPhysicalDeviceQueueFamilyProperties(_gpu, &queue_family_count, nullptr);
-
-        std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
-        vkGetPhysicalDeviceQueueFamilyProperties(_gpu, &queue_family_count, queue_families.data());
+        double best_bandwidth = 0.0;
+        double best_compute   = 0.0;
+        double best_transfer  = 0.0;
+        double best_memory    = 0.0;
+        double best_features  = 0.0;
+
+        for (GpuReport& report : _gpu_report) {
+            try {
+                if (const Adapter* adapter = _instance->adapter(report.gpu)) {
+                    report.probe  = probe_gpu(*_api, *adapter);
+                    report.probed = true;
+                }
+            } catch (const std::runtime_error&) {
+                // An adapter that can't run the probes keeps a zero probe score
+            }
 
-        uint32_t selected_family_index = UINT32_MAX;
+            best_bandwidth = std::max(best_bandwidth, report.probe.bandwidth_gbps);
+            best_compute   = std::max(best_compute, report.probe.compute_gflops);
+            best_transfer  = std::max(best_transfer, report.probe.transfer_gbps);
+            best_memory    = std::max(best_memory, static_cast<double>(report.local_memory));
+            best_features  = std::max(best_features, static_cast<double>(report.feature_count));
+        }
 
-        // Find the first suitable queue family
-        for (uint32_t i = 0; i < queue_family_count; ++i) {
-            const VkQueueFamilyProperties& family = queue_families[i];
+        const ProbeWeights weights = probe_weights(usage);
 
-            // Check if this family meets the flag requirements
-            bool has_required_flags = (family.queueFlags & required_flags) == required_flags;
-            bool has_excluded_flags = (family.queueFlags & excluded_flags) != 0;
+        size_t winner = 0;
+        for (size_t i = 0; i < _gpu_report.size(); ++i) {
+            GpuReport& report = _gpu_report[i];
+            report.score = weights.bandwidth * relative(report.probe.bandwidth_gbps, best_bandwidth) +
+                           weights.compute * relative(report.probe.compute_gflops, best_compute) +
+                           weights.transfer * relative(report.probe.transfer_gbps, best_transfer) +
+                           weights.memory * relative(static_cast<double>(report.local_memory), best_memory) +
+                           weights.features * relative(static_cast<double>(report.feature_count), best_features);
 
-            if (!has_required_flags || has_excluded_flags) {
-                continue;
+            if (report.score > _gpu_report[winner].score) {
+                winner = i;
             }
+        }
 
-            // Check if we have enough queues available
-            if (queue_count <= family.queueCount) {
-                selected_family_index = i;
-                break;
-            }
+        if (cache_path.empty() || !_gpu_report[winner].probed) {
+            return;
         }
 
-        if (selected_family_index == UINT32_MAX) {
-            throw std::runtime_error("No suitable queue family found");
+        std::string contents;
+        for (const std::string& line : cache_lines) {
+            contents += line + "\n";
         }
+        contents += selection_key + "\t" + keys[winner] + "\n";
 
-        // Create queue creation info - caller must keep vector alive!
-        _queue_create_infos.emplace_back(VkDeviceQueueCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .queueFamilyIndex = selected_family_index,
-            .queueCount = queue_count,
-            .pQueuePriorities = priorities.data()
-        });
+        write_cache_file(cache_path, contents);
+    }
+
+    auto Device::plan_queues(const QueuePlanRequest& request) -> const QueueTopology& {
+        VULKRON_PROFILE_ZONE("Device::plan_queues");
+
+        if (_gpu == nullptr) {
+            throw std::runtime_error("Queues can only be planned after select_gpu()");
+        }
+        if (_device != nullptr) {
+            throw std::runtime_error("Queues can't be replanned after create_device()");
+        }
+
+        _queue_topology = plan_queue_topology(selected_adapter().queue_families, request);
+        return _queue_topology;
+    }
 
-        return selected_family_index;
+    auto Device::queue_topology() const noexcept -> const QueueTopology& {
+        return _queue_topology;
     }
 
     auto Device::request_queue(uint32_t queue_family_index, uint32_t queue_index) -> VkQueue {
         VkQueue queue;
-        vkGetDeviceQueue(_device, queue_family_index, queue_index, &queue);
+        _api->vkGetDeviceQueue(_device, queue_family_index, queue_index, &queue);
         return queue;
     }
 
     auto Device::create_device() -> VkDevice {
-        // This is pretty basic, but we should expand on this
-        VkPhysicalDeviceFeatures2 features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
-        PChainNext                chained_features = features;
+        VULKRON_PROFILE_ZONE("Device::create_device");
 
-        // chained_features.print();
+        if (_gpu == nullptr) {
+            throw std::runtime_error("Device can only be created after select_gpu()");
+        }
+        const Adapter& adapter = selected_adapter();
+
+        FeatureChain enabled(adapter.api_version);
+        std::string  missing;
+
+        _capabilities = resolve_capabilities(adapter, enabled, missing);
+        if (!missing.empty()) {
+            throw std::runtime_error("GPU lacks required capabilities:" + missing);
+        }
+
+        if (_queue_topology.priorities.empty()) {
+            plan_queues();
+        }
+        const std::vector<VkDeviceQueueCreateInfo> queue_create_infos = _queue_topology.queue_create_infos();
+
+        std::vector<const char*> extension_names;
+        extension_names.reserve(_capabilities.extensions.size());
+        for (const std::string& extension : _capabilities.extensions) {
+            extension_names.push_back(extension.c_str());
+        }
 
         VkDeviceCreateInfo device_create_info = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext = chained_features.get(),
+            .pNext = enabled.get(),
             .flags = 0,
-            .queueCreateInfoCount = static_cast<uint32_t>(_queue_create_infos.size()),
-            .pQueueCreateInfos = _queue_create_infos.data(),
+            .queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size()),
+            .pQueueCreateInfos = queue_create_infos.data(),
             .enabledLayerCount = 0,       // deprecated
             .ppEnabledLayerNames = nullptr, // deprecated
-            .enabledExtensionCount = 0,       // no extensions yet
-            .ppEnabledExtensionNames = nullptr,
+            .enabledExtensionCount = static_cast<uint32_t>(extension_names.size()),
+            .ppEnabledExtensionNames = extension_names.data(),
             .pEnabledFeatures = nullptr // Using VkPhysicalDeviceFeatures2
         };
 
-        if (vkCreateDevice(_gpu, &device_create_info, nullptr, &_device) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create logical device!");
+        {
+            VULKRON_PROFILE_ZONE("vkCreateDevice");
+            if (_api->vkCreateDevice(_gpu, &device_create_info, nullptr, &_device) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create logical device!");
+            }
+            _api->load_device(_device);
+        }
+
+        {
+            VULKRON_PROFILE_ZONE("vkGetDeviceQueue");
+            const auto fetch = [this](const QueueSlot& slot) -> Queue {
+                if (!slot.valid()) {
+                    return Queue{};
+                }
+                return Queue{request_queue(slot.family, slot.index), slot.family, slot.index, slot.shared};
+            };
+            _queues = QueueSet{
+                .graphics = fetch(_queue_topology.graphics),
+                .compute  = fetch(_queue_topology.compute),
+                .transfer = fetch(_queue_topology.transfer)
+            };
+        }
+
+        MemoryAllocator::Config allocator_config;
+        allocator_config.device_address = _capabilities.has(DeviceFeature::BufferDeviceAddress);
+        _allocator = std::make_unique<MemoryAllocator>(*_api, selected_adapter(), _device, allocator_config);
+
+        // One file per adapter, the cache itself checks that the driver still matches
+        std::filesystem::path pipeline_cache_path;
+        if (!_cache_directory.empty()) {
+            pipeline_cache_path = _cache_directory / ("pipelines-" + hex(adapter.properties.get<VkPhysicalDeviceVulkan11Properties>().deviceUUID) + ".bin");
         }
+        _pipeline_cache = std::make_unique<PipelineCache>(*_api, adapter, _device, std::move(pipeline_cache_path));
 
         return _device;
     }
 
+    auto Device::allocator() const -> MemoryAllocator& {
+        if (!_allocator) {
+            throw std::runtime_error("Device has no allocator before create_device()");
+        }
+        return *_allocator;
+    }
+
+    auto Device::capabilities() const noexcept -> const DeviceCapabilities& {
+        return _capabilities;
+    }
+
+    auto Device::pipeline_cache() const -> PipelineCache& {
+        if (!_pipeline_cache) {
+            throw std::runtime_error("Device has no pipeline cache before create_device()");
+        }
+        return *_pipeline_cache;
+    }
+
+    auto Device::queues() const noexcept -> const QueueSet& {
+        return _queues;
+    }
+
+    auto Device::resolve_capabilities(const Adapter& adapter, FeatureChain& enabled, std::string& missing) const -> DeviceCapabilities {
+        DeviceCapabilities capabilities;
+        capabilities.api_version = adapter.api_version;
+
+        for (size_t i = 0; i < DEVICE_FEATURE_COUNT; ++i) {
+            if (!_required_features.test(i) && !_optional_features.test(i)) {
+                continue;
+            }
+
+            const auto feature = static_cast<DeviceFeature>(i);
+            if (adapter.features.test(i)) {
+                *enabled.flag(feature) = VK_TRUE;
+                capabilities.features.set(i);
+            } else if (_required_features.test(i)) {
+                missing += " ";
+                missing += to_string(feature);
+            }
+        }
+
+        const std::vector<std::string>& available = adapter.extensions;
+
+        auto resolve_extension = [&](const std::string& extension, bool required) {
+            if (std::ranges::binary_search(available, extension)) {
+                capabilities.extensions.push_back(extension);
+            } else if (required) {
+                missing += " " + extension;
+            }
+        };
+
+        for (const std::string& extension : _required_extensions) {
+            resolve_extension(extension, true);
+        }
+        for (const std::string& extension : _optional_extensions) {
+            resolve_extension(extension, false);
+        }
+
+        return capabilities;
+    }
+
+    auto Device::selected_adapter() const -> const Adapter& {
+        const Adapter* adapter = _instance->adapter(_gpu);
+        if (adapter == nullptr) {
+            throw std::runtime_error("No GPU selected");
+        }
+        return *adapter;
+    }
+
+    auto create_devices(const std::shared_ptr<const Instance>& instance, uint32_t count, Device::GpuUsage usage,
+                        const std::function<void(Device&, uint32_t)>& setup) -> std::vector<Device> {
+        VULKRON_PROFILE_ZONE("create_devices");
+
+        std::vector<std::optional<Device>> devices(count);
+        std::vector<std::exception_ptr>    errors(count);
+
+        const auto create = [&](uint32_t index) {
+            try {
+                Device& device = devices[index].emplace(instance);
+                if (setup) {
+                    setup(device, index);
+                }
+                device.select_gpu(usage);
+                device.create_device();
+            } catch (...) {
+                errors[index] = std::current_exception();
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(count > 0 ? count - 1 : 0);
+            for (uint32_t i = 1; i < count; ++i) {
+                threads.emplace_back(create, i);
+            }
+            if (count > 0) {
+                create(0);
+            }
+        }
+
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        std::vector<Device> created;
+        created.reserve(count);
+        for (std::optional<Device>& device : devices) {
+            created.push_back(std::move(*device));
+        }
+        return created;
+    }
+
 } // namespace vulkron::gpu::vulkan
\ No newline at end of file
@@ -1,16 +1,43 @@
 #pragma once
 
+#include "allocator.hpp"
+#include "capabilities.hpp"
+#include "dispatch.hpp"
+#include "gpu_probe.hpp"
+#include "instance.hpp"
+#include "pipeline_cache.hpp"
+#include "queue_topology.hpp"
+
+#include <bitset>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace vulkron::gpu::vulkan {
 
   class Device {
-    VkInstance       _instance;
+    std::shared_ptr<const Instance> _instance;
+    std::unique_ptr<DispatchTable>  _api; // heap-allocated so references survive moving the Device
+
     VkDevice         _device;
     VkPhysicalDevice _gpu;
 
-    std::vector<VkDeviceQueueCreateInfo> _queue_create_infos;
+    QueueTopology _queue_topology;
+    QueueSet      _queues;
+
+    std::bitset<DEVICE_FEATURE_COUNT> _required_features;
+    std::bitset<DEVICE_FEATURE_COUNT> _optional_features;
+    std::vector<std::string>          _required_extensions;
+    std::vector<std::string>          _optional_extensions;
+    DeviceCapabilities                _capabilities;
+
+    std::unique_ptr<MemoryAllocator> _allocator;
+    std::unique_ptr<PipelineCache>   _pipeline_cache;
 
   public:
     enum class GpuUsage {
@@ -19,8 +46,32 @@ namespace vulkron::gpu::vulkan {
         Transfer  // Memory transfer / copy operations
     };
 
+    enum class GpuSelection {
+        Heuristic, // API version and device type
+        Benchmark  // Micro-benchmarks, memory and features; cached on disk per adapter set and driver
+    };
+
+    // How each candidate fared in the last select_gpu()
+    struct GpuReport {
+        std::string      name;
+        VkPhysicalDevice gpu;
+        double           score            = 0.0;
+        VkDeviceSize     local_memory     = 0;
+        size_t           feature_count    = 0;    // requested features the GPU supports
+        float            timestamp_period = 0.0f; // nanoseconds per timestamp tick
+        GpuProbe         probe;
+        bool             probed           = false;
+        bool             cached           = false; // score came from the selection cache
+    };
+
+  private:
+    std::filesystem::path  _cache_directory;
+    std::vector<GpuReport> _gpu_report;
+
   public:
+    // Creates an Instance of its own
     Device();
+    explicit Device(std::shared_ptr<const Instance> instance);
     ~Device();
 
     Device(const Device&) = delete;
@@ -29,15 +80,67 @@ namespace vulkron::gpu::vulkan {
     Device(Device&& other) noexcept;
     auto operator=(Device&& other) noexcept -> Device&;
 
+    [[nodiscard]] auto instance() const noexcept -> const std::shared_ptr<const Instance>&;
     [[nodiscard]] auto instance_handle() const -> VkInstance;
     [[nodiscard]] auto device_handle() const -> VkDevice;
     [[nodiscard]] auto physical_device_handle() const -> VkPhysicalDevice;
 
-    auto select_gpu(GpuUsage usage) -> void;
+    // Instance functions after construction, device functions once create_device() succeeded, none after being moved from
+    [[nodiscard]] auto dispatch() const noexcept -> const DispatchTable&;
+
+    // Declare before select_gpu(), GPUs missing a required capability are skipped
+    auto require_feature(DeviceFeature feature, Requirement requirement = Requirement::Required) -> void;
+    auto require_extension(std::string_view extension, Requirement requirement = Requirement::Required) -> void;
+
+    auto select_gpu(GpuUsage usage, GpuSelection selection = GpuSelection::Heuristic) -> void;
+    [[nodiscard]] auto gpu_report() const noexcept -> const std::vector<GpuReport>&;
+    // Nanoseconds per timestamp query tick of the selected GPU, 0 before select_gpu()
+    [[nodiscard]] auto timestamp_period() const noexcept -> float;
+
+    // Where benchmark results and pipeline caches are kept, an empty path disables both
+    auto set_cache_directory(std::filesystem::path directory) -> void;
+    [[nodiscard]] auto cache_directory() const noexcept -> const std::filesystem::path&;
+
+    // After select_gpu(), create_device() plans with the default request when this wasn't called
+    auto plan_queues(const QueuePlanRequest& request = {}) -> const QueueTopology&;
+    [[nodiscard]] auto queue_topology() const noexcept -> const QueueTopology&;
 
-    [[nodiscard]] auto request_queue_family(const std::vector<float>& priorities, uint32_t queue_count, VkQueueFlags required_flags, VkQueueFlags excluded_flags) -> uint32_t;
     [[nodiscard]] auto request_queue(uint32_t queue_family_index, uint32_t queue_index) -> VkQueue;
     auto create_device() -> VkDevice;
+
+    // Available once create_device() succeeded
+    [[nodiscard]] auto queues() const noexcept -> const QueueSet&;
+    [[nodiscard]] auto allocator() const -> MemoryAllocator&;
+    [[nodiscard]] auto capabilities() const noexcept -> const DeviceCapabilities&;
+    // Loaded from the cache directory, written back when the Device is destroyed
+    [[nodiscard]] auto pipeline_cache() const -> PipelineCache&;
+
+  private:
+    // Fills `enabled` with every requested feature the adapter supports, names of missing required ones go to `missing`
+    auto resolve_capabilities(const Adapter& adapter, FeatureChain& enabled, std::string& missing) const -> DeviceCapabilities;
+    auto selected_adapter() const -> const Adapter&;
+
+    // Replaces the heuristic scores in _gpu_report, `keys` identify each adapter and driver
+    auto benchmark_gpus(GpuUsage usage, std::span<const std::string> keys) -> void;
   };
 
+  /**
+   * @brief Selects and creates `count` Devices on one Instance at once
+   *
+   * Device 0 is created on the calling thread, every other one on a thread
+   * of its own; the shared Instance is read-only, so they don't contend.
+   * `setup` runs on each Device before select_gpu() to declare requirements
+   * or set its cache directory. The first exception thrown is rethrown once
+   * every thread finished.
+   *
+   * @code
+   * auto instance = std::make_shared<const Instance>();
+   * std::vector<Device> tenants = create_devices(instance, 8, Device::GpuUsage::Compute, [](Device& device, uint32_t) {
+   *     device.require_feature(DeviceFeature::BufferDeviceAddress);
+   * });
+   * @endcode
+   */
+  [[nodiscard]] auto create_devices(const std::shared_ptr<const Instance>& instance, uint32_t count, Device::GpuUsage usage,
+                                    const std::function<void(Device&, uint32_t)>& setup = {}) -> std::vector<Device>;
+
 } // namespace vulkron::gpu::vulkan
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "disk_cache.hpp"
+#include "support/common/config.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+#include <utility>
+
+#if defined(VULKRON_PLATFORM_WINDOWS)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        auto environment_path(const char* name) -> std::filesystem::path {
+            const char* value = std::getenv(name);
+            return value != nullptr && value[0] != '\0' ? std::filesystem::path(value) : std::filesystem::path();
+        }
+
+    } // namespace
+
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER size{};
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                // The view keeps the mapping object alive on its own
+                if (void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0); view != nullptr) {
+                    _data = static_cast<const std::byte*>(view);
+                    _size = static_cast<size_t>(size.QuadPart);
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) {
+            return;
+        }
+
+        struct stat status{};
+        if (::fstat(file, &status) == 0 && status.st_size > 0) {
+            void* view = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (view != MAP_FAILED) {
+                _data = static_cast<const std::byte*>(view);
+                _size = static_cast<size_t>(status.st_size);
+            }
+        }
+        ::close(file);
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+        if (_data == nullptr) {
+            return;
+        }
+#if defined(VULKRON_PLATFORM_WINDOWS)
+        UnmapViewOfFile(_data);
+#else
+        ::munmap(const_cast<std::byte*>(_data), _size);
+#endif
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0))
+    {
+    }
+
+    auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+        if (this != &other) {
+            MappedFile released(std::move(*this));
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    auto MappedFile::bytes() const noexcept -> std::span<const std::byte> {
+        return {_data, _size};
+    }
+
+    auto MappedFile::empty() const noexcept -> bool {
+        return _size == 0;
+    }
+
+    auto default_cache_directory() -> std::filesystem::path {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+        if (auto local = environment_path("LOCALAPPDATA"); !local.empty()) {
+            return local / "vulkron";
+        }
+#else
+        if (auto xdg = environment_path("XDG_CACHE_HOME"); !xdg.empty()) {
+            return xdg / "vulkron";
+        }
+        if (auto home = environment_path("HOME"); !home.empty()) {
+            return home / ".cache" / "vulkron";
+        }
+#endif
+        std::error_code error;
+        auto temp = std::filesystem::temp_directory_path(error);
+        return error ? std::filesystem::path("vulkron-cache") : temp / "vulkron";
+    }
+
+    auto read_cache_file(const std::filesystem::path& path) -> std::optional<std::string> {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return std::nullopt;
+        }
+
+        std::string contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        if (file.bad()) {
+            return std::nullopt;
+        }
+        return contents;
+    }
+
+    auto write_cache_file(const std::filesystem::path& path, std::string_view contents) -> bool {
+        static const uint32_t        process_tag = std::random_device{}();
+        static std::atomic<uint64_t> sequence    = 0;
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // Unique per process and call, concurrent writers never share a temporary
+        std::filesystem::path temporary = path;
+        temporary += ".tmp." + std::to_string(process_tag) + "." + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file || !file.write(contents.data(), static_cast<std::streamsize>(contents.size())) || !file.flush()) {
+                file.close();
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Read-only memory mapping of a cache file
+     *
+     * The file handle is closed right after mapping, so the file can still be
+     * replaced by write_cache_file() while the view is alive.
+     */
+    class MappedFile {
+        const std::byte* _data = nullptr;
+        size_t           _size = 0;
+
+      public:
+        MappedFile() = default;
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+        // Empty when the file is missing, empty or couldn't be mapped
+        [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte>;
+        [[nodiscard]] auto empty() const noexcept -> bool;
+    };
+
+    // $XDG_CACHE_HOME/vulkron, ~/.cache/vulkron or %LOCALAPPDATA%\vulkron, falling back to the temp directory
+    [[nodiscard]] auto default_cache_directory() -> std::filesystem::path;
+
+    // Caches are an optimization: failures are reported through the return value, never thrown
+    [[nodiscard]] auto read_cache_file(const std::filesystem::path& path) -> std::optional<std::string>;
+
+    // Writes to a sibling temporary and renames it into place, so readers never see a torn file
+    auto write_cache_file(const std::filesystem::path& path, std::string_view contents) -> bool;
+
+} // namespace vulkron::gpu::vulkan
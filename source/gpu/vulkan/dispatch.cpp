@@ -0,0 +1,73 @@
+#include "dispatch.hpp"
+#include "support/common/config.hpp"
+
+#include <stdexcept>
+
+#if defined(VULKRON_PLATFORM_WINDOWS)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        // The library is never closed, tables copied out of a Device may outlive it
+        auto open_loader() noexcept -> PFN_vkGetInstanceProcAddr {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+            HMODULE library = LoadLibraryW(L"vulkan-1.dll");
+            if (library == nullptr) {
+                return nullptr;
+            }
+            return reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetProcAddress(library, "vkGetInstanceProcAddr"));
+#else
+            void* library = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+            if (library == nullptr) {
+                library = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+            }
+            if (library == nullptr) {
+                return nullptr;
+            }
+            return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(library, "vkGetInstanceProcAddr"));
+#endif
+        }
+
+    } // namespace
+
+    auto loader_proc_addr() noexcept -> PFN_vkGetInstanceProcAddr {
+        static const PFN_vkGetInstanceProcAddr proc_addr = open_loader();
+        return proc_addr;
+    }
+
+    auto DispatchTable::load_global() -> void {
+        vkGetInstanceProcAddr = loader_proc_addr();
+        if (vkGetInstanceProcAddr == nullptr) {
+            throw std::runtime_error("Failed to load the Vulkan loader library");
+        }
+
+#define VULKRON_VK_LOAD(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(nullptr, #name));
+        VULKRON_VK_GLOBAL_FUNCTIONS(VULKRON_VK_LOAD)
+#undef VULKRON_VK_LOAD
+
+        if (vkCreateInstance == nullptr) {
+            throw std::runtime_error("Vulkan loader doesn't export vkCreateInstance");
+        }
+    }
+
+    auto DispatchTable::load_instance(VkInstance instance) -> void {
+#define VULKRON_VK_LOAD(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(instance, #name));
+        VULKRON_VK_INSTANCE_FUNCTIONS(VULKRON_VK_LOAD)
+#undef VULKRON_VK_LOAD
+    }
+
+    auto DispatchTable::load_device(VkDevice device) -> void {
+#define VULKRON_VK_LOAD(name) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name));
+        VULKRON_VK_DEVICE_FUNCTIONS(VULKRON_VK_LOAD)
+#undef VULKRON_VK_LOAD
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// Every Vulkan entry point the gpu module calls. Adding one is a single line in
+// the list matching the level it is loaded at, DispatchTable picks it up.
+
+// Loaded with a null instance
+#define VULKRON_VK_GLOBAL_FUNCTIONS(X)        \
+    X(vkCreateInstance)                       \
+    X(vkEnumerateInstanceVersion)             \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties)
+
+// Dispatchable from VkInstance or VkPhysicalDevice
+#define VULKRON_VK_INSTANCE_FUNCTIONS(X)            \
+    X(vkDestroyInstance)                            \
+    X(vkEnumeratePhysicalDevices)                   \
+    X(vkEnumerateDeviceExtensionProperties)         \
+    X(vkGetPhysicalDeviceProperties)                \
+    X(vkGetPhysicalDeviceProperties2)               \
+    X(vkGetPhysicalDeviceFeatures2)                 \
+    X(vkGetPhysicalDeviceMemoryProperties)          \
+    X(vkGetPhysicalDeviceMemoryProperties2)         \
+    X(vkGetPhysicalDeviceQueueFamilyProperties)     \
+    X(vkGetPhysicalDeviceQueueFamilyProperties2)    \
+    X(vkGetPhysicalDeviceFormatProperties)          \
+    X(vkCreateDevice)                               \
+    X(vkGetDeviceProcAddr)
+
+// Dispatchable from VkDevice, VkQueue or VkCommandBuffer; loaded straight from the driver
+#define VULKRON_VK_DEVICE_FUNCTIONS(X)      \
+    X(vkDestroyDevice)                      \
+    X(vkDeviceWaitIdle)                     \
+    X(vkGetDeviceQueue)                     \
+    X(vkQueueSubmit)                        \
+    X(vkQueueSubmit2)                       \
+    X(vkQueueWaitIdle)                      \
+                                            \
+    X(vkAllocateMemory)                     \
+    X(vkFreeMemory)                         \
+    X(vkMapMemory)                          \
+    X(vkUnmapMemory)                        \
+    X(vkFlushMappedMemoryRanges)            \
+    X(vkInvalidateMappedMemoryRanges)       \
+    X(vkCreateBuffer)                       \
+    X(vkDestroyBuffer)                      \
+    X(vkCreateImage)                        \
+    X(vkDestroyImage)                       \
+    X(vkCreateImageView)                    \
+    X(vkDestroyImageView)                   \
+    X(vkCreateSampler)                      \
+    X(vkDestroySampler)                     \
+    X(vkGetBufferMemoryRequirements)        \
+    X(vkGetImageMemoryRequirements)         \
+    X(vkBindBufferMemory)                   \
+    X(vkBindImageMemory)                    \
+    X(vkGetBufferDeviceAddress)             \
+                                            \
+    X(vkCreateFence)                        \
+    X(vkDestroyFence)                       \
+    X(vkResetFences)                        \
+    X(vkWaitForFences)                      \
+    X(vkCreateSemaphore)                    \
+    X(vkDestroySemaphore)                   \
+    X(vkGetSemaphoreCounterValue)           \
+    X(vkWaitSemaphores)                     \
+    X(vkSignalSemaphore)                    \
+                                            \
+    X(vkCreateQueryPool)                    \
+    X(vkDestroyQueryPool)                   \
+    X(vkGetQueryPoolResults)                \
+                                            \
+    X(vkCreateShaderModule)                 \
+    X(vkDestroyShaderModule)                \
+    X(vkCreatePipelineCache)                \
+    X(vkDestroyPipelineCache)               \
+    X(vkGetPipelineCacheData)               \
+    X(vkMergePipelineCaches)                \
+    X(vkCreateGraphicsPipelines)            \
+    X(vkCreateComputePipelines)             \
+    X(vkDestroyPipeline)                    \
+    X(vkCreatePipelineLayout)               \
+    X(vkDestroyPipelineLayout)              \
+                                            \
+    X(vkCreateDescriptorSetLayout)          \
+    X(vkDestroyDescriptorSetLayout)         \
+    X(vkCreateDescriptorPool)               \
+    X(vkDestroyDescriptorPool)              \
+    X(vkAllocateDescriptorSets)             \
+    X(vkResetDescriptorPool)                \
+    X(vkUpdateDescriptorSets)               \
+                                            \
+    X(vkCreateCommandPool)                  \
+    X(vkDestroyCommandPool)                 \
+    X(vkResetCommandPool)                   \
+    X(vkAllocateCommandBuffers)             \
+    X(vkFreeCommandBuffers)                 \
+    X(vkBeginCommandBuffer)                 \
+    X(vkEndCommandBuffer)                   \
+                                            \
+    X(vkCmdPipelineBarrier2)                \
+    X(vkCmdBeginRendering)                  \
+    X(vkCmdEndRendering)                    \
+    X(vkCmdExecuteCommands)                 \
+    X(vkCmdBindPipeline)                    \
+    X(vkCmdBindDescriptorSets)              \
+    X(vkCmdPushConstants)                   \
+    X(vkCmdBindVertexBuffers)               \
+    X(vkCmdBindIndexBuffer)                 \
+    X(vkCmdSetViewport)                     \
+    X(vkCmdSetScissor)                      \
+    X(vkCmdDraw)                            \
+    X(vkCmdDrawIndexed)                     \
+    X(vkCmdDispatch)                        \
+    X(vkCmdDispatchIndirect)                \
+    X(vkCmdCopyBuffer)                      \
+    X(vkCmdCopyBuffer2)                     \
+    X(vkCmdCopyBufferToImage2)              \
+    X(vkCmdCopyImageToBuffer2)              \
+    X(vkCmdFillBuffer)                      \
+    X(vkCmdResetQueryPool)                  \
+    X(vkCmdWriteTimestamp)                  \
+    X(vkCmdWriteTimestamp2)                 \
+    X(vkCmdBeginQuery)                      \
+    X(vkCmdEndQuery)
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Vulkan entry points resolved at runtime, one table per Device
+     *
+     * The loader library is opened on first use instead of being linked, so
+     * the gpu module builds with VK_NO_PROTOTYPES and only needs the headers.
+     * Device-level functions come from vkGetDeviceProcAddr and jump straight
+     * into the driver, skipping the loader's per-call trampoline that looks
+     * up the dispatch table behind every handle.
+     *
+     * Entries the instance or device doesn't provide stay null.
+     *
+     * @code
+     * const DispatchTable& api = device.dispatch();
+     * api.vkCmdDispatch(cmd, groups_x, groups_y, 1);
+     * @endcode
+     */
+    struct DispatchTable {
+#define VULKRON_VK_DECLARE(name) PFN_##name name = nullptr;
+        PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+
+        VULKRON_VK_GLOBAL_FUNCTIONS(VULKRON_VK_DECLARE)
+        VULKRON_VK_INSTANCE_FUNCTIONS(VULKRON_VK_DECLARE)
+        VULKRON_VK_DEVICE_FUNCTIONS(VULKRON_VK_DECLARE)
+#undef VULKRON_VK_DECLARE
+
+        // Opens the system loader, throws when no Vulkan runtime is installed
+        auto load_global() -> void;
+        auto load_instance(VkInstance instance) -> void;
+        auto load_device(VkDevice device) -> void;
+    };
+
+    // vkGetInstanceProcAddr of the system loader, opened once per process; null when it's missing
+    [[nodiscard]] auto loader_proc_addr() noexcept -> PFN_vkGetInstanceProcAddr;
+
+} // namespace vulkron::gpu::vulkan
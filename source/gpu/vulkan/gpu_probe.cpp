@@ -0,0 +1,532 @@
+#include "gpu_probe.hpp"
+#include "allocator.hpp"
+#include "instance.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr uint32_t     PROBE_RUNS         = 3;
+        constexpr VkDeviceSize BANDWIDTH_BYTES    = VkDeviceSize{32} << 20;
+        constexpr VkDeviceSize TRANSFER_BYTES     = VkDeviceSize{16} << 20;
+        constexpr uint32_t     COMPUTE_ITERATIONS = 1024;
+        constexpr uint32_t     COMPUTE_GROUPS     = 1024;
+        constexpr uint32_t     WORKGROUP_SIZE     = 64;
+
+        // Owns the throwaway device and everything created on it
+        class ProbeDevice {
+            DispatchTable   _api; // the instance's functions, device ones loaded from the probe device
+            VkDevice        _device       = VK_NULL_HANDLE;
+            VkQueue         _queue        = VK_NULL_HANDLE;
+            VkCommandPool   _pool         = VK_NULL_HANDLE;
+            VkCommandBuffer _cmd          = VK_NULL_HANDLE;
+            VkFence         _fence        = VK_NULL_HANDLE;
+            VkQueryPool     _timestamps   = VK_NULL_HANDLE;
+            double          _tick_seconds = 0.0;
+            uint64_t        _tick_mask    = 0;
+
+            std::unique_ptr<MemoryAllocator> _allocator;
+
+          public:
+            ProbeDevice(const DispatchTable& api, const Adapter& adapter)
+                : _api(api)
+            {
+                const std::vector<VkQueueFamilyProperties>& families = adapter.queue_families;
+
+                // The compute probe needs a compute-capable family, prefer the universal one
+                uint32_t family = UINT32_MAX;
+                for (uint32_t i = 0; i < families.size(); ++i) {
+                    const VkQueueFlags flags = families[i].queueFlags;
+                    if ((flags & VK_QUEUE_COMPUTE_BIT) == 0) {
+                        continue;
+                    }
+                    if ((flags & VK_QUEUE_GRAPHICS_BIT) != 0) {
+                        family = i;
+                        break;
+                    }
+                    if (family == UINT32_MAX) {
+                        family = i;
+                    }
+                }
+
+                if (family == UINT32_MAX) {
+                    throw std::runtime_error("GPU has no compute queue to probe");
+                }
+
+                const float priority = 1.0f;
+                VkDeviceQueueCreateInfo queue_info = {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .queueFamilyIndex = family,
+                    .queueCount       = 1,
+                    .pQueuePriorities = &priority
+                };
+
+                VkDeviceCreateInfo device_info = {
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .queueCreateInfoCount    = 1,
+                    .pQueueCreateInfos       = &queue_info,
+                    .enabledLayerCount       = 0,
+                    .ppEnabledLayerNames     = nullptr,
+                    .enabledExtensionCount   = 0,
+                    .ppEnabledExtensionNames = nullptr,
+                    .pEnabledFeatures        = nullptr
+                };
+
+                if (_api.vkCreateDevice(adapter.gpu, &device_info, nullptr, &_device) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create probe device");
+                }
+                _api.load_device(_device);
+
+                _api.vkGetDeviceQueue(_device, family, 0, &_queue);
+
+                VkCommandPoolCreateInfo pool_info = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                    .queueFamilyIndex = family
+                };
+
+                VkFenceCreateInfo fence_info = {
+                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0
+                };
+
+                if (_api.vkCreateCommandPool(_device, &pool_info, nullptr, &_pool) != VK_SUCCESS ||
+                    _api.vkCreateFence(_device, &fence_info, nullptr, &_fence) != VK_SUCCESS) {
+                    destroy();
+                    throw std::runtime_error("Failed to create probe command objects");
+                }
+
+                VkCommandBufferAllocateInfo allocate_info = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                    .pNext = nullptr,
+                    .commandPool        = _pool,
+                    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                    .commandBufferCount = 1
+                };
+
+                if (_api.vkAllocateCommandBuffers(_device, &allocate_info, &_cmd) != VK_SUCCESS) {
+                    destroy();
+                    throw std::runtime_error("Failed to allocate probe command buffer");
+                }
+
+                const VkPhysicalDeviceLimits& limits = adapter.properties.head()->properties.limits;
+
+                const uint32_t valid_bits = families[family].timestampValidBits;
+                if (valid_bits != 0 && limits.timestampPeriod > 0.0f) {
+                    VkQueryPoolCreateInfo query_info = {
+                        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                        .pNext = nullptr,
+                        .flags = 0,
+                        .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+                        .queryCount         = 2,
+                        .pipelineStatistics = 0
+                    };
+
+                    // Without a query pool the probes fall back to CPU timing
+                    if (_api.vkCreateQueryPool(_device, &query_info, nullptr, &_timestamps) != VK_SUCCESS) {
+                        _timestamps = VK_NULL_HANDLE;
+                    }
+
+                    _tick_seconds = static_cast<double>(limits.timestampPeriod) * 1e-9;
+                    _tick_mask    = valid_bits >= 64 ? UINT64_MAX : (uint64_t{1} << valid_bits) - 1;
+                }
+
+                _allocator = std::make_unique<MemoryAllocator>(_api, adapter, _device);
+            }
+
+            ~ProbeDevice() {
+                destroy();
+            }
+
+            ProbeDevice(const ProbeDevice&) = delete;
+            auto operator=(const ProbeDevice&) -> ProbeDevice& = delete;
+
+            [[nodiscard]] auto api() const noexcept -> const DispatchTable& {
+                return _api;
+            }
+
+            [[nodiscard]] auto device() const noexcept -> VkDevice {
+                return _device;
+            }
+
+            [[nodiscard]] auto allocator() noexcept -> MemoryAllocator& {
+                return *_allocator;
+            }
+
+            // Best-of-PROBE_RUNS duration of the commands `record` emits, in seconds
+            template <typename Record>
+            [[nodiscard]] auto time(Record&& record) -> double {
+                double best = 0.0;
+
+                for (uint32_t run = 0; run < PROBE_RUNS; ++run) {
+                    _api.vkResetCommandPool(_device, _pool, 0);
+
+                    VkCommandBufferBeginInfo begin_info = {
+                        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                        .pNext = nullptr,
+                        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                        .pInheritanceInfo = nullptr
+                    };
+                    _api.vkBeginCommandBuffer(_cmd, &begin_info);
+
+                    if (_timestamps != VK_NULL_HANDLE) {
+                        _api.vkCmdResetQueryPool(_cmd, _timestamps, 0, 2);
+                        _api.vkCmdWriteTimestamp(_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _timestamps, 0);
+                    }
+
+                    record(_cmd);
+
+                    if (_timestamps != VK_NULL_HANDLE) {
+                        _api.vkCmdWriteTimestamp(_cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _timestamps, 1);
+                    }
+
+                    if (_api.vkEndCommandBuffer(_cmd) != VK_SUCCESS) {
+                        throw std::runtime_error("Failed to record probe commands");
+                    }
+
+                    VkSubmitInfo submit_info = {
+                        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                        .pNext = nullptr,
+                        .waitSemaphoreCount   = 0,
+                        .pWaitSemaphores      = nullptr,
+                        .pWaitDstStageMask    = nullptr,
+                        .commandBufferCount   = 1,
+                        .pCommandBuffers      = &_cmd,
+                        .signalSemaphoreCount = 0,
+                        .pSignalSemaphores    = nullptr
+                    };
+
+                    const auto start = std::chrono::steady_clock::now();
+                    if (_api.vkQueueSubmit(_queue, 1, &submit_info, _fence) != VK_SUCCESS ||
+                        _api.vkWaitForFences(_device, 1, &_fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+                        throw std::runtime_error("Probe submission failed");
+                    }
+                    const auto stop = std::chrono::steady_clock::now();
+                    _api.vkResetFences(_device, 1, &_fence);
+
+                    double seconds = std::chrono::duration<double>(stop - start).count();
+
+                    std::array<uint64_t, 2> ticks{};
+                    if (_timestamps != VK_NULL_HANDLE &&
+                        _api.vkGetQueryPoolResults(_device, _timestamps, 0, 2, sizeof(ticks), ticks.data(), sizeof(uint64_t),
+                                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+                        seconds = static_cast<double>((ticks[1] - ticks[0]) & _tick_mask) * _tick_seconds;
+                    }
+
+                    if (run == 0 || seconds < best) {
+                        best = seconds;
+                    }
+                }
+
+                // Guards the divisions below against a zero-length reading on coarse clocks
+                return std::max(best, 1e-9);
+            }
+
+          private:
+            auto destroy() -> void {
+                _allocator.reset();
+
+                if (_device == VK_NULL_HANDLE) {
+                    return;
+                }
+
+                _api.vkDeviceWaitIdle(_device);
+                if (_timestamps != VK_NULL_HANDLE) {
+                    _api.vkDestroyQueryPool(_device, _timestamps, nullptr);
+                }
+                if (_fence != VK_NULL_HANDLE) {
+                    _api.vkDestroyFence(_device, _fence, nullptr);
+                }
+                if (_pool != VK_NULL_HANDLE) {
+                    _api.vkDestroyCommandPool(_device, _pool, nullptr);
+                }
+                _api.vkDestroyDevice(_device, nullptr);
+                _device = VK_NULL_HANDLE;
+            }
+        };
+
+        auto buffer_info(VkDeviceSize size, VkBufferUsageFlags usage) noexcept -> VkBufferCreateInfo {
+            return VkBufferCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size  = size,
+                .usage = usage,
+                .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices   = nullptr
+            };
+        }
+
+        auto copy_seconds(ProbeDevice& probe, MemoryUsage source_usage, VkDeviceSize size) -> double {
+            const DispatchTable& api       = probe.api();
+            MemoryAllocator&     allocator = probe.allocator();
+
+            AllocatedBuffer source      = allocator.create_buffer(buffer_info(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT), source_usage);
+            AllocatedBuffer destination = allocator.create_buffer(buffer_info(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT), MemoryUsage::GpuOnly);
+
+            const VkBufferCopy region = {0, 0, size};
+            const double seconds = probe.time([&](VkCommandBuffer cmd) {
+                api.vkCmdCopyBuffer(cmd, source.buffer, destination.buffer, 1, &region);
+            });
+
+            allocator.destroy_buffer(destination);
+            allocator.destroy_buffer(source);
+            return seconds;
+        }
+
+        auto compute_seconds(ProbeDevice& probe) -> double {
+            const DispatchTable&        api         = probe.api();
+            const VkDevice              device      = probe.device();
+            const VkDeviceSize          output_size = VkDeviceSize{COMPUTE_GROUPS} * WORKGROUP_SIZE * sizeof(float);
+            const std::vector<uint32_t> code        = probe_shader(COMPUTE_ITERATIONS);
+
+            MemoryAllocator& allocator = probe.allocator();
+            AllocatedBuffer  output    = allocator.create_buffer(buffer_info(output_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), MemoryUsage::GpuOnly);
+
+            VkShaderModule        shader     = VK_NULL_HANDLE;
+            VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+            VkPipelineLayout      layout     = VK_NULL_HANDLE;
+            VkPipeline            pipeline   = VK_NULL_HANDLE;
+            VkDescriptorPool      pool       = VK_NULL_HANDLE;
+            VkDescriptorSet       set        = VK_NULL_HANDLE;
+
+            auto cleanup = [&]() {
+                api.vkDestroyDescriptorPool(device, pool, nullptr);
+                api.vkDestroyPipeline(device, pipeline, nullptr);
+                api.vkDestroyPipelineLayout(device, layout, nullptr);
+                api.vkDestroyDescriptorSetLayout(device, set_layout, nullptr);
+                api.vkDestroyShaderModule(device, shader, nullptr);
+                allocator.destroy_buffer(output);
+            };
+
+            VkShaderModuleCreateInfo shader_info = {
+                .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .codeSize = code.size() * sizeof(uint32_t),
+                .pCode    = code.data()
+            };
+
+            VkDescriptorSetLayoutBinding binding = {
+                .binding            = 0,
+                .descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount    = 1,
+                .stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr
+            };
+
+            VkDescriptorSetLayoutCreateInfo set_layout_info = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .bindingCount = 1,
+                .pBindings    = &binding
+            };
+
+            if (api.vkCreateShaderModule(device, &shader_info, nullptr, &shader) != VK_SUCCESS ||
+                api.vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, &set_layout) != VK_SUCCESS) {
+                cleanup();
+                throw std::runtime_error("Failed to create compute probe shader");
+            }
+
+            VkPipelineLayoutCreateInfo layout_info = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .setLayoutCount         = 1,
+                .pSetLayouts            = &set_layout,
+                .pushConstantRangeCount = 0,
+                .pPushConstantRanges    = nullptr
+            };
+
+            if (api.vkCreatePipelineLayout(device, &layout_info, nullptr, &layout) != VK_SUCCESS) {
+                cleanup();
+                throw std::runtime_error("Failed to create compute probe pipeline layout");
+            }
+
+            VkComputePipelineCreateInfo pipeline_info = {
+                .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage = VkPipelineShaderStageCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .module = shader,
+                    .pName  = "main",
+                    .pSpecializationInfo = nullptr
+                },
+                .layout             = layout,
+                .basePipelineHandle = VK_NULL_HANDLE,
+                .basePipelineIndex  = -1
+            };
+
+            if (api.vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS) {
+                cleanup();
+                throw std::runtime_error("Failed to create compute probe pipeline");
+            }
+
+            VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};
+            VkDescriptorPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .maxSets       = 1,
+                .poolSizeCount = 1,
+                .pPoolSizes    = &pool_size
+            };
+
+            if (api.vkCreateDescriptorPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+                cleanup();
+                throw std::runtime_error("Failed to create compute probe descriptor pool");
+            }
+
+            VkDescriptorSetAllocateInfo set_info = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .descriptorPool     = pool,
+                .descriptorSetCount = 1,
+                .pSetLayouts        = &set_layout
+            };
+
+            if (api.vkAllocateDescriptorSets(device, &set_info, &set) != VK_SUCCESS) {
+                cleanup();
+                throw std::runtime_error("Failed to allocate compute probe descriptor set");
+            }
+
+            VkDescriptorBufferInfo descriptor = {output.buffer, 0, VK_WHOLE_SIZE};
+            VkWriteDescriptorSet write = {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet           = set,
+                .dstBinding       = 0,
+                .dstArrayElement  = 0,
+                .descriptorCount  = 1,
+                .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pImageInfo       = nullptr,
+                .pBufferInfo      = &descriptor,
+                .pTexelBufferView = nullptr
+            };
+            api.vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+            const double seconds = probe.time([&](VkCommandBuffer cmd) {
+                api.vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                api.vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+                api.vkCmdDispatch(cmd, COMPUTE_GROUPS, 1, 1);
+            });
+
+            cleanup();
+            return seconds;
+        }
+
+    } // namespace
+
+    auto probe_gpu(const DispatchTable& api, const Adapter& adapter) -> GpuProbe {
+        ProbeDevice probe(api, adapter);
+
+        GpuProbe result;
+        result.bandwidth_gbps = 2.0 * static_cast<double>(BANDWIDTH_BYTES) / copy_seconds(probe, MemoryUsage::GpuOnly, BANDWIDTH_BYTES) * 1e-9;
+        result.transfer_gbps  = static_cast<double>(TRANSFER_BYTES) / copy_seconds(probe, MemoryUsage::Upload, TRANSFER_BYTES) * 1e-9;
+
+        const double flops = 2.0 * COMPUTE_ITERATIONS * COMPUTE_GROUPS * WORKGROUP_SIZE;
+        result.compute_gflops = flops / compute_seconds(probe) * 1e-9;
+
+        return result;
+    }
+
+    auto probe_shader(uint32_t iterations) -> std::vector<uint32_t> {
+        // Hand-assembled SPIR-V 1.0, equivalent to
+        //
+        //   layout(local_size_x = 64) in;
+        //   layout(set = 0, binding = 0) buffer Output { float values[]; };
+        //   void main() {
+        //       uint  index = gl_GlobalInvocationID.x;
+        //       float seed  = float(index);
+        //       float x     = seed;
+        //       for (...) x = x * seed + 0.5;   // unrolled `iterations` times
+        //       values[index] = x;
+        //   }
+        //
+        // The multiplier is not a constant, so the chain can't be folded away.
+        enum : uint32_t {
+            VOID = 1, FUNCTION_TYPE, UINT, FLOAT, UVEC3, INPUT_UVEC3, GLOBAL_ID, FLOAT_ARRAY, OUTPUT_BLOCK,
+            UNIFORM_BLOCK, OUTPUT, UNIFORM_FLOAT, ZERO, HALF, MAIN, ENTRY, GLOBAL_ID_VALUE, INDEX, SEED,
+            FIRST_FREE_ID
+        };
+
+        std::vector<uint32_t> code = {0x07230203, 0x00010000, 0, 0, 0};
+
+        auto op = [&code](uint32_t opcode, std::initializer_list<uint32_t> operands) {
+            code.push_back(static_cast<uint32_t>(operands.size() + 1) << 16 | opcode);
+            code.insert(code.end(), operands);
+        };
+
+        op(17, {1});                                     // OpCapability Shader
+        op(14, {0, 1});                                  // OpMemoryModel Logical GLSL450
+        op(15, {5, MAIN, 0x6E69616D, 0, GLOBAL_ID});     // OpEntryPoint GLCompute "main"
+        op(16, {MAIN, 17, WORKGROUP_SIZE, 1, 1});        // OpExecutionMode LocalSize
+
+        op(71, {GLOBAL_ID, 11, 28});                     // BuiltIn GlobalInvocationId
+        op(71, {FLOAT_ARRAY, 6, 4});                     // ArrayStride 4
+        op(72, {OUTPUT_BLOCK, 0, 35, 0});                // member 0 Offset 0
+        op(71, {OUTPUT_BLOCK, 3});                       // BufferBlock
+        op(71, {OUTPUT, 34, 0});                         // DescriptorSet 0
+        op(71, {OUTPUT, 33, 0});                         // Binding 0
+
+        op(19, {VOID});
+        op(33, {FUNCTION_TYPE, VOID});
+        op(21, {UINT, 32, 0});
+        op(22, {FLOAT, 32});
+        op(23, {UVEC3, UINT, 3});
+        op(32, {INPUT_UVEC3, 1, UVEC3});                 // Input
+        op(59, {INPUT_UVEC3, GLOBAL_ID, 1});
+        op(29, {FLOAT_ARRAY, FLOAT});
+        op(30, {OUTPUT_BLOCK, FLOAT_ARRAY});
+        op(32, {UNIFORM_BLOCK, 2, OUTPUT_BLOCK});        // Uniform
+        op(59, {UNIFORM_BLOCK, OUTPUT, 2});
+        op(32, {UNIFORM_FLOAT, 2, FLOAT});
+        op(43, {UINT, ZERO, 0});
+        op(43, {FLOAT, HALF, 0x3F000000});               // 0.5f
+
+        op(54, {VOID, MAIN, 0, FUNCTION_TYPE});
+        op(248, {ENTRY});
+        op(61, {UVEC3, GLOBAL_ID_VALUE, GLOBAL_ID});     // OpLoad
+        op(81, {UINT, INDEX, GLOBAL_ID_VALUE, 0});       // OpCompositeExtract .x
+        op(112, {FLOAT, SEED, INDEX});                   // OpConvertUToF
+
+        uint32_t next = FIRST_FREE_ID;
+        uint32_t x    = SEED;
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const uint32_t product = next++;
+            const uint32_t sum     = next++;
+            op(133, {FLOAT, product, x, SEED});          // OpFMul
+            op(129, {FLOAT, sum, product, HALF});        // OpFAdd
+            x = sum;
+        }
+
+        const uint32_t element = next++;
+        op(65, {UNIFORM_FLOAT, element, OUTPUT, ZERO, INDEX}); // OpAccessChain
+        op(62, {element, x});                            // OpStore
+        op(253, {});                                     // OpReturn
+        op(56, {});                                      // OpFunctionEnd
+
+        code[3] = next; // id bound
+        return code;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "dispatch.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    struct Adapter;
+
+    /**
+     * @brief Micro-benchmark results of one adapter
+     *
+     * Every number is the best of a few short runs, timed with GPU timestamps
+     * when the queue supports them and with the CPU clock otherwise.
+     */
+    struct GpuProbe {
+        double bandwidth_gbps = 0.0; // device-local to device-local copy, read + write bytes
+        double compute_gflops = 0.0; // dependent multiply-add chains
+        double transfer_gbps  = 0.0; // host-visible to device-local copy
+    };
+
+    // Creates a short-lived VkDevice on the adapter, runs the probes and tears it down again
+    [[nodiscard]] auto probe_gpu(const DispatchTable& api, const Adapter& adapter) -> GpuProbe;
+
+    // SPIR-V of the compute probe, `iterations` multiply-adds per invocation in a 64-wide workgroup
+    [[nodiscard]] auto probe_shader(uint32_t iterations) -> std::vector<uint32_t>;
+
+} // namespace vulkron::gpu::vulkan
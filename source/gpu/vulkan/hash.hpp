@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Incremental 64-bit FNV-1a, for cache keys and checksums
+     *
+     * Not collision resistant against adversarial input, only meant for data
+     * the application produces itself.
+     */
+    class Hasher {
+        uint64_t _state = 0xcbf29ce484222325ull;
+
+      public:
+        constexpr auto update(std::span<const std::byte> bytes) noexcept -> Hasher& {
+            for (std::byte byte : bytes) {
+                _state = (_state ^ static_cast<uint64_t>(byte)) * 0x100000001b3ull;
+            }
+            return *this;
+        }
+
+        // Length-prefixed so consecutive strings can't run into each other
+        auto update(std::string_view text) noexcept -> Hasher& {
+            value(static_cast<uint64_t>(text.size()));
+            return update(std::as_bytes(std::span(text.data(), text.size())));
+        }
+
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        auto value(const T& object) noexcept -> Hasher& {
+            return update(std::as_bytes(std::span(&object, 1)));
+        }
+
+        [[nodiscard]] constexpr auto digest() const noexcept -> uint64_t {
+            return _state;
+        }
+    };
+
+    [[nodiscard]] inline auto hash_bytes(std::span<const std::byte> bytes) noexcept -> uint64_t {
+        return Hasher{}.update(bytes).digest();
+    }
+
+    [[nodiscard]] inline auto hex(uint64_t value) -> std::string {
+        constexpr char digits[] = "0123456789abcdef";
+
+        std::string text(16, '0');
+        for (size_t i = 0; i < 16; ++i) {
+            text[15 - i] = digits[(value >> (i * 4)) & 0xf];
+        }
+        return text;
+    }
+
+} // namespace vulkron::gpu::vulkan
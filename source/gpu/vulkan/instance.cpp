@@ -0,0 +1,135 @@
+#include "instance.hpp"
+#include "support/common/small_vector.hpp"
+#include "support/profiler/profiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        auto device_local_bytes(const VkPhysicalDeviceMemoryProperties& memory) -> VkDeviceSize {
+            VkDeviceSize bytes = 0;
+            for (uint32_t i = 0; i < memory.memoryHeapCount; ++i) {
+                const VkMemoryHeap& heap = memory.memoryHeaps[i];
+                if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                    bytes += heap.size;
+                }
+            }
+            return bytes;
+        }
+
+    } // namespace
+
+    Instance::Instance()
+        : _api(std::make_unique<DispatchTable>())
+    {
+        VULKRON_PROFILE_ZONE("Instance::Instance");
+
+        VkApplicationInfo application_info = {
+            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .pNext = nullptr,
+            .pApplicationName   = "Vulkron",
+            .applicationVersion = VK_MAKE_VERSION(0, 1, 0),
+            .pEngineName        = "Vulkron",
+            .engineVersion      = VK_MAKE_VERSION(0, 1, 0),
+            .apiVersion         = VK_API_VERSION_1_4
+        };
+
+        VkInstanceCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .pApplicationInfo        = &application_info,
+            .enabledLayerCount       = 0,
+            .ppEnabledLayerNames     = nullptr,
+            .enabledExtensionCount   = 0,
+            .ppEnabledExtensionNames = nullptr
+        };
+
+        {
+            VULKRON_PROFILE_ZONE("vkCreateInstance");
+            _api->load_global();
+            if (_api->vkCreateInstance(&create_info, nullptr, &_instance) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create Vulkan instance");
+            }
+            _api->load_instance(_instance);
+        }
+
+        try {
+            VULKRON_PROFILE_ZONE("Instance adapters");
+
+            uint32_t gpu_count = 0;
+            _api->vkEnumeratePhysicalDevices(_instance, &gpu_count, nullptr);
+
+            support::SmallVector<VkPhysicalDevice, 8> gpus(gpu_count);
+            _api->vkEnumeratePhysicalDevices(_instance, &gpu_count, gpus.data());
+
+            _adapters.reserve(gpu_count);
+            for (uint32_t i = 0; i < gpu_count; ++i) {
+                _adapters.push_back(query_adapter(gpus[i]));
+            }
+        } catch (...) {
+            _api->vkDestroyInstance(_instance, nullptr);
+            throw;
+        }
+    }
+
+    Instance::~Instance() {
+        _api->vkDestroyInstance(_instance, nullptr);
+    }
+
+    auto Instance::handle() const noexcept -> VkInstance {
+        return _instance;
+    }
+
+    auto Instance::dispatch() const noexcept -> const DispatchTable& {
+        return *_api;
+    }
+
+    auto Instance::adapters() const noexcept -> std::span<const Adapter> {
+        return _adapters;
+    }
+
+    auto Instance::adapter(VkPhysicalDevice gpu) const noexcept -> const Adapter* {
+        auto found = std::ranges::find(_adapters, gpu, &Adapter::gpu);
+        return found != _adapters.end() ? &*found : nullptr;
+    }
+
+    auto Instance::query_adapter(VkPhysicalDevice gpu) const -> Adapter {
+        Adapter adapter = {
+            .gpu            = gpu,
+            .api_version    = device_api_version(*_api, gpu),
+            .properties     = {},
+            .local_memory   = 0,
+            .queue_families = {},
+            .extensions     = device_extensions(*_api, gpu),
+            .features       = {}
+        };
+
+        // Chaining a struct of a core version the device doesn't expose is invalid
+        if (adapter.api_version < VK_API_VERSION_1_2) adapter.properties.unlink<VkPhysicalDeviceVulkan12Properties>();
+        if (adapter.api_version < VK_API_VERSION_1_3) adapter.properties.unlink<VkPhysicalDeviceVulkan13Properties>();
+        if (adapter.api_version < VK_API_VERSION_1_4) adapter.properties.unlink<VkPhysicalDeviceVulkan14Properties>();
+        _api->vkGetPhysicalDeviceProperties2(gpu, adapter.properties.head());
+
+        VkPhysicalDeviceMemoryProperties memory;
+        _api->vkGetPhysicalDeviceMemoryProperties(gpu, &memory);
+        adapter.local_memory = device_local_bytes(memory);
+
+        uint32_t family_count = 0;
+        _api->vkGetPhysicalDeviceQueueFamilyProperties(gpu, &family_count, nullptr);
+        adapter.queue_families.resize(family_count);
+        _api->vkGetPhysicalDeviceQueueFamilyProperties(gpu, &family_count, adapter.queue_families.data());
+
+        FeatureChain supported(adapter.api_version);
+        supported.query(*_api, gpu);
+        for (size_t i = 0; i < DEVICE_FEATURE_COUNT; ++i) {
+            adapter.features.set(i, supported.supports(static_cast<DeviceFeature>(i)));
+        }
+
+        return adapter;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "capabilities.hpp"
+#include "dispatch.hpp"
+#include "structchain.hpp"
+
+#include <bitset>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Everything Device needs to know about one physical device, queried once
+     */
+    struct Adapter {
+        using Properties = StructChain<VkPhysicalDeviceProperties2,
+                                       VkPhysicalDeviceVulkan11Properties,
+                                       VkPhysicalDeviceVulkan12Properties,
+                                       VkPhysicalDeviceVulkan13Properties,
+                                       VkPhysicalDeviceVulkan14Properties>;
+
+        VkPhysicalDevice                     gpu;
+        uint32_t                             api_version;
+        Properties                           properties; // structs above api_version are left unlinked and zeroed
+        VkDeviceSize                         local_memory;
+        std::vector<VkQueueFamilyProperties> queue_families;
+        std::vector<std::string>             extensions; // sorted
+        std::bitset<DEVICE_FEATURE_COUNT>    features;   // supported
+
+        [[nodiscard]] auto name() const noexcept -> const char* {
+            return properties.head()->properties.deviceName;
+        }
+    };
+
+    /**
+     * @brief A VkInstance shared by any number of Devices
+     *
+     * Opening the loader, creating the instance and enumerating adapters is
+     * paid once instead of once per Device. Every adapter's properties,
+     * queue families, extensions and features are queried in the
+     * constructor, so select_gpu() and create_device() of each Device read
+     * the cache instead of calling into the driver again.
+     *
+     * The cache never changes after construction, so Devices sharing an
+     * Instance can select and create concurrently, see create_devices().
+     * Devices keep their Instance alive through a shared_ptr.
+     *
+     * @code
+     * auto instance = std::make_shared<const Instance>();
+     *
+     * Device renderer(instance);
+     * renderer.select_gpu(Device::GpuUsage::Graphics);
+     * renderer.create_device();
+     *
+     * Device tenant(instance);
+     * tenant.select_gpu(Device::GpuUsage::Compute);
+     * tenant.create_device();
+     * @endcode
+     */
+    class Instance {
+        std::unique_ptr<DispatchTable> _api; // Devices copy the instance level entries out of it
+        VkInstance                     _instance = VK_NULL_HANDLE;
+        std::vector<Adapter>           _adapters;
+
+      public:
+        Instance();
+        ~Instance();
+
+        Instance(const Instance&) = delete;
+        auto operator=(const Instance&) -> Instance& = delete;
+
+        Instance(Instance&&) = delete;
+        auto operator=(Instance&&) -> Instance& = delete;
+
+        [[nodiscard]] auto handle() const noexcept -> VkInstance;
+
+        // Global and instance functions, no device functions
+        [[nodiscard]] auto dispatch() const noexcept -> const DispatchTable&;
+
+        // In enumeration order
+        [[nodiscard]] auto adapters() const noexcept -> std::span<const Adapter>;
+
+        // nullptr for a handle that isn't one of this instance's adapters
+        [[nodiscard]] auto adapter(VkPhysicalDevice gpu) const noexcept -> const Adapter*;
+
+      private:
+        auto query_adapter(VkPhysicalDevice gpu) const -> Adapter;
+    };
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,274 @@
+#include "offscreen.hpp"
+#include "deletion_queue.hpp"
+#include "device.hpp"
+
+#include <array>
+#include <span>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        auto has_stencil(VkFormat format) noexcept -> bool {
+            return format == VK_FORMAT_S8_UINT ||
+                   format == VK_FORMAT_D16_UNORM_S8_UINT ||
+                   format == VK_FORMAT_D24_UNORM_S8_UINT ||
+                   format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+        }
+
+        auto depth_aspect(VkFormat format) noexcept -> VkImageAspectFlags {
+            if (format == VK_FORMAT_S8_UINT) {
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
+            return has_stencil(format) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+
+        auto whole_image(VkImageAspectFlags aspect) noexcept -> VkImageSubresourceRange {
+            return VkImageSubresourceRange{
+                .aspectMask     = aspect,
+                .baseMipLevel   = 0,
+                .levelCount     = 1,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            };
+        }
+
+        auto image_barrier(VkImage image, VkImageAspectFlags aspect) noexcept -> VkImageMemoryBarrier2 {
+            return VkImageMemoryBarrier2{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask  = VK_PIPELINE_STAGE_2_NONE,
+                .srcAccessMask = VK_ACCESS_2_NONE,
+                .dstStageMask  = VK_PIPELINE_STAGE_2_NONE,
+                .dstAccessMask = VK_ACCESS_2_NONE,
+                .oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout     = VK_IMAGE_LAYOUT_UNDEFINED,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image            = image,
+                .subresourceRange = whole_image(aspect)
+            };
+        }
+
+        auto pipeline_barrier(const DispatchTable& api, VkCommandBuffer cmd, std::span<const VkImageMemoryBarrier2> barriers) -> void {
+            VkDependencyInfo info = {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags          = 0,
+                .memoryBarrierCount       = 0,
+                .pMemoryBarriers          = nullptr,
+                .bufferMemoryBarrierCount = 0,
+                .pBufferMemoryBarriers    = nullptr,
+                .imageMemoryBarrierCount  = static_cast<uint32_t>(barriers.size()),
+                .pImageMemoryBarriers     = barriers.data()
+            };
+            api.vkCmdPipelineBarrier2(cmd, &info);
+        }
+
+    } // namespace
+
+    OffscreenTargets::OffscreenTargets(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _allocator(device.allocator()),
+        _config(config)
+    {
+        if (_config.width == 0 || _config.height == 0) {
+            throw std::runtime_error("Offscreen targets need a non-zero extent");
+        }
+        if (_config.count == 0) {
+            _config.count = 1;
+        }
+
+        create_targets();
+    }
+
+    OffscreenTargets::~OffscreenTargets() {
+        destroy();
+    }
+
+    auto OffscreenTargets::begin(VkCommandBuffer cmd, uint32_t index, VkRenderingFlags flags) -> void {
+        const Target& current = target(index);
+        const bool    depth   = current.depth_view != VK_NULL_HANDLE;
+
+        // The frame that last used this target has retired, its contents are simply discarded
+        std::array<VkImageMemoryBarrier2, 2> barriers = {
+            image_barrier(current.color.image, VK_IMAGE_ASPECT_COLOR_BIT),
+            image_barrier(current.depth.image, depth_aspect(_config.depth_format))
+        };
+
+        barriers[0].dstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        barriers[0].newLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        barriers[1].dstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barriers[1].newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        pipeline_barrier(_api, cmd, std::span(barriers.data(), depth ? 2 : 1));
+
+        VkRenderingAttachmentInfo color_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .pNext = nullptr,
+            .imageView          = current.color_view,
+            .imageLayout        = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .resolveMode        = VK_RESOLVE_MODE_NONE,
+            .resolveImageView   = VK_NULL_HANDLE,
+            .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .loadOp             = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp            = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue         = {.color = _config.clear_color}
+        };
+
+        VkRenderingAttachmentInfo depth_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .pNext = nullptr,
+            .imageView          = current.depth_view,
+            .imageLayout        = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .resolveMode        = VK_RESOLVE_MODE_NONE,
+            .resolveImageView   = VK_NULL_HANDLE,
+            .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .loadOp             = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp            = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue         = {.depthStencil = {.depth = 1.0f, .stencil = 0}}
+        };
+
+        const bool stencil = depth && has_stencil(_config.depth_format);
+
+        VkRenderingInfo rendering_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = flags,
+            .renderArea           = {.offset = {0, 0}, .extent = extent()},
+            .layerCount           = 1,
+            .viewMask             = 0,
+            .colorAttachmentCount = 1,
+            .pColorAttachments    = &color_attachment,
+            .pDepthAttachment     = depth && _config.depth_format != VK_FORMAT_S8_UINT ? &depth_attachment : nullptr,
+            .pStencilAttachment   = stencil ? &depth_attachment : nullptr
+        };
+
+        _api.vkCmdBeginRendering(cmd, &rendering_info);
+    }
+
+    auto OffscreenTargets::end(VkCommandBuffer cmd, uint32_t index) -> void {
+        const Target& current = target(index);
+
+        _api.vkCmdEndRendering(cmd);
+
+        VkImageMemoryBarrier2 barrier = image_barrier(current.color.image, VK_IMAGE_ASPECT_COLOR_BIT);
+        barrier.srcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        pipeline_barrier(_api, cmd, std::span(&barrier, 1));
+    }
+
+    auto OffscreenTargets::resize(uint32_t width, uint32_t height, DeletionQueue& retired, uint64_t last_use) -> void {
+        if (width == 0 || height == 0) {
+            throw std::runtime_error("Offscreen targets need a non-zero extent");
+        }
+
+        // Frames up to `last_use` may still render into the old images
+        for (Target& target : _targets) {
+            retired.retire(target.depth_view, last_use);
+            retired.retire(target.color_view, last_use);
+            retired.retire(target.depth, last_use);
+            retired.retire(target.color, last_use);
+        }
+        _targets.clear();
+
+        _config.width  = width;
+        _config.height = height;
+        create_targets();
+    }
+
+    auto OffscreenTargets::target(uint32_t index) const -> const Target& {
+        if (index >= _targets.size()) {
+            throw std::runtime_error("Offscreen target index out of range");
+        }
+        return _targets[index];
+    }
+
+    auto OffscreenTargets::extent() const noexcept -> VkExtent2D {
+        return VkExtent2D{_config.width, _config.height};
+    }
+
+    auto OffscreenTargets::config() const noexcept -> const Config& {
+        return _config;
+    }
+
+    auto OffscreenTargets::create_targets() -> void {
+        _targets.resize(_config.count);
+
+        try {
+            for (Target& target : _targets) {
+                create_image(_config.color_format,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                             VK_IMAGE_ASPECT_COLOR_BIT, target.color, target.color_view);
+
+                // Depth never leaves the frame, the driver may keep it in tile memory
+                if (_config.depth_format != VK_FORMAT_UNDEFINED) {
+                    create_image(_config.depth_format,
+                                 VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                                 depth_aspect(_config.depth_format), target.depth, target.depth_view);
+                }
+            }
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+
+    auto OffscreenTargets::create_image(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, AllocatedImage& image, VkImageView& view) -> void {
+        VkImageCreateInfo image_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .imageType             = VK_IMAGE_TYPE_2D,
+            .format                = format,
+            .extent                = {_config.width, _config.height, 1},
+            .mipLevels             = 1,
+            .arrayLayers           = 1,
+            .samples               = VK_SAMPLE_COUNT_1_BIT,
+            .tiling                = VK_IMAGE_TILING_OPTIMAL,
+            .usage                 = usage,
+            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices   = nullptr,
+            .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+
+        image = _allocator.create_image(image_info, MemoryUsage::GpuOnly);
+
+        VkImageViewCreateInfo view_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .image            = image.image,
+            .viewType         = VK_IMAGE_VIEW_TYPE_2D,
+            .format           = format,
+            .components       = {},
+            .subresourceRange = whole_image(aspect)
+        };
+
+        if (_api.vkCreateImageView(_device, &view_info, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image view");
+        }
+    }
+
+    auto OffscreenTargets::destroy() noexcept -> void {
+        for (Target& target : _targets) {
+            _api.vkDestroyImageView(_device, target.depth_view, nullptr);
+            _api.vkDestroyImageView(_device, target.color_view, nullptr);
+            _allocator.destroy_image(target.depth);
+            _allocator.destroy_image(target.color);
+        }
+        _targets.clear();
+    }
+
+} // namespace vulkron::gpu::vulkan
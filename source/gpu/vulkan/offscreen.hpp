@@ -0,0 +1,94 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "dispatch.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+    class DeletionQueue;
+
+    /**
+     * @brief Render targets for rendering without a surface or swapchain
+     *
+     * One color image, and optionally one depth image, per frame in flight.
+     * A target is only reused once the frame that last rendered into it has
+     * retired, which CommandRecorder already guarantees when the target is
+     * picked by its frame_index(), so no extra synchronization is needed.
+     *
+     * begin() discards the previous contents and clears; end() leaves the
+     * color image in TRANSFER_SRC_OPTIMAL, ready to be copied out.
+     *
+     * resize() hands the old images to a DeletionQueue instead of waiting
+     * for the frames still rendering into them.
+     *
+     * @code
+     * OffscreenTargets targets(device, {.width = 1920, .height = 1080, .count = 3});
+     *
+     * VkCommandBuffer cmd = recorder.begin_frame();
+     * targets.begin(cmd, recorder.frame_index(), VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+     * recorder.record_parallel(64, draw_chunk, &inheritance);
+     * targets.end(cmd, recorder.frame_index());
+     * recorder.end_frame();
+     * @endcode
+     */
+    class OffscreenTargets {
+      public:
+        struct Config {
+            uint32_t          width;
+            uint32_t          height;
+            VkFormat          color_format = VK_FORMAT_R8G8B8A8_UNORM;
+            VkFormat          depth_format = VK_FORMAT_UNDEFINED; // no depth attachment
+            uint32_t          count        = 2;
+            VkClearColorValue clear_color  = {};
+        };
+
+        struct Target {
+            AllocatedImage color;
+            VkImageView    color_view = VK_NULL_HANDLE;
+            AllocatedImage depth;
+            VkImageView    depth_view = VK_NULL_HANDLE;
+        };
+
+      private:
+        const DispatchTable& _api;
+        VkDevice             _device;
+        MemoryAllocator&     _allocator;
+        Config               _config;
+
+        std::vector<Target> _targets;
+
+      public:
+        OffscreenTargets(Device& device, const Config& config);
+        ~OffscreenTargets();
+
+        OffscreenTargets(const OffscreenTargets&) = delete;
+        auto operator=(const OffscreenTargets&) -> OffscreenTargets& = delete;
+
+        OffscreenTargets(OffscreenTargets&&) = delete;
+        auto operator=(OffscreenTargets&&) -> OffscreenTargets& = delete;
+
+        // Transitions target `index` for rendering and begins clearing it
+        auto begin(VkCommandBuffer cmd, uint32_t index, VkRenderingFlags flags = 0) -> void;
+
+        // Ends rendering and makes the color image a transfer source
+        auto end(VkCommandBuffer cmd, uint32_t index) -> void;
+
+        // Replaces every target, the old ones are destroyed once the timeline reaches `last_use`
+        auto resize(uint32_t width, uint32_t height, DeletionQueue& retired, uint64_t last_use) -> void;
+
+        [[nodiscard]] auto target(uint32_t index) const -> const Target&;
+        [[nodiscard]] auto extent() const noexcept -> VkExtent2D;
+        [[nodiscard]] auto config() const noexcept -> const Config&;
+
+      private:
+        auto create_targets() -> void;
+        auto create_image(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, AllocatedImage& image, VkImageView& view) -> void;
+        auto destroy() noexcept -> void;
+    };
+
+} // namespace vulkron::gpu::vulkan
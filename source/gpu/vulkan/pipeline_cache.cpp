@@ -0,0 +1,317 @@
+#include "pipeline_cache.hpp"
+#include "disk_cache.hpp"
+#include "hash.hpp"
+#include "instance.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr char     FILE_MAGIC[8] = {'V', 'K', 'R', 'N', 'P', 'S', 'O', '\0'};
+        constexpr uint32_t FILE_VERSION  = 1;
+
+        // Precedes the driver's blob, identifies who may load it
+        struct FileHeader {
+            char     magic[8];
+            uint32_t version;
+            uint32_t vendor_id;
+            uint32_t device_id;
+            uint32_t driver_version;
+            uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+            uint8_t  driver_uuid[VK_UUID_SIZE];
+            uint64_t data_size;
+            uint64_t checksum;
+        };
+        static_assert(std::is_trivially_copyable_v<FileHeader>);
+
+        // Leading fields of VkPipelineCacheHeaderVersionOne, which every blob starts with
+        constexpr size_t VK_CACHE_HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+        auto expected_header(const Adapter& adapter) -> FileHeader {
+            const VkPhysicalDeviceProperties&         properties = adapter.properties.head()->properties;
+            const VkPhysicalDeviceVulkan11Properties& vk11       = adapter.properties.get<VkPhysicalDeviceVulkan11Properties>();
+
+            FileHeader header{};
+            std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+            header.version        = FILE_VERSION;
+            header.vendor_id      = properties.vendorID;
+            header.device_id      = properties.deviceID;
+            header.driver_version = properties.driverVersion;
+            std::memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+            std::memcpy(header.driver_uuid, vk11.driverUUID, VK_UUID_SIZE);
+            return header;
+        }
+
+        // Payload of a file written for `expected`, empty when the file doesn't match
+        auto validate(std::span<const std::byte> file, const FileHeader& expected) -> std::span<const std::byte> {
+            if (file.size() < sizeof(FileHeader)) {
+                return {};
+            }
+
+            FileHeader header;
+            std::memcpy(&header, file.data(), sizeof(FileHeader));
+
+            // Everything except size and checksum has to match byte for byte
+            if (std::memcmp(&header, &expected, offsetof(FileHeader, data_size)) != 0) {
+                return {};
+            }
+
+            std::span<const std::byte> payload = file.subspan(sizeof(FileHeader));
+            if (payload.size() != header.data_size || payload.size() < VK_CACHE_HEADER_SIZE || hash_bytes(payload) != header.checksum) {
+                return {};
+            }
+
+            // The driver's own header has to agree with ours as well
+            uint32_t vk_header[4];
+            std::memcpy(vk_header, payload.data(), sizeof(vk_header));
+            const bool vk_header_matches = vk_header[0] >= VK_CACHE_HEADER_SIZE
+                && vk_header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && vk_header[2] == expected.vendor_id
+                && vk_header[3] == expected.device_id
+                && std::memcmp(payload.data() + sizeof(vk_header), expected.pipeline_cache_uuid, VK_UUID_SIZE) == 0;
+
+            return vk_header_matches ? payload : std::span<const std::byte>{};
+        }
+
+        auto create_cache(const DispatchTable& api, VkDevice device, std::span<const std::byte> initial_data) -> VkPipelineCache {
+            VkPipelineCacheCreateInfo create_info = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .initialDataSize = initial_data.size(),
+                .pInitialData    = initial_data.data()
+            };
+
+            VkPipelineCache cache = nullptr;
+            if (api.vkCreatePipelineCache(device, &create_info, nullptr, &cache) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline cache");
+            }
+            return cache;
+        }
+
+        // The cache may grow between the size query and the copy when other threads insert into it
+        auto cache_data(const DispatchTable& api, VkDevice device, VkPipelineCache cache, size_t offset) -> std::vector<std::byte> {
+            std::vector<std::byte> data;
+            VkResult               result;
+            do {
+                size_t size = 0;
+                if (api.vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS) {
+                    return {};
+                }
+                data.resize(offset + size);
+                result = api.vkGetPipelineCacheData(device, cache, &size, data.data() + offset);
+                data.resize(offset + size);
+            } while (result == VK_INCOMPLETE);
+
+            return result == VK_SUCCESS ? data : std::vector<std::byte>{};
+        }
+
+        // PipelineCaches by id, a thread exiting after its cache was destroyed finds nothing here
+        struct LiveCaches {
+            std::mutex                                   mutex;
+            std::unordered_map<uint64_t, PipelineCache*> caches;
+            uint64_t                                     next_id = 0;
+        };
+
+        // Never destroyed, threads may still exit while statics are torn down
+        auto live_caches() -> LiveCaches& {
+            static LiveCaches* instance = new LiveCaches();
+            return *instance;
+        }
+
+    } // namespace
+
+    // Hands the thread's caches back on exit, so short-lived threads such as the compilers'
+    // don't each leave a VkPipelineCache behind
+    struct PipelineCache::ThreadOwner {
+        std::vector<uint64_t> caches; // ids of the PipelineCaches this thread took a handle from
+
+        ~ThreadOwner() {
+            LiveCaches& live = live_caches();
+            std::lock_guard lock(live.mutex);
+            for (const uint64_t id : caches) {
+                if (const auto it = live.caches.find(id); it != live.caches.end()) {
+                    it->second->release_thread_handle();
+                }
+            }
+        }
+    };
+
+    PipelineCache::PipelineCache(const DispatchTable& api, const Adapter& adapter, VkDevice device, std::filesystem::path path)
+        : _api(api),
+        _adapter(adapter),
+        _device(device),
+        _path(std::move(path)),
+        _cache(nullptr),
+        _id(0)
+    {
+        MappedFile file;
+        if (!_path.empty()) {
+            file = MappedFile(_path);
+        }
+
+        std::span<const std::byte> payload;
+        if (!file.empty()) {
+            payload            = validate(file.bytes(), expected_header(_adapter));
+            _stats.load_result = payload.empty() ? LoadResult::Rejected : LoadResult::Loaded;
+        }
+
+        // Drivers may still refuse a blob that passed validation, start cold then
+        if (!payload.empty()) {
+            try {
+                _cache              = create_cache(_api, _device, payload);
+                _stats.loaded_bytes = payload.size();
+            } catch (const std::runtime_error&) {
+                _stats.load_result = LoadResult::Rejected;
+            }
+        }
+
+        if (_cache == nullptr) {
+            _cache = create_cache(_api, _device, {});
+        }
+
+        LiveCaches& live = live_caches();
+        std::lock_guard lock(live.mutex);
+        _id = live.next_id++;
+        live.caches.emplace(_id, this);
+    }
+
+    PipelineCache::~PipelineCache() {
+        // Waits for threads exiting right now to finish releasing their caches
+        {
+            LiveCaches& live = live_caches();
+            std::lock_guard lock(live.mutex);
+            live.caches.erase(_id);
+        }
+
+        // A cache that fails to merge or serialize is not worth terminating over, the next start is cold
+        if (!_path.empty()) {
+            try {
+                save();
+            } catch (const std::exception&) {
+            }
+        }
+
+        for (auto& [thread, cache] : _thread_caches) {
+            _api.vkDestroyPipelineCache(_device, cache, nullptr);
+        }
+        _api.vkDestroyPipelineCache(_device, _cache, nullptr);
+    }
+
+    auto PipelineCache::handle() const noexcept -> VkPipelineCache {
+        return _cache;
+    }
+
+    auto PipelineCache::thread_handle() -> VkPipelineCache {
+        std::lock_guard lock(_mutex);
+
+        auto [it, inserted] = _thread_caches.try_emplace(std::this_thread::get_id(), nullptr);
+        if (inserted) {
+            try {
+                it->second = create_cache(_api, _device, cache_data(_api, _device, _cache, 0));
+            } catch (...) {
+                _thread_caches.erase(it);
+                throw;
+            }
+            _stats.thread_caches = static_cast<uint32_t>(_thread_caches.size());
+            thread_owner().caches.push_back(_id);
+        }
+        return it->second;
+    }
+
+    auto PipelineCache::merge() -> void {
+        std::lock_guard lock(_mutex);
+        merge_locked();
+    }
+
+    auto PipelineCache::save() -> bool {
+        std::string contents;
+        {
+            std::lock_guard lock(_mutex);
+            if (_path.empty()) {
+                return false;
+            }
+
+            merge_locked();
+            contents = serialize_locked();
+        }
+
+        if (contents.empty() || !write_cache_file(_path, contents)) {
+            return false;
+        }
+
+        std::lock_guard lock(_mutex);
+        _stats.saved_bytes = contents.size() - sizeof(FileHeader);
+        return true;
+    }
+
+    auto PipelineCache::path() const noexcept -> const std::filesystem::path& {
+        return _path;
+    }
+
+    auto PipelineCache::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+        return _stats;
+    }
+
+    auto PipelineCache::thread_owner() -> ThreadOwner& {
+        thread_local ThreadOwner owner;
+        return owner;
+    }
+
+    // Called by the exiting thread's ThreadOwner, with the live caches locked
+    auto PipelineCache::release_thread_handle() -> void {
+        std::lock_guard lock(_mutex);
+
+        const auto it = _thread_caches.find(std::this_thread::get_id());
+        if (it == _thread_caches.end()) {
+            return;
+        }
+
+        // A failed merge only loses what this thread compiled
+        static_cast<void>(_api.vkMergePipelineCaches(_device, _cache, 1, &it->second));
+        _api.vkDestroyPipelineCache(_device, it->second, nullptr);
+        _thread_caches.erase(it);
+        _stats.thread_caches = static_cast<uint32_t>(_thread_caches.size());
+    }
+
+    auto PipelineCache::merge_locked() -> void {
+        if (_thread_caches.empty()) {
+            return;
+        }
+
+        std::vector<VkPipelineCache> sources;
+        sources.reserve(_thread_caches.size());
+        for (const auto& [thread, cache] : _thread_caches) {
+            sources.push_back(cache);
+        }
+
+        if (_api.vkMergePipelineCaches(_device, _cache, static_cast<uint32_t>(sources.size()), sources.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to merge pipeline caches");
+        }
+    }
+
+    auto PipelineCache::serialize_locked() const -> std::string {
+        std::vector<std::byte> data = cache_data(_api, _device, _cache, sizeof(FileHeader));
+        if (data.size() <= sizeof(FileHeader)) {
+            return {};
+        }
+
+        std::span<const std::byte> payload = std::span(data).subspan(sizeof(FileHeader));
+
+        FileHeader header = expected_header(_adapter);
+        header.data_size  = payload.size();
+        header.checksum   = hash_bytes(payload);
+        std::memcpy(data.data(), &header, sizeof(FileHeader));
+
+        return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "dispatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    struct Adapter;
+
+    /**
+     * @brief VkPipelineCache persisted across runs
+     *
+     * The cache file is memory-mapped and handed to the driver without an
+     * intermediate copy. It's only used if its header matches the GPU's vendor,
+     * device, pipeline cache UUID and driver UUID and the payload checksum
+     * holds, as some drivers crash on foreign or truncated blobs instead of
+     * rejecting them.
+     *
+     * Threads creating pipelines concurrently use their own cache from
+     * thread_handle() so they don't contend on the driver's lock. A thread's
+     * cache is merged into the shared one and destroyed when the thread
+     * exits. merge() folds the live ones in as well and save() writes the
+     * shared cache back atomically, which also happens on destruction.
+     *
+     * @code
+     * PipelineCache& cache = device.pipeline_cache();
+     * device.dispatch().vkCreateGraphicsPipelines(device.device_handle(), cache.thread_handle(), 1, &create_info, nullptr, &pipeline);
+     * @endcode
+     */
+    class PipelineCache {
+      public:
+        enum class LoadResult {
+            Missing,  // No file, or caching to disk is disabled
+            Loaded,   // File matched this GPU and driver
+            Rejected  // File was written by another GPU or driver, or is corrupt
+        };
+
+        struct Stats {
+            LoadResult load_result   = LoadResult::Missing;
+            size_t     loaded_bytes  = 0;
+            size_t     saved_bytes   = 0;
+            uint32_t   thread_caches = 0; // of threads that are still running
+        };
+
+      private:
+        // Releases the calling thread's caches when it exits
+        struct ThreadOwner;
+
+        const DispatchTable&  _api;
+        const Adapter&        _adapter;
+        VkDevice              _device;
+        std::filesystem::path _path;
+
+        VkPipelineCache _cache;
+        uint64_t        _id; // identifies this cache to ThreadOwner
+
+        mutable std::mutex                                   _mutex;
+        std::unordered_map<std::thread::id, VkPipelineCache> _thread_caches;
+        Stats                                                _stats;
+
+      public:
+        // An empty path keeps the cache in memory only
+        PipelineCache(const DispatchTable& api, const Adapter& adapter, VkDevice device, std::filesystem::path path);
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache&) = delete;
+        auto operator=(const PipelineCache&) -> PipelineCache& = delete;
+
+        PipelineCache(PipelineCache&&) = delete;
+        auto operator=(PipelineCache&&) -> PipelineCache& = delete;
+
+        // Shared by all threads, the driver serializes access to it
+        [[nodiscard]] auto handle() const noexcept -> VkPipelineCache;
+
+        // Owned by the calling thread, seeded with the shared cache's contents
+        [[nodiscard]] auto thread_handle() -> VkPipelineCache;
+
+        // Folds the thread caches into the shared one
+        auto merge() -> void;
+
+        // Merges and writes the shared cache to disk, false when that failed or there is no path
+        auto save() -> bool;
+
+        [[nodiscard]] auto path() const noexcept -> const std::filesystem::path&;
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        [[nodiscard]] static auto thread_owner() -> ThreadOwner&;
+
+        auto release_thread_handle() -> void;
+        auto merge_locked() -> void;
+        auto serialize_locked() const -> std::string;
+    };
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,411 @@
+#include "pipeline_compiler.hpp"
+#include "device.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    // `pipeline` and `error` are published by the release store to `status`
+    struct PipelineSlot {
+        std::atomic<PipelineHandle::Status> status   = PipelineHandle::Status::Pending;
+        VkPipeline                          pipeline = VK_NULL_HANDLE;
+        std::string                         error;
+        std::shared_ptr<PipelineSlot>       fallback;
+    };
+
+    namespace {
+
+        // Modules only live until the pipeline is created
+        class ShaderModules {
+            const DispatchTable&        _api;
+            VkDevice                    _device;
+            std::vector<VkShaderModule> _modules;
+
+          public:
+            ShaderModules(const DispatchTable& api, VkDevice device) noexcept
+                : _api(api),
+                _device(device)
+            {
+            }
+
+            ~ShaderModules() {
+                for (VkShaderModule module : _modules) {
+                    _api.vkDestroyShaderModule(_device, module, nullptr);
+                }
+            }
+
+            ShaderModules(const ShaderModules&) = delete;
+            auto operator=(const ShaderModules&) -> ShaderModules& = delete;
+
+            auto stage(const ShaderStageDesc& desc) -> VkPipelineShaderStageCreateInfo {
+                if (desc.spirv.empty()) {
+                    throw std::runtime_error("Shader stage has no SPIR-V");
+                }
+
+                VkShaderModuleCreateInfo create_info = {
+                    .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .codeSize = desc.spirv.size() * sizeof(uint32_t),
+                    .pCode    = desc.spirv.data()
+                };
+
+                VkShaderModule module = VK_NULL_HANDLE;
+                if (_api.vkCreateShaderModule(_device, &create_info, nullptr, &module) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create shader module");
+                }
+                _modules.push_back(module);
+
+                return VkPipelineShaderStageCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .stage  = desc.stage,
+                    .module = module,
+                    .pName  = desc.entry_point.c_str(),
+                    .pSpecializationInfo = nullptr
+                };
+            }
+        };
+
+        auto milliseconds(std::chrono::steady_clock::duration duration) -> double {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+    } // namespace
+
+    PipelineHandle::PipelineHandle(std::shared_ptr<PipelineSlot> slot) noexcept
+        : _slot(std::move(slot))
+    {
+    }
+
+    auto PipelineHandle::ready(VkPipeline pipeline) -> PipelineHandle {
+        auto slot      = std::make_shared<PipelineSlot>();
+        slot->pipeline = pipeline;
+        slot->status.store(Status::Ready, std::memory_order_release);
+        return PipelineHandle(std::move(slot));
+    }
+
+    auto PipelineHandle::status() const noexcept -> Status {
+        return _slot ? _slot->status.load(std::memory_order_acquire) : Status::Failed;
+    }
+
+    auto PipelineHandle::is_ready() const noexcept -> bool {
+        return status() == Status::Ready;
+    }
+
+    auto PipelineHandle::valid() const noexcept -> bool {
+        return _slot != nullptr;
+    }
+
+    auto PipelineHandle::get() const noexcept -> VkPipeline {
+        for (const PipelineSlot* slot = _slot.get(); slot != nullptr; slot = slot->fallback.get()) {
+            if (slot->status.load(std::memory_order_acquire) == Status::Ready) {
+                return slot->pipeline;
+            }
+        }
+        return VK_NULL_HANDLE;
+    }
+
+    auto PipelineHandle::usable() const noexcept -> bool {
+        return get() != VK_NULL_HANDLE;
+    }
+
+    auto PipelineHandle::error() const -> std::string {
+        return status() == Status::Failed && _slot ? _slot->error : std::string();
+    }
+
+    PipelineCompiler::PipelineCompiler(Device& device)
+        : PipelineCompiler(device, Config{})
+    {
+    }
+
+    PipelineCompiler::PipelineCompiler(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _owner(device)
+    {
+        if (_device == VK_NULL_HANDLE) {
+            throw std::runtime_error("PipelineCompiler needs a Device after create_device()");
+        }
+
+        uint32_t thread_count = config.threads;
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency() / 2);
+        }
+
+        _workers.reserve(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i) {
+            _workers.emplace_back([this](std::stop_token stop) { work(stop); });
+        }
+    }
+
+    PipelineCompiler::~PipelineCompiler() {
+        // Joins, workers finish the pipeline they are building first
+        _workers.clear();
+
+        for (Job& job : _queue) {
+            job.slot->error = "Pipeline compiler was destroyed before compiling this pipeline";
+            job.slot->status.store(PipelineHandle::Status::Failed, std::memory_order_release);
+        }
+        _queue.clear();
+
+        for (VkPipeline pipeline : _pipelines) {
+            _api.vkDestroyPipeline(_device, pipeline, nullptr);
+        }
+    }
+
+    auto PipelineCompiler::compile(GraphicsPipelineDesc desc, const PipelineHandle& fallback) -> PipelineHandle {
+        return enqueue(std::move(desc), fallback);
+    }
+
+    auto PipelineCompiler::compile(ComputePipelineDesc desc, const PipelineHandle& fallback) -> PipelineHandle {
+        return enqueue(std::move(desc), fallback);
+    }
+
+    auto PipelineCompiler::wait_idle() -> void {
+        std::unique_lock lock(_mutex);
+        _idle.wait(lock, [this]() { return _queue.empty() && _stats.in_flight == 0; });
+    }
+
+    auto PipelineCompiler::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+        return _stats;
+    }
+
+    auto PipelineCompiler::enqueue(Request request, const PipelineHandle& fallback) -> PipelineHandle {
+        auto slot      = std::make_shared<PipelineSlot>();
+        slot->fallback = fallback._slot;
+
+        {
+            std::lock_guard lock(_mutex);
+            _queue.push_back(Job{std::move(request), slot, Clock::now()});
+
+            _stats.queue_depth      = static_cast<uint32_t>(_queue.size());
+            _stats.peak_queue_depth = std::max(_stats.peak_queue_depth, _stats.queue_depth);
+        }
+        _wake.notify_one();
+
+        return PipelineHandle(std::move(slot));
+    }
+
+    auto PipelineCompiler::work(std::stop_token stop) -> void {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(_mutex);
+                // Pending requests are abandoned on stop rather than drained
+                if (!_wake.wait(lock, stop, [this]() { return !_queue.empty(); }) || stop.stop_requested()) {
+                    return;
+                }
+
+                job = std::move(_queue.front());
+                _queue.pop_front();
+
+                _stats.queue_depth = static_cast<uint32_t>(_queue.size());
+                ++_stats.in_flight;
+            }
+
+            const Clock::time_point start = Clock::now();
+
+            VkPipeline  pipeline = VK_NULL_HANDLE;
+            std::string error;
+            try {
+                pipeline = build(job.request);
+            } catch (const std::exception& exception) {
+                error = exception.what();
+            }
+
+            const Clock::time_point end = Clock::now();
+            {
+                std::lock_guard lock(_mutex);
+                --_stats.in_flight;
+
+                if (pipeline != VK_NULL_HANDLE) {
+                    _pipelines.push_back(pipeline);
+                    job.slot->pipeline = pipeline;
+                    job.slot->status.store(PipelineHandle::Status::Ready, std::memory_order_release);
+                    ++_stats.compiled;
+                } else {
+                    job.slot->error = std::move(error);
+                    job.slot->status.store(PipelineHandle::Status::Failed, std::memory_order_release);
+                    ++_stats.failed;
+                }
+
+                const double latency_ms = milliseconds(end - job.enqueued);
+                _total_latency_ms += latency_ms;
+                _total_compile_ms += milliseconds(end - start);
+
+                const double finished   = static_cast<double>(_stats.compiled + _stats.failed);
+                _stats.mean_latency_ms  = _total_latency_ms / finished;
+                _stats.mean_compile_ms  = _total_compile_ms / finished;
+                _stats.max_latency_ms   = std::max(_stats.max_latency_ms, latency_ms);
+            }
+            _idle.notify_all();
+        }
+    }
+
+    auto PipelineCompiler::build(const Request& request) -> VkPipeline {
+        ShaderModules   modules(_api, _device);
+        VkPipelineCache cache    = _owner.pipeline_cache().thread_handle();
+        VkPipeline      pipeline = VK_NULL_HANDLE;
+
+        if (const auto* compute = std::get_if<ComputePipelineDesc>(&request)) {
+            VkComputePipelineCreateInfo create_info = {
+                .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage  = modules.stage(compute->stage),
+                .layout = compute->layout,
+                .basePipelineHandle = VK_NULL_HANDLE,
+                .basePipelineIndex  = -1
+            };
+
+            if (_api.vkCreateComputePipelines(_device, cache, 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create compute pipeline");
+            }
+            return pipeline;
+        }
+
+        const auto& desc = std::get<GraphicsPipelineDesc>(request);
+        if (desc.blend.size() != desc.color_formats.size()) {
+            throw std::runtime_error("Graphics pipeline needs one blend state per color attachment");
+        }
+
+        std::vector<VkPipelineShaderStageCreateInfo> stages;
+        stages.reserve(desc.stages.size());
+        for (const ShaderStageDesc& stage : desc.stages) {
+            stages.push_back(modules.stage(stage));
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertex_input = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .vertexBindingDescriptionCount   = static_cast<uint32_t>(desc.vertex_bindings.size()),
+            .pVertexBindingDescriptions      = desc.vertex_bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertex_attributes.size()),
+            .pVertexAttributeDescriptions    = desc.vertex_attributes.data()
+        };
+
+        VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .topology = desc.topology,
+            .primitiveRestartEnable = VK_FALSE
+        };
+
+        VkPipelineViewportStateCreateInfo viewport = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .viewportCount = 1,
+            .pViewports    = nullptr, // dynamic
+            .scissorCount  = 1,
+            .pScissors     = nullptr  // dynamic
+        };
+
+        VkPipelineRasterizationStateCreateInfo rasterization = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .depthClampEnable        = VK_FALSE,
+            .rasterizerDiscardEnable = VK_FALSE,
+            .polygonMode = desc.polygon_mode,
+            .cullMode    = desc.cull_mode,
+            .frontFace   = desc.front_face,
+            .depthBiasEnable         = VK_FALSE,
+            .depthBiasConstantFactor = 0.0f,
+            .depthBiasClamp          = 0.0f,
+            .depthBiasSlopeFactor    = 0.0f,
+            .lineWidth = 1.0f
+        };
+
+        VkPipelineMultisampleStateCreateInfo multisample = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .rasterizationSamples  = desc.samples,
+            .sampleShadingEnable   = VK_FALSE,
+            .minSampleShading      = 0.0f,
+            .pSampleMask           = nullptr,
+            .alphaToCoverageEnable = VK_FALSE,
+            .alphaToOneEnable      = VK_FALSE
+        };
+
+        VkPipelineDepthStencilStateCreateInfo depth_stencil = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .depthTestEnable  = desc.depth_test ? VK_TRUE : VK_FALSE,
+            .depthWriteEnable = desc.depth_write ? VK_TRUE : VK_FALSE,
+            .depthCompareOp   = desc.depth_compare,
+            .depthBoundsTestEnable = VK_FALSE,
+            .stencilTestEnable     = VK_FALSE,
+            .front = {},
+            .back  = {},
+            .minDepthBounds = 0.0f,
+            .maxDepthBounds = 1.0f
+        };
+
+        VkPipelineColorBlendStateCreateInfo color_blend = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .logicOpEnable   = VK_FALSE,
+            .logicOp         = VK_LOGIC_OP_COPY,
+            .attachmentCount = static_cast<uint32_t>(desc.blend.size()),
+            .pAttachments    = desc.blend.data(),
+            .blendConstants  = {0.0f, 0.0f, 0.0f, 0.0f}
+        };
+
+        constexpr VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamic = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .dynamicStateCount = 2,
+            .pDynamicStates    = dynamic_states
+        };
+
+        VkPipelineRenderingCreateInfo rendering = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .pNext = nullptr,
+            .viewMask = 0,
+            .colorAttachmentCount    = static_cast<uint32_t>(desc.color_formats.size()),
+            .pColorAttachmentFormats = desc.color_formats.data(),
+            .depthAttachmentFormat   = desc.depth_format,
+            .stencilAttachmentFormat = desc.stencil_format
+        };
+
+        VkGraphicsPipelineCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &rendering,
+            .flags = 0,
+            .stageCount = static_cast<uint32_t>(stages.size()),
+            .pStages    = stages.data(),
+            .pVertexInputState   = &vertex_input,
+            .pInputAssemblyState = &input_assembly,
+            .pTessellationState  = nullptr,
+            .pViewportState      = &viewport,
+            .pRasterizationState = &rasterization,
+            .pMultisampleState   = &multisample,
+            .pDepthStencilState  = &depth_stencil,
+            .pColorBlendState    = &color_blend,
+            .pDynamicState       = &dynamic,
+            .layout     = desc.layout,
+            .renderPass = VK_NULL_HANDLE, // dynamic rendering
+            .subpass    = 0,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex  = -1
+        };
+
+        if (_api.vkCreateGraphicsPipelines(_device, cache, 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create graphics pipeline");
+        }
+        return pipeline;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "dispatch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    struct ShaderStageDesc {
+        VkShaderStageFlagBits stage;
+        std::vector<uint32_t> spirv;
+        std::string           entry_point = "main";
+        uint64_t              spirv_hash  = 0; // identifies the SPIR-V, e.g. ShaderBinary::key, trusted without comparing the words; hashed from spirv when 0
+    };
+
+    /**
+     * @brief Everything that goes into a graphics VkPipeline
+     *
+     * Pipelines target dynamic rendering, viewport and scissor are always
+     * dynamic state.
+     */
+    struct GraphicsPipelineDesc {
+        std::vector<ShaderStageDesc> stages;
+        VkPipelineLayout             layout = VK_NULL_HANDLE;
+
+        std::vector<VkVertexInputBindingDescription>   vertex_bindings;
+        std::vector<VkVertexInputAttributeDescription> vertex_attributes;
+        VkPrimitiveTopology                            topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkPolygonMode   polygon_mode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags cull_mode    = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace     front_face   = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+        bool        depth_test    = false;
+        bool        depth_write   = false;
+        VkCompareOp depth_compare = VK_COMPARE_OP_GREATER_OR_EQUAL; // reversed Z
+
+        // One blend state per color attachment
+        std::vector<VkPipelineColorBlendAttachmentState> blend;
+        std::vector<VkFormat>                            color_formats;
+        VkFormat                                         depth_format   = VK_FORMAT_UNDEFINED;
+        VkFormat                                         stencil_format = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits                            samples        = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    struct ComputePipelineDesc {
+        ShaderStageDesc  stage{VK_SHADER_STAGE_COMPUTE_BIT, {}};
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+    };
+
+    // Shared between a PipelineHandle and the thread that builds it
+    struct PipelineSlot;
+
+    /**
+     * @brief Pipeline that may still be compiling
+     *
+     * Cheap to copy and to query from any thread. get() returns the compiled
+     * pipeline once it is ready and the fallback's pipeline until then, or
+     * VK_NULL_HANDLE when there is nothing to draw with yet. Handles are only
+     * valid while the compiler that issued them is alive.
+     */
+    class PipelineHandle {
+        friend class PipelineCompiler;
+
+        std::shared_ptr<PipelineSlot> _slot;
+
+        explicit PipelineHandle(std::shared_ptr<PipelineSlot> slot) noexcept;
+
+      public:
+        enum class Status : uint8_t {
+            Pending,
+            Ready,
+            Failed
+        };
+
+        PipelineHandle() = default;
+
+        // Wraps a pipeline created elsewhere, always ready
+        [[nodiscard]] static auto ready(VkPipeline pipeline) -> PipelineHandle;
+
+        [[nodiscard]] auto status() const noexcept -> Status;
+        [[nodiscard]] auto is_ready() const noexcept -> bool;
+        [[nodiscard]] auto valid() const noexcept -> bool;
+
+        // The pipeline to bind right now, falling back while compilation is pending or failed
+        [[nodiscard]] auto get() const noexcept -> VkPipeline;
+        // Whether get() has something to bind
+        [[nodiscard]] auto usable() const noexcept -> bool;
+
+        // Compiler message when status() is Failed
+        [[nodiscard]] auto error() const -> std::string;
+    };
+
+    /**
+     * @brief Creates pipelines on worker threads
+     *
+     * compile() enqueues the description and returns immediately, so the
+     * render thread never blocks on the driver's compiler. Workers create
+     * pipelines through their own thread cache of the Device's pipeline
+     * cache. The compiler owns every pipeline it creates and destroys them
+     * with itself, pending requests are abandoned as Failed.
+     *
+     * @code
+     * PipelineCompiler compiler(device);
+     * auto fallback = compiler.compile(simple_desc);
+     * auto material = compiler.compile(material_desc, fallback);
+     *
+     * // Each frame, binds the simple pipeline until the material one is ready
+     * if (material.usable()) {
+     *     device.dispatch().vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material.get());
+     * }
+     * @endcode
+     */
+    class PipelineCompiler {
+      public:
+        struct Config {
+            uint32_t threads = 0; // 0 uses half of the hardware threads
+        };
+
+        struct Stats {
+            uint32_t queue_depth      = 0; // requests waiting for a worker
+            uint32_t peak_queue_depth = 0;
+            uint32_t in_flight        = 0; // requests a worker is compiling
+            uint64_t compiled         = 0;
+            uint64_t failed           = 0;
+            double   mean_latency_ms  = 0.0; // compile() until ready, including queueing
+            double   max_latency_ms   = 0.0;
+            double   mean_compile_ms  = 0.0; // driver time only
+        };
+
+      private:
+        using Clock   = std::chrono::steady_clock;
+        using Request = std::variant<GraphicsPipelineDesc, ComputePipelineDesc>;
+
+        struct Job {
+            Request                       request;
+            std::shared_ptr<PipelineSlot> slot;
+            Clock::time_point             enqueued;
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        Device&              _owner;
+
+        mutable std::mutex          _mutex;
+        std::condition_variable_any _wake;
+        std::condition_variable_any _idle;
+        std::deque<Job>             _queue;
+        std::vector<VkPipeline>     _pipelines;
+
+        Stats  _stats;
+        double _total_latency_ms = 0.0;
+        double _total_compile_ms = 0.0;
+
+        std::vector<std::jthread> _workers;
+
+      public:
+        explicit PipelineCompiler(Device& device);
+        PipelineCompiler(Device& device, const Config& config);
+        ~PipelineCompiler();
+
+        PipelineCompiler(const PipelineCompiler&) = delete;
+        auto operator=(const PipelineCompiler&) -> PipelineCompiler& = delete;
+
+        PipelineCompiler(PipelineCompiler&&) = delete;
+        auto operator=(PipelineCompiler&&) -> PipelineCompiler& = delete;
+
+        [[nodiscard]] auto compile(GraphicsPipelineDesc desc, const PipelineHandle& fallback = {}) -> PipelineHandle;
+        [[nodiscard]] auto compile(ComputePipelineDesc desc, const PipelineHandle& fallback = {}) -> PipelineHandle;
+
+        // Blocks until every request enqueued so far has finished
+        auto wait_idle() -> void;
+
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        auto enqueue(Request request, const PipelineHandle& fallback) -> PipelineHandle;
+        auto work(std::stop_token stop) -> void;
+        auto build(const Request& request) -> VkPipeline;
+    };
+
+} // namespace vulkron::gpu::vulkan
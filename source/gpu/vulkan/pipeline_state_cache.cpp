@@ -0,0 +1,207 @@
+#include "pipeline_state_cache.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <utility>
+
+namespace vulkron::gpu::vulkan {
+
+    struct PipelineStateCache::Entry {
+        uint64_t             hash;
+        GraphicsPipelineDesc desc;
+        Entry*               next = nullptr;
+
+        // Written once by the inserting thread, then published by `ready`
+        PipelineHandle    handle;
+        std::atomic<bool> ready = false;
+    };
+
+    namespace {
+
+        auto stage_hash(const ShaderStageDesc& stage) noexcept -> uint64_t {
+            if (stage.spirv_hash != 0) {
+                return stage.spirv_hash;
+            }
+            return hash_bytes(std::as_bytes(std::span(stage.spirv)));
+        }
+
+        // Two given SPIR-V hashes settle it, every lookup would walk the whole module otherwise
+        auto same_stage(const ShaderStageDesc& a, const ShaderStageDesc& b) noexcept -> bool {
+            if (a.spirv_hash != 0 && b.spirv_hash != 0) {
+                return a.spirv_hash == b.spirv_hash && a.stage == b.stage && a.entry_point == b.entry_point;
+            }
+            return a.stage == b.stage && a.entry_point == b.entry_point && a.spirv == b.spirv;
+        }
+
+        auto same_binding(const VkVertexInputBindingDescription& a, const VkVertexInputBindingDescription& b) noexcept -> bool {
+            return a.binding == b.binding && a.stride == b.stride && a.inputRate == b.inputRate;
+        }
+
+        auto same_attribute(const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b) noexcept -> bool {
+            return a.location == b.location && a.binding == b.binding && a.format == b.format && a.offset == b.offset;
+        }
+
+        auto same_blend(const VkPipelineColorBlendAttachmentState& a, const VkPipelineColorBlendAttachmentState& b) noexcept -> bool {
+            // Blend factors don't matter while blending is off
+            if (a.blendEnable != b.blendEnable || a.colorWriteMask != b.colorWriteMask) {
+                return false;
+            }
+            return a.blendEnable == VK_FALSE || (
+                a.srcColorBlendFactor == b.srcColorBlendFactor && a.dstColorBlendFactor == b.dstColorBlendFactor &&
+                a.colorBlendOp == b.colorBlendOp &&
+                a.srcAlphaBlendFactor == b.srcAlphaBlendFactor && a.dstAlphaBlendFactor == b.dstAlphaBlendFactor &&
+                a.alphaBlendOp == b.alphaBlendOp
+            );
+        }
+
+        // Approximate heap footprint of an entry, for Stats::memory_bytes
+        template <typename T>
+        auto capacity_bytes(const std::vector<T>& vector) noexcept -> uint64_t {
+            return vector.capacity() * sizeof(T);
+        }
+
+    } // namespace
+
+    auto hash_pipeline(const GraphicsPipelineDesc& desc) -> uint64_t {
+        Hasher hasher;
+
+        hasher.value(desc.stages.size());
+        for (const ShaderStageDesc& stage : desc.stages) {
+            hasher.value(static_cast<uint32_t>(stage.stage)).value(stage_hash(stage)).update(stage.entry_point);
+        }
+        hasher.value(desc.layout);
+
+        // Field by field, padding inside Vulkan structs must not reach the hash
+        hasher.value(desc.vertex_bindings.size());
+        for (const auto& binding : desc.vertex_bindings) {
+            hasher.value(binding.binding).value(binding.stride).value(binding.inputRate);
+        }
+        hasher.value(desc.vertex_attributes.size());
+        for (const auto& attribute : desc.vertex_attributes) {
+            hasher.value(attribute.location).value(attribute.binding).value(attribute.format).value(attribute.offset);
+        }
+        hasher.value(desc.topology);
+
+        hasher.value(desc.polygon_mode).value(desc.cull_mode).value(desc.front_face);
+        hasher.value(desc.depth_test).value(desc.depth_write).value(desc.depth_compare);
+
+        hasher.value(desc.blend.size());
+        for (const auto& blend : desc.blend) {
+            hasher.value(blend.blendEnable).value(blend.colorWriteMask);
+            if (blend.blendEnable != VK_FALSE) {
+                hasher.value(blend.srcColorBlendFactor).value(blend.dstColorBlendFactor).value(blend.colorBlendOp);
+                hasher.value(blend.srcAlphaBlendFactor).value(blend.dstAlphaBlendFactor).value(blend.alphaBlendOp);
+            }
+        }
+        hasher.value(desc.color_formats.size());
+        for (VkFormat format : desc.color_formats) {
+            hasher.value(format);
+        }
+        hasher.value(desc.depth_format).value(desc.stencil_format).value(desc.samples);
+
+        return hasher.digest();
+    }
+
+    auto same_pipeline(const GraphicsPipelineDesc& a, const GraphicsPipelineDesc& b) -> bool {
+        return a.layout == b.layout
+            && a.topology == b.topology
+            && a.polygon_mode == b.polygon_mode && a.cull_mode == b.cull_mode && a.front_face == b.front_face
+            && a.depth_test == b.depth_test && a.depth_write == b.depth_write && a.depth_compare == b.depth_compare
+            && a.color_formats == b.color_formats
+            && a.depth_format == b.depth_format && a.stencil_format == b.stencil_format && a.samples == b.samples
+            && std::ranges::equal(a.blend, b.blend, same_blend)
+            && std::ranges::equal(a.vertex_bindings, b.vertex_bindings, same_binding)
+            && std::ranges::equal(a.vertex_attributes, b.vertex_attributes, same_attribute)
+            && std::ranges::equal(a.stages, b.stages, same_stage);
+    }
+
+    PipelineStateCache::PipelineStateCache(PipelineCompiler& compiler)
+        : PipelineStateCache(compiler, Config{})
+    {
+    }
+
+    PipelineStateCache::PipelineStateCache(PipelineCompiler& compiler, const Config& config)
+        : _compiler(compiler)
+    {
+        const uint64_t bucket_count = std::bit_ceil(std::max<uint64_t>(config.bucket_count, 1));
+
+        _buckets     = std::make_unique<std::atomic<Entry*>[]>(bucket_count);
+        _bucket_mask = bucket_count - 1;
+    }
+
+    PipelineStateCache::~PipelineStateCache() {
+        for (uint64_t i = 0; i <= _bucket_mask; ++i) {
+            Entry* entry = _buckets[i].load(std::memory_order_acquire);
+            while (entry != nullptr) {
+                delete std::exchange(entry, entry->next);
+            }
+        }
+    }
+
+    auto PipelineStateCache::get(const GraphicsPipelineDesc& desc, const PipelineHandle& fallback) -> PipelineHandle {
+        const uint64_t       hash   = hash_pipeline(desc);
+        std::atomic<Entry*>& bucket = _buckets[hash & _bucket_mask];
+
+        Entry* head = bucket.load(std::memory_order_acquire);
+        if (Entry* entry = find(head, nullptr, hash, desc)) {
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            return published(*entry);
+        }
+
+        auto entry  = std::make_unique<Entry>();
+        entry->hash = hash;
+        entry->desc = desc;
+        entry->next = head;
+
+        // A failed CAS loads the new head into `next`, only entries pushed since `head` need a look
+        while (!bucket.compare_exchange_weak(entry->next, entry.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            if (Entry* existing = find(entry->next, head, hash, desc)) {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                return published(*existing);
+            }
+            head = entry->next;
+        }
+
+        Entry& inserted = *entry.release();
+        _misses.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t bytes = sizeof(Entry) + capacity_bytes(inserted.desc.stages) + capacity_bytes(inserted.desc.vertex_bindings)
+            + capacity_bytes(inserted.desc.vertex_attributes) + capacity_bytes(inserted.desc.blend) + capacity_bytes(inserted.desc.color_formats);
+        for (const ShaderStageDesc& stage : inserted.desc.stages) {
+            bytes += capacity_bytes(stage.spirv) + stage.entry_point.capacity();
+        }
+        _memory_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        inserted.handle = _compiler.compile(desc, fallback);
+        inserted.ready.store(true, std::memory_order_release);
+        return inserted.handle;
+    }
+
+    auto PipelineStateCache::stats() const noexcept -> Stats {
+        return Stats{
+            .hits         = _hits.load(std::memory_order_relaxed),
+            .misses       = _misses.load(std::memory_order_relaxed),
+            .memory_bytes = _memory_bytes.load(std::memory_order_relaxed)
+        };
+    }
+
+    auto PipelineStateCache::find(Entry* first, const Entry* last, uint64_t hash, const GraphicsPipelineDesc& desc) noexcept -> Entry* {
+        for (Entry* entry = first; entry != last; entry = entry->next) {
+            if (entry->hash == hash && same_pipeline(entry->desc, desc)) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    auto PipelineStateCache::published(const Entry& entry) noexcept -> PipelineHandle {
+        // Only racing with the inserting thread's compile() call, which doesn't wait on the driver
+        while (!entry.ready.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        return entry.handle;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "pipeline_compiler.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    // Canonical hash over every field of the description, shaders by content
+    [[nodiscard]] auto hash_pipeline(const GraphicsPipelineDesc& desc) -> uint64_t;
+    [[nodiscard]] auto same_pipeline(const GraphicsPipelineDesc& a, const GraphicsPipelineDesc& b) -> bool;
+
+    /**
+     * @brief Deduplicates graphics pipelines by their full description
+     *
+     * Equal descriptions share one PipelineHandle, however many systems ask
+     * for them. Entries live in a fixed array of buckets, each an insert-only
+     * linked list whose head is swapped in with a CAS, so lookups that hit
+     * never lock. The thread whose insert wins hands the description to the
+     * PipelineCompiler, making each state build exactly once; threads racing
+     * on the same new state briefly wait for that hand-off, never for the
+     * compilation itself.
+     *
+     * Entries are never evicted, the cache lives as long as the compiler.
+     *
+     * @code
+     * PipelineStateCache states(compiler);
+     * PipelineHandle pipeline = states.get(desc); // from any recording thread
+     * @endcode
+     */
+    class PipelineStateCache {
+      public:
+        struct Config {
+            uint32_t bucket_count = 4096; // rounded up to a power of two
+        };
+
+        struct Stats {
+            uint64_t hits         = 0;
+            uint64_t misses       = 0; // equals the number of pipelines built
+            uint64_t memory_bytes = 0; // entries including their descriptions
+
+            [[nodiscard]] auto hit_rate() const noexcept -> double {
+                const uint64_t lookups = hits + misses;
+                return lookups != 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+            }
+        };
+
+      private:
+        struct Entry;
+
+        PipelineCompiler& _compiler;
+
+        std::unique_ptr<std::atomic<Entry*>[]> _buckets;
+        uint64_t                               _bucket_mask;
+
+        std::atomic<uint64_t> _hits         = 0;
+        std::atomic<uint64_t> _misses       = 0;
+        std::atomic<uint64_t> _memory_bytes = 0;
+
+      public:
+        explicit PipelineStateCache(PipelineCompiler& compiler);
+        PipelineStateCache(PipelineCompiler& compiler, const Config& config);
+        ~PipelineStateCache();
+
+        PipelineStateCache(const PipelineStateCache&) = delete;
+        auto operator=(const PipelineStateCache&) -> PipelineStateCache& = delete;
+
+        PipelineStateCache(PipelineStateCache&&) = delete;
+        auto operator=(PipelineStateCache&&) -> PipelineStateCache& = delete;
+
+        // `fallback` is only used when this call creates the entry
+        [[nodiscard]] auto get(const GraphicsPipelineDesc& desc, const PipelineHandle& fallback = {}) -> PipelineHandle;
+
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+      private:
+        // Scans [first, last) for desc, the list is immutable behind its head
+        static auto find(Entry* first, const Entry* last, uint64_t hash, const GraphicsPipelineDesc& desc) noexcept -> Entry*;
+        static auto published(const Entry& entry) noexcept -> PipelineHandle;
+    };
+
+} // namespace vulkron::gpu::vulkan
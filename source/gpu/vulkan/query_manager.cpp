@@ -0,0 +1,299 @@
+#include "query_manager.hpp"
+#include "device.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        // Bit order of these flags is the order of the PipelineStatistics members
+        constexpr VkQueryPipelineStatisticFlags STATISTICS =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+        static_assert(sizeof(PipelineStatistics) == 7 * sizeof(uint64_t));
+
+        auto create_pool(const DispatchTable& api, VkDevice device, VkQueryType type, uint32_t count, VkQueryPipelineStatisticFlags statistics) -> VkQueryPool {
+            const VkQueryPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .queryType          = type,
+                .queryCount         = count,
+                .pipelineStatistics = statistics
+            };
+
+            VkQueryPool pool = VK_NULL_HANDLE;
+            if (api.vkCreateQueryPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create query pool");
+            }
+            return pool;
+        }
+
+        // RFC 4180 field: quoted, with embedded quotes doubled; commas and newlines need nothing else
+        auto write_csv_field(std::ofstream& out, std::string_view text) -> void {
+            out << '"';
+            for (const char c : text) {
+                if (c == '"') {
+                    out << '"';
+                }
+                out << c;
+            }
+            out << '"';
+        }
+
+    } // namespace
+
+    QueryManager::QueryManager(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _config(config),
+        _ns_per_tick(device.timestamp_period())
+    {
+        if (_config.timeline == VK_NULL_HANDLE) {
+            throw std::runtime_error("QueryManager needs a timeline semaphore");
+        }
+        _config.frames_in_flight = std::max(_config.frames_in_flight, 1u);
+        _config.max_passes       = std::max(_config.max_passes, 1u);
+
+        const Adapter* adapter = device.instance()->adapter(device.physical_device_handle());
+        if (adapter == nullptr) {
+            throw std::runtime_error("QueryManager needs a device with a selected GPU");
+        }
+
+        const std::vector<VkQueueFamilyProperties>& families = adapter->queue_families;
+        if (_config.queue_family >= families.size()) {
+            throw std::runtime_error("QueryManager queue family out of range");
+        }
+
+        const uint32_t valid_bits = families[_config.queue_family].timestampValidBits;
+        if (valid_bits == 0) {
+            throw std::runtime_error("Queue family doesn't support timestamp queries");
+        }
+        _timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (uint64_t{1} << valid_bits) - 1;
+
+        _config.pipeline_statistics = _config.pipeline_statistics && device.capabilities().has(DeviceFeature::PipelineStatisticsQuery);
+
+        const uint32_t queries = _config.frames_in_flight * _config.max_passes;
+        _timestamps = create_pool(_api, _device, VK_QUERY_TYPE_TIMESTAMP, queries * 2, 0);
+
+        if (_config.pipeline_statistics) {
+            try {
+                _statistics = create_pool(_api, _device, VK_QUERY_TYPE_PIPELINE_STATISTICS, queries, STATISTICS);
+            } catch (...) {
+                _api.vkDestroyQueryPool(_device, _timestamps, nullptr);
+                throw;
+            }
+        }
+
+        _slots.resize(_config.frames_in_flight);
+        for (Slot& slot : _slots) {
+            slot.names.resize(_config.max_passes);
+            slot.statistics.resize(_config.max_passes);
+        }
+        _timestamp_results.resize(size_t{_config.max_passes} * 2);
+    }
+
+    QueryManager::~QueryManager() {
+        // Pending results are dropped, the pools may only be destroyed once no submission uses them
+        if (_statistics != VK_NULL_HANDLE) {
+            _api.vkDestroyQueryPool(_device, _statistics, nullptr);
+        }
+        _api.vkDestroyQueryPool(_device, _timestamps, nullptr);
+    }
+
+    auto QueryManager::begin_frame(VkCommandBuffer cmd) -> void {
+        resolve();
+
+        _slot = static_cast<uint32_t>(_frame % _config.frames_in_flight);
+
+        Slot& slot = _slots[_slot];
+        if (slot.value != 0) {
+            ++_stats.frames_dropped;
+        }
+        slot.passes = 0;
+        slot.frame  = _frame++;
+        slot.value  = 0;
+
+        const uint32_t first = _slot * _config.max_passes;
+        _api.vkCmdResetQueryPool(cmd, _timestamps, first * 2, _config.max_passes * 2);
+        if (_statistics != VK_NULL_HANDLE) {
+            _api.vkCmdResetQueryPool(cmd, _statistics, first, _config.max_passes);
+        }
+
+        _recording       = true;
+        _statistics_pass = NO_PASS;
+    }
+
+    auto QueryManager::begin_pass(VkCommandBuffer cmd, std::string_view name) -> uint32_t {
+        if (!_recording) {
+            throw std::runtime_error("QueryManager::begin_pass() outside of begin_frame() and end_frame()");
+        }
+
+        Slot& slot = _slots[_slot];
+        if (slot.passes == _config.max_passes) {
+            ++_stats.passes_dropped;
+            return NO_PASS;
+        }
+
+        const uint32_t pass  = slot.passes++;
+        const uint32_t query = _slot * _config.max_passes + pass;
+
+        slot.names[pass].assign(name);
+        slot.statistics[pass] = false;
+
+        _api.vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, _timestamps, query * 2);
+
+        if (_statistics != VK_NULL_HANDLE && _statistics_pass == NO_PASS) {
+            _api.vkCmdBeginQuery(cmd, _statistics, query, 0);
+            slot.statistics[pass] = true;
+            _statistics_pass      = pass;
+        }
+        return pass;
+    }
+
+    auto QueryManager::end_pass(VkCommandBuffer cmd, uint32_t pass) -> void {
+        if (pass == NO_PASS) {
+            return;
+        }
+
+        const uint32_t query = _slot * _config.max_passes + pass;
+
+        if (_statistics_pass == pass) {
+            _api.vkCmdEndQuery(cmd, _statistics, query);
+            _statistics_pass = NO_PASS;
+        }
+
+        _api.vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _timestamps, query * 2 + 1);
+    }
+
+    auto QueryManager::end_frame(uint64_t value) -> void {
+        if (_statistics_pass != NO_PASS) {
+            throw std::runtime_error("QueryManager::end_frame() with a pass still open");
+        }
+
+        _slots[_slot].value = _slots[_slot].passes != 0 ? value : 0;
+        _recording          = false;
+    }
+
+    auto QueryManager::resolve() -> void {
+        bool pending = false;
+        for (const Slot& slot : _slots) {
+            pending = pending || slot.value != 0;
+        }
+        if (!pending) {
+            return;
+        }
+
+        const uint64_t completed = completed_value();
+
+        // Oldest frame first, so the last sample of every row is the newest one
+        for (uint32_t i = 1; i <= _config.frames_in_flight; ++i) {
+            const uint32_t index = (_slot + i) % _config.frames_in_flight;
+            Slot&          slot  = _slots[index];
+
+            if (slot.value != 0 && slot.value <= completed) {
+                read(index);
+            }
+        }
+    }
+
+    auto QueryManager::table() const noexcept -> std::span<const PassTiming> {
+        return _table;
+    }
+
+    auto QueryManager::stats() const noexcept -> Stats {
+        return _stats;
+    }
+
+    auto QueryManager::write_table(const std::filesystem::path& path) const -> bool {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        out << "pass,last_ms,mean_ms,min_ms,max_ms,samples,input_vertices,input_primitives,vertex_invocations,"
+               "clipping_invocations,clipping_primitives,fragment_invocations,compute_invocations\n";
+
+        for (const PassTiming& pass : _table) {
+            const PipelineStatistics& statistics = pass.statistics;
+
+            write_csv_field(out, pass.name);
+            out << ',' << pass.last_ms << ',' << pass.mean_ms << ',' << pass.min_ms << ',' << pass.max_ms << ','
+                << pass.samples << ',' << statistics.input_vertices << ',' << statistics.input_primitives << ','
+                << statistics.vertex_invocations << ',' << statistics.clipping_invocations << ',' << statistics.clipping_primitives << ','
+                << statistics.fragment_invocations << ',' << statistics.compute_invocations << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    auto QueryManager::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _config.timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query query manager timeline semaphore");
+        }
+        return value;
+    }
+
+    auto QueryManager::read(uint32_t index) -> void {
+        Slot&          slot  = _slots[index];
+        const uint32_t first = index * _config.max_passes;
+
+        slot.value = 0;
+
+        // The timeline says the frame retired, so VK_NOT_READY only means a pass was never closed
+        const VkResult timestamps = _api.vkGetQueryPoolResults(
+            _device, _timestamps, first * 2, slot.passes * 2, slot.passes * 2 * sizeof(uint64_t), _timestamp_results.data(),
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+        );
+        if (timestamps != VK_SUCCESS) {
+            ++_stats.frames_dropped;
+            return;
+        }
+
+        for (uint32_t pass = 0; pass < slot.passes; ++pass) {
+            PipelineStatistics statistics;
+            if (slot.statistics[pass]) {
+                const VkResult result = _api.vkGetQueryPoolResults(
+                    _device, _statistics, first + pass, 1, sizeof(PipelineStatistics), &statistics, sizeof(PipelineStatistics),
+                    VK_QUERY_RESULT_64_BIT
+                );
+                if (result != VK_SUCCESS) {
+                    statistics = {};
+                }
+            }
+
+            const uint64_t ticks = (_timestamp_results[pass * 2 + 1] - _timestamp_results[pass * 2]) & _timestamp_mask;
+            const double   ms    = static_cast<double>(ticks) * _ns_per_tick / 1'000'000.0;
+
+            PassTiming& timing = row(slot.names[pass]);
+            timing.min_ms      = timing.samples == 0 ? ms : std::min(timing.min_ms, ms);
+            timing.max_ms      = timing.samples == 0 ? ms : std::max(timing.max_ms, ms);
+            timing.mean_ms    += (ms - timing.mean_ms) / static_cast<double>(timing.samples + 1);
+            timing.last_ms     = ms;
+            timing.frame       = slot.frame;
+            timing.statistics  = statistics;
+            ++timing.samples;
+        }
+
+        ++_stats.frames_resolved;
+    }
+
+    auto QueryManager::row(std::string_view name) -> PassTiming& {
+        auto found = std::ranges::find(_table, name, &PassTiming::name);
+        if (found != _table.end()) {
+            return *found;
+        }
+        return _table.emplace_back(PassTiming{.name = std::string(name)});
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "dispatch.hpp"
+#include "gpu/pass_timing.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    /**
+     * @brief Times passes on the GPU and collects their pipeline statistics
+     *
+     * Every frame in flight owns a slice of one timestamp pool and one
+     * pipeline-statistics pool, reset with a single command at begin_frame().
+     * Results are only read once the timeline semaphore shows the frame
+     * retired, without VK_QUERY_RESULT_WAIT_BIT, so nothing ever blocks; a
+     * slice that comes around again before that drops its frame instead.
+     *
+     * Timestamps are converted with the selected GPU's timestampPeriod and
+     * masked to the queue family's timestampValidBits. Statistics queries
+     * can't nest, a pass opened inside another one only gets timestamps.
+     *
+     * @code
+     * QueryManager queries(device, {.timeline = recorder.semaphore(), .queue_family = queues.graphics.family});
+     *
+     * VkCommandBuffer cmd = recorder.begin_frame();
+     * queries.begin_frame(cmd);
+     * uint32_t shadows = queries.begin_pass(cmd, "shadows");
+     * // ... record the pass
+     * queries.end_pass(cmd, shadows);
+     * queries.end_frame(recorder.end_frame());
+     *
+     * for (const PassTiming& pass : queries.table()) {
+     *     draw_overlay_row(pass.name, pass.mean_ms);
+     * }
+     * @endcode
+     */
+    class QueryManager {
+      public:
+        static constexpr uint32_t NO_PASS = UINT32_MAX;
+
+        struct Config {
+            VkSemaphore timeline;     // signalled by the submissions passed to end_frame()
+            uint32_t    queue_family; // the passes are recorded for
+            uint32_t    frames_in_flight    = 2;
+            uint32_t    max_passes          = 64; // per frame, later passes aren't timed
+            bool        pipeline_statistics = false; // needs DeviceFeature::PipelineStatisticsQuery
+        };
+
+        struct Stats {
+            uint64_t frames_resolved = 0;
+            uint64_t frames_dropped  = 0; // slice reused before its frame retired
+            uint64_t passes_dropped  = 0; // begin_pass() calls beyond max_passes
+        };
+
+      private:
+        struct Slot {
+            std::vector<std::string> names;      // kept for their capacity, only the first `passes` are live
+            std::vector<uint8_t>     statistics; // whether the pass got a statistics query
+            uint32_t                 passes = 0;
+            uint64_t                 frame  = 0;
+            uint64_t                 value  = 0; // 0 when nothing is waiting to be read
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        Config               _config;
+        double               _ns_per_tick;
+        uint64_t             _timestamp_mask;
+
+        VkQueryPool _timestamps = VK_NULL_HANDLE;
+        VkQueryPool _statistics = VK_NULL_HANDLE;
+
+        std::vector<Slot> _slots;
+        uint32_t          _slot            = 0;
+        uint64_t          _frame           = 0;
+        bool              _recording       = false;
+        uint32_t          _statistics_pass = NO_PASS; // pass whose statistics query is active
+
+        std::vector<uint64_t>   _timestamp_results;
+        std::vector<PassTiming> _table;
+        Stats                   _stats;
+
+      public:
+        QueryManager(Device& device, const Config& config);
+        ~QueryManager();
+
+        QueryManager(const QueryManager&) = delete;
+        auto operator=(const QueryManager&) -> QueryManager& = delete;
+
+        QueryManager(QueryManager&&) = delete;
+        auto operator=(QueryManager&&) -> QueryManager& = delete;
+
+        // Reads every retired frame and resets this frame's queries, outside of any render pass
+        auto begin_frame(VkCommandBuffer cmd) -> void;
+
+        // NO_PASS once the frame ran out of queries, end_pass() ignores it
+        [[nodiscard]] auto begin_pass(VkCommandBuffer cmd, std::string_view name) -> uint32_t;
+        auto end_pass(VkCommandBuffer cmd, uint32_t pass) -> void;
+
+        // The frame's queries complete when the timeline reaches `value`
+        auto end_frame(uint64_t value) -> void;
+
+        // Reads whatever frames have retired since the last call, never waits
+        auto resolve() -> void;
+
+        [[nodiscard]] auto table() const noexcept -> std::span<const PassTiming>;
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+        // One CSV line per pass, false when the file can't be written
+        auto write_table(const std::filesystem::path& path) const -> bool;
+
+      private:
+        auto completed_value() const -> uint64_t;
+        auto read(uint32_t index) -> void;
+        auto row(std::string_view name) -> PassTiming&;
+    };
+
+} // namespace vulkron::gpu::vulkan
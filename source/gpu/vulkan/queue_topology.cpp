@@ -0,0 +1,168 @@
+#include "queue_topology.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        // Only these bits matter for the planner, video or sparse support doesn't make a family "less dedicated"
+        constexpr VkQueueFlags ROLE_FLAGS = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+
+        constexpr auto same_queue(const QueueSlot& a, const QueueSlot& b) noexcept -> bool {
+            return a.valid() && b.valid() && a.family == b.family && a.index == b.index;
+        }
+
+        class Planner {
+            std::span<const VkQueueFamilyProperties> _families;
+            QueueTopology&                           _topology;
+
+          public:
+            Planner(std::span<const VkQueueFamilyProperties> families, QueueTopology& topology)
+                : _families(families),
+                _topology(topology)
+            {
+                _topology.priorities.assign(families.size(), {});
+            }
+
+            // Graphics and compute families implicitly support transfers
+            [[nodiscard]] auto flags(uint32_t family) const noexcept -> VkQueueFlags {
+                VkQueueFlags queue_flags = _families[family].queueFlags & ROLE_FLAGS;
+                if (queue_flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) {
+                    queue_flags |= VK_QUEUE_TRANSFER_BIT;
+                }
+                return queue_flags;
+            }
+
+            [[nodiscard]] auto has_free_queue(uint32_t family) const noexcept -> bool {
+                return _topology.priorities[family].size() < _families[family].queueCount;
+            }
+
+            // Family with a free queue whose flags contain `required` and none of `excluded`, fewest extra capabilities first
+            [[nodiscard]] auto find(VkQueueFlags required, VkQueueFlags excluded) const noexcept -> uint32_t {
+                uint32_t best       = UINT32_MAX;
+                int      best_extra = 0;
+
+                for (uint32_t family = 0; family < _families.size(); ++family) {
+                    const VkQueueFlags family_flags = flags(family);
+                    if ((family_flags & required) != required || (family_flags & excluded) != 0 || !has_free_queue(family)) {
+                        continue;
+                    }
+
+                    const int extra = std::popcount(family_flags & ~required);
+                    if (best == UINT32_MAX || extra < best_extra) {
+                        best       = family;
+                        best_extra = extra;
+                    }
+                }
+                return best;
+            }
+
+            [[nodiscard]] auto allocate(uint32_t family, float priority) -> QueueSlot {
+                std::vector<float>& priorities = _topology.priorities[family];
+                priorities.push_back(priority);
+                return QueueSlot{family, static_cast<uint32_t>(priorities.size() - 1), false};
+            }
+
+            [[nodiscard]] auto share(QueueSlot& slot, float priority) -> QueueSlot {
+                float& existing = _topology.priorities[slot.family][slot.index];
+                existing    = std::max(existing, priority);
+                slot.shared = true;
+                return QueueSlot{slot.family, slot.index, true};
+            }
+        };
+
+    } // namespace
+
+    auto QueueTopology::async_compute() const noexcept -> bool {
+        return compute.valid() && !same_queue(compute, graphics);
+    }
+
+    auto QueueTopology::async_transfer() const noexcept -> bool {
+        return transfer.valid() && !same_queue(transfer, graphics) && !same_queue(transfer, compute);
+    }
+
+    auto QueueTopology::queue_create_infos() const -> std::vector<VkDeviceQueueCreateInfo> {
+        std::vector<VkDeviceQueueCreateInfo> create_infos;
+
+        for (uint32_t family = 0; family < priorities.size(); ++family) {
+            if (priorities[family].empty()) {
+                continue;
+            }
+
+            // Points into this topology, which has to outlive vkCreateDevice
+            create_infos.push_back(VkDeviceQueueCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .queueFamilyIndex = family,
+                .queueCount       = static_cast<uint32_t>(priorities[family].size()),
+                .pQueuePriorities = priorities[family].data()
+            });
+        }
+
+        return create_infos;
+    }
+
+    auto plan_queue_topology(std::span<const VkQueueFamilyProperties> families, const QueuePlanRequest& request) -> QueueTopology {
+        for (float priority : {request.graphics_priority, request.compute_priority, request.transfer_priority}) {
+            if (priority < 0.0f || priority > 1.0f) {
+                throw std::runtime_error("Queue priorities must be in range [0.0, 1.0]");
+            }
+        }
+
+        QueueTopology topology;
+        Planner       planner(families, topology);
+
+        if (request.graphics) {
+            // The universal family, graphics families nearly always support compute as well
+            uint32_t family = planner.find(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0);
+            if (family == UINT32_MAX) {
+                family = planner.find(VK_QUEUE_GRAPHICS_BIT, 0);
+            }
+            if (family == UINT32_MAX) {
+                throw std::runtime_error("No graphics queue family found");
+            }
+            topology.graphics = planner.allocate(family, request.graphics_priority);
+        }
+
+        if (request.compute) {
+            // Async compute family first, then another queue next to graphics
+            uint32_t family = planner.find(VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+            if (family == UINT32_MAX) {
+                family = planner.find(VK_QUEUE_COMPUTE_BIT, 0);
+            }
+
+            if (family != UINT32_MAX) {
+                topology.compute = planner.allocate(family, request.compute_priority);
+            } else if (topology.graphics.valid() && (planner.flags(topology.graphics.family) & VK_QUEUE_COMPUTE_BIT)) {
+                topology.compute = planner.share(topology.graphics, request.compute_priority);
+            } else {
+                throw std::runtime_error("No compute queue family found");
+            }
+        }
+
+        if (request.transfer) {
+            // DMA family first, then a spare queue in the least capable family left
+            uint32_t family = planner.find(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+            if (family == UINT32_MAX) {
+                family = planner.find(VK_QUEUE_TRANSFER_BIT, 0);
+            }
+
+            if (family != UINT32_MAX) {
+                topology.transfer = planner.allocate(family, request.transfer_priority);
+            } else if (topology.compute.valid()) {
+                topology.transfer = planner.share(topology.compute, request.transfer_priority);
+            } else if (topology.graphics.valid()) {
+                topology.transfer = planner.share(topology.graphics, request.transfer_priority);
+            } else {
+                throw std::runtime_error("No transfer queue family found");
+            }
+        }
+
+        return topology;
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief Which queues to plan for and how to weigh them
+     */
+    struct QueuePlanRequest {
+        bool graphics = true;
+        bool compute  = true;
+        bool transfer = true;
+
+        float graphics_priority = 1.0f;
+        float compute_priority  = 0.5f;
+        float transfer_priority = 0.5f;
+    };
+
+    /**
+     * @brief Where one role's queue lives
+     *
+     * `shared` means the role reuses the VkQueue of another role because its
+     * family ran out of queues; submissions from different threads to it then
+     * need external synchronization.
+     */
+    struct QueueSlot {
+        uint32_t family = UINT32_MAX;
+        uint32_t index  = 0;
+        bool     shared = false;
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool {
+            return family != UINT32_MAX;
+        }
+    };
+
+    /**
+     * @brief Result of planning, also the source of the VkDeviceQueueCreateInfos
+     */
+    struct QueueTopology {
+        QueueSlot graphics;
+        QueueSlot compute;
+        QueueSlot transfer;
+
+        // One priority per queue to create, indexed by family; empty families create nothing
+        std::vector<std::vector<float>> priorities;
+
+        // Compute runs on another VkQueue than graphics and may overlap graphics work
+        [[nodiscard]] auto async_compute() const noexcept -> bool;
+        // Transfer runs on its own VkQueue, outside the graphics and compute queues
+        [[nodiscard]] auto async_transfer() const noexcept -> bool;
+
+        [[nodiscard]] auto queue_create_infos() const -> std::vector<VkDeviceQueueCreateInfo>;
+    };
+
+    struct Queue {
+        VkQueue  handle = nullptr;
+        uint32_t family = UINT32_MAX;
+        uint32_t index  = 0;
+        bool     shared = false;
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool {
+            return handle != nullptr;
+        }
+    };
+
+    /**
+     * @brief The queues a Device created, one per role
+     *
+     * Roles that were not requested hold an invalid Queue. Roles marked
+     * `shared` alias the same VkQueue as another role.
+     */
+    struct QueueSet {
+        Queue graphics;
+        Queue compute;
+        Queue transfer;
+    };
+
+    /**
+     * @brief Assigns graphics, compute and transfer roles to queue families
+     *
+     * All families are inspected at once. Compute prefers a family without
+     * graphics support and transfer prefers a transfer-only family (DMA
+     * engines), each picking the candidate with the fewest extra
+     * capabilities. Without dedicated families a role takes another queue of
+     * a shared family, and only when that family is out of queues does it
+     * share an existing VkQueue, which is then created with the highest
+     * priority of the roles on it.
+     */
+    [[nodiscard]] auto plan_queue_topology(std::span<const VkQueueFamilyProperties> families, const QueuePlanRequest& request) -> QueueTopology;
+
+} // namespace vulkron::gpu::vulkan
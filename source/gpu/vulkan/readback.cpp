@@ -0,0 +1,320 @@
+#include "readback.hpp"
+#include "device.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr uint64_t UNSUBMITTED = UINT64_MAX;
+
+        auto milliseconds(std::chrono::steady_clock::duration duration) -> double {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+    } // namespace
+
+    auto texel_size(VkFormat format) noexcept -> uint32_t {
+        switch (format) {
+            case VK_FORMAT_R8_UNORM:
+            case VK_FORMAT_R8_UINT:
+                return 1;
+            case VK_FORMAT_R8G8_UNORM:
+            case VK_FORMAT_R16_SFLOAT:
+            case VK_FORMAT_R16_UINT:
+                return 2;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+            case VK_FORMAT_R32_SFLOAT:
+            case VK_FORMAT_R32_UINT:
+                return 4;
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+                return 8;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    ReadbackRing::ReadbackRing(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _allocator(device.allocator()),
+        _config(config)
+    {
+        if (_config.timeline == VK_NULL_HANDLE) {
+            throw std::runtime_error("ReadbackRing needs a timeline semaphore");
+        }
+        _config.slots = std::max(_config.slots, 1u);
+        _slots.resize(_config.slots);
+
+        if (_config.slot_size == 0) {
+            return; // sized by the first copies
+        }
+
+        const VkBufferCreateInfo buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size                  = _config.slot_size,
+            .usage                 = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices   = nullptr
+        };
+
+        try {
+            for (Slot& slot : _slots) {
+                slot.buffer   = _allocator.create_buffer(buffer_info, MemoryUsage::Readback);
+                slot.capacity = _config.slot_size;
+            }
+        } catch (...) {
+            for (Slot& slot : _slots) {
+                _allocator.destroy_buffer(slot.buffer);
+            }
+            throw;
+        }
+    }
+
+    ReadbackRing::~ReadbackRing() {
+        // Copies still in flight write into the buffers, their callbacks are dropped
+        uint64_t last = 0;
+        for (const Slot& slot : _slots) {
+            if (slot.value != UNSUBMITTED) {
+                last = std::max(last, slot.value);
+            }
+        }
+        try {
+            wait_value(last);
+        } catch (const std::runtime_error&) {
+            // The wait only fails once the device is lost, the copies will never land
+        }
+
+        for (Slot& slot : _slots) {
+            _allocator.destroy_buffer(slot.buffer);
+        }
+    }
+
+    auto ReadbackRing::copy_image(VkCommandBuffer cmd, VkImage image, VkExtent2D extent, VkFormat format, Callback callback) -> void {
+        const uint32_t texel = texel_size(format);
+        if (texel == 0) {
+            throw std::runtime_error("ReadbackRing can't copy images of this format");
+        }
+
+        Slot& slot = _slots[_next];
+        if (slot.value == UNSUBMITTED) {
+            throw std::runtime_error("More readbacks in one submission than ReadbackRing has slots");
+        }
+        if (slot.value != 0) {
+            // The ring wrapped onto a copy that is still in flight
+            ++_stats.stalls;
+            wait_value(slot.value);
+            poll();
+        }
+
+        const VkDeviceSize size = VkDeviceSize{extent.width} * extent.height * texel;
+
+        // A delivered slot is idle, so growing it can't race the GPU
+        if (slot.capacity < size) {
+            _allocator.destroy_buffer(slot.buffer);
+
+            const VkBufferCreateInfo buffer_info = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size                  = size,
+                .usage                 = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices   = nullptr
+            };
+            slot.capacity = 0;
+            slot.buffer   = _allocator.create_buffer(buffer_info, MemoryUsage::Readback);
+            slot.capacity = size;
+        }
+
+        const VkBufferImageCopy2 region = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+            .pNext = nullptr,
+            .bufferOffset      = 0,
+            .bufferRowLength   = 0, // tightly packed
+            .bufferImageHeight = 0,
+            .imageSubresource  = {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel       = 0,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {extent.width, extent.height, 1}
+        };
+
+        const VkCopyImageToBufferInfo2 copy_info = {
+            .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_BUFFER_INFO_2,
+            .pNext = nullptr,
+            .srcImage       = image,
+            .srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .dstBuffer      = slot.buffer.buffer,
+            .regionCount    = 1,
+            .pRegions       = &region
+        };
+
+        _api.vkCmdCopyImageToBuffer2(cmd, &copy_info);
+
+        // Makes the copy visible to host reads once the timeline wait returns
+        const VkBufferMemoryBarrier2 barrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask  = VK_PIPELINE_STAGE_2_HOST_BIT,
+            .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = slot.buffer.buffer,
+            .offset = 0,
+            .size   = size
+        };
+
+        const VkDependencyInfo dependency = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags          = 0,
+            .memoryBarrierCount       = 0,
+            .pMemoryBarriers          = nullptr,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers    = &barrier,
+            .imageMemoryBarrierCount  = 0,
+            .pImageMemoryBarriers     = nullptr
+        };
+
+        _api.vkCmdPipelineBarrier2(cmd, &dependency);
+
+        slot.callback = std::move(callback);
+        slot.extent   = extent;
+        slot.format   = format;
+        slot.size     = size;
+        slot.value    = UNSUBMITTED;
+        slot.recorded = Clock::now();
+
+        if (_first_copy == Clock::time_point{}) {
+            _first_copy = slot.recorded;
+        }
+        _next = (_next + 1) % _config.slots;
+    }
+
+    auto ReadbackRing::submit(uint64_t value) -> void {
+        for (Slot& slot : _slots) {
+            if (slot.value == UNSUBMITTED) {
+                slot.value = value;
+            }
+        }
+    }
+
+    auto ReadbackRing::poll() -> uint32_t {
+        if (_slots[_oldest].value == 0 || _slots[_oldest].value == UNSUBMITTED) {
+            return 0;
+        }
+
+        const uint64_t completed = completed_value();
+
+        uint32_t delivered = 0;
+        for (Slot* slot = &_slots[_oldest]; slot->value != 0 && slot->value != UNSUBMITTED && slot->value <= completed; slot = &_slots[_oldest]) {
+            _oldest = (_oldest + 1) % _config.slots;
+            deliver(*slot);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    auto ReadbackRing::flush() -> void {
+        uint64_t last = 0;
+        for (const Slot& slot : _slots) {
+            if (slot.value != UNSUBMITTED) {
+                last = std::max(last, slot.value);
+            }
+        }
+        wait_value(last);
+        poll();
+    }
+
+    auto ReadbackRing::pending() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(std::ranges::count_if(_slots, [](const Slot& slot) { return slot.value != 0; }));
+    }
+
+    auto ReadbackRing::stats() const noexcept -> Stats {
+        return _stats;
+    }
+
+    auto ReadbackRing::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _config.timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query readback timeline semaphore");
+        }
+        return value;
+    }
+
+    auto ReadbackRing::wait_value(uint64_t value) const -> void {
+        if (value == 0) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores    = &_config.timeline,
+            .pValues        = &value
+        };
+
+        if (_api.vkWaitSemaphores(_device, &wait_info, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to wait on readback timeline semaphore");
+        }
+    }
+
+    auto ReadbackRing::deliver(Slot& slot) -> void {
+        _allocator.invalidate(slot.buffer.allocation);
+
+        const Clock::time_point now        = Clock::now();
+        const double            latency_ms = milliseconds(now - slot.recorded);
+
+        const ReadbackFrame frame = {
+            .pixels     = std::span(static_cast<const std::byte*>(slot.buffer.allocation.mapped), slot.size),
+            .extent     = slot.extent,
+            .format     = slot.format,
+            .value      = slot.value,
+            .latency_ms = latency_ms
+        };
+
+        // The slot is free before the callback runs, a throwing callback leaves the ring consistent
+        Callback callback = std::move(slot.callback);
+        slot.callback     = nullptr;
+        slot.value        = 0;
+
+        ++_stats.frames;
+        _stats.bytes += frame.pixels.size();
+        _stats.last_latency_ms = latency_ms;
+        _total_latency_ms += latency_ms;
+        _stats.mean_latency_ms = _total_latency_ms / static_cast<double>(_stats.frames);
+
+        const double elapsed_ms = milliseconds(now - _first_copy);
+        if (elapsed_ms > 0.0) {
+            _stats.bytes_per_second = static_cast<double>(_stats.bytes) * 1000.0 / elapsed_ms;
+        }
+
+        if (callback) {
+            callback(frame);
+        }
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "dispatch.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    // A finished copy, `pixels` is only valid during the callback
+    struct ReadbackFrame {
+        std::span<const std::byte> pixels; // tightly packed rows
+        VkExtent2D                 extent;
+        VkFormat                   format;
+        uint64_t                   value;      // timeline value of the submission that copied it
+        double                     latency_ms; // copy_image() to delivery
+    };
+
+    /**
+     * @brief Copies images back to the CPU without waiting on the queue
+     *
+     * Each copy goes into the next slot of a ring of persistently mapped,
+     * preferably host-cached staging buffers and is recorded into the
+     * caller's command buffer, usually right before the frame is submitted.
+     * submit() tags the copies recorded since the last call with the
+     * timeline value of that submission, poll() hands every slot whose value
+     * the semaphore has passed to its callback.
+     *
+     * With at least as many slots as frames in flight, a slot comes around
+     * again only after its frame retired, so copies never block; otherwise
+     * copy_image() waits for the oldest slot on the CPU and counts a stall.
+     * The GPU never waits on readback.
+     *
+     * @code
+     * ReadbackRing readback(device, {.timeline = recorder.semaphore(), .slots = 3, .slot_size = 1920 * 1080 * 4});
+     *
+     * readback.poll(); // delivers what frames N - 3 and earlier copied
+     * VkCommandBuffer cmd = recorder.begin_frame();
+     * // ... render into image, leave it in TRANSFER_SRC_OPTIMAL
+     * readback.copy_image(cmd, image, extent, VK_FORMAT_R8G8B8A8_UNORM, [](const ReadbackFrame& frame) {
+     *     encode(frame.pixels);
+     * });
+     * readback.submit(recorder.end_frame());
+     * @endcode
+     */
+    class ReadbackRing {
+      public:
+        using Callback = std::function<void(const ReadbackFrame& frame)>;
+
+        struct Config {
+            VkSemaphore  timeline;  // signalled by the submissions passed to submit()
+            uint32_t     slots     = 3;
+            VkDeviceSize slot_size = 0;
+        };
+
+        struct Stats {
+            uint64_t frames           = 0; // delivered
+            uint64_t bytes            = 0; // delivered
+            uint64_t stalls           = 0; // copy_image() calls that waited for a slot
+            double   last_latency_ms  = 0.0;
+            double   mean_latency_ms  = 0.0;
+            double   bytes_per_second = 0.0; // delivered bytes over the time since the first copy
+        };
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Slot {
+            AllocatedBuffer   buffer;
+            Callback          callback;
+            VkExtent2D        extent   = {0, 0};
+            VkFormat          format   = VK_FORMAT_UNDEFINED;
+            VkDeviceSize      size     = 0;
+            VkDeviceSize      capacity = 0; // size the buffer was created with
+            uint64_t          value    = 0; // 0 once delivered, UINT64_MAX until submitted
+            Clock::time_point recorded;
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        MemoryAllocator&     _allocator;
+        Config               _config;
+
+        std::vector<Slot> _slots;
+        uint32_t          _next   = 0; // slot the next copy goes into
+        uint32_t          _oldest = 0; // oldest slot not delivered yet
+
+        Clock::time_point _first_copy;
+        Stats             _stats;
+        double            _total_latency_ms = 0.0;
+
+      public:
+        ReadbackRing(Device& device, const Config& config);
+        ~ReadbackRing();
+
+        ReadbackRing(const ReadbackRing&) = delete;
+        auto operator=(const ReadbackRing&) -> ReadbackRing& = delete;
+
+        ReadbackRing(ReadbackRing&&) = delete;
+        auto operator=(ReadbackRing&&) -> ReadbackRing& = delete;
+
+        // Records a copy of the whole first mip and layer of `image`, which must be in TRANSFER_SRC_OPTIMAL
+        auto copy_image(VkCommandBuffer cmd, VkImage image, VkExtent2D extent, VkFormat format, Callback callback) -> void;
+
+        // The copies recorded since the last call complete when the timeline reaches `value`
+        auto submit(uint64_t value) -> void;
+
+        // Delivers every finished copy in submission order, returns how many
+        auto poll() -> uint32_t;
+
+        // Waits for every submitted copy and delivers it
+        auto flush() -> void;
+
+        [[nodiscard]] auto pending() const noexcept -> uint32_t;
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+
+      private:
+        auto completed_value() const -> uint64_t;
+        auto wait_value(uint64_t value) const -> void;
+        auto deliver(Slot& slot) -> void;
+    };
+
+    // Bytes per texel of the color formats ReadbackRing can copy, 0 for anything else
+    [[nodiscard]] auto texel_size(VkFormat format) noexcept -> uint32_t;
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,420 @@
+#include "shader_compiler.hpp"
+#include "disk_cache.hpp"
+#include "hash.hpp"
+#include "support/common/config.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+        // Bump when the key or manifest layout changes
+        constexpr std::string_view CACHE_FORMAT = "vulkron-shader-cache-1";
+
+        auto stage_name(VkShaderStageFlagBits stage) -> const char* {
+            switch (stage) {
+                case VK_SHADER_STAGE_VERTEX_BIT:                  return "vertex";
+                case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:    return "hull";
+                case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: return "domain";
+                case VK_SHADER_STAGE_GEOMETRY_BIT:                return "geometry";
+                case VK_SHADER_STAGE_FRAGMENT_BIT:                return "fragment";
+                case VK_SHADER_STAGE_COMPUTE_BIT:                 return "compute";
+                case VK_SHADER_STAGE_TASK_BIT_EXT:                return "amplification";
+                case VK_SHADER_STAGE_MESH_BIT_EXT:                return "mesh";
+                default:
+                    throw std::runtime_error("Unsupported shader stage for Slang compilation");
+            }
+        }
+
+        auto quote(const std::string& argument) -> std::string {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+            return "\"" + argument + "\"";
+#else
+            std::string quoted = "'";
+            for (char c : argument) {
+                quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+            }
+            return quoted + "'";
+#endif
+        }
+
+        auto run(const std::string& command) -> int {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+            // cmd /c strips the outermost quotes of the whole line
+            return std::system(("\"" + command + "\"").c_str());
+#else
+            return std::system(command.c_str());
+#endif
+        }
+
+        // Unique per process and call, parallel compiles never share outputs
+        auto scratch_path(const std::filesystem::path& directory) -> std::filesystem::path {
+            static const uint32_t        process_tag = std::random_device{}();
+            static std::atomic<uint64_t> sequence    = 0;
+
+            return directory / (std::to_string(process_tag) + "." + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed)));
+        }
+
+        auto with_extension(std::filesystem::path path, const char* extension) -> std::filesystem::path {
+            path += extension;
+            return path;
+        }
+
+        auto normalize(const std::filesystem::path& path) -> std::filesystem::path {
+            std::error_code error;
+            std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+            return error ? path.lexically_normal() : normalized;
+        }
+
+        // Prerequisites of a make-style rule, as written by slangc -depfile
+        auto parse_depfile(std::string_view text) -> std::vector<std::filesystem::path> {
+            std::vector<std::filesystem::path> files;
+
+            // Skip the target, a drive letter colon is never followed by whitespace
+            size_t position = 0;
+            while (position < text.size()) {
+                position = text.find(':', position);
+                if (position == std::string_view::npos) {
+                    return files;
+                }
+                ++position;
+                if (position == text.size() || text[position] == ' ' || text[position] == '\t' || text[position] == '\r' || text[position] == '\n') {
+                    break;
+                }
+            }
+
+            std::string token;
+            const auto flush = [&]() {
+                // Further rules list their target before a colon
+                if (!token.empty() && token.back() != ':') {
+                    files.emplace_back(token);
+                }
+                token.clear();
+            };
+
+            for (; position < text.size(); ++position) {
+                const char c = text[position];
+                if (c == '\\' && position + 1 < text.size()) {
+                    const char next = text[position + 1];
+                    if (next == ' ' || next == '#') {
+                        token += next;
+                        ++position;
+                        continue;
+                    }
+                    if (next == '\n' || next == '\r') {
+                        flush();
+                        continue;
+                    }
+                }
+                if (c == '$' && position + 1 < text.size() && text[position + 1] == '$') {
+                    token += '$';
+                    ++position;
+                    continue;
+                }
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                    flush();
+                    continue;
+                }
+                token += c;
+            }
+            flush();
+
+            return files;
+        }
+
+        auto to_spirv(const std::string& bytes) -> std::optional<std::vector<uint32_t>> {
+            if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+                return std::nullopt;
+            }
+
+            std::vector<uint32_t> words(bytes.size() / sizeof(uint32_t));
+            std::memcpy(words.data(), bytes.data(), bytes.size());
+            if (words[0] != SPIRV_MAGIC) {
+                return std::nullopt;
+            }
+            return words;
+        }
+
+        struct Dependency {
+            std::filesystem::path path;
+            uint64_t              hash;
+        };
+
+        struct Manifest {
+            uint64_t                object = 0;
+            std::vector<Dependency> dependencies;
+        };
+
+        // First line is the object key, then one "<hash>\t<path>" line per file the compile read
+        auto parse_manifest(const std::string& text) -> std::optional<Manifest> {
+            std::istringstream stream(text);
+            std::string        line;
+
+            Manifest manifest;
+            if (!std::getline(stream, line) || line.size() != 16) {
+                return std::nullopt;
+            }
+            manifest.object = std::strtoull(line.c_str(), nullptr, 16);
+
+            while (std::getline(stream, line)) {
+                const size_t tab = line.find('\t');
+                if (tab != 16) {
+                    return std::nullopt;
+                }
+                manifest.dependencies.push_back({line.substr(tab + 1), std::strtoull(line.substr(0, tab).c_str(), nullptr, 16)});
+            }
+            return manifest;
+        }
+
+        auto serialize_manifest(const Manifest& manifest) -> std::string {
+            std::string text = hex(manifest.object) + "\n";
+            for (const Dependency& dependency : manifest.dependencies) {
+                text += hex(dependency.hash) + "\t" + dependency.path.string() + "\n";
+            }
+            return text;
+        }
+
+        auto object_key(uint64_t manifest_key, const std::vector<Dependency>& dependencies) -> uint64_t {
+            Hasher hasher;
+            hasher.value(manifest_key);
+            for (const Dependency& dependency : dependencies) {
+                hasher.update(dependency.path.string());
+                hasher.value(dependency.hash);
+            }
+            return hasher.digest();
+        }
+
+        // Content hashes of the files one compile() call touched, permutations mostly share includes
+        class FileHashes {
+            std::mutex                                               _mutex;
+            std::map<std::filesystem::path, std::optional<uint64_t>> _hashes;
+
+          public:
+            auto get(const std::filesystem::path& path) -> std::optional<uint64_t> {
+                {
+                    std::lock_guard lock(_mutex);
+                    if (auto it = _hashes.find(path); it != _hashes.end()) {
+                        return it->second;
+                    }
+                }
+
+                std::optional<uint64_t> hash;
+                if (auto contents = read_cache_file(path)) {
+                    hash = Hasher{}.update(*contents).digest();
+                }
+
+                std::lock_guard lock(_mutex);
+                return _hashes.try_emplace(path, hash).first->second;
+            }
+        };
+
+    } // namespace
+
+    ShaderCompiler::ShaderCompiler(Config config)
+        : _config(std::move(config))
+    {
+        if (_config.cache_directory.empty()) {
+            _config.cache_directory = default_cache_directory() / "shaders";
+        }
+        for (std::filesystem::path& directory : _config.include_directories) {
+            directory = normalize(directory);
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(_config.cache_directory / "tmp", error);
+
+        // The compiler's version is part of every key, upgrading slangc invalidates the cache
+        const std::filesystem::path output = with_extension(scratch_path(_config.cache_directory / "tmp"), ".version");
+        if (run(quote(_config.compiler.string()) + " -v > " + quote(output.string()) + " 2>&1") == 0) {
+            _compiler_version = read_cache_file(output).value_or("");
+        }
+        std::filesystem::remove(output, error);
+    }
+
+    auto ShaderCompiler::compile(const ShaderRequest& request) -> ShaderBinary {
+        return std::move(compile(std::span(&request, 1)).front());
+    }
+
+    auto ShaderCompiler::compile(std::span<const ShaderRequest> requests) -> std::vector<ShaderBinary> {
+        const std::filesystem::path manifests = _config.cache_directory / "manifests";
+        const std::filesystem::path objects   = _config.cache_directory / "objects";
+        const std::filesystem::path scratch   = _config.cache_directory / "tmp";
+
+        FileHashes file_hashes;
+
+        std::vector<ShaderBinary>          binaries(requests.size());
+        std::vector<uint64_t>              manifest_keys(requests.size());
+        std::vector<std::filesystem::path> sources(requests.size());
+        std::vector<size_t>                misses;
+
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const ShaderRequest& request = requests[i];
+            sources[i] = normalize(request.source);
+
+            // Defines are canonicalized, their order on the command line doesn't change the output
+            auto defines = request.defines;
+            std::ranges::sort(defines);
+
+            Hasher hasher;
+            hasher.update(CACHE_FORMAT).update(_compiler_version).update(sources[i].string());
+            hasher.update(request.entry_point).update(stage_name(request.stage)).update(request.profile);
+            for (const auto& [name, value] : defines) {
+                hasher.update(name).update(value);
+            }
+            for (const std::filesystem::path& directory : _config.include_directories) {
+                hasher.update(directory.string());
+            }
+            manifest_keys[i] = hasher.digest();
+
+            auto manifest = read_cache_file(manifests / hex(manifest_keys[i]))
+                .and_then([](const std::string& text) { return parse_manifest(text); });
+
+            const bool up_to_date = manifest && std::ranges::all_of(manifest->dependencies, [&](const Dependency& dependency) {
+                return file_hashes.get(dependency.path) == dependency.hash;
+            });
+
+            std::optional<std::vector<uint32_t>> spirv;
+            std::optional<std::string>           reflection;
+            if (up_to_date && object_key(manifest_keys[i], manifest->dependencies) == manifest->object) {
+                spirv      = read_cache_file(objects / (hex(manifest->object) + ".spv")).and_then(to_spirv);
+                reflection = read_cache_file(objects / (hex(manifest->object) + ".json"));
+            }
+
+            if (spirv && reflection) {
+                binaries[i] = ShaderBinary{std::move(*spirv), std::move(*reflection), manifest->object, true};
+            } else {
+                misses.push_back(i);
+            }
+        }
+
+        _hits.fetch_add(requests.size() - misses.size(), std::memory_order_relaxed);
+        _misses.fetch_add(misses.size(), std::memory_order_relaxed);
+
+        if (misses.empty()) {
+            return binaries;
+        }
+        if (_compiler_version.empty()) {
+            throw std::runtime_error("Shader compiler " + _config.compiler.string() + " is not available");
+        }
+
+        std::vector<std::string> errors(requests.size());
+        std::atomic<size_t>      next = 0;
+
+        const auto compile_misses = [&]() {
+            for (size_t slot = next.fetch_add(1); slot < misses.size(); slot = next.fetch_add(1)) {
+                const size_t         i       = misses[slot];
+                const ShaderRequest& request = requests[i];
+
+                const std::filesystem::path base = scratch_path(scratch);
+                const auto spirv_path      = with_extension(base, ".spv");
+                const auto reflection_path = with_extension(base, ".json");
+                const auto depfile_path    = with_extension(base, ".d");
+                const auto log_path        = with_extension(base, ".log");
+
+                std::string command = quote(_config.compiler.string()) + " " + quote(sources[i].string());
+                command += " -target spirv -profile " + quote(request.profile);
+                command += " -entry " + quote(request.entry_point);
+                command += " -stage " + std::string(stage_name(request.stage));
+                for (const std::filesystem::path& directory : _config.include_directories) {
+                    command += " -I " + quote(directory.string());
+                }
+                for (const auto& [name, value] : request.defines) {
+                    command += " -D " + quote(value.empty() ? name : name + "=" + value);
+                }
+                command += " -o " + quote(spirv_path.string());
+                command += " -reflection-json " + quote(reflection_path.string());
+                command += " -depfile " + quote(depfile_path.string());
+                command += " > " + quote(log_path.string()) + " 2>&1";
+
+                const int status     = run(command);
+                auto      spirv      = read_cache_file(spirv_path).and_then(to_spirv);
+                auto      reflection = read_cache_file(reflection_path);
+                auto      depfile    = read_cache_file(depfile_path);
+                auto      log        = read_cache_file(log_path);
+
+                std::error_code error;
+                for (const auto& path : {spirv_path, reflection_path, depfile_path, log_path}) {
+                    std::filesystem::remove(path, error);
+                }
+
+                if (status != 0 || !spirv || !reflection) {
+                    std::string message = log.value_or("slangc produced no output");
+                    message.erase(message.find_last_not_of(" \r\n") + 1);
+                    errors[i] = sources[i].string() + " (" + request.entry_point + "): " + message;
+                    continue;
+                }
+
+                // The depfile is the include closure, the source itself is always part of it
+                std::vector<std::filesystem::path> files = depfile ? parse_depfile(*depfile) : std::vector<std::filesystem::path>{};
+                files.push_back(sources[i]);
+                for (std::filesystem::path& file : files) {
+                    file = normalize(file);
+                }
+                std::ranges::sort(files);
+                files.erase(std::unique(files.begin(), files.end()), files.end());
+
+                Manifest manifest;
+                bool     complete = true;
+                for (const std::filesystem::path& file : files) {
+                    const std::optional<uint64_t> hash = file_hashes.get(file);
+                    complete &= hash.has_value();
+                    manifest.dependencies.push_back({file, hash.value_or(0)});
+                }
+                manifest.object = object_key(manifest_keys[i], manifest.dependencies);
+
+                // Objects go first, a manifest never points at a missing object
+                if (complete) {
+                    const std::string_view spirv_bytes(reinterpret_cast<const char*>(spirv->data()), spirv->size() * sizeof(uint32_t));
+                    const bool stored = write_cache_file(objects / (hex(manifest.object) + ".spv"), spirv_bytes)
+                        && write_cache_file(objects / (hex(manifest.object) + ".json"), *reflection);
+                    if (stored) {
+                        write_cache_file(manifests / hex(manifest_keys[i]), serialize_manifest(manifest));
+                    }
+                }
+
+                binaries[i] = ShaderBinary{std::move(*spirv), std::move(*reflection), manifest.object, false};
+            }
+        };
+
+        uint32_t thread_count = _config.threads != 0 ? _config.threads : std::max(1u, std::thread::hardware_concurrency());
+        thread_count = std::min<uint32_t>(thread_count, static_cast<uint32_t>(misses.size()));
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(thread_count - 1);
+            for (uint32_t i = 1; i < thread_count; ++i) {
+                workers.emplace_back(compile_misses);
+            }
+            compile_misses();
+        }
+
+        std::string failures;
+        for (const std::string& error : errors) {
+            if (!error.empty()) {
+                failures += "\n" + error;
+            }
+        }
+        if (!failures.empty()) {
+            throw std::runtime_error("Shader compilation failed:" + failures);
+        }
+
+        return binaries;
+    }
+
+    auto ShaderCompiler::stats() const noexcept -> Stats {
+        return Stats{_hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed)};
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    /**
+     * @brief One permutation of a Slang entry point to compile
+     */
+    struct ShaderRequest {
+        std::filesystem::path                            source;
+        std::string                                      entry_point = "main";
+        VkShaderStageFlagBits                            stage       = VK_SHADER_STAGE_COMPUTE_BIT;
+        std::vector<std::pair<std::string, std::string>> defines;
+        std::string                                      profile     = "spirv_1_5";
+    };
+
+    struct ShaderBinary {
+        std::vector<uint32_t> spirv;
+        std::string           reflection; // slangc -reflection-json output
+        uint64_t              key    = 0; // content address of the binary
+        bool                  cached = false;
+    };
+
+    /**
+     * @brief Compiles Slang to SPIR-V through a content-addressed cache
+     *
+     * A permutation is looked up in two steps, like ccache's direct mode. The
+     * source file, defines, entry point, stage, profile, include directories
+     * and compiler version name a manifest, which lists every file the last
+     * compile read (from slangc's depfile) with its content hash. When all of
+     * them still hash the same, the manifest names the cached SPIR-V and
+     * reflection. Editing an include therefore only recompiles the
+     * permutations whose manifest lists it.
+     *
+     * Misses are compiled by slangc processes running in parallel. Entries
+     * are written with write_cache_file(), so concurrent processes can share
+     * one cache directory.
+     *
+     * @code
+     * ShaderCompiler compiler({.cache_directory = default_cache_directory() / "shaders", .include_directories = {"shaders"}});
+     * auto binaries = compiler.compile(requests);
+     * @endcode
+     */
+    class ShaderCompiler {
+      public:
+        struct Config {
+            std::filesystem::path              cache_directory;
+            std::vector<std::filesystem::path> include_directories;
+            std::filesystem::path              compiler = "slangc";
+            uint32_t                           threads  = 0; // 0 uses every hardware thread
+        };
+
+        struct Stats {
+            uint64_t hits   = 0;
+            uint64_t misses = 0;
+        };
+
+      private:
+        Config      _config;
+        std::string _compiler_version;
+
+        std::atomic<uint64_t> _hits   = 0;
+        std::atomic<uint64_t> _misses = 0;
+
+      public:
+        explicit ShaderCompiler(Config config);
+
+        ShaderCompiler(const ShaderCompiler&) = delete;
+        auto operator=(const ShaderCompiler&) -> ShaderCompiler& = delete;
+
+        ShaderCompiler(ShaderCompiler&&) = delete;
+        auto operator=(ShaderCompiler&&) -> ShaderCompiler& = delete;
+
+        // Results match the order of `requests`, throws with the compiler log when any permutation fails
+        [[nodiscard]] auto compile(std::span<const ShaderRequest> requests) -> std::vector<ShaderBinary>;
+        [[nodiscard]] auto compile(const ShaderRequest& request) -> ShaderBinary;
+
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+    };
+
+} // namespace vulkron::gpu::vulkan
@@ -1,73 +1,191 @@
 #pragma once
 
+#include <array>
 #include <concepts>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vulkan/vulkan.h>
 
 namespace vulkron::gpu::vulkan {
 
+    // sType of each struct a StructChain may hold, add a line below to chain a new one
+    template <typename T>
+    struct StructureType;
+
+#define VULKRON_STRUCTURE_TYPE(type, s_type)                     \
+    template <>                                                  \
+    struct StructureType<type> {                                 \
+        static constexpr VkStructureType value = s_type;         \
+    };
+
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceFeatures2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan11Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan12Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan13Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan14Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_4_FEATURES)
+
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceProperties2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan11Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan12Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan13Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceVulkan14Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_4_PROPERTIES)
+    VULKRON_STRUCTURE_TYPE(VkPhysicalDeviceMemoryProperties2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2)
+
+#undef VULKRON_STRUCTURE_TYPE
+
     template <typename T>
     concept VulkanStruct = requires(T t) {
         { t.sType } -> std::convertible_to<VkStructureType>;
-        { t.pNext } -> std::convertible_to<void*>;
+        { t.pNext } -> std::convertible_to<const void*>;
+        { StructureType<T>::value } -> std::convertible_to<VkStructureType>;
     };
 
-    class PChainNext {
-        VkBaseOutStructure* head = nullptr;
+    namespace detail {
+
+        template <typename T, typename... Ts>
+        consteval auto chain_index() -> size_t {
+            constexpr std::array<bool, sizeof...(Ts)> matches{std::is_same_v<T, Ts>...};
+            for (size_t i = 0; i < matches.size(); ++i) {
+                if (matches[i]) {
+                    return i;
+                }
+            }
+            return matches.size();
+        }
+
+        template <typename... Ts>
+        consteval auto unique_structure_types() -> bool {
+            constexpr std::array<VkStructureType, sizeof...(Ts)> types{StructureType<Ts>::value...};
+            for (size_t i = 0; i < types.size(); ++i) {
+                for (size_t j = i + 1; j < types.size(); ++j) {
+                    if (types[i] == types[j]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief pNext chain whose members are fixed at compile time
+     *
+     * The structs live inline in declaration order, get their sType filled in
+     * and are linked front to back on construction. Copies relink to their own
+     * storage. Chaining the same struct twice doesn't compile.
+     *
+     * Members other than the head can be unlinked and linked again, e.g. for
+     * core versions a device doesn't expose; relinking rewrites every pNext in
+     * one pass over the members, nothing walks the chain.
+     *
+     * @code
+     * StructChain<VkPhysicalDeviceProperties2, VkPhysicalDeviceVulkan11Properties> properties;
+     * api.vkGetPhysicalDeviceProperties2(gpu, properties.head());
+     * const uint8_t* uuid = properties.get<VkPhysicalDeviceVulkan11Properties>().deviceUUID;
+     * @endcode
+     */
+    template <VulkanStruct Head, VulkanStruct... Tail>
+    class StructChain {
+        static constexpr size_t COUNT = 1 + sizeof...(Tail);
+
+        static_assert(detail::unique_structure_types<Head, Tail...>(), "A structure type can only appear once in a chain");
+        static_assert(COUNT <= 32, "StructChain tracks linked members in a 32-bit mask");
+
+        std::tuple<Head, Tail...> _structs{}; // value-initialized, every flag starts out VK_FALSE
+        uint32_t                  _unlinked = 0;
 
       public:
-        constexpr PChainNext() noexcept = default;
+        constexpr StructChain() noexcept {
+            set_types(std::make_index_sequence<COUNT>{});
+            link();
+        }
 
-        template <VulkanStruct T>
-        constexpr PChainNext(T& first) noexcept 
-        : head(reinterpret_cast<VkBaseOutStructure*>(&first))
+        constexpr StructChain(const StructChain& other) noexcept
+            : _structs(other._structs),
+            _unlinked(other._unlinked)
         {
-            first.pNext = nullptr; // ensure the chain terminates
+            link();
         }
 
-        [[nodiscard]]
-        constexpr auto get() const noexcept -> void* {
-            return head;
+        constexpr auto operator=(const StructChain& other) noexcept -> StructChain& {
+            _structs  = other._structs;
+            _unlinked = other._unlinked;
+            link();
+            return *this;
         }
 
-        auto print() const -> void {
-            if (!head) {
-                std::cout << "<empty chain>\n";
-                return;
-            }
+        template <typename T>
+        [[nodiscard]] constexpr auto get() noexcept -> T& {
+            return std::get<index<T>()>(_structs);
+        }
 
-            const VkBaseOutStructure* current = head;
-            while (current) {
-                std::cout << "struct @ " << current << " sType = " << current->sType
-                          << " pNext = " << current->pNext << "\n";
-                current = current->pNext;
-            }
+        template <typename T>
+        [[nodiscard]] constexpr auto get() const noexcept -> const T& {
+            return std::get<index<T>()>(_structs);
         }
 
-        template <VulkanStruct T>
-        auto append(T& nextStruct) noexcept -> PChainNext& {
-            nextStruct.pNext = nullptr;
+        // What gets passed to Vulkan
+        [[nodiscard]] constexpr auto head() noexcept -> Head* {
+            return &std::get<0>(_structs);
+        }
 
-            if (!head) {
-                head = reinterpret_cast<VkBaseOutStructure*>(&nextStruct);
-                return *this;
-            }
+        [[nodiscard]] constexpr auto head() const noexcept -> const Head* {
+            return &std::get<0>(_structs);
+        }
 
-            VkBaseOutStructure* last = head;
-            while (last->pNext) {
-                last = last->pNext;
-            }
+        template <typename T>
+        constexpr auto unlink() noexcept -> void {
+            static_assert(index<T>() != 0, "The head of a chain can't be unlinked");
+            _unlinked |= uint32_t{1} << index<T>();
+            link();
+        }
 
-            last->pNext = reinterpret_cast<VkBaseOutStructure*>(&nextStruct);
-            return *this;
+        template <typename T>
+        constexpr auto relink() noexcept -> void {
+            _unlinked &= ~(uint32_t{1} << index<T>());
+            link();
+        }
+
+        template <typename T>
+        [[nodiscard]] constexpr auto linked() const noexcept -> bool {
+            return (_unlinked & (uint32_t{1} << index<T>())) == 0;
+        }
+
+      private:
+        template <typename T>
+        static consteval auto index() -> size_t {
+            constexpr size_t i = detail::chain_index<T, Head, Tail...>();
+            static_assert(i < COUNT, "Structure type isn't part of this chain");
+            return i;
+        }
+
+        template <size_t... I>
+        constexpr auto set_types(std::index_sequence<I...>) noexcept -> void {
+            ((std::get<I>(_structs).sType = StructureType<std::tuple_element_t<I, std::tuple<Head, Tail...>>>::value), ...);
         }
-    };
 
-    // Pipe operator for chaining
-    template <VulkanStruct T>
-    auto operator|(PChainNext chain, T& nextStruct) noexcept -> PChainNext {
-        chain.append(nextStruct);
-        return chain;
-    }
+        // Back to front, so each linked member points at the next linked one
+        constexpr auto link() noexcept -> void {
+            void* next = nullptr;
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (link_member<COUNT - 1 - I>(next), ...);
+            }(std::make_index_sequence<COUNT>{});
+        }
+
+        template <size_t I>
+        constexpr auto link_member(void*& next) noexcept -> void {
+            auto& member = std::get<I>(_structs);
+            if (I == 0 || (_unlinked & (uint32_t{1} << I)) == 0) {
+                member.pNext = next;
+                next         = &member;
+            } else {
+                member.pNext = nullptr;
+            }
+        }
+    };
 
-} // namespace vulkron::gpu::vulkan
\ No newline at end of file
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,580 @@
+#include "upload.hpp"
+#include "device.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace vulkron::gpu::vulkan {
+
+    namespace {
+
+        // Command pools kept around for submissions still in flight
+        constexpr size_t MAX_FRAMES = 8;
+
+        constexpr auto align_up(VkDeviceSize value, VkDeviceSize alignment) noexcept -> VkDeviceSize {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        auto subresource_range(const VkImageSubresourceLayers& layers) noexcept -> VkImageSubresourceRange {
+            return VkImageSubresourceRange{
+                .aspectMask     = layers.aspectMask,
+                .baseMipLevel   = layers.mipLevel,
+                .levelCount     = 1,
+                .baseArrayLayer = layers.baseArrayLayer,
+                .layerCount     = layers.layerCount
+            };
+        }
+
+    } // namespace
+
+    UploadEngine::UploadEngine(Device& device, const Config& config)
+        : _api(device.dispatch()),
+        _device(device.device_handle()),
+        _allocator(device.allocator()),
+        _config(config),
+        _alignment(16),
+        _mapped(nullptr)
+    {
+        const Adapter* adapter = device.instance()->adapter(device.physical_device_handle());
+        if (adapter == nullptr) {
+            throw std::runtime_error("UploadEngine needs a device with a selected GPU");
+        }
+        const VkPhysicalDeviceLimits& limits = adapter->properties.head()->properties.limits;
+
+        // Image copies need texel-aligned buffer offsets, 16 covers every uncompressed format we upload
+        _alignment = std::max<VkDeviceSize>(_alignment, limits.optimalBufferCopyOffsetAlignment);
+        _config.staging_size = align_up(std::max(_config.staging_size, _alignment), _alignment);
+
+        VkBufferCreateInfo buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size  = _config.staging_size,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices   = nullptr
+        };
+
+        _staging = _allocator.create_buffer(buffer_info, MemoryUsage::Upload);
+        _mapped  = static_cast<std::byte*>(_staging.allocation.mapped);
+        if (_mapped == nullptr) {
+            _allocator.destroy_buffer(_staging);
+            throw std::runtime_error("Upload staging buffer is not host visible");
+        }
+
+        VkSemaphoreTypeCreateInfo type_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue  = 0
+        };
+
+        VkSemaphoreCreateInfo semaphore_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+            .flags = 0
+        };
+
+        if (_api.vkCreateSemaphore(_device, &semaphore_info, nullptr, &_timeline) != VK_SUCCESS) {
+            _allocator.destroy_buffer(_staging);
+            throw std::runtime_error("Failed to create upload timeline semaphore");
+        }
+    }
+
+    UploadEngine::~UploadEngine() {
+        // Anything queued but never ticked is dropped, only submitted copies are waited on.
+        // The wait only fails once the device is lost, nothing executes on it any more.
+        try {
+            wait_value(_submitted, UINT64_MAX);
+        } catch (const std::runtime_error&) {
+        }
+
+        for (Frame& frame : _frames) {
+            _api.vkDestroyCommandPool(_device, frame.pool, nullptr);
+        }
+
+        _api.vkDestroySemaphore(_device, _timeline, nullptr);
+        _allocator.destroy_buffer(_staging);
+    }
+
+    auto UploadEngine::upload_buffer(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data,
+                                     VkPipelineStageFlags2 consumer_stages) -> UploadTicket {
+        if (data.empty()) {
+            return {};
+        }
+
+        std::lock_guard lock(_mutex);
+
+        // Large buffers go through in chunks so the ring keeps turning over
+        const VkDeviceSize chunk_limit = std::max(_config.staging_size / 4 / _alignment * _alignment, _alignment);
+
+        VkDeviceSize copied = 0;
+        while (copied < data.size()) {
+            const VkDeviceSize chunk = std::min<VkDeviceSize>(data.size() - copied, chunk_limit);
+            const VkDeviceSize ring_offset = reserve(chunk);
+
+            std::memcpy(_mapped + ring_offset, data.data() + copied, chunk);
+
+            _buffer_copies.push_back(BufferCopy{
+                .buffer = buffer,
+                .region = VkBufferCopy2{
+                    .sType     = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+                    .pNext     = nullptr,
+                    .srcOffset = ring_offset,
+                    .dstOffset = offset + copied,
+                    .size      = chunk
+                },
+                .consumer_stages = consumer_stages
+            });
+
+            copied += chunk;
+        }
+
+        _stats.bytes_uploaded += data.size();
+        return UploadTicket{_submitted + 1};
+    }
+
+    auto UploadEngine::upload_image(const ImageUpload& upload, std::span<const std::byte> data) -> UploadTicket {
+        if (data.empty()) {
+            return {};
+        }
+
+        if (data.size() > _config.staging_size) {
+            throw std::runtime_error("Image upload does not fit into the staging ring");
+        }
+
+        std::lock_guard lock(_mutex);
+
+        const VkDeviceSize ring_offset = reserve(data.size());
+        std::memcpy(_mapped + ring_offset, data.data(), data.size());
+
+        _image_copies.push_back(ImageCopy{
+            .upload = upload,
+            .region = VkBufferImageCopy2{
+                .sType             = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+                .pNext             = nullptr,
+                .bufferOffset      = ring_offset,
+                .bufferRowLength   = 0, // tightly packed
+                .bufferImageHeight = 0,
+                .imageSubresource  = upload.subresource,
+                .imageOffset       = upload.offset,
+                .imageExtent       = upload.extent
+            }
+        });
+
+        _stats.bytes_uploaded += data.size();
+        return UploadTicket{_submitted + 1};
+    }
+
+    auto UploadEngine::tick() -> void {
+        std::lock_guard lock(_mutex);
+        submit_locked();
+        retire(false);
+    }
+
+    auto UploadEngine::is_complete(UploadTicket ticket) const -> bool {
+        return ticket.value <= completed_value();
+    }
+
+    auto UploadEngine::wait(UploadTicket ticket, uint64_t timeout) -> bool {
+        {
+            std::lock_guard lock(_mutex);
+            if (ticket.value > _submitted) {
+                submit_locked();
+            }
+        }
+
+        return wait_value(ticket.value, timeout);
+    }
+
+    auto UploadEngine::acquire(VkCommandBuffer cmd) -> UploadTicket {
+        std::lock_guard lock(_mutex);
+
+        if (_buffer_acquires.empty() && _image_acquires.empty()) {
+            return {};
+        }
+
+        VkDependencyInfo dependency = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags          = 0,
+            .memoryBarrierCount       = 0,
+            .pMemoryBarriers          = nullptr,
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(_buffer_acquires.size()),
+            .pBufferMemoryBarriers    = _buffer_acquires.data(),
+            .imageMemoryBarrierCount  = static_cast<uint32_t>(_image_acquires.size()),
+            .pImageMemoryBarriers     = _image_acquires.data()
+        };
+        _api.vkCmdPipelineBarrier2(cmd, &dependency);
+
+        _buffer_acquires.clear();
+        _image_acquires.clear();
+        return UploadTicket{_acquire_value};
+    }
+
+    auto UploadEngine::semaphore() const noexcept -> VkSemaphore {
+        return _timeline;
+    }
+
+    auto UploadEngine::stats() const -> Stats {
+        std::lock_guard lock(_mutex);
+
+        Stats stats = _stats;
+        stats.ring_in_use = _head - _tail;
+        return stats;
+    }
+
+    auto UploadEngine::completed_value() const -> uint64_t {
+        uint64_t value = 0;
+        if (_api.vkGetSemaphoreCounterValue(_device, _timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query upload timeline semaphore");
+        }
+        return value;
+    }
+
+    auto UploadEngine::wait_value(uint64_t value, uint64_t timeout) const -> bool {
+        if (value == 0) {
+            return true;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores    = &_timeline,
+            .pValues        = &value
+        };
+
+        const VkResult result = _api.vkWaitSemaphores(_device, &wait_info, timeout);
+        if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+            throw std::runtime_error("Failed to wait on upload timeline semaphore");
+        }
+        return result == VK_SUCCESS;
+    }
+
+    auto UploadEngine::reserve(VkDeviceSize size) -> VkDeviceSize {
+        const VkDeviceSize ring_size = _config.staging_size;
+
+        for (;;) {
+            // Restart from the beginning whenever the ring drains, so wrapping never wastes space
+            if (_head == _tail) {
+                _head = _tail = align_up(_head, ring_size);
+            }
+
+            const VkDeviceSize position = _head % ring_size;
+            VkDeviceSize       start    = align_up(position, _alignment);
+            uint64_t           new_head = _head + (start - position) + size;
+
+            if (start + size > ring_size) {
+                start    = 0;
+                new_head = _head + (ring_size - position) + size;
+            }
+
+            if (new_head - _tail <= ring_size) {
+                _head = new_head;
+                return start;
+            }
+
+            if (retire(false)) {
+                continue;
+            }
+
+            // Out of space: push out whatever is queued and block on the oldest submission
+            ++_stats.ring_stalls;
+            submit_locked();
+            retire(true);
+        }
+    }
+
+    auto UploadEngine::retire(bool block) -> bool {
+        if (_in_flight.empty()) {
+            return false;
+        }
+
+        if (block) {
+            wait_value(_in_flight.front().value, UINT64_MAX);
+        }
+
+        const uint64_t completed = completed_value();
+
+        bool retired = false;
+        while (!_in_flight.empty() && _in_flight.front().value <= completed) {
+            _tail = _in_flight.front().ring_end;
+            _in_flight.pop_front();
+            retired = true;
+        }
+        return retired;
+    }
+
+    auto UploadEngine::next_frame() -> Frame& {
+        const uint64_t completed = completed_value();
+
+        for (Frame& frame : _frames) {
+            if (frame.value <= completed) {
+                return frame;
+            }
+        }
+
+        if (_frames.size() == MAX_FRAMES) {
+            auto oldest = std::ranges::min_element(_frames, {}, &Frame::value);
+            wait_value(oldest->value, UINT64_MAX);
+            return *oldest;
+        }
+
+        Frame frame;
+
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = _config.queue_family
+        };
+
+        if (_api.vkCreateCommandPool(_device, &pool_info, nullptr, &frame.pool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create upload command pool");
+        }
+
+        VkCommandBufferAllocateInfo allocate_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool        = frame.pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+
+        if (_api.vkAllocateCommandBuffers(_device, &allocate_info, &frame.cmd) != VK_SUCCESS) {
+            _api.vkDestroyCommandPool(_device, frame.pool, nullptr);
+            throw std::runtime_error("Failed to allocate upload command buffer");
+        }
+
+        return _frames.emplace_back(frame);
+    }
+
+    auto UploadEngine::submit_locked() -> void {
+        if (_buffer_copies.empty() && _image_copies.empty()) {
+            return;
+        }
+
+        Frame& frame = next_frame();
+        _api.vkResetCommandPool(_device, frame.pool, 0);
+
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr
+        };
+
+        if (_api.vkBeginCommandBuffer(frame.cmd, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin upload command buffer");
+        }
+
+        const uint64_t value = _submitted + 1;
+        record(frame.cmd);
+
+        if (_api.vkEndCommandBuffer(frame.cmd) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record upload command buffer");
+        }
+
+        _allocator.flush(_staging.allocation);
+
+        VkCommandBufferSubmitInfo command_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = frame.cmd,
+            .deviceMask    = 0
+        };
+
+        VkSemaphoreSubmitInfo signal_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .semaphore   = _timeline,
+            .value       = value,
+            .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        };
+
+        VkSubmitInfo2 submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = 0,
+            .waitSemaphoreInfoCount   = 0,
+            .pWaitSemaphoreInfos      = nullptr,
+            .commandBufferInfoCount   = 1,
+            .pCommandBufferInfos      = &command_info,
+            .signalSemaphoreInfoCount = 1,
+            .pSignalSemaphoreInfos    = &signal_info
+        };
+
+        if (_api.vkQueueSubmit2(_config.queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit uploads");
+        }
+
+        _submitted  = value;
+        frame.value = value;
+        _in_flight.push_back(InFlight{value, _head});
+
+        if (!_buffer_acquires.empty() || !_image_acquires.empty()) {
+            _acquire_value = value;
+        }
+
+        ++_stats.submissions;
+        _stats.buffer_copies += _buffer_copies.size();
+        _stats.image_copies  += _image_copies.size();
+
+        _buffer_copies.clear();
+        _image_copies.clear();
+    }
+
+    auto UploadEngine::record(VkCommandBuffer cmd) -> void {
+        // Same family: images still need their layout transition, buffers are covered by the semaphore
+        const bool     transfer_ownership = _config.queue_family != _config.consumer_family;
+        const uint32_t src_family = transfer_ownership ? _config.queue_family : VK_QUEUE_FAMILY_IGNORED;
+        const uint32_t dst_family = transfer_ownership ? _config.consumer_family : VK_QUEUE_FAMILY_IGNORED;
+
+        std::vector<VkImageMemoryBarrier2>  image_barriers;
+        std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+
+        auto dependency = [&]() {
+            return VkDependencyInfo{
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags          = 0,
+                .memoryBarrierCount       = 0,
+                .pMemoryBarriers          = nullptr,
+                .bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size()),
+                .pBufferMemoryBarriers    = buffer_barriers.data(),
+                .imageMemoryBarrierCount  = static_cast<uint32_t>(image_barriers.size()),
+                .pImageMemoryBarriers     = image_barriers.data()
+            };
+        };
+
+        // Every image region enters TRANSFER_DST_OPTIMAL in one batch
+        image_barriers.reserve(_image_copies.size());
+        for (const ImageCopy& copy : _image_copies) {
+            image_barriers.push_back(VkImageMemoryBarrier2{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask  = VK_PIPELINE_STAGE_2_NONE,
+                .srcAccessMask = VK_ACCESS_2_NONE,
+                .dstStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+                .dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image            = copy.upload.image,
+                .subresourceRange = subresource_range(copy.upload.subresource)
+            });
+        }
+
+        if (!image_barriers.empty()) {
+            const VkDependencyInfo info = dependency();
+            _api.vkCmdPipelineBarrier2(cmd, &info);
+        }
+
+        // One vkCmdCopyBuffer2 per destination buffer
+        std::ranges::stable_sort(_buffer_copies, {}, [](const BufferCopy& copy) { return copy.buffer; });
+
+        std::vector<VkBufferCopy2> regions;
+        regions.reserve(_buffer_copies.size());
+
+        for (size_t first = 0; first < _buffer_copies.size();) {
+            size_t last = first;
+            regions.clear();
+            while (last < _buffer_copies.size() && _buffer_copies[last].buffer == _buffer_copies[first].buffer) {
+                regions.push_back(_buffer_copies[last].region);
+                ++last;
+            }
+
+            VkCopyBufferInfo2 copy_info = {
+                .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+                .pNext = nullptr,
+                .srcBuffer   = _staging.buffer,
+                .dstBuffer   = _buffer_copies[first].buffer,
+                .regionCount = static_cast<uint32_t>(regions.size()),
+                .pRegions    = regions.data()
+            };
+            _api.vkCmdCopyBuffer2(cmd, &copy_info);
+
+            first = last;
+        }
+
+        for (const ImageCopy& copy : _image_copies) {
+            VkCopyBufferToImageInfo2 copy_info = {
+                .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_TO_IMAGE_INFO_2,
+                .pNext = nullptr,
+                .srcBuffer      = _staging.buffer,
+                .dstImage       = copy.upload.image,
+                .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .regionCount    = 1,
+                .pRegions       = &copy.region
+            };
+            _api.vkCmdCopyBufferToImage2(cmd, &copy_info);
+        }
+
+        // Release barriers, the acquire halves are queued for the consumer
+        image_barriers.clear();
+
+        if (transfer_ownership) {
+            buffer_barriers.reserve(_buffer_copies.size());
+            for (const BufferCopy& copy : _buffer_copies) {
+                VkBufferMemoryBarrier2 barrier = {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                    .pNext = nullptr,
+                    .srcStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+                    .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    .dstStageMask  = VK_PIPELINE_STAGE_2_NONE,
+                    .dstAccessMask = VK_ACCESS_2_NONE,
+                    .srcQueueFamilyIndex = src_family,
+                    .dstQueueFamilyIndex = dst_family,
+                    .buffer = copy.buffer,
+                    .offset = copy.region.dstOffset,
+                    .size   = copy.region.size
+                };
+                buffer_barriers.push_back(barrier);
+
+                barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+                barrier.srcAccessMask = VK_ACCESS_2_NONE;
+                barrier.dstStageMask  = copy.consumer_stages;
+                barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+                _buffer_acquires.push_back(barrier);
+            }
+        }
+
+        for (const ImageCopy& copy : _image_copies) {
+            VkImageMemoryBarrier2 barrier = {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT,
+                .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dstStageMask  = VK_PIPELINE_STAGE_2_NONE,
+                .dstAccessMask = VK_ACCESS_2_NONE,
+                .oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout     = copy.upload.final_layout,
+                .srcQueueFamilyIndex = src_family,
+                .dstQueueFamilyIndex = dst_family,
+                .image            = copy.upload.image,
+                .subresourceRange = subresource_range(copy.upload.subresource)
+            };
+            image_barriers.push_back(barrier);
+
+            if (transfer_ownership) {
+                barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+                barrier.srcAccessMask = VK_ACCESS_2_NONE;
+                barrier.dstStageMask  = copy.upload.consumer_stages;
+                barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+                _image_acquires.push_back(barrier);
+            }
+        }
+
+        if (!buffer_barriers.empty() || !image_barriers.empty()) {
+            const VkDependencyInfo info = dependency();
+            _api.vkCmdPipelineBarrier2(cmd, &info);
+        }
+    }
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace vulkron::gpu::vulkan {
+
+    class Device;
+
+    /**
+     * @brief Completion token of an upload, compared against the engine's timeline semaphore
+     */
+    struct UploadTicket {
+        uint64_t value = 0;
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool {
+            return value != 0;
+        }
+    };
+
+    /**
+     * @brief Copy of tightly packed texels into one subresource of an image
+     *
+     * The image is transitioned from UNDEFINED, so the previous contents of
+     * the region's subresource are discarded.
+     */
+    struct ImageUpload {
+        VkImage                  image;
+        VkImageSubresourceLayers subresource;
+        VkOffset3D               offset          = {0, 0, 0};
+        VkExtent3D               extent;
+        VkImageLayout            final_layout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkPipelineStageFlags2    consumer_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    };
+
+    /**
+     * @brief Streams data to the GPU on a dedicated transfer queue
+     *
+     * Data is copied into a persistently mapped staging ring right away and
+     * the GPU copies are batched into a single vkQueueSubmit2 per tick(),
+     * which signals the engine's timeline semaphore. Ring space is reclaimed
+     * as the semaphore advances; the CPU only blocks when the ring is full.
+     *
+     * When the consumer lives on another queue family, each submission ends
+     * with queue family release barriers. The matching acquire barriers are
+     * recorded into the consumer's command buffer by acquire(), whose ticket
+     * that submission has to wait on.
+     *
+     * @code
+     * const QueueSet& queues = device.queues();
+     * UploadEngine uploads(device, {.queue = queues.transfer.handle, .queue_family = queues.transfer.family, .consumer_family = queues.graphics.family});
+     *
+     * auto ticket = uploads.upload_buffer(vertices, 0, std::as_bytes(std::span(mesh.vertices)));
+     * uploads.tick();
+     *
+     * // Render thread, while recording the frame
+     * auto acquired = uploads.acquire(cmd);
+     * // ... submit cmd waiting on uploads.semaphore() at acquired.value
+     * @endcode
+     */
+    class UploadEngine {
+      public:
+        struct Config {
+            VkQueue      queue;
+            uint32_t     queue_family;
+            uint32_t     consumer_family;
+            VkDeviceSize staging_size = VkDeviceSize{64} << 20;
+        };
+
+        struct Stats {
+            uint64_t     submissions    = 0;
+            uint64_t     buffer_copies  = 0;
+            uint64_t     image_copies   = 0;
+            uint64_t     bytes_uploaded = 0;
+            uint64_t     ring_stalls    = 0; // times an upload waited for ring space
+            VkDeviceSize ring_in_use    = 0;
+        };
+
+      private:
+        // Command pool of one submission, reused once its timeline value is reached
+        struct Frame {
+            VkCommandPool   pool  = VK_NULL_HANDLE;
+            VkCommandBuffer cmd   = VK_NULL_HANDLE;
+            uint64_t        value = 0;
+        };
+
+        struct InFlight {
+            uint64_t value;
+            uint64_t ring_end;
+        };
+
+        struct BufferCopy {
+            VkBuffer              buffer;
+            VkBufferCopy2         region;
+            VkPipelineStageFlags2 consumer_stages;
+        };
+
+        struct ImageCopy {
+            ImageUpload        upload;
+            VkBufferImageCopy2 region;
+        };
+
+        const DispatchTable& _api;
+        VkDevice             _device;
+        MemoryAllocator&     _allocator;
+        Config               _config;
+        VkDeviceSize         _alignment;
+
+        AllocatedBuffer _staging;
+        std::byte*      _mapped;
+
+        // Monotonic byte counters, the ring offset is counter % staging_size
+        uint64_t _head = 0;
+        uint64_t _tail = 0;
+
+        VkSemaphore _timeline  = VK_NULL_HANDLE;
+        uint64_t    _submitted = 0; // last value handed to vkQueueSubmit2
+
+        std::vector<Frame>   _frames;
+        std::deque<InFlight> _in_flight;
+
+        std::vector<BufferCopy> _buffer_copies;
+        std::vector<ImageCopy>  _image_copies;
+
+        // Acquire halves of ownership transfers already submitted on the transfer queue
+        std::vector<VkBufferMemoryBarrier2> _buffer_acquires;
+        std::vector<VkImageMemoryBarrier2>  _image_acquires;
+        uint64_t                            _acquire_value = 0;
+
+        Stats _stats;
+
+        mutable std::mutex _mutex;
+
+      public:
+        UploadEngine(Device& device, const Config& config);
+        ~UploadEngine();
+
+        UploadEngine(const UploadEngine&) = delete;
+        auto operator=(const UploadEngine&) -> UploadEngine& = delete;
+
+        UploadEngine(UploadEngine&&) = delete;
+        auto operator=(UploadEngine&&) -> UploadEngine& = delete;
+
+        // Both copy `data` into the staging ring before returning, the span may be reused right away
+        [[nodiscard]] auto upload_buffer(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data,
+                                         VkPipelineStageFlags2 consumer_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) -> UploadTicket;
+        [[nodiscard]] auto upload_image(const ImageUpload& upload, std::span<const std::byte> data) -> UploadTicket;
+
+        // Submits everything queued since the last tick, no-op when nothing is pending
+        auto tick() -> void;
+
+        [[nodiscard]] auto is_complete(UploadTicket ticket) const -> bool;
+        auto wait(UploadTicket ticket, uint64_t timeout = UINT64_MAX) -> bool;
+
+        // Records pending acquire barriers, the returned ticket is what `cmd`'s submission must wait on
+        [[nodiscard]] auto acquire(VkCommandBuffer cmd) -> UploadTicket;
+
+        [[nodiscard]] auto semaphore() const noexcept -> VkSemaphore;
+        [[nodiscard]] auto stats() const -> Stats;
+
+      private:
+        [[nodiscard]] auto completed_value() const -> uint64_t;
+        auto wait_value(uint64_t value, uint64_t timeout) const -> bool;
+
+        [[nodiscard]] auto reserve(VkDeviceSize size) -> VkDeviceSize;
+        auto retire(bool block) -> bool;
+        auto submit_locked() -> void;
+        [[nodiscard]] auto next_frame() -> Frame&;
+        auto record(VkCommandBuffer cmd) -> void;
+    };
+
+} // namespace vulkron::gpu::vulkan
@@ -0,0 +1,331 @@
+#include "support/jobs/job_system.hpp"
+#include "support/common/config.hpp"
+#include "support/profiler/profiler.hpp"
+#include "work_stealing_deque.hpp"
+
+#include <bit>
+#include <utility>
+
+#if defined(VULKRON_PLATFORM_WINDOWS)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace vulkron::support {
+
+    namespace detail {
+
+        struct Job {
+            JobSystem::Function        function;
+            JobCounter*                counter;
+            std::pmr::memory_resource* memory; // where the job was allocated
+        };
+
+        auto destroy_job(Job* job) -> void {
+            std::pmr::polymorphic_allocator<Job>(job->memory).delete_object(job);
+        }
+
+    } // namespace detail
+
+    struct JobSystem::Worker {
+        WorkStealingDeque<detail::Job> deque;
+        uint64_t                       random; // xorshift state for picking victims
+
+        Worker(size_t capacity, uint64_t seed)
+            : deque(capacity),
+            random(seed)
+        {
+        }
+    };
+
+    namespace {
+
+        // Spins through the queues this many times before a worker goes to sleep
+        constexpr uint32_t IDLE_ROUNDS = 64;
+
+        thread_local const JobSystem* t_system = nullptr;
+        thread_local uint32_t         t_worker = JobSystem::NOT_A_WORKER;
+
+        auto next_random(uint64_t& state) noexcept -> uint64_t {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        auto pin_to_core(std::jthread& thread, uint32_t core) -> void {
+#if defined(VULKRON_PLATFORM_WINDOWS)
+            if (core < 64) {
+                SetThreadAffinityMask(thread.native_handle(), DWORD_PTR{1} << core);
+            }
+#else
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+        }
+
+    } // namespace
+
+    JobCounter::~JobCounter() {
+        // Continuations that never became ready are dropped with their counter
+        for (detail::Job* job : _continuations) {
+            detail::destroy_job(job);
+        }
+    }
+
+    JobSystem::JobSystem()
+        : JobSystem(Config{})
+    {
+    }
+
+    JobSystem::JobSystem(const Config& config) {
+        const uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+        _worker_count = config.threads != AUTO_THREADS ? config.threads : std::max(cores, 2u) - 1;
+
+        const size_t capacity = std::bit_ceil(std::max<size_t>(config.deque_capacity, 2));
+        _workers.reserve(_worker_count);
+        for (uint32_t i = 0; i < _worker_count; ++i) {
+            _workers.push_back(std::make_unique<Worker>(capacity, 0x9E3779B97F4A7C15ull * (i + 1)));
+        }
+
+        _threads.reserve(_worker_count);
+        for (uint32_t i = 0; i < _worker_count; ++i) {
+            _threads.emplace_back([this, i](std::stop_token stop) { work(stop, i); });
+
+            // Core 0 is left to the thread that owns the system
+            if (config.pin_threads && _worker_count < cores) {
+                pin_to_core(_threads.back(), i + 1);
+            }
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        for (std::jthread& thread : _threads) {
+            thread.request_stop();
+        }
+        {
+            std::lock_guard lock(_sleep_mutex);
+            _wake.notify_all();
+        }
+        _threads.clear();
+
+        // Jobs nobody waited for are dropped unrun
+        for (uint32_t i = 0; i < _worker_count; ++i) {
+            while (detail::Job* job = _workers[i]->deque.pop()) {
+                detail::destroy_job(job);
+            }
+        }
+        for (size_t i = _injection_head; i < _injection.size(); ++i) {
+            detail::destroy_job(_injection[i]);
+        }
+    }
+
+    auto JobSystem::run(Function function, JobCounter* counter) -> void {
+        if (counter != nullptr) {
+            counter->_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        schedule(make_job(std::move(function), counter));
+    }
+
+    auto JobSystem::run_after(JobCounter& dependency, Function function, JobCounter* counter) -> void {
+        if (counter != nullptr) {
+            counter->_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        detail::Job* job = make_job(std::move(function), counter);
+
+        {
+            // The last job of `dependency` takes its continuations under this lock
+            std::lock_guard lock(dependency._mutex);
+            if (dependency._pending.load(std::memory_order_acquire) != 0) {
+                dependency._continuations.push_back(job);
+                return;
+            }
+        }
+        schedule(job);
+    }
+
+    auto JobSystem::wait(JobCounter& counter) -> void {
+        const uint32_t self = worker_index();
+
+        while (!counter.done()) {
+            if (detail::Job* job = find_job(self)) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        // Lets the job that brought the count to zero leave finish() before the counter may go away
+        std::lock_guard lock(counter._mutex);
+    }
+
+    auto JobSystem::thread_count() const noexcept -> uint32_t {
+        return _worker_count;
+    }
+
+    auto JobSystem::worker_index() const noexcept -> uint32_t {
+        return t_system == this ? t_worker : NOT_A_WORKER;
+    }
+
+    auto JobSystem::stats() const noexcept -> Stats {
+        return Stats{
+            .executed = _executed.load(std::memory_order_relaxed),
+            .stolen   = _stolen.load(std::memory_order_relaxed),
+            .injected = _injected_total.load(std::memory_order_relaxed),
+            .inlined  = _inlined.load(std::memory_order_relaxed)
+        };
+    }
+
+    auto JobSystem::make_job(Function function, JobCounter* counter) -> detail::Job* {
+        return std::pmr::polymorphic_allocator<detail::Job>(&_job_memory).new_object<detail::Job>(std::move(function), counter, &_job_memory);
+    }
+
+    auto JobSystem::work(std::stop_token stop, uint32_t index) -> void {
+        t_system = this;
+        t_worker = index;
+        VULKRON_PROFILE_THREAD_NAME("job worker");
+
+        uint32_t idle = 0;
+        while (!stop.stop_requested()) {
+            const uint64_t epoch = _epoch.load(std::memory_order_seq_cst);
+
+            if (detail::Job* job = find_job(index)) {
+                execute(job);
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < IDLE_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            idle = 0;
+
+            // A job scheduled after `epoch` was read either moved it or saw us sleeping
+            std::unique_lock lock(_sleep_mutex);
+            _sleepers.fetch_add(1, std::memory_order_seq_cst);
+            _wake.wait(lock, stop, [&] { return _epoch.load(std::memory_order_seq_cst) != epoch; });
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    auto JobSystem::schedule(detail::Job* job) -> void {
+        const uint32_t self = worker_index();
+
+        if (self != NOT_A_WORKER) {
+            if (!_workers[self]->deque.push(job)) {
+                _inlined.fetch_add(1, std::memory_order_relaxed);
+                execute(job);
+                return;
+            }
+        } else {
+            std::lock_guard lock(_injection_mutex);
+            _injection.push_back(job);
+            _injected.fetch_add(1, std::memory_order_release);
+            _injected_total.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        wake();
+    }
+
+    auto JobSystem::find_job(uint32_t self) -> detail::Job* {
+        if (self != NOT_A_WORKER) {
+            if (detail::Job* job = _workers[self]->deque.pop()) {
+                return job;
+            }
+        }
+
+        if (_injected.load(std::memory_order_acquire) != 0) {
+            std::lock_guard lock(_injection_mutex);
+            if (_injection_head < _injection.size()) {
+                detail::Job* job = _injection[_injection_head++];
+                if (_injection_head == _injection.size()) {
+                    _injection.clear();
+                    _injection_head = 0;
+                }
+                else if (_injection_head * 2 >= _injection.size()) {
+                    // Drop the consumed half so a queue that never fully drains stops growing
+                    _injection.erase(_injection.begin(), _injection.begin() + static_cast<ptrdiff_t>(_injection_head));
+                    _injection_head = 0;
+                }
+                _injected.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        if (_worker_count == 0) {
+            return nullptr;
+        }
+
+        // Threads outside the pool have no state of their own, they scan from a moving start
+        static thread_local uint64_t t_random = 0x2545F4914F6CDD1Dull ^ reinterpret_cast<uintptr_t>(&t_random);
+        uint64_t& random = self != NOT_A_WORKER ? _workers[self]->random : t_random;
+
+        const uint32_t start = static_cast<uint32_t>(next_random(random) % _worker_count);
+        for (uint32_t i = 0; i < _worker_count; ++i) {
+            const uint32_t victim = (start + i) % _worker_count;
+            if (victim == self) {
+                continue;
+            }
+            if (detail::Job* job = _workers[victim]->deque.steal()) {
+                _stolen.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    auto JobSystem::execute(detail::Job* job) -> void {
+        // Jobs must not throw, their counter would never reach zero
+        job->function();
+        _executed.fetch_add(1, std::memory_order_relaxed);
+
+        JobCounter* counter = job->counter;
+        detail::destroy_job(job);
+
+        if (counter != nullptr) {
+            finish(*counter);
+        }
+    }
+
+    auto JobSystem::finish(JobCounter& counter) -> void {
+        uint32_t pending = counter._pending.load(std::memory_order_relaxed);
+        while (pending > 1) {
+            if (counter._pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+
+        // Possibly the last one, reach zero under the lock so waiters and run_after() see it consistently
+        std::vector<detail::Job*> ready;
+        {
+            std::lock_guard lock(counter._mutex);
+            if (counter._pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ready.swap(counter._continuations);
+            }
+        }
+
+        for (detail::Job* job : ready) {
+            schedule(job);
+        }
+    }
+
+    auto JobSystem::wake() -> void {
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (_sleepers.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+
+        std::lock_guard lock(_sleep_mutex);
+        _wake.notify_one();
+    }
+
+} // namespace vulkron::support
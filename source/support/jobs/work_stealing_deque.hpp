@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace vulkron::support {
+
+    /**
+     * @brief Bounded Chase-Lev deque of pointers
+     *
+     * The owning thread pushes and pops at the bottom without contention,
+     * any other thread steals from the top with a single CAS. Memory orders
+     * follow Lê et al., "Correct and Efficient Work-Stealing for Weak Memory
+     * Models" (2013). The buffer never grows, push() reports a full deque
+     * and lets the caller run the item itself.
+     */
+    template <class T>
+    class WorkStealingDeque {
+        static constexpr size_t CACHE_LINE = 64;
+
+        alignas(CACHE_LINE) std::atomic<int64_t> _top    = 0;
+        alignas(CACHE_LINE) std::atomic<int64_t> _bottom = 0;
+        alignas(CACHE_LINE) std::unique_ptr<std::atomic<T*>[]> _buffer;
+        int64_t _mask;
+
+      public:
+        // `capacity` must be a power of two
+        explicit WorkStealingDeque(size_t capacity)
+            : _buffer(std::make_unique<std::atomic<T*>[]>(capacity)),
+            _mask(static_cast<int64_t>(capacity) - 1)
+        {
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        auto operator=(const WorkStealingDeque&) -> WorkStealingDeque& = delete;
+
+        // Owner only
+        [[nodiscard]] auto push(T* item) noexcept -> bool {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+            const int64_t top    = _top.load(std::memory_order_acquire);
+            if (bottom - top > _mask) {
+                return false;
+            }
+
+            _buffer[bottom & _mask].store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Owner only, newest first
+        [[nodiscard]] auto pop() noexcept -> T* {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+            _bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = _top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+            if (top == bottom) {
+                // Last item, race the thieves for it
+                if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread, oldest first; nullptr when empty or another thief won
+        [[nodiscard]] auto steal() noexcept -> T* {
+            int64_t top = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) {
+                return nullptr;
+            }
+
+            T* item = _buffer[top & _mask].load(std::memory_order_relaxed);
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            return item;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool {
+            return _top.load(std::memory_order_relaxed) >= _bottom.load(std::memory_order_relaxed);
+        }
+    };
+
+} // namespace vulkron::support
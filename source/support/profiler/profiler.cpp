@@ -0,0 +1,210 @@
+#include "support/profiler/profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vulkron::support::profiler {
+
+    namespace {
+
+        struct Registry {
+            std::mutex                                       mutex;
+            std::vector<std::unique_ptr<detail::ThreadRing>> rings;
+            std::vector<detail::ThreadRing*>                 free_rings; // of exited threads
+
+            // First point of the tick to wall-clock calibration, see `calibrated` below
+            uint64_t                              base_ticks = now();
+            std::chrono::steady_clock::time_point base_time  = std::chrono::steady_clock::now();
+        };
+
+        // Never destroyed, threads may still record while statics are torn down
+        auto registry() -> Registry& {
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        // Builds the registry during static initialization rather than on the first event, which
+        // comes after its zone took its begin tick. Zones opened by other static initializers
+        // before this one ran may still predate the calibration, timestamp() clamps them to 0.
+        [[maybe_unused]] const Registry& calibrated = registry();
+
+        // Hands the thread's ring back on exit, so short-lived threads such as the compilers'
+        // don't each leave one behind
+        struct RingOwner {
+            detail::ThreadRing* ring = nullptr;
+
+            ~RingOwner() {
+                if (ring == nullptr) {
+                    return;
+                }
+                detail::t_ring = nullptr;
+
+                Registry& state = registry();
+                std::lock_guard lock(state.mutex);
+                state.free_rings.push_back(ring);
+            }
+        };
+
+        thread_local RingOwner t_owner;
+
+        auto write_escaped(std::ofstream& out, const char* text) -> void {
+            for (const char* c = text; *c != '\0'; ++c) {
+                switch (*c) {
+                    case '"':
+                        out << "\\\"";
+                        break;
+                    case '\\':
+                        out << "\\\\";
+                        break;
+                    case '\n':
+                        out << "\\n";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(*c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+                            out << escaped;
+                        } else {
+                            out << *c;
+                        }
+                }
+            }
+        }
+
+        // Events still in the ring, oldest first; anything overwritten during the copy is dropped
+        auto snapshot(const detail::ThreadRing& ring, std::vector<Event>& events) -> void {
+            const uint64_t head  = ring.head.load(std::memory_order_acquire);
+            const uint64_t first = head > detail::RING_CAPACITY ? head - detail::RING_CAPACITY : 0;
+
+            events.clear();
+            events.reserve(head - first);
+            for (uint64_t i = first; i < head; ++i) {
+                const detail::Slot& slot      = ring.slots[i & detail::RING_MASK];
+                const uint64_t      published = 2 * i + 2;
+
+                // Already overwritten by a later event, or being overwritten
+                if (slot.sequence.load(std::memory_order_acquire) != published) {
+                    continue;
+                }
+
+                const Event event = {
+                    slot.name.load(std::memory_order_relaxed),
+                    slot.begin.load(std::memory_order_relaxed),
+                    slot.end.load(std::memory_order_relaxed)
+                };
+
+                // Orders the copy before the second read of the sequence, pairs with the fence in record()
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == published) {
+                    events.push_back(event);
+                }
+            }
+        }
+
+    } // namespace
+
+    auto detail::register_thread() -> ThreadRing* {
+        Registry& state = registry();
+
+        ThreadRing*      ring = nullptr;
+        std::unique_lock lock(state.mutex);
+        if (!state.free_rings.empty()) {
+            // The previous owner's events go, they would be shown under this thread's name
+            ring = state.free_rings.back();
+            state.free_rings.pop_back();
+            ring->head.store(0, std::memory_order_relaxed);
+        } else {
+            lock.unlock();
+            auto created = std::make_unique<ThreadRing>();
+            lock.lock();
+
+            created->thread_index = static_cast<uint32_t>(state.rings.size());
+            state.rings.push_back(std::move(created));
+            ring = state.rings.back().get();
+        }
+        std::snprintf(ring->thread_name, sizeof(ring->thread_name), "thread %u", ring->thread_index);
+
+        t_owner.ring = ring;
+        return ring;
+    }
+
+    auto set_thread_name(const char* name) -> void {
+        detail::ThreadRing* ring = detail::ring();
+
+        std::lock_guard lock(registry().mutex);
+        std::snprintf(ring->thread_name, sizeof(ring->thread_name), "%s", name);
+    }
+
+    auto export_chrome_trace(const std::filesystem::path& path) -> bool {
+        Registry& state = registry();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        // Second calibration point, ticks are assumed to run at a constant rate in between
+        const uint64_t ticks = now();
+        const double   elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - state.base_time).count();
+        const double   us_per_tick = ticks > state.base_ticks ? elapsed_us / static_cast<double>(ticks - state.base_ticks) : 0.0;
+
+        const auto timestamp = [&](uint64_t tick) {
+            return tick > state.base_ticks ? static_cast<double>(tick - state.base_ticks) * us_per_tick : 0.0;
+        };
+
+        std::lock_guard lock(state.mutex);
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out.setf(std::ios::fixed);
+        out.precision(3);
+
+        bool               first = true;
+        std::vector<Event> events;
+
+        const auto separator = [&]() {
+            if (!first) {
+                out << ",\n";
+            }
+            first = false;
+        };
+
+        for (const std::unique_ptr<detail::ThreadRing>& ring : state.rings) {
+            separator();
+            out << R"({"ph":"M","name":"thread_name","pid":1,"tid":)" << ring->thread_index << R"(,"args":{"name":")";
+            write_escaped(out, ring->thread_name);
+            out << "\"}}";
+
+            snapshot(*ring, events);
+            for (const Event& event : events) {
+                separator();
+                out << "{\"name\":\"";
+                write_escaped(out, event.name);
+                if (event.end == 0) {
+                    out << R"(","ph":"i","s":"g","ts":)" << timestamp(event.begin);
+                } else {
+                    out << R"(","ph":"X","ts":)" << timestamp(event.begin)
+                        << ",\"dur\":" << static_cast<double>(event.end - event.begin) * us_per_tick;
+                }
+                out << ",\"pid\":1,\"tid\":" << ring->thread_index << "}";
+            }
+        }
+
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+    auto clear() -> void {
+        Registry& state = registry();
+
+        std::lock_guard lock(state.mutex);
+        for (const std::unique_ptr<detail::ThreadRing>& ring : state.rings) {
+            ring->head.store(0, std::memory_order_release);
+        }
+    }
+
+} // namespace vulkron::support::profiler
@@ -1,4 +1,5 @@
 #include "ui/window.hpp"
+#include "support/profiler/profiler.hpp"
 
 #if _WIN32
 #include "win32.hpp"
@@ -50,6 +51,7 @@ namespace vulkron::ui {
 
     auto Window::poll_events() -> void
     {
+        VULKRON_PROFILE_ZONE("Window::poll_events");
         impl()->_platform.poll_events();
     }
 
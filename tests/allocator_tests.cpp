@@ -0,0 +1,157 @@
+#include "allocator.hpp"
+#include "gpu_device.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using namespace vulkron;
+    using gpu::vulkan::Allocation;
+    using gpu::vulkan::MemoryAllocator;
+    using gpu::vulkan::MemoryUsage;
+    using gpu::vulkan::ResourceTiling;
+
+    constexpr VkDeviceSize BLOCK_SIZE = VkDeviceSize{1} << 20;
+
+    // Small blocks so the stress test grows, empties and refills pools many times
+    auto small_block_allocator(const gpu::vulkan::Device& device) -> MemoryAllocator {
+        return MemoryAllocator(device.dispatch(), *device.instance()->adapter(device.physical_device_handle()), device.device_handle(), {.block_size = BLOCK_SIZE});
+    }
+
+    auto any_memory_type(const MemoryAllocator& allocator) -> uint32_t {
+        return (1u << allocator.memory_properties().memoryTypeCount) - 1;
+    }
+
+    // Live ranges sharing a VkDeviceMemory must not overlap
+    auto check_disjoint(std::vector<Allocation> allocations) -> void {
+        std::ranges::sort(allocations, [](const Allocation& a, const Allocation& b) {
+            return a.memory != b.memory ? a.memory < b.memory : a.offset < b.offset;
+        });
+
+        for (size_t i = 1; i < allocations.size(); ++i) {
+            const Allocation& previous = allocations[i - 1];
+            const Allocation& current  = allocations[i];
+            CHECK(previous.memory != current.memory || previous.offset + previous.size <= current.offset);
+        }
+    }
+
+} // namespace
+
+VULKRON_TEST(allocator_gpu, random_allocate_free) {
+    constexpr uint32_t OPERATIONS = 20'000;
+    constexpr uint32_t MAX_LIVE   = 512;
+
+    gpu::vulkan::Device device    = tests::test_device();
+    MemoryAllocator     allocator = small_block_allocator(device);
+
+    std::mt19937                            random(42);
+    std::uniform_int_distribution<uint32_t> size_shift(8, 16);  // 256 B to 64 KiB
+    std::uniform_int_distribution<uint32_t> alignment_shift(4, 12);
+    std::vector<Allocation>                 live;
+    double                                  worst_fragmentation = 0.0;
+
+    for (uint32_t i = 0; i < OPERATIONS; ++i) {
+        // Biased towards allocating until the live set is full, then churns around it
+        const bool allocate = live.empty() || (live.size() < MAX_LIVE && random() % 3 != 0);
+
+        if (allocate) {
+            const VkMemoryRequirements requirements = {
+                .size           = (VkDeviceSize{1} << size_shift(random)) + random() % 256,
+                .alignment      = VkDeviceSize{1} << alignment_shift(random),
+                .memoryTypeBits = any_memory_type(allocator)
+            };
+
+            const Allocation allocation = allocator.allocate(requirements, MemoryUsage::GpuOnly, ResourceTiling::Linear);
+            CHECK(allocation.valid());
+            CHECK(allocation.size >= requirements.size);
+            CHECK(allocation.offset % requirements.alignment == 0);
+            live.push_back(allocation);
+        }
+        else {
+            const size_t victim = random() % live.size();
+            allocator.free(live[victim]);
+            CHECK(!live[victim].valid());
+            live[victim] = live.back();
+            live.pop_back();
+        }
+
+        if (i % 1000 == 0) {
+            check_disjoint(live);
+            for (const MemoryAllocator::PoolStats& pool : allocator.stats().pools) {
+                worst_fragmentation = std::max(worst_fragmentation, pool.fragmentation);
+            }
+        }
+    }
+
+    const MemoryAllocator::Stats loaded = allocator.stats();
+    CHECK(loaded.pools.size() == 1);
+    CHECK(loaded.pools[0].allocation_count == live.size());
+    std::printf("  %zu live, %u blocks, %.1f%% used, fragmentation %.3f (worst %.3f), %llu vkAllocateMemory calls\n",
+                live.size(),
+                loaded.pools[0].block_count,
+                100.0 * static_cast<double>(loaded.pools[0].used_bytes) / static_cast<double>(loaded.pools[0].block_bytes),
+                loaded.pools[0].fragmentation,
+                worst_fragmentation,
+                static_cast<unsigned long long>(loaded.device_allocations));
+
+    for (Allocation& allocation : live) {
+        allocator.free(allocation);
+    }
+
+    // Everything coalesced back, one empty block is kept to absorb the next burst
+    const MemoryAllocator::Stats drained = allocator.stats();
+    CHECK(drained.pools[0].allocation_count == 0);
+    CHECK(drained.pools[0].used_bytes == 0);
+    CHECK(drained.pools[0].block_count <= 1);
+    CHECK(drained.pools[0].fragmentation == 0.0);
+}
+
+// Requests just under the dedicated threshold with a large alignment are where the
+// rounded-up class search needs more than size + alignment from a new block
+VULKRON_TEST(allocator_gpu, grows_for_rounded_requests) {
+    gpu::vulkan::Device device    = tests::test_device();
+    MemoryAllocator     allocator = small_block_allocator(device);
+
+    const VkMemoryRequirements requirements = {
+        .size           = BLOCK_SIZE / 2 - 1,
+        .alignment      = 4096,
+        .memoryTypeBits = any_memory_type(allocator)
+    };
+
+    std::vector<Allocation> allocations;
+    for (uint32_t i = 0; i < 8; ++i) {
+        allocations.push_back(allocator.allocate(requirements, MemoryUsage::GpuOnly, ResourceTiling::Optimal));
+        CHECK(allocations.back().valid());
+        CHECK(allocations.back().offset % requirements.alignment == 0);
+    }
+    check_disjoint(allocations);
+    CHECK(allocator.stats().dedicated_count == 0);
+
+    for (Allocation& allocation : allocations) {
+        allocator.free(allocation);
+    }
+}
+
+VULKRON_TEST(allocator_gpu, large_requests_are_dedicated) {
+    gpu::vulkan::Device device    = tests::test_device();
+    MemoryAllocator     allocator = small_block_allocator(device);
+
+    const VkMemoryRequirements requirements = {
+        .size           = BLOCK_SIZE,
+        .alignment      = 256,
+        .memoryTypeBits = any_memory_type(allocator)
+    };
+
+    Allocation allocation = allocator.allocate(requirements, MemoryUsage::GpuOnly, ResourceTiling::Linear);
+    CHECK(allocation.valid());
+    CHECK(allocation.offset == 0);
+    CHECK(allocator.stats().dedicated_count == 1);
+
+    allocator.free(allocation);
+    CHECK(allocator.stats().dedicated_count == 0);
+}
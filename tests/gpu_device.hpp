@@ -0,0 +1,51 @@
+#pragma once
+
+#include "device.hpp"
+#include "test.hpp"
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace vulkron::tests {
+
+    // Instance to share between Devices, skips the calling test when there is no Vulkan loader
+    [[nodiscard]] inline auto test_instance() -> std::shared_ptr<const gpu::vulkan::Instance> {
+        try {
+            return std::make_shared<const gpu::vulkan::Instance>();
+        }
+        catch (const std::exception& error) {
+            skip(std::string("no Vulkan instance: ") + error.what());
+        }
+    }
+
+    /**
+     * @brief Device on the first adapter the loader offers, lavapipe under ctest
+     *
+     * Skips the calling test when there is no Vulkan loader or no adapter
+     * meeting `setup`'s requirements. Caches are disabled so every test
+     * starts cold.
+     */
+    [[nodiscard]] inline auto test_device(const std::function<void(gpu::vulkan::Device&)>& setup = {}) -> gpu::vulkan::Device {
+        std::optional<gpu::vulkan::Device> device;
+
+        try {
+            device.emplace();
+            device->set_cache_directory({});
+            if (setup) {
+                setup(*device);
+            }
+            device->select_gpu(gpu::vulkan::Device::GpuUsage::Graphics);
+        }
+        catch (const std::exception& error) {
+            skip(std::string("no usable Vulkan device: ") + error.what());
+        }
+
+        device->create_device();
+        return std::move(*device);
+    }
+
+} // namespace vulkron::tests
@@ -0,0 +1,97 @@
+#include "device.hpp"
+#include "gpu_device.hpp"
+#include "gpu_probe.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace {
+
+    using namespace vulkron;
+    using gpu::vulkan::Device;
+
+    // Removed again when the test ends, failed or not
+    class TemporaryDirectory {
+        std::filesystem::path _path;
+
+      public:
+        TemporaryDirectory()
+            : _path(std::filesystem::temp_directory_path() / ("vulkron-tests-" + std::to_string(std::random_device{}())))
+        {
+            std::filesystem::create_directories(_path);
+        }
+
+        ~TemporaryDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(_path, error);
+        }
+
+        TemporaryDirectory(const TemporaryDirectory&) = delete;
+        auto operator=(const TemporaryDirectory&) -> TemporaryDirectory& = delete;
+
+        [[nodiscard]] auto path() const noexcept -> const std::filesystem::path& {
+            return _path;
+        }
+    };
+
+} // namespace
+
+VULKRON_TEST(gpu_selection, probe_shader_is_spirv) {
+    const std::vector<uint32_t> spirv = gpu::vulkan::probe_shader(64);
+
+    CHECK(spirv.size() > 5);
+    CHECK(spirv[0] == 0x07230203);
+    CHECK(gpu::vulkan::probe_shader(64) == spirv);
+    CHECK(gpu::vulkan::probe_shader(128) != spirv);
+}
+
+// Every adapter is probed, on lavapipe too, and the best score is selected
+VULKRON_TEST(gpu_selection_gpu, benchmark_probes_every_adapter) {
+    Device device(tests::test_instance());
+    device.set_cache_directory({});
+    device.select_gpu(Device::GpuUsage::Compute, Device::GpuSelection::Benchmark);
+
+    const std::vector<Device::GpuReport>& report = device.gpu_report();
+    CHECK(!report.empty());
+
+    for (const Device::GpuReport& gpu : report) {
+        CHECK(gpu.probed);
+        CHECK(!gpu.cached);
+        CHECK(gpu.probe.bandwidth_gbps > 0.0);
+        CHECK(gpu.probe.compute_gflops > 0.0);
+        CHECK(gpu.probe.transfer_gbps > 0.0);
+    }
+
+    const auto best = std::ranges::max_element(report, {}, &Device::GpuReport::score);
+    CHECK(device.physical_device_handle() == best->gpu);
+}
+
+// A second selection over the same adapters and drivers reads the winner back instead of probing
+VULKRON_TEST(gpu_selection_gpu, benchmark_result_is_cached) {
+    const auto         instance = tests::test_instance();
+    TemporaryDirectory cache;
+
+    Device first(instance);
+    first.set_cache_directory(cache.path());
+    first.select_gpu(Device::GpuUsage::Compute, Device::GpuSelection::Benchmark);
+    CHECK(std::filesystem::exists(cache.path() / "gpu_selection.txt"));
+
+    Device second(instance);
+    second.set_cache_directory(cache.path());
+    second.select_gpu(Device::GpuUsage::Compute, Device::GpuSelection::Benchmark);
+
+    CHECK(second.physical_device_handle() == first.physical_device_handle());
+    for (const Device::GpuReport& gpu : second.gpu_report()) {
+        CHECK(gpu.cached);
+        CHECK(!gpu.probed);
+    }
+
+    // Another usage is keyed separately and probes again
+    Device graphics(instance);
+    graphics.set_cache_directory(cache.path());
+    graphics.select_gpu(Device::GpuUsage::Graphics, Device::GpuSelection::Benchmark);
+    CHECK(std::ranges::none_of(graphics.gpu_report(), &Device::GpuReport::cached));
+}
@@ -0,0 +1,73 @@
+#include "test.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <string_view>
+
+namespace vulkron::tests {
+
+    auto registry() -> std::vector<Test>& {
+        static std::vector<Test> tests;
+        return tests;
+    }
+
+} // namespace vulkron::tests
+
+namespace {
+
+    // ctest's SKIP_RETURN_CODE, every selected test skipped
+    constexpr int EXIT_SKIPPED = 77;
+    constexpr int EXIT_USAGE   = 2;
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int {
+    using namespace vulkron::tests;
+
+    if (argc > 2) {
+        std::fputs("usage: vulkron-tests [suite]\n", stderr);
+        return EXIT_USAGE;
+    }
+
+    const std::string_view suite = argc == 2 ? argv[1] : "";
+
+    uint32_t passed  = 0;
+    uint32_t failed  = 0;
+    uint32_t skipped = 0;
+
+    for (const Test& test : registry()) {
+        if (!suite.empty() && test.suite != suite) {
+            continue;
+        }
+
+        try {
+            test.run();
+            ++passed;
+            std::printf("[ pass ] %.*s.%.*s\n", static_cast<int>(test.suite.size()), test.suite.data(), static_cast<int>(test.name.size()), test.name.data());
+        }
+        catch (const Skipped& skip) {
+            ++skipped;
+            std::printf("[ skip ] %.*s.%.*s: %s\n", static_cast<int>(test.suite.size()), test.suite.data(), static_cast<int>(test.name.size()), test.name.data(), skip.what());
+        }
+        catch (const std::exception& error) {
+            ++failed;
+            std::printf("[ FAIL ] %.*s.%.*s: %s\n", static_cast<int>(test.suite.size()), test.suite.data(), static_cast<int>(test.name.size()), test.name.data(), error.what());
+        }
+        std::fflush(stdout);
+    }
+
+    std::printf("%u passed, %u failed, %u skipped\n", passed, failed, skipped);
+
+    if (failed > 0) {
+        return 1;
+    }
+    if (passed == 0 && skipped > 0) {
+        return EXIT_SKIPPED;
+    }
+    if (passed == 0) {
+        std::fprintf(stderr, "no tests in suite '%.*s'\n", static_cast<int>(suite.size()), suite.data());
+        return EXIT_USAGE;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "gpu/context.hpp"
+#include "support/common/frame_arena.hpp"
+#include "support/common/pool_allocator.hpp"
+#include "support/common/small_vector.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Replaces the global allocation functions of the whole test executable, so every
+// operator new made anywhere, worker threads included, is counted.
+namespace {
+
+    std::atomic<uint64_t> heap_allocations{0};
+
+    auto counted_allocate(std::size_t size, std::size_t alignment) -> void* {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        size = std::max<std::size_t>(size, 1);
+        void* pointer = alignment <= alignof(std::max_align_t) ? std::malloc(size)
+                                                               : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+} // namespace
+
+auto operator new(std::size_t size) -> void* {
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+    return counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+auto operator delete(void* pointer) noexcept -> void {
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::size_t) noexcept -> void {
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::align_val_t) noexcept -> void {
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::size_t, std::align_val_t) noexcept -> void {
+    std::free(pointer);
+}
+
+namespace {
+
+    using namespace vulkron;
+
+    // Heap allocations made since construction
+    class AllocationCounter {
+        uint64_t _start = heap_allocations.load();
+
+      public:
+        [[nodiscard]] auto count() const noexcept -> uint64_t {
+            return heap_allocations.load() - _start;
+        }
+    };
+
+} // namespace
+
+// Called directly, unlike new-expressions the call can't be optimized away
+VULKRON_TEST(memory, counter_sees_allocations) {
+    const AllocationCounter counter;
+    void*                   pointer = ::operator new(16);
+    CHECK(counter.count() == 1);
+    ::operator delete(pointer);
+}
+
+VULKRON_TEST(memory, frame_arena_steady_state) {
+    constexpr uint32_t WARM_UP = 4;
+    constexpr uint32_t FRAMES  = 100;
+
+    support::FrameArena arena(4096);
+    uint64_t            steady = 0;
+
+    for (uint32_t frame = 0; frame < WARM_UP + FRAMES; ++frame) {
+        const AllocationCounter counter;
+
+        // Outgrows the first block on purpose, reset() coalesces
+        arena.reset();
+        std::pmr::vector<uint64_t> values(&arena);
+        for (uint64_t i = 0; i < 2000; ++i) {
+            values.push_back(i);
+        }
+        CHECK(values.back() == 1999);
+
+        if (frame >= WARM_UP) {
+            steady += counter.count();
+        }
+    }
+
+    CHECK(steady == 0);
+}
+
+VULKRON_TEST(memory, pool_allocator_steady_state) {
+    struct Node {
+        uint64_t key;
+        Node*    next;
+    };
+
+    support::PoolAllocator pool(sizeof(Node), alignof(Node), 64);
+    std::vector<Node*>     live;
+    live.reserve(100);
+
+    const auto churn = [&] {
+        for (uint64_t i = 0; i < 100; ++i) {
+            live.push_back(pool.create<Node>(i, nullptr));
+        }
+        for (Node* node : live) {
+            pool.destroy(node);
+        }
+        live.clear();
+    };
+
+    churn();
+    CHECK(pool.live() == 0);
+
+    const AllocationCounter counter;
+    for (uint32_t i = 0; i < 100; ++i) {
+        churn();
+    }
+    CHECK(counter.count() == 0);
+}
+
+VULKRON_TEST(memory, small_vector_spills_past_inline_capacity) {
+    const AllocationCounter counter;
+
+    support::SmallVector<uint32_t, 8> values;
+    for (uint32_t i = 0; i < 8; ++i) {
+        values.push_back(i);
+    }
+    CHECK(counter.count() == 0);
+
+    values.push_back(8);
+    CHECK(counter.count() == 1);
+    CHECK(values.size() == 9);
+    CHECK(values[8] == 8);
+}
+
+// Headless frames through the public Context, parallel recording included. Not run under the
+// validation layer, which would count its own allocations, see tests/CMakeLists.txt.
+VULKRON_TEST(memory_gpu, context_frames_steady_state) {
+    constexpr uint32_t WARM_UP = 10;
+    constexpr uint32_t FRAMES  = 100;
+
+    std::optional<gpu::Context> context;
+    try {
+        context.emplace(gpu::Context::Config{.frames_in_flight = 3, .headless = {.width = 64, .height = 64}});
+    }
+    catch (const std::exception& error) {
+        tests::skip(std::string("no usable Vulkan device: ") + error.what());
+    }
+
+    const gpu::Context::record_function no_commands = [](gpu::Context::native_command_buffer, uint32_t) {};
+
+    uint64_t steady = 0;
+    for (uint32_t frame = 0; frame < WARM_UP + FRAMES; ++frame) {
+        const AllocationCounter counter;
+
+        static_cast<void>(context->begin_frame());
+        context->record(4, no_commands);
+        context->render(4, no_commands);
+        context->end_frame();
+
+        if (frame >= WARM_UP) {
+            steady += counter.count();
+        }
+    }
+    context->wait_idle();
+
+    CHECK(steady == 0);
+}
@@ -0,0 +1,118 @@
+#include "gpu_device.hpp"
+#include "pipeline_cache.hpp"
+#include "scratch_directory.hpp"
+#include "test.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+    using namespace vulkron;
+    using gpu::vulkan::PipelineCache;
+    using tests::ScratchDirectory;
+
+    // Byte offsets into the file header of pipeline_cache.cpp, after the 8 byte magic and the version
+    constexpr size_t VENDOR_ID_OFFSET           = 12;
+    constexpr size_t DEVICE_ID_OFFSET           = 16;
+    constexpr size_t PIPELINE_CACHE_UUID_OFFSET = 24;
+
+    auto read_file(const std::filesystem::path& path) -> std::string {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    auto write_file(const std::filesystem::path& path, const std::string& contents) -> void {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    auto open_cache(const gpu::vulkan::Device& device, const std::filesystem::path& path) -> std::unique_ptr<PipelineCache> {
+        return std::make_unique<PipelineCache>(device.dispatch(), *device.instance()->adapter(device.physical_device_handle()), device.device_handle(), path);
+    }
+
+    // Saves the cache of an empty VkPipelineCache to `path`, which is the driver's header and nothing else
+    auto save_cache(const gpu::vulkan::Device& device, const std::filesystem::path& path) -> std::string {
+        CHECK(open_cache(device, path)->save());
+        return read_file(path);
+    }
+
+    // Stats of a PipelineCache loading `contents`, the file is left to the cache's destructor to overwrite
+    auto load_cache(const gpu::vulkan::Device& device, const std::filesystem::path& path, const std::string& contents) -> PipelineCache::Stats {
+        write_file(path, contents);
+        const std::unique_ptr<PipelineCache> cache = open_cache(device, path);
+        CHECK(cache->handle() != VK_NULL_HANDLE);
+        return cache->stats();
+    }
+
+} // namespace
+
+VULKRON_TEST(pipeline_cache_gpu, saved_cache_is_loaded) {
+    gpu::vulkan::Device    device = tests::test_device();
+    const ScratchDirectory directory("saved-cache");
+    const auto             path = directory.path() / "pipelines.bin";
+
+    const std::string          saved = save_cache(device, path);
+    const PipelineCache::Stats stats = load_cache(device, path, saved);
+    CHECK(stats.load_result == PipelineCache::LoadResult::Loaded);
+    CHECK(stats.loaded_bytes > 0);
+}
+
+VULKRON_TEST(pipeline_cache_gpu, truncated_file_is_rejected) {
+    gpu::vulkan::Device    device = tests::test_device();
+    const ScratchDirectory directory("truncated-cache");
+    const auto             path = directory.path() / "pipelines.bin";
+
+    const std::string saved = save_cache(device, path);
+    CHECK(saved.size() > 1);
+
+    // Cut inside the driver's blob, and inside our own header
+    for (const size_t size : {saved.size() - 1, size_t{VENDOR_ID_OFFSET}}) {
+        const PipelineCache::Stats stats = load_cache(device, path, saved.substr(0, size));
+        CHECK(stats.load_result == PipelineCache::LoadResult::Rejected);
+        CHECK(stats.loaded_bytes == 0);
+    }
+}
+
+VULKRON_TEST(pipeline_cache_gpu, foreign_header_is_rejected) {
+    gpu::vulkan::Device    device = tests::test_device();
+    const ScratchDirectory directory("foreign-cache");
+    const auto             path = directory.path() / "pipelines.bin";
+
+    const std::string saved = save_cache(device, path);
+
+    // As if written by another vendor, another device or a driver with another cache layout
+    for (const size_t offset : {VENDOR_ID_OFFSET, DEVICE_ID_OFFSET, PIPELINE_CACHE_UUID_OFFSET}) {
+        std::string foreign = saved;
+        foreign[offset]     = static_cast<char>(foreign[offset] ^ 0x5a);
+
+        const PipelineCache::Stats stats = load_cache(device, path, foreign);
+        CHECK(stats.load_result == PipelineCache::LoadResult::Rejected);
+        CHECK(stats.loaded_bytes == 0);
+    }
+}
+
+VULKRON_TEST(pipeline_cache_gpu, thread_caches_are_released_on_exit) {
+    gpu::vulkan::Device                  device = tests::test_device();
+    const std::unique_ptr<PipelineCache> cache  = open_cache(device, {});
+
+    // A failed CHECK would terminate on another thread, the results are checked after the join
+    VkPipelineCache first         = VK_NULL_HANDLE;
+    VkPipelineCache second        = VK_NULL_HANDLE;
+    uint32_t        while_running = 0;
+    std::thread([&] {
+        first         = cache->thread_handle();
+        second        = cache->thread_handle();
+        while_running = cache->stats().thread_caches;
+    }).join();
+
+    CHECK(first != VK_NULL_HANDLE && first == second);
+    CHECK(while_running == 1);
+    CHECK(cache->stats().thread_caches == 0);
+}
@@ -0,0 +1,221 @@
+#include "compute.hpp"
+#include "gpu_device.hpp"
+#include "render_graph.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace {
+
+    using namespace vulkron;
+    using gpu::graphs::RenderGraph;
+    using gpu::graphs::ResourceHandle;
+    using gpu::graphs::ResourceUsage;
+
+    // compile() without a device never calls Vulkan, imports only need to be non-null
+    template <typename Handle>
+    auto fake_handle(uint64_t value) -> Handle {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return reinterpret_cast<Handle>(static_cast<uintptr_t>(value));
+        }
+        else {
+            return static_cast<Handle>(value);
+        }
+    }
+
+    constexpr uint32_t CHAINS      = 4;
+    constexpr uint32_t CHAIN_DEPTH = 5;
+
+    // Four independent chains of five compute passes, declared chain by chain. Each
+    // pass reads and writes its chain's resource, so every level needs one barrier per chain.
+    auto add_chains(RenderGraph& graph, const std::array<ResourceHandle, CHAINS>& resources) -> void {
+        for (uint32_t chain = 0; chain < CHAINS; ++chain) {
+            for (uint32_t depth = 0; depth < CHAIN_DEPTH; ++depth) {
+                RenderGraph::PassBuilder pass = graph.add_pass("chain", [](VkCommandBuffer) {});
+                pass.write(resources[chain], ResourceUsage::ComputeStorageReadWrite);
+
+                // Transient contents are dead after the graph, the last pass is what observes them
+                if (depth == CHAIN_DEPTH - 1) {
+                    pass.keep();
+                }
+            }
+        }
+    }
+
+} // namespace
+
+VULKRON_TEST(render_graph, twenty_passes_batch_barriers_per_level) {
+    const VkImageSubresourceRange color = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    RenderGraph graph;
+    const std::array<ResourceHandle, CHAINS> resources = {
+        graph.import_image("image_0", {.image = fake_handle<VkImage>(1), .range = color, .final_usage = ResourceUsage::TransferSrc}),
+        graph.import_image("image_1", {.image = fake_handle<VkImage>(2), .range = color, .final_usage = ResourceUsage::TransferSrc}),
+        graph.import_buffer("buffer_0", {.buffer = fake_handle<VkBuffer>(3)}),
+        graph.import_buffer("buffer_1", {.buffer = fake_handle<VkBuffer>(4)})
+    };
+    add_chains(graph, resources);
+    graph.compile();
+
+    const RenderGraph::CompileStats& stats = graph.stats();
+    CHECK(stats.pass_count == CHAINS * CHAIN_DEPTH);
+    CHECK(stats.culled_passes == 0);
+    CHECK(stats.level_count == CHAIN_DEPTH);
+
+    // Level 0 only transitions the images out of UNDEFINED, levels 1-4 order every
+    // chain after its previous pass, and a final batch hands the images back.
+    // One vkCmdPipelineBarrier2 per pass would have taken 18 calls.
+    CHECK(stats.barrier_batches == CHAIN_DEPTH + 1);
+    CHECK(stats.image_barriers == 2 + 2 * (CHAIN_DEPTH - 1) + 2);
+    CHECK(stats.buffer_barriers == 2 * (CHAIN_DEPTH - 1));
+
+    // Level by level, declaration order within a level
+    const std::vector<uint32_t>& order = graph.execution_order();
+    CHECK(order.size() == CHAINS * CHAIN_DEPTH);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        CHECK(order[i] == (i % CHAINS) * CHAIN_DEPTH + i / CHAINS);
+    }
+}
+
+VULKRON_TEST(render_graph, readers_of_one_level_share_a_barrier) {
+    RenderGraph graph;
+    const ResourceHandle buffer = graph.import_buffer("buffer", {.buffer = fake_handle<VkBuffer>(1)});
+
+    graph.add_pass("produce", {}).write(buffer, ResourceUsage::ComputeStorageWrite);
+    graph.add_pass("storage", {}).read(buffer, ResourceUsage::ComputeStorageRead).keep();
+    graph.add_pass("uniform", {}).read(buffer, ResourceUsage::ComputeUniformBuffer).keep();
+    graph.add_pass("indirect", {}).read(buffer, ResourceUsage::IndirectBuffer).keep();
+    graph.compile();
+
+    CHECK(graph.stats().level_count == 2);
+    CHECK(graph.stats().barrier_batches == 1);
+    CHECK(graph.stats().buffer_barriers == 1);
+}
+
+VULKRON_TEST(render_graph, unobserved_passes_are_culled) {
+    RenderGraph graph;
+    const ResourceHandle output  = graph.import_buffer("output", {.buffer = fake_handle<VkBuffer>(1)});
+    const ResourceHandle scratch = graph.create_buffer("scratch", {.size = 1024});
+
+    graph.add_pass("used", {}).write(output, ResourceUsage::ComputeStorageWrite);
+    graph.add_pass("unused", {}).write(scratch, ResourceUsage::ComputeStorageWrite);
+
+    // The only transient is culled with its pass, so no device is needed
+    graph.compile();
+
+    CHECK(graph.stats().culled_passes == 1);
+    CHECK(graph.is_culled(1));
+    CHECK(!graph.is_culled(0));
+}
+
+VULKRON_TEST(render_graph, transients_need_a_device) {
+    RenderGraph graph;
+    const ResourceHandle scratch = graph.create_buffer("scratch", {.size = 1024});
+
+    graph.add_pass("write", {}).write(scratch, ResourceUsage::ComputeStorageWrite).keep();
+
+    CHECK_THROWS(graph.compile());
+}
+
+// The same 20 passes on transient resources, executed twice in one submission. ctest runs
+// this suite with the validation layer and fails on any message it prints.
+VULKRON_TEST(render_graph_gpu, twenty_passes_execute) {
+    gpu::vulkan::Device device = tests::test_device();
+
+    const gpu::graphs::ImageDesc image = {.format = VK_FORMAT_R8G8B8A8_UNORM, .extent = {64, 64, 1}};
+
+    RenderGraph graph;
+    const std::array<ResourceHandle, CHAINS> resources = {
+        graph.create_image("image_0", image),
+        graph.create_image("image_1", image),
+        graph.create_buffer("buffer_0", {.size = 64 << 10}),
+        graph.create_buffer("buffer_1", {.size = 64 << 10})
+    };
+    add_chains(graph, resources);
+    graph.compile(device);
+
+    // Every chain also waits for its own last use in the previous execution
+    const RenderGraph::CompileStats& stats = graph.stats();
+    CHECK(stats.transient_resources == CHAINS);
+    CHECK(stats.level_count == CHAIN_DEPTH);
+    CHECK(stats.barrier_batches == CHAIN_DEPTH);
+    CHECK(stats.image_barriers == 2 * CHAIN_DEPTH);
+    CHECK(stats.buffer_barriers == 2 * CHAIN_DEPTH);
+    CHECK(graph.image(resources[0]) != VK_NULL_HANDLE);
+    CHECK(graph.buffer(resources[2]) != VK_NULL_HANDLE);
+
+    gpu::vulkan::ComputeQueue queue(device);
+    graph.execute(device, queue.command_buffer());
+    graph.execute(device, queue.command_buffer());
+    queue.wait(queue.submit());
+}
+
+namespace {
+
+    constexpr VkDeviceSize STAGE_SIZE = 64 << 10;
+
+    // Three passes in a row, each reading the previous stage's buffer and writing its own. Stages
+    // 0 and 2 are never alive at once, stage 1 overlaps both.
+    auto add_stages(RenderGraph& graph) -> std::array<ResourceHandle, 3> {
+        const std::array<ResourceHandle, 3> stages = {
+            graph.create_buffer("stage_0", {.size = STAGE_SIZE}),
+            graph.create_buffer("stage_1", {.size = STAGE_SIZE}),
+            graph.create_buffer("stage_2", {.size = STAGE_SIZE})
+        };
+
+        graph.add_pass("first", [](VkCommandBuffer) {}).write(stages[0], ResourceUsage::ComputeStorageWrite);
+        graph.add_pass("second", [](VkCommandBuffer) {})
+            .read(stages[0], ResourceUsage::ComputeStorageRead)
+            .write(stages[1], ResourceUsage::ComputeStorageWrite);
+        graph.add_pass("third", [](VkCommandBuffer) {})
+            .read(stages[1], ResourceUsage::ComputeStorageRead)
+            .write(stages[2], ResourceUsage::ComputeStorageWrite)
+            .keep();
+        return stages;
+    }
+
+} // namespace
+
+VULKRON_TEST(render_graph_gpu, disjoint_transients_share_memory) {
+    gpu::vulkan::Device device = tests::test_device();
+
+    RenderGraph graph;
+    const std::array<ResourceHandle, 3> stages = add_stages(graph);
+    graph.compile(device);
+
+    const RenderGraph::MemoryBinding first  = graph.memory_binding(stages[0]);
+    const RenderGraph::MemoryBinding middle = graph.memory_binding(stages[1]);
+    const RenderGraph::MemoryBinding last   = graph.memory_binding(stages[2]);
+    CHECK(first.memory == last.memory);
+    CHECK(first.offset == last.offset);
+
+    // The overlapping stage keeps a range of its own
+    CHECK(middle.memory != first.memory || middle.offset + middle.size <= first.offset || first.offset + first.size <= middle.offset);
+
+    const RenderGraph::CompileStats& stats = graph.stats();
+    CHECK(stats.transient_resources == 3);
+    CHECK(stats.transient_bytes < stats.unaliased_bytes);
+
+    // The validation layer checks the aliased buffers are used in order
+    gpu::vulkan::ComputeQueue queue(device);
+    graph.execute(device, queue.command_buffer());
+    queue.wait(queue.submit());
+}
+
+VULKRON_TEST(render_graph_gpu, aliasing_can_be_turned_off) {
+    gpu::vulkan::Device device = tests::test_device();
+
+    RenderGraph graph;
+    graph.set_aliasing(false);
+    const std::array<ResourceHandle, 3> stages = add_stages(graph);
+    graph.compile(device);
+
+    CHECK(graph.memory_binding(stages[0]).offset != graph.memory_binding(stages[2]).offset);
+    CHECK(graph.stats().transient_bytes == graph.stats().unaliased_bytes);
+
+    gpu::vulkan::ComputeQueue queue(device);
+    graph.execute(device, queue.command_buffer());
+    queue.wait(queue.submit());
+}
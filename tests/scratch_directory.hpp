@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace vulkron::tests {
+
+    /**
+     * @brief Empty directory under the system's temporary directory
+     *
+     * Named after the test so suites running in parallel don't share one.
+     * Anything left over from an earlier run is removed first, the directory
+     * itself is removed on destruction.
+     */
+    class ScratchDirectory {
+        std::filesystem::path _path;
+
+      public:
+        explicit ScratchDirectory(const std::string& name)
+            : _path(std::filesystem::temp_directory_path() / ("vulkron-tests-" + name))
+        {
+            std::filesystem::remove_all(_path);
+            std::filesystem::create_directories(_path);
+        }
+
+        ~ScratchDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(_path, error);
+        }
+
+        ScratchDirectory(const ScratchDirectory&) = delete;
+        auto operator=(const ScratchDirectory&) -> ScratchDirectory& = delete;
+
+        [[nodiscard]] auto path() const -> const std::filesystem::path& {
+            return _path;
+        }
+    };
+
+} // namespace vulkron::tests
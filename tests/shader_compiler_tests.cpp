@@ -0,0 +1,126 @@
+#include "scratch_directory.hpp"
+#include "shader_compiler.hpp"
+#include "support/common/config.hpp"
+#include "test.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using namespace vulkron;
+    using gpu::vulkan::ShaderBinary;
+    using gpu::vulkan::ShaderCompiler;
+    using gpu::vulkan::ShaderRequest;
+    using tests::ScratchDirectory;
+
+#if defined(VULKRON_PLATFORM_WINDOWS)
+    constexpr char             PATH_SEPARATOR = ';';
+    constexpr std::string_view SLANGC         = "slangc.exe";
+#else
+    constexpr char             PATH_SEPARATOR = ':';
+    constexpr std::string_view SLANGC         = "slangc";
+#endif
+
+    // Looks for slangc where the default Config runs it from
+    auto slangc_installed() -> bool {
+        const char* path = std::getenv("PATH");
+        if (path == nullptr) {
+            return false;
+        }
+
+        for (std::string_view directories = path; !directories.empty();) {
+            const size_t end = directories.find(PATH_SEPARATOR);
+
+            std::error_code error;
+            if (std::filesystem::is_regular_file(std::filesystem::path(directories.substr(0, end)) / SLANGC, error)) {
+                return true;
+            }
+            directories = end == std::string_view::npos ? std::string_view{} : directories.substr(end + 1);
+        }
+        return false;
+    }
+
+    auto write_file(const std::filesystem::path& path, std::string_view contents) -> void {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    // One kernel, and a header only the WITH_HEADER permutation includes
+    constexpr std::string_view KERNEL = R"(#ifdef WITH_HEADER
+#include "scale.slang"
+#else
+static const float SCALE = 1.0;
+#endif
+
+RWStructuredBuffer<float> values;
+
+[shader("compute")]
+[numthreads(64, 1, 1)]
+void main(uint3 thread : SV_DispatchThreadID) {
+    values[thread.x] *= SCALE;
+}
+)";
+
+    constexpr std::string_view HEADER        = "static const float SCALE = 2.0;\n";
+    constexpr std::string_view EDITED_HEADER = "static const float SCALE = 3.0;\n";
+
+} // namespace
+
+VULKRON_TEST(shader_compiler, editing_an_include_recompiles_only_its_permutations) {
+    if (!slangc_installed()) {
+        tests::skip("slangc is not on the PATH");
+    }
+
+    const ScratchDirectory directory("shader-includes");
+    const auto             shaders = directory.path() / "shaders";
+    std::filesystem::create_directories(shaders);
+    write_file(shaders / "kernel.slang", KERNEL);
+    write_file(shaders / "scale.slang", HEADER);
+
+    const std::vector<ShaderRequest> requests = {
+        {.source = shaders / "kernel.slang", .defines = {{"WITH_HEADER", ""}}},
+        {.source = shaders / "kernel.slang"}
+    };
+
+    // A new compiler per step, so its stats count that step's lookups only
+    const auto compile = [&] {
+        ShaderCompiler compiler({.cache_directory = directory.path() / "cache", .include_directories = {shaders}});
+
+        const std::vector<ShaderBinary> binaries = compiler.compile(requests);
+        CHECK(binaries.size() == requests.size());
+        CHECK(!binaries[0].spirv.empty() && !binaries[1].spirv.empty());
+        CHECK(compiler.stats().hits + compiler.stats().misses == requests.size());
+        return binaries;
+    };
+
+    std::vector<ShaderBinary> binaries = compile();
+    CHECK(!binaries[0].cached && !binaries[1].cached);
+
+    binaries = compile();
+    CHECK(binaries[0].cached && binaries[1].cached);
+
+    // The cache goes by content, a newer timestamp alone changes nothing
+    const auto header = shaders / "scale.slang";
+    std::filesystem::last_write_time(header, std::filesystem::last_write_time(header) + std::chrono::hours(1));
+    binaries = compile();
+    CHECK(binaries[0].cached && binaries[1].cached);
+
+    const uint64_t including_key = binaries[0].key;
+    const uint64_t excluding_key = binaries[1].key;
+
+    write_file(header, EDITED_HEADER);
+    binaries = compile();
+    CHECK(!binaries[0].cached);
+    CHECK(binaries[1].cached);
+    CHECK(binaries[0].key != including_key);
+    CHECK(binaries[1].key == excluding_key);
+
+    binaries = compile();
+    CHECK(binaries[0].cached && binaries[1].cached);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <source_location>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vulkron::tests {
+
+    /**
+     * @brief One test case, registered by VULKRON_TEST at static initialization
+     *
+     * Tests of a suite run in registration order, each stops at its first
+     * failed CHECK. ctest runs one suite per test so suites can carry their
+     * own environment, see tests/CMakeLists.txt.
+     */
+    struct Test {
+        std::string_view suite;
+        std::string_view name;
+        void           (*run)();
+    };
+
+    // Thrown by a failed CHECK
+    struct Failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // Thrown by skip(), e.g. when there is no Vulkan device to run on
+    struct Skipped : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    [[nodiscard]] auto registry() -> std::vector<Test>&;
+
+    struct Registration {
+        Registration(std::string_view suite, std::string_view name, void (*run)()) {
+            registry().push_back(Test{suite, name, run});
+        }
+    };
+
+    [[noreturn]] inline auto fail(std::string_view expression, std::source_location location = std::source_location::current()) -> void {
+        throw Failure(std::string(location.file_name()) + ":" + std::to_string(location.line()) + ": CHECK(" + std::string(expression) + ") failed");
+    }
+
+    [[noreturn]] inline auto skip(std::string_view reason) -> void {
+        throw Skipped(std::string(reason));
+    }
+
+} // namespace vulkron::tests
+
+#define VULKRON_TEST_CONCAT_IMPL(a, b) a##b
+#define VULKRON_TEST_CONCAT(a, b)      VULKRON_TEST_CONCAT_IMPL(a, b)
+
+// Defines a test function and registers it under `suite`
+#define VULKRON_TEST(suite, name)                                                 \
+    static auto VULKRON_TEST_CONCAT(test_, __LINE__)() -> void;                   \
+    static const ::vulkron::tests::Registration VULKRON_TEST_CONCAT(registration_, \
+        __LINE__)(#suite, #name, &VULKRON_TEST_CONCAT(test_, __LINE__));           \
+    static auto VULKRON_TEST_CONCAT(test_, __LINE__)() -> void
+
+#define CHECK(expression)                        \
+    do {                                         \
+        if (!(expression)) {                     \
+            ::vulkron::tests::fail(#expression); \
+        }                                        \
+    } while (false)
+
+#define CHECK_THROWS(expression)                           \
+    do {                                                   \
+        bool thrown = false;                               \
+        try {                                              \
+            static_cast<void>(expression);                 \
+        }                                                  \
+        catch (const std::exception&) {                    \
+            thrown = true;                                 \
+        }                                                  \
+        if (!thrown) {                                     \
+            ::vulkron::tests::fail(#expression " throws"); \
+        }                                                  \
+    } while (false)